@@ -0,0 +1,22 @@
+# edgecase's own scaling benchmarks (see README)
+# builds edgecase-bench from the application's shared sources (see src/src.pri)
+
+# Qt libraries config
+QT += core gui network
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+# app settings
+TARGET   = edgecase-bench
+TEMPLATE = app
+
+# source code
+include(../src/src.pri)
+
+SOURCES += exportcheck.cpp \
+           fakeprogramgenerator.cpp \
+           main.cpp \
+           scalebenchmark.cpp
+
+HEADERS += exportcheck.h \
+           fakeprogramgenerator.h \
+           scalebenchmark.h
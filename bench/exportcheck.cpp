@@ -0,0 +1,124 @@
+#include "exportcheck.h"
+#include "fakeprogramgenerator.h"
+#include "jsonreader.h"
+#include "programfinder.h"
+#include "resultexporter.h"
+#include "scalebenchmark.h"
+#include "testrunner.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+
+    const int Timeout = 60 * 1000; // msecs, per phase
+
+    // as written by FakeProgramGenerator
+    const char* const CrashingProgram = "gtest_crash_0001";
+
+} // namespace Constants
+
+// ------------------------------
+// ExportCheck implementation
+// ------------------------------
+
+ExportCheck::ExportCheck(const QString& directory)
+    : m_directory(directory)
+{ }
+
+ExportCheck::~ExportCheck(void) { }
+
+bool ExportCheck::checkJson(const QString& filename, const QString& programName, QString* error) const {
+
+    QFile file(filename);
+    if ( !file.open(QFile::ReadOnly) ) {
+        *error = QString("Could not read %1: %2").arg(filename, file.errorString());
+        return false;
+    }
+    QString parseError;
+    const QVariantMap root = JsonReader::parse(file.readAll(), &parseError).toMap();
+    if ( !parseError.isEmpty() ) {
+        *error = QString("%1: %2").arg(filename, parseError);
+        return false;
+    }
+
+    // program entry w/ its error
+    const QVariantList programs = root.value("programs").toList();
+    foreach ( const QVariant& program, programs ) {
+        const QVariantMap fields = program.toMap();
+        if ( fields.value("name").toString() == programName && !fields.value("error").toString().isEmpty() )
+            return true;
+    }
+    *error = QString("%1: no error entry for %2").arg(filename, programName);
+    return false;
+}
+
+bool ExportCheck::checkJUnit(const QString& filename, const QString& programName, QString* error) const {
+
+    QFile file(filename);
+    if ( !file.open(QFile::ReadOnly) ) {
+        *error = QString("Could not read %1: %2").arg(filename, file.errorString());
+        return false;
+    }
+
+    // program's own <testsuite>, w/ an error
+    QXmlStreamReader xml(&file);
+    while ( !xml.atEnd() ) {
+        xml.readNext();
+        if ( !xml.isStartElement() || xml.name().toString() != "testsuite" )
+            continue;
+        const QXmlStreamAttributes attributes = xml.attributes();
+        if ( attributes.value("name").toString() == programName && attributes.value("errors").toString() == "1" )
+            return true;
+    }
+    *error = ( xml.hasError() ? QString("%1: %2").arg(filename, xml.errorString())
+                              : QString("%1: no errored testsuite for %2").arg(filename, programName) );
+    return false;
+}
+
+bool ExportCheck::run(QString* error) {
+
+    Q_ASSERT_X(error, Q_FUNC_INFO, "null error string");
+
+    // a few good programs, & one that crashes when listed
+    FakeProgramGenerator::Settings settings;
+    settings.programs = 2;
+    settings.suites = 2;
+    settings.tests = 2;
+    settings.framework = FakeProgramGenerator::GoogleTest;
+    settings.failureRate = 0.0;
+    settings.crashingPrograms = 1;
+    FakeProgramGenerator generator(settings);
+    if ( !generator.generate(m_directory, error) )
+        return false;
+
+    // list & run, streaming results as headless mode does
+    TestRunner runner;
+    runner.programFinder()->setUsesIndex(false);
+    const QString junitFilename = QDir(m_directory).absoluteFilePath("results.xml");
+    const QString jsonFilename  = QDir(m_directory).absoluteFilePath("results.json");
+    ResultExporter junitExporter(ResultExporter::JUnitXml, junitFilename);
+    ResultExporter jsonExporter(ResultExporter::Json, jsonFilename);
+    junitExporter.attach(&runner);
+    jsonExporter.attach(&runner);
+
+    QMetaObject::invokeMethod(&runner, "listTests", Qt::QueuedConnection,
+                              Q_ARG(QString, FakeProgramGenerator::programsDirectory(m_directory)),
+                              Q_ARG(bool, true));
+    if ( !ScaleBenchmark::waitFor(&runner, SIGNAL(listTestsFinished()), Constants::Timeout) ) {
+        *error = "Timed out during listing";
+        return false;
+    }
+    QMetaObject::invokeMethod(&runner, "runTests", Qt::QueuedConnection);
+    if ( !ScaleBenchmark::waitFor(&runner, SIGNAL(runTestsFinished()), Constants::Timeout) ) {
+        *error = "Timed out during run";
+        return false;
+    }
+    if ( junitExporter.hasError() || jsonExporter.hasError() ) {
+        *error = ( junitExporter.hasError() ? junitExporter.errorString() : jsonExporter.errorString() );
+        return false;
+    }
+
+    // both files must report the crashed program
+    return checkJUnit(junitFilename, Constants::CrashingProgram, error) &&
+           checkJson(jsonFilename, Constants::CrashingProgram, error);
+}
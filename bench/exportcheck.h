@@ -0,0 +1,34 @@
+#ifndef EXPORTCHECK_H
+#define EXPORTCHECK_H
+
+#include <QString>
+
+// checks that result files streamed during a run (see ResultExporter::attach())
+// report every program, including one that crashes while being listed (so is
+// never run) - as headless mode's exit code does
+//
+// generates a couple of passing GoogleTest programs & one crashing one (see
+// FakeProgramGenerator), lists & runs them w/ JUnit & JSON exporters attached,
+// & reads both files back.
+class ExportCheck {
+
+    // ctor & dtor
+    public:
+        explicit ExportCheck(const QString& directory);
+        ~ExportCheck(void);
+
+    // ExportCheck interface
+    public:
+        bool run(QString* error);
+
+    // internal methods
+    private:
+        bool checkJson(const QString& filename, const QString& programName, QString* error) const;
+        bool checkJUnit(const QString& filename, const QString& programName, QString* error) const;
+
+    // data members
+    private:
+        QString m_directory;
+};
+
+#endif // EXPORTCHECK_H
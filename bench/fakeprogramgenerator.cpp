@@ -0,0 +1,356 @@
+#include "fakeprogramgenerator.h"
+#include <QtCore>
+#include <QtDebug>
+#include <math.h>
+
+namespace Constants {
+
+    const int NameDigits = 4;   // 'gtest_fake_0001'
+    const int MaxExitCode = 127;
+
+} // namespace Constants
+
+// returns text quoted for use in a shell script
+static
+QString shellQuote(const QString& text) {
+    QString quoted = text;
+    quoted.replace("'", "'\\''");
+    return "'" + quoted + "'";
+}
+
+// writes file contents, optionally marking it executable
+static
+bool writeFile(const QString& filename, const QByteArray& contents, bool isExecutable, QString* error) {
+
+    Q_ASSERT_X(error, Q_FUNC_INFO, "null error string");
+
+    QFile file(filename);
+    if ( !file.open(QFile::WriteOnly | QFile::Truncate) ||
+         file.write(contents) != contents.size() )
+    {
+        *error = QString("Could not write %1: %2").arg(filename, file.errorString());
+        return false;
+    }
+    file.close();
+
+    if ( isExecutable ) {
+        const QFile::Permissions execPermissions = QFile::ExeOwner | QFile::ExeUser | QFile::ExeGroup | QFile::ExeOther;
+        if ( !file.setPermissions(file.permissions() | execPermissions) ) {
+            *error = QString("Could not make %1 executable: %2").arg(filename, file.errorString());
+            return false;
+        }
+    }
+    return true;
+}
+
+// returns shell command that sleeps for a run's duration (empty if none)
+static
+QString sleepCommand(double seconds) {
+    if ( seconds < 0.0005 )
+        return QString();
+    return QString("sleep %1\n").arg(seconds, 0, 'f', 3);
+}
+
+// ------------------------------------------
+// FakeProgramGenerator::Settings implementation
+// ------------------------------------------
+
+FakeProgramGenerator::Settings::Settings(void)
+    : programs(10)
+    , suites(5)
+    , tests(10)
+    , framework(FakeProgramGenerator::MixedFrameworks)
+    , failureRate(0.05)
+    , failureMessageBytes(256)
+    , sleepMsecs(0)
+    , sleepDistribution(FakeProgramGenerator::FixedSleep)
+    , seed(1)
+    , crashingPrograms(0)
+{ }
+
+// ------------------------------------------
+// FakeProgramGenerator implementation
+// ------------------------------------------
+
+FakeProgramGenerator::FakeProgramGenerator(const Settings& settings)
+    : m_settings(settings)
+    , m_testCount(0)
+    , m_failedTestCount(0)
+{ }
+
+FakeProgramGenerator::~FakeProgramGenerator(void) { }
+
+QByteArray FakeProgramGenerator::failureMessage(const QString& testName) const {
+
+    // GoogleTest-like message, padded out to the requested size
+    QByteArray message = QString("fake.cpp:42: Failure\nExpected equality of these values (in %1):\n")
+                             .arg(testName)
+                             .toUtf8();
+    const QByteArray filler("  Actual: 0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnop\n");
+    while ( message.size() < m_settings.failureMessageBytes )
+        message.append(filler);
+    message.truncate( qMax(m_settings.failureMessageBytes, 1) );
+    return message;
+}
+
+int FakeProgramGenerator::failedTestCount(void) const {
+    return m_failedTestCount;
+}
+
+bool FakeProgramGenerator::frameworkFromName(const QString& name, Framework* framework) {
+    Q_ASSERT_X(framework, Q_FUNC_INFO, "null framework");
+    if      ( name == "gtest" ) *framework = FakeProgramGenerator::GoogleTest;
+    else if ( name == "qtest" ) *framework = FakeProgramGenerator::QtTestLib;
+    else if ( name == "mixed" ) *framework = FakeProgramGenerator::MixedFrameworks;
+    else
+        return false;
+    return true;
+}
+
+bool FakeProgramGenerator::generate(const QString& directory, QString* error) {
+
+    Q_ASSERT_X(error, Q_FUNC_INFO, "null error string");
+
+    m_programsDirectory = programsDirectory(directory);
+    m_dataDirectory = QDir(directory).absoluteFilePath("data");
+    m_testCount = 0;
+    m_failedTestCount = 0;
+
+    if ( !QDir().mkpath(m_programsDirectory) || !QDir().mkpath(m_dataDirectory) ) {
+        *error = QString("Could not create directories in %1").arg(directory);
+        return false;
+    }
+
+    // same programs & results for the same seed
+    qsrand(m_settings.seed);
+
+    for ( int i = 0; i < m_settings.programs; ++i ) {
+
+        Framework framework = m_settings.framework;
+        if ( framework == FakeProgramGenerator::MixedFrameworks )
+            framework = ( i % 2 == 0 ? FakeProgramGenerator::GoogleTest : FakeProgramGenerator::QtTestLib );
+
+        const QString number = QString("%1").arg(i + 1, Constants::NameDigits, 10, QChar('0'));
+        const double seconds = sleepSeconds();
+        const bool ok = ( framework == FakeProgramGenerator::GoogleTest
+                          ? writeGoogleTest("gtest_fake_" + number, seconds, error)
+                          : writeQTestLib("tst_fake_" + number, seconds, error) );
+        if ( !ok )
+            return false;
+    }
+
+    for ( int i = 0; i < m_settings.crashingPrograms; ++i ) {
+        const QString number = QString("%1").arg(i + 1, Constants::NameDigits, 10, QChar('0'));
+        if ( !writeCrashingGoogleTest("gtest_crash_" + number, error) )
+            return false;
+    }
+    return true;
+}
+
+bool FakeProgramGenerator::isFailing(void) const {
+    return ( qrand() < m_settings.failureRate * RAND_MAX );
+}
+
+QString FakeProgramGenerator::programsDirectory(const QString& directory) {
+    return QDir(directory).absoluteFilePath("programs");
+}
+
+double FakeProgramGenerator::sleepSeconds(void) const {
+
+    const double mean = m_settings.sleepMsecs / 1000.0;
+    const double uniform = ( qrand() + 1.0 ) / ( RAND_MAX + 2.0 ); // (0, 1)
+
+    switch ( m_settings.sleepDistribution ) {
+        case FakeProgramGenerator::UniformSleep     : return 2.0 * mean * uniform;
+        case FakeProgramGenerator::ExponentialSleep : return -mean * ::log(uniform);
+        case FakeProgramGenerator::FixedSleep       :
+        default:
+            return mean;
+    }
+}
+
+bool FakeProgramGenerator::sleepDistributionFromName(const QString& name, SleepDistribution* distribution) {
+    Q_ASSERT_X(distribution, Q_FUNC_INFO, "null distribution");
+    if      ( name == "fixed" )       *distribution = FakeProgramGenerator::FixedSleep;
+    else if ( name == "uniform" )     *distribution = FakeProgramGenerator::UniformSleep;
+    else if ( name == "exponential" ) *distribution = FakeProgramGenerator::ExponentialSleep;
+    else
+        return false;
+    return true;
+}
+
+int FakeProgramGenerator::testCount(void) const {
+    return m_testCount;
+}
+
+bool FakeProgramGenerator::writeCrashingGoogleTest(const QString& name, QString* error) {
+
+    // killed by a signal while listing, like a program w/ a broken static initializer
+    const QString script =
+        "#!/bin/sh\n"
+        "# fake GoogleTest program that crashes, generated by edgecase-bench\n"
+        "kill -SEGV $$\n";
+    return writeFile(QDir(m_programsDirectory).absoluteFilePath(name), script.toUtf8(), true, error);
+}
+
+bool FakeProgramGenerator::writeGoogleTest(const QString& name, double seconds, QString* error) {
+
+    const int numTests = m_settings.suites * m_settings.tests;
+    const QString testTime = QString::number( ( numTests > 0 ? seconds / numTests : 0.0 ), 'f', 3 );
+
+    QByteArray listing;
+    QByteArray output;
+    QByteArray xml;
+    QXmlStreamWriter writer(&xml);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeStartElement("testsuites");
+    writer.writeAttribute("name", "AllTests");
+    writer.writeAttribute("tests", QString::number(numTests));
+    writer.writeAttribute("time", QString::number(seconds, 'f', 3));
+
+    int numFailed = 0;
+    for ( int i = 0; i < m_settings.suites; ++i ) {
+        const QString suiteName = QString("FakeSuite%1").arg(i + 1);
+        listing.append( (suiteName + ".\n").toUtf8() );
+
+        writer.writeStartElement("testsuite");
+        writer.writeAttribute("name", suiteName);
+        writer.writeAttribute("tests", QString::number(m_settings.tests));
+
+        for ( int j = 0; j < m_settings.tests; ++j ) {
+            const QString testName = QString("test%1").arg(j + 1);
+            const QString fullName = suiteName + '.' + testName;
+            listing.append( ("  " + testName + '\n').toUtf8() );
+
+            writer.writeStartElement("testcase");
+            writer.writeAttribute("name", testName);
+            writer.writeAttribute("status", "run");
+            writer.writeAttribute("time", testTime);
+            writer.writeAttribute("classname", suiteName);
+
+            output.append( ("[ RUN      ] " + fullName + '\n').toUtf8() );
+            if ( isFailing() ) {
+                const QByteArray message = failureMessage(fullName);
+                writer.writeStartElement("failure");
+                writer.writeAttribute("message", QString::fromUtf8(message.left(80)));
+                writer.writeCDATA(QString::fromUtf8(message));
+                writer.writeEndElement(); // failure
+                output.append(message);
+                output.append( ("\n[  FAILED  ] " + fullName + '\n').toUtf8() );
+                ++numFailed;
+            } else
+                output.append( ("[       OK ] " + fullName + '\n').toUtf8() );
+
+            writer.writeEndElement(); // testcase
+        }
+        writer.writeEndElement(); // testsuite
+    }
+    writer.writeEndElement(); // testsuites
+    writer.writeEndDocument();
+
+    const QString dataPrefix = QDir(m_dataDirectory).absoluteFilePath(name);
+    const QString script =
+        "#!/bin/sh\n"
+        "# fake GoogleTest program, generated by edgecase-bench\n"
+        "if [ \"$1\" = \"--gtest_list_tests\" ]; then\n"
+        "    exec cat " + shellQuote(dataPrefix + ".listing") + "\n"
+        "fi\n"
+        "xml=\n"
+        "for arg in \"$@\"; do\n"
+        "    case \"$arg\" in\n"
+        "        --gtest_output=xml:*) xml=\"${arg#--gtest_output=xml:}\" ;;\n"
+        "    esac\n"
+        "done\n"
+        + sleepCommand(seconds) +
+        "cat " + shellQuote(dataPrefix + ".out") + "\n"
+        "[ -n \"$xml\" ] && cp " + shellQuote(dataPrefix + ".xml") + " \"$xml\"\n"
+        + QString("exit %1\n").arg( numFailed > 0 ? 1 : 0 );
+
+    m_testCount += numTests;
+    m_failedTestCount += numFailed;
+    return writeFile(dataPrefix + ".listing", listing, false, error) &&
+           writeFile(dataPrefix + ".out", output, false, error) &&
+           writeFile(dataPrefix + ".xml", xml, false, error) &&
+           writeFile(QDir(m_programsDirectory).absoluteFilePath(name), script.toUtf8(), true, error);
+}
+
+bool FakeProgramGenerator::writeQTestLib(const QString& name, double seconds, QString* error) {
+
+    const int numTests = m_settings.suites * m_settings.tests;
+    const QString testMsecs = QString::number( ( numTests > 0 ? seconds * 1000.0 / numTests : 0.0 ), 'f', 3 );
+    const QString suiteName = "FakeTest" + name.mid(name.lastIndexOf('_') + 1);
+
+    QByteArray listing;
+    QByteArray xml;
+    QXmlStreamWriter writer(&xml);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeStartElement("TestCase");
+    writer.writeAttribute("name", suiteName);
+
+    // initTestCase & cleanupTestCase aren't listed, but are always run
+    QStringList testNames;
+    testNames << "initTestCase";
+    for ( int i = 0; i < numTests; ++i ) {
+        const QString testName = QString("test%1").arg(i + 1);
+        listing.append( QString("%1 %2\n").arg(suiteName, testName).toUtf8() );
+        testNames << testName;
+    }
+    testNames << "cleanupTestCase";
+
+    int numFailed = 0;
+    foreach ( const QString& testName, testNames ) {
+        writer.writeStartElement("TestFunction");
+        writer.writeAttribute("name", testName);
+
+        const bool isListed = ( testName != "initTestCase" && testName != "cleanupTestCase" );
+        writer.writeStartElement("Incident");
+        if ( isListed && isFailing() ) {
+            writer.writeAttribute("type", "fail");
+            writer.writeAttribute("file", "fake.cpp");
+            writer.writeAttribute("line", "42");
+            writer.writeStartElement("Description");
+            writer.writeCDATA( QString::fromUtf8(failureMessage(suiteName + "::" + testName)) );
+            writer.writeEndElement(); // Description
+            ++numFailed;
+        } else {
+            writer.writeAttribute("type", "pass");
+            writer.writeAttribute("file", "");
+            writer.writeAttribute("line", "0");
+        }
+        writer.writeEndElement(); // Incident
+
+        writer.writeEmptyElement("Duration");
+        writer.writeAttribute("msecs", ( isListed ? testMsecs : QString("0") ));
+        writer.writeEndElement(); // TestFunction
+    }
+    writer.writeEndElement(); // TestCase
+    writer.writeEndDocument();
+
+    // QTestLib writes nothing to the console when given an output file
+    const QString dataPrefix = QDir(m_dataDirectory).absoluteFilePath(name);
+    const QString script =
+        "#!/bin/sh\n"
+        "# fake QTestLib program, generated by edgecase-bench\n"
+        "if [ \"$1\" = \"-datatags\" ]; then\n"
+        "    exec cat " + shellQuote(dataPrefix + ".listing") + "\n"
+        "fi\n"
+        "xml=\n"
+        "while [ $# -gt 0 ]; do\n"
+        "    if [ \"$1\" = \"-o\" ]; then\n"
+        "        xml=\"$2\"\n"
+        "        shift\n"
+        "    fi\n"
+        "    shift\n"
+        "done\n"
+        + sleepCommand(seconds) +
+        "[ -n \"$xml\" ] && cp " + shellQuote(dataPrefix + ".xml") + " \"$xml\"\n"
+        + QString("exit %1\n").arg( qMin(numFailed, Constants::MaxExitCode) );
+
+    m_testCount += numTests;
+    m_failedTestCount += numFailed;
+    return writeFile(dataPrefix + ".listing", listing, false, error) &&
+           writeFile(dataPrefix + ".xml", xml, false, error) &&
+           writeFile(QDir(m_programsDirectory).absoluteFilePath(name), script.toUtf8(), true, error);
+}
@@ -0,0 +1,89 @@
+#ifndef FAKEPROGRAMGENERATOR_H
+#define FAKEPROGRAMGENERATOR_H
+
+#include <QByteArray>
+#include <QString>
+
+// writes a directory of fake test programs (shell scripts), for measuring
+// edgecase itself at scale
+//
+// each script answers edgecase's listing & run command lines the way a real
+// GoogleTest or QTestLib program would, replaying canned listings, console
+// output, & XML results. Programs are named 'gtest_fake_NNNN' / 'tst_fake_NNNN',
+// so they're classified by name (see ProgramTypeSelector). Results are random,
+// but repeatable for a given seed.
+//
+// QTestLib programs only have one suite, so they get all (suites x tests) of
+// their tests in it.
+//
+// optionally, some GoogleTest programs ('gtest_crash_NNNN') crash as soon as
+// they're listed, for checking how edgecase reports broken programs.
+class FakeProgramGenerator {
+
+    // enums
+    public:
+        enum Framework { GoogleTest = 0
+                       , QtTestLib
+                       , MixedFrameworks    // alternating, program by program
+                       };
+
+        enum SleepDistribution { FixedSleep = 0
+                               , UniformSleep       // 0 .. 2 x mean
+                               , ExponentialSleep
+                               };
+
+    // settings
+    public:
+        struct Settings {
+            int programs;
+            int suites;                 // per program
+            int tests;                  // per suite
+            Framework framework;
+            double failureRate;         // 0 .. 1, share of tests that fail
+            int failureMessageBytes;    // size of each failure message
+            int sleepMsecs;             // mean run time per program
+            SleepDistribution sleepDistribution;
+            uint seed;
+            int crashingPrograms;       // in addition to the above, crash when listed
+
+            Settings(void);
+        };
+
+    // ctor & dtor
+    public:
+        explicit FakeProgramGenerator(const Settings& settings);
+        ~FakeProgramGenerator(void);
+
+    // FakeProgramGenerator interface
+    public:
+
+        // scripts go in '<directory>/programs', their canned output in '<directory>/data'
+        bool generate(const QString& directory, QString* error);
+        static QString programsDirectory(const QString& directory);
+
+        // totals from last generate()
+        int testCount(void) const;
+        int failedTestCount(void) const;
+
+        static bool frameworkFromName(const QString& name, Framework* framework);
+        static bool sleepDistributionFromName(const QString& name, SleepDistribution* distribution);
+
+    // internal methods
+    private:
+        QByteArray failureMessage(const QString& testName) const;
+        bool isFailing(void) const;
+        double sleepSeconds(void) const;
+        bool writeCrashingGoogleTest(const QString& name, QString* error);
+        bool writeGoogleTest(const QString& name, double seconds, QString* error);
+        bool writeQTestLib(const QString& name, double seconds, QString* error);
+
+    // data members
+    private:
+        Settings m_settings;
+        QString  m_programsDirectory;
+        QString  m_dataDirectory;
+        int      m_testCount;
+        int      m_failedTestCount;
+};
+
+#endif // FAKEPROGRAMGENERATOR_H
@@ -0,0 +1,293 @@
+#include <QApplication>
+#include "exportcheck.h"
+#include "fakeprogramgenerator.h"
+#include "scalebenchmark.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+
+    const int ExitSuccess = 0;
+    const int ExitFailure = 1;
+    const int ExitUsage   = 2;
+
+    const int DefaultRepeat = 3;
+    const char* const DefaultScales[] = { "10x5x10", "50x10x20", "200x10x50" };
+
+    const int ColumnWidth = 12;
+    const int NumPhases = 8;    // see ScaleBenchmark::Timings
+
+} // namespace Constants
+
+// programs x suites x tests
+struct Scale {
+    int programs;
+    int suites;
+    int tests;
+};
+
+// parses 'NxMxK'
+static
+bool parseScale(const QString& text, Scale* scale) {
+    const QStringList fields = text.split('x');
+    if ( fields.size() != 3 )
+        return false;
+    bool ok[3];
+    scale->programs = fields.at(0).toInt(&ok[0]);
+    scale->suites   = fields.at(1).toInt(&ok[1]);
+    scale->tests    = fields.at(2).toInt(&ok[2]);
+    return ok[0] && ok[1] && ok[2] &&
+           scale->programs > 0 && scale->suites > 0 && scale->tests > 0;
+}
+
+static
+double median(QList<double> values) {
+    if ( values.isEmpty() )
+        return 0.0;
+    qSort(values);
+    const int middle = values.size() / 2;
+    return ( values.size() % 2 == 1 ? values.at(middle)
+                                    : (values.at(middle - 1) + values.at(middle)) / 2.0 );
+}
+
+// removes directory & all of its contents
+static
+bool removeDirectory(const QString& path) {
+    QDir dir(path);
+    if ( !dir.exists() )
+        return true;
+    const QFileInfoList entries = dir.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    foreach ( const QFileInfo& entry, entries ) {
+        const bool ok = ( entry.isDir() && !entry.isSymLink() ? removeDirectory(entry.absoluteFilePath())
+                                                              : QFile::remove(entry.absoluteFilePath()) );
+        if ( !ok )
+            return false;
+    }
+    return dir.rmdir(path);
+}
+
+// returns fields as a fixed-width table row
+static
+QString tableRow(const QStringList& fields) {
+    QString row;
+    foreach ( const QString& field, fields )
+        row += field.rightJustified(Constants::ColumnWidth) + ' ';
+    return row;
+}
+
+static
+QString usage(void) {
+    return QString(
+        "usage: edgecase-bench [options]\n"
+        "\n"
+        "Generates fake GoogleTest & QTestLib programs at each scale, then times\n"
+        "discovery, listing, listing parse, tree population, search, run, result\n"
+        "parse, & view updates (median of each, in msecs).\n"
+        "\n"
+        "options:\n"
+        "  --scale=NxMxK         N programs x M suites x K tests (repeatable)\n"
+        "                        (default: 10x5x10, 50x10x20, 200x10x50)\n"
+        "  --framework=NAME      gtest, qtest, or mixed (default: mixed)\n"
+        "  --failure-rate=F      share of tests that fail, 0..1 (default: 0.05)\n"
+        "  --failure-bytes=B     size of each failure message (default: 256)\n"
+        "  --sleep=MSECS         mean run time per program (default: 0)\n"
+        "  --sleep-distribution=NAME  fixed, uniform, or exponential (default: fixed)\n"
+        "  --seed=N              random seed for results & run times (default: 1)\n"
+        "  --jobs=N              run at most N programs at once (default: number of CPUs)\n"
+        "  --repeat=R            measurements per scale (default: 3)\n"
+        "  --csv=FILE            also write each measurement to FILE\n"
+        "  --dir=DIR             generate programs in DIR, & keep them (default: a temp\n"
+        "                        directory, removed afterwards)\n"
+        "  --keep                don't remove generated programs afterwards\n"
+        "  --check-export        instead of timing, check that streamed JUnit & JSON\n"
+        "                        results include a program that crashes when listed\n"
+        "  --help                show this message\n"
+        "\n"
+        "Without a display, run with '-platform offscreen' (Qt 5).");
+}
+
+int main(int argc, char* argv[]) {
+
+    // TestListView is a widget, so a GUI application is needed (though it's never shown)
+    QApplication a(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    // parse options
+    FakeProgramGenerator::Settings settings;
+    QList<Scale> scales;
+    int jobs = 0;
+    int repeat = Constants::DefaultRepeat;
+    QString csvFilename;
+    QString directory;
+    bool keepFiles = false;
+    bool isExportCheck = false;
+
+    const QStringList args = a.arguments();
+    for ( int i = 1; i < args.size(); ++i ) {
+        const QString& arg = args.at(i);
+        const QString option = arg.section('=', 0, 0);
+        const QString value  = arg.section('=', 1);
+
+        bool ok = true;
+        if ( option == "--help" || option == "-h" ) {
+            out << usage() << endl;
+            return Constants::ExitSuccess;
+        } else if ( option == "--keep" ) {
+            keepFiles = true;
+        } else if ( option == "--check-export" ) {
+            isExportCheck = true;
+        } else if ( option == "--scale" ) {
+            Scale scale;
+            ok = parseScale(value, &scale);
+            if ( ok )
+                scales.append(scale);
+        } else if ( option == "--framework" ) {
+            ok = FakeProgramGenerator::frameworkFromName(value, &settings.framework);
+        } else if ( option == "--failure-rate" ) {
+            settings.failureRate = value.toDouble(&ok);
+            ok = ok && settings.failureRate >= 0.0 && settings.failureRate <= 1.0;
+        } else if ( option == "--failure-bytes" ) {
+            settings.failureMessageBytes = value.toInt(&ok);
+            ok = ok && settings.failureMessageBytes > 0;
+        } else if ( option == "--sleep" ) {
+            settings.sleepMsecs = value.toInt(&ok);
+            ok = ok && settings.sleepMsecs >= 0;
+        } else if ( option == "--sleep-distribution" ) {
+            ok = FakeProgramGenerator::sleepDistributionFromName(value, &settings.sleepDistribution);
+        } else if ( option == "--seed" ) {
+            settings.seed = value.toUInt(&ok);
+        } else if ( option == "--jobs" ) {
+            jobs = value.toInt(&ok);
+            ok = ok && jobs > 0;
+        } else if ( option == "--repeat" ) {
+            repeat = value.toInt(&ok);
+            ok = ok && repeat > 0;
+        } else if ( option == "--csv" ) {
+            csvFilename = value;
+            ok = !value.isEmpty();
+        } else if ( option == "--dir" ) {
+            directory = value;
+            keepFiles = true;   // never remove a directory we didn't create
+            ok = !value.isEmpty();
+        } else {
+            err << "edgecase-bench: unknown option " << arg << endl << usage() << endl;
+            return Constants::ExitUsage;
+        }
+
+        if ( !ok ) {
+            err << "edgecase-bench: invalid value for " << option << ": " << value << endl;
+            return Constants::ExitUsage;
+        }
+    }
+
+    if ( scales.isEmpty() ) {
+        for ( size_t i = 0; i < sizeof(Constants::DefaultScales)/sizeof(Constants::DefaultScales[0]); ++i ) {
+            Scale scale;
+            parseScale(Constants::DefaultScales[i], &scale);
+            scales.append(scale);
+        }
+    }
+
+    if ( directory.isEmpty() )
+        directory = QDir::temp().absoluteFilePath( QString("edgecase-bench-%1").arg(QCoreApplication::applicationPid()) );
+    directory = QFileInfo(directory).absoluteFilePath();
+
+    // keep history, baselines, metrics, etc. out of the real ~/.edgecase
+    const QString homeDirectory = QDir(directory).absoluteFilePath("home");
+    QDir().mkpath(homeDirectory);
+    qputenv("HOME", QFile::encodeName(homeDirectory));
+
+    // check, instead of measuring
+    if ( isExportCheck ) {
+        QString error;
+        ExportCheck check( QDir(directory).absoluteFilePath("export-check") );
+        const bool ok = check.run(&error);
+        if ( ok )
+            out << "export check: OK" << endl;
+        else
+            err << "edgecase-bench: export check failed: " << error << endl;
+        if ( !keepFiles )
+            removeDirectory(directory);
+        return ( ok ? Constants::ExitSuccess : Constants::ExitFailure );
+    }
+
+    QFile csvFile(csvFilename);
+    QTextStream csv(&csvFile);
+    if ( !csvFilename.isEmpty() ) {
+        if ( !csvFile.open(QFile::WriteOnly | QFile::Truncate) ) {
+            err << "edgecase-bench: could not write " << csvFilename << ": " << csvFile.errorString() << endl;
+            return Constants::ExitFailure;
+        }
+        csv << "scale,repeat,programs,tests,failed,discovery,listing,listing_parse,"
+               "tree_population,search,run,result_parse,view_updates\n";
+    }
+
+    const QStringList phaseNames = QStringList() << "discovery" << "listing" << "list parse"
+                                                 << "tree" << "search" << "run" << "result parse" << "view upd.";
+    out << tableRow( QStringList() << "scale" << "tests" << phaseNames ) << endl;
+
+    // measure each scale
+    int exitCode = Constants::ExitSuccess;
+    foreach ( const Scale& scale, scales ) {
+        const QString scaleName = QString("%1x%2x%3").arg(scale.programs).arg(scale.suites).arg(scale.tests);
+        const QString scaleDirectory = QDir(directory).absoluteFilePath(scaleName);
+
+        // generate programs
+        settings.programs = scale.programs;
+        settings.suites = scale.suites;
+        settings.tests = scale.tests;
+        FakeProgramGenerator generator(settings);
+        QString error;
+        if ( !removeDirectory(scaleDirectory) || !generator.generate(scaleDirectory, &error) ) {
+            err << "edgecase-bench: " << scaleName << ": " << error << endl;
+            exitCode = Constants::ExitFailure;
+            break;
+        }
+
+        ScaleBenchmark benchmark( FakeProgramGenerator::programsDirectory(scaleDirectory) );
+        benchmark.setMaxConcurrentPrograms(jobs);
+
+        // each phase's samples
+        QList<double> samples[Constants::NumPhases];
+        for ( int r = 0; r < repeat; ++r ) {
+            ScaleBenchmark::Timings timings;
+            if ( !benchmark.measure(&timings, &error) ) {
+                err << "edgecase-bench: " << scaleName << ": " << error << endl;
+                exitCode = Constants::ExitFailure;
+                break;
+            }
+
+            const double values[Constants::NumPhases] = { timings.discovery, timings.listing, timings.listingParse,
+                                       timings.treePopulation, timings.search, timings.run,
+                                       timings.resultParse, timings.viewUpdates };
+            for ( int p = 0; p < Constants::NumPhases; ++p )
+                samples[p].append(values[p]);
+
+            if ( csvFile.isOpen() ) {
+                csv << scaleName << ',' << (r + 1) << ',' << timings.programs << ','
+                    << timings.tests << ',' << timings.failedTests;
+                for ( int p = 0; p < Constants::NumPhases; ++p )
+                    csv << ',' << QString::number(values[p], 'f', 6);
+                csv << '\n';
+            }
+        }
+        if ( exitCode != Constants::ExitSuccess )
+            break;
+
+        QStringList fields;
+        fields << scaleName << QString::number(generator.testCount());
+        for ( int p = 0; p < Constants::NumPhases; ++p )
+            fields << QString::number(median(samples[p]) * 1000.0, 'f', 1);
+        out << tableRow(fields) << endl;
+    }
+
+    // clean up
+    csv.flush();
+    if ( !keepFiles )
+        removeDirectory(directory);
+    else
+        out << "Generated programs kept in " << directory << endl;
+
+    return exitCode;
+}
@@ -0,0 +1,197 @@
+#include "scalebenchmark.h"
+#include "programfinder.h"
+#include "resultbatcher.h"
+#include "runnermetrics.h"
+#include "testlistview.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+
+    const int DefaultTimeout = 10 * 60 * 1000; // msecs
+
+    // TestRunner's dispatch histogram (see README)
+    const char* const DispatchMetric = "edgecase_result_dispatch_seconds";
+
+    // typical searches over FakeProgramGenerator's names: substring, glob, regex,
+    // & back to the whole tree
+    const char* const SearchQueries[] = { "test1", "FakeSuite1*.test2*", "/FakeSuite2\\.test\\d*5$/", "" };
+    const int NumSearchQueries = sizeof(SearchQueries) / sizeof(SearchQueries[0]);
+
+} // namespace Constants
+
+// returns first program error, if any
+static
+QString programError(const TestRunner& runner) {
+    const int numPrograms = runner.programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        const TestProgram* program = runner.programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        if ( program->hasError() )
+            return QString("%1: %2").arg(program->programName(), program->errorString());
+    }
+    return QString();
+}
+
+// returns parse time of each program's last listing or run, summed
+static
+double totalParseTime(const TestRunner& runner) {
+    double total = 0.0;
+    const int numPrograms = runner.programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        const TestProgram* program = runner.programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        const TestProgram::TaskTiming timing = program->lastTaskTiming();
+        if ( timing.parseTime >= 0.0 )
+            total += timing.parseTime;
+    }
+    return total;
+}
+
+// ------------------------------------------
+// ScaleBenchmark::Timings implementation
+// ------------------------------------------
+
+ScaleBenchmark::Timings::Timings(void)
+    : discovery(0.0)
+    , listing(0.0)
+    , listingParse(0.0)
+    , treePopulation(0.0)
+    , search(0.0)
+    , run(0.0)
+    , resultParse(0.0)
+    , viewUpdates(0.0)
+    , programs(0)
+    , tests(0)
+    , failedTests(0)
+{ }
+
+// ------------------------------------------
+// ScaleBenchmark implementation
+// ------------------------------------------
+
+ScaleBenchmark::ScaleBenchmark(const QString& directory)
+    : m_directory(directory)
+    , m_maxConcurrentPrograms(0)
+    , m_timeout(Constants::DefaultTimeout)
+{ }
+
+ScaleBenchmark::~ScaleBenchmark(void) { }
+
+int ScaleBenchmark::maxConcurrentPrograms(void) const {
+    return m_maxConcurrentPrograms;
+}
+
+bool ScaleBenchmark::measure(Timings* timings, QString* error) {
+
+    Q_ASSERT_X(timings, Q_FUNC_INFO, "null timings");
+    Q_ASSERT_X(error,   Q_FUNC_INFO, "null error string");
+    *timings = ScaleBenchmark::Timings();
+    QElapsedTimer timer;
+
+    // discovery, on its own
+    {
+        ProgramFinder finder;
+        finder.setUsesIndex(false);
+        timer.start();
+        QMetaObject::invokeMethod(&finder, "start", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_directory), Q_ARG(bool, true));
+        if ( !waitFor(&finder, SIGNAL(finished()), m_timeout) ) {
+            *error = "Timed out during discovery";
+            return false;
+        }
+        timings->discovery = RunnerMetrics::elapsedSeconds(timer);
+    }
+
+    // runner & view, connected as in MainWindow (results batched, so their
+    // view updates show up in the runner's dispatch time), except listing, so
+    // tree population can be timed on its own
+    TestRunner runner;
+    runner.programFinder()->setUsesIndex(false);
+    if ( m_maxConcurrentPrograms > 0 )
+        runner.setMaxConcurrentPrograms(m_maxConcurrentPrograms);
+
+    TestListView view(&runner);
+    view.setSearchDelay(0);
+    ResultBatcher batcher(&runner);
+    QObject::connect(&runner, SIGNAL(listTestsStarted()), &view, SLOT(onListTestsStarted()));
+    QObject::connect(&runner, SIGNAL(runTestsStarted()),  &view, SLOT(onRunTestsStarted()));
+    QObject::connect(&runner, SIGNAL(runTestsFinished()), &view, SLOT(onRunTestsFinished()));
+    QObject::connect(&batcher, SIGNAL(resultsReady(QList<TestProgram*>)),
+                     &view,    SLOT(onTestResultsBatchReady(QList<TestProgram*>)));
+
+    // listing
+    timer.start();
+    QMetaObject::invokeMethod(&runner, "listTests", Qt::QueuedConnection,
+                              Q_ARG(QString, m_directory), Q_ARG(bool, true));
+    if ( !waitFor(&runner, SIGNAL(listTestsFinished()), m_timeout) ) {
+        *error = "Timed out during listing";
+        return false;
+    }
+    timings->listing = RunnerMetrics::elapsedSeconds(timer);
+    timings->listingParse = totalParseTime(runner);
+    timings->programs = runner.programCount();
+    timings->tests = runner.totalTestCount();
+    *error = programError(runner);
+    if ( !error->isEmpty() )
+        return false;
+
+    // tree population
+    timer.start();
+    view.onListTestsFinished();
+    timings->treePopulation = RunnerMetrics::elapsedSeconds(timer);
+
+    // search, once the index is built (w/ a program expanded, as when browsing)
+    if ( !view.isSearchIndexReady() &&
+         !waitFor(&view, SIGNAL(searchResultsChanged(int)), m_timeout) )
+    {
+        *error = "Timed out building search index";
+        return false;
+    }
+    view.expand( view.testModel()->index(0, 0) );
+    timer.start();
+    for ( int i = 0; i < Constants::NumSearchQueries; ++i )
+        view.setSearchQuery( QString(Constants::SearchQueries[i]) );
+    timings->search = RunnerMetrics::elapsedSeconds(timer) / Constants::NumSearchQueries;
+
+    // run
+    timer.start();
+    QMetaObject::invokeMethod(&runner, "runTests", Qt::QueuedConnection);
+    if ( !waitFor(&runner, SIGNAL(runTestsFinished()), m_timeout) ) {
+        *error = "Timed out during run";
+        return false;
+    }
+    timings->run = RunnerMetrics::elapsedSeconds(timer);
+    timings->resultParse = totalParseTime(runner);
+    timings->viewUpdates = runner.metrics()->value(Constants::DispatchMetric);
+    timings->failedTests = runner.failedTestCount();
+    *error = programError(runner);
+    return error->isEmpty();
+}
+
+void ScaleBenchmark::setMaxConcurrentPrograms(int count) {
+    m_maxConcurrentPrograms = count;
+}
+
+void ScaleBenchmark::setTimeout(int msecs) {
+    m_timeout = msecs;
+}
+
+int ScaleBenchmark::timeout(void) const {
+    return m_timeout;
+}
+
+bool ScaleBenchmark::waitFor(QObject* sender, const char* signal, int msecs) {
+
+    // spin event loop until signal arrives, or time is up
+    QEventLoop loop;
+    QTimer timeoutTimer;
+    timeoutTimer.setSingleShot(true);
+    QObject::connect(sender, signal, &loop, SLOT(quit()));
+    QObject::connect(&timeoutTimer, SIGNAL(timeout()), &loop, SLOT(quit()));
+    timeoutTimer.start(msecs);
+    loop.exec();
+    return timeoutTimer.isActive();
+}
@@ -0,0 +1,66 @@
+#ifndef SCALEBENCHMARK_H
+#define SCALEBENCHMARK_H
+
+#include <QString>
+class QObject;
+
+// times each phase of edgecase's pipeline over a directory of test programs
+// (see FakeProgramGenerator), using the same classes as the application
+//
+// phases (wall time, in seconds):
+//   discovery      ProgramFinder scan only (index not used)
+//   listing        TestRunner::listTests(), until listTestsFinished (includes discovery)
+//   listingParse   listing output parsing & suite/test building, summed across programs
+//   treePopulation TestListView::onListTestsFinished()
+//   search         TestListView::setSearchQuery() (no typing delay), mean of a few
+//                  queries on the whole tree
+//   run            TestRunner::runTests(), until runTestsFinished
+//   resultParse    result XML parsing, summed across programs
+//   viewUpdates    batched result delivery to TestListView (see ResultBatcher), summed across batches
+class ScaleBenchmark {
+
+    // timings
+    public:
+        struct Timings {
+            double discovery;
+            double listing;
+            double listingParse;
+            double treePopulation;
+            double search;
+            double run;
+            double resultParse;
+            double viewUpdates;
+
+            int programs;       // found
+            int tests;          // listed
+            int failedTests;    // from run
+
+            Timings(void);
+        };
+
+    // ctor & dtor
+    public:
+        explicit ScaleBenchmark(const QString& directory);
+        ~ScaleBenchmark(void);
+
+    // ScaleBenchmark interface
+    public:
+        int maxConcurrentPrograms(void) const;   // 0 = TestRunner's default
+        void setMaxConcurrentPrograms(int count);
+        int timeout(void) const;                 // msecs per phase
+        void setTimeout(int msecs);
+
+        // runs each phase once
+        bool measure(Timings* timings, QString* error);
+
+        // spins the event loop until sender emits signal (false if msecs pass first)
+        static bool waitFor(QObject* sender, const char* signal, int msecs);
+
+    // data members
+    private:
+        QString m_directory;
+        int m_maxConcurrentPrograms;
+        int m_timeout;
+};
+
+#endif // SCALEBENCHMARK_H
@@ -0,0 +1,364 @@
+#include "benchmarkbaseline.h"
+#include <QtCore>
+#include <QtDebug>
+#include <cmath>
+
+namespace Constants {
+    const quint32 BaselineMagic   = 0xEDC4BA5E;
+    const quint32 BaselineVersion = 1;
+
+    enum { MinimumSamples    = 3   // per side, fewer can never be significant at 0.05
+         , MaxStoredSamples  = 50  // per benchmark, oldest are dropped
+         , MaxExactSamples   = 20  // per side, larger samples use normal approximation
+         };
+} // namespace Constants
+
+// only measured (not aggregated) values are sampled, & user-defined counters
+// are skipped since they aren't necessarily 'lower is better'
+static inline
+bool isComparable(const BenchmarkResult& result) {
+    return !result.isAggregate() && result.counterName.isEmpty();
+}
+
+// returns median of (unsorted) values
+static
+qreal median(QList<qreal> values) {
+    if ( values.isEmpty() )
+        return 0.0;
+    qSort(values);
+    const int mid = values.size() / 2;
+    if ( values.size() % 2 == 1 )
+        return values.at(mid);
+    return (values.at(mid-1) + values.at(mid)) / 2.0;
+}
+
+// returns P(Z >= z) for standard normal Z
+// (Abramowitz & Stegun 26.2.17, absolute error < 7.5e-8)
+static
+qreal normalUpperTail(qreal z) {
+    if ( z < 0.0 )
+        return 1.0 - normalUpperTail(-z);
+    const qreal t = 1.0 / (1.0 + 0.2316419*z);
+    const qreal poly = t*(0.319381530 + t*(-0.356563782 + t*(1.781477937 + t*(-1.821255978 + t*1.330274429))));
+    const qreal pdf = std::exp(-0.5*z*z) * 0.398942280401432678; // 1/sqrt(2*pi)
+    return pdf * poly;
+}
+
+// returns P(U >= u), using the exact null distribution of U for sample sizes n & m
+// (counts of orderings with a given U, built up one element at a time)
+static
+qreal exactUpperTail(int n, int m, qreal u) {
+
+    const int maxU = n*m;
+    QVector<qreal> counts((n+1)*(m+1)*(maxU+1), 0.0);
+    #define COUNT(i,j,k) counts[((i)*(m+1)+(j))*(maxU+1)+(k)]
+
+    for ( int i = 0; i <= n; ++i ) {
+        for ( int j = 0; j <= m; ++j ) {
+            if ( i == 0 || j == 0 ) {
+                COUNT(i,j,0) = 1.0;
+                continue;
+            }
+            // largest value is from 'current' (beats all j baseline values) or from 'baseline'
+            for ( int k = 0; k <= i*j; ++k )
+                COUNT(i,j,k) = ( k >= j ? COUNT(i-1,j,k-j) : 0.0 ) + COUNT(i,j-1,k);
+        }
+    }
+
+    qreal tail  = 0.0;
+    qreal total = 0.0;
+    for ( int k = 0; k <= maxU; ++k ) {
+        total += COUNT(n,m,k);
+        if ( k >= u )
+            tail += COUNT(n,m,k);
+    }
+
+    #undef COUNT
+    return tail / total;
+}
+
+// ------------------------------------
+// BenchmarkComparison implementation
+// ------------------------------------
+
+QString BenchmarkComparison::toString(void) const {
+
+    QString result;
+    if ( !dataTag.isEmpty() )
+        result.append( QString("[%1] ").arg(dataTag) );
+    result.append( BenchmarkResult::metricName(metric) + ": " );
+
+    switch ( status ) {
+        case BenchmarkComparison::NoBaseline :
+            result.append("no baseline");
+            return result;
+        case BenchmarkComparison::InsufficientSamples :
+            result.append( QString("not enough samples yet (baseline: %1, current: %2)")
+                           .arg(baselineSamples)
+                           .arg(currentSamples) );
+            return result;
+        default:
+            break;
+    }
+
+    result.append( QString("%1 -> %2 %3 (%4%5%, p = %6)")
+                   .arg(baselineMedian)
+                   .arg(currentMedian)
+                   .arg(unit)
+                   .arg(change >= 0.0 ? "+" : "")
+                   .arg(change*100.0, 0, 'f', 1)
+                   .arg(pValue, 0, 'g', 3) );
+
+    if ( status == BenchmarkComparison::Regressed )
+        result.append(" REGRESSED");
+    else if ( status == BenchmarkComparison::Improved )
+        result.append(" improved");
+    return result;
+}
+
+// ----------------------------------
+// BenchmarkBaseline implementation
+// ----------------------------------
+
+BenchmarkBaseline::BenchmarkBaseline(void)
+    : m_alpha(0.05)
+    , m_minimumChange(0.05)
+    , m_sampleWindow(5)
+{ }
+
+BenchmarkBaseline::~BenchmarkBaseline(void) { }
+
+void BenchmarkBaseline::addResults(const QString& testKey,
+                                   const QList<BenchmarkResult>& results)
+{
+    foreach ( const BenchmarkResult& result, results ) {
+        if ( !isComparable(result) )
+            continue;
+        QList<qreal>& samples = m_recent[ sampleKey(testKey, result) ];
+        samples.append(result.value);
+        while ( samples.size() > Constants::MaxStoredSamples )
+            samples.removeFirst();
+    }
+}
+
+qreal BenchmarkBaseline::alpha(void) const {
+    return m_alpha;
+}
+
+void BenchmarkBaseline::clear(void) {
+    m_baseline.clear();
+    m_recent.clear();
+}
+
+QList<BenchmarkComparison> BenchmarkBaseline::compare(const QString& testKey,
+                                                      const QList<BenchmarkResult>& results) const
+{
+    QList<BenchmarkComparison> comparisons;
+    QSet<QString> seenKeys;
+
+    foreach ( const BenchmarkResult& result, results ) {
+        if ( !isComparable(result) )
+            continue;
+
+        // only compare each benchmark once (e.g. repetitions add several samples per run)
+        const QString key = sampleKey(testKey, result);
+        if ( seenKeys.contains(key) )
+            continue;
+        seenKeys.insert(key);
+
+        BenchmarkComparison comparison;
+        comparison.dataTag = result.dataTag;
+        comparison.metric  = result.metric;
+        comparison.unit    = result.unit;
+
+        // fetch samples
+        const QList<qreal> baseline = m_baseline.value(key);
+        const QList<qreal> recent   = m_recent.value(key);
+        const QList<qreal> current  = recent.mid( qMax(0, recent.size() - m_sampleWindow) );
+        comparison.baselineSamples = baseline.size();
+        comparison.currentSamples  = current.size();
+
+        if ( baseline.isEmpty() ) {
+            comparisons.append(comparison);
+            continue;
+        }
+
+        if ( baseline.size() < Constants::MinimumSamples || current.size() < Constants::MinimumSamples ) {
+            comparison.status = BenchmarkComparison::InsufficientSamples;
+            comparisons.append(comparison);
+            continue;
+        }
+
+        // compare medians
+        comparison.baselineMedian = median(baseline);
+        comparison.currentMedian  = median(current);
+        if ( comparison.baselineMedian != 0.0 )
+            comparison.change = (comparison.currentMedian - comparison.baselineMedian) / qAbs(comparison.baselineMedian);
+
+        // test for significance, in the direction of the change
+        comparison.status = BenchmarkComparison::Unchanged;
+        if ( comparison.change >= 0.0 ) {
+            comparison.pValue = mannWhitneyPValue(baseline, current);
+            if ( comparison.pValue <= m_alpha && comparison.change >= m_minimumChange )
+                comparison.status = BenchmarkComparison::Regressed;
+        } else {
+            comparison.pValue = mannWhitneyPValue(current, baseline);
+            if ( comparison.pValue <= m_alpha && -comparison.change >= m_minimumChange )
+                comparison.status = BenchmarkComparison::Improved;
+        }
+
+        comparisons.append(comparison);
+    }
+
+    return comparisons;
+}
+
+QString BenchmarkBaseline::fileName(void) const {
+    return m_filename;
+}
+
+bool BenchmarkBaseline::hasBaseline(void) const {
+    return !m_baseline.isEmpty();
+}
+
+bool BenchmarkBaseline::load(const QString& filename) {
+
+    // reset state
+    m_filename = filename;
+    clear();
+
+    // open file (missing file is not an error, just no baseline yet)
+    QFile file(filename);
+    if ( !file.open(QFile::ReadOnly) )
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    // check header
+    quint32 magic;
+    quint32 version;
+    in >> magic >> version;
+    if ( magic != Constants::BaselineMagic || version != Constants::BaselineVersion )
+        return false;
+
+    // read samples
+    in >> m_baseline >> m_recent;
+    if ( in.status() != QDataStream::Ok ) {
+        qDebug() << "Discarding corrupt benchmark baseline: " << filename;
+        clear();
+        return false;
+    }
+    return true;
+}
+
+qreal BenchmarkBaseline::mannWhitneyPValue(const QList<qreal>& baseline,
+                                           const QList<qreal>& current)
+{
+    const int m = baseline.size();
+    const int n = current.size();
+    if ( n == 0 || m == 0 )
+        return 1.0;
+
+    // U = number of (current, baseline) pairs where current is larger (ties count 1/2)
+    qreal u = 0.0;
+    foreach ( qreal c, current ) {
+        foreach ( qreal b, baseline ) {
+            if ( c > b )
+                u += 1.0;
+            else if ( c == b )
+                u += 0.5;
+        }
+    }
+
+    // find tied groups, for tie correction
+    QList<qreal> combined = baseline + current;
+    qSort(combined);
+    qreal tieSum = 0.0;
+    for ( int i = 0; i < combined.size(); ) {
+        int j = i + 1;
+        while ( j < combined.size() && combined.at(j) == combined.at(i) )
+            ++j;
+        const qreal t = j - i;
+        tieSum += t*t*t - t;
+        i = j;
+    }
+
+    // use exact distribution when we can
+    if ( tieSum == 0.0 && n <= Constants::MaxExactSamples && m <= Constants::MaxExactSamples )
+        return exactUpperTail(n, m, u);
+
+    // otherwise, normal approximation (with tie & continuity corrections)
+    const qreal total = n + m;
+    const qreal mean = n*m / 2.0;
+    const qreal variance = (n*m / 12.0) * ((total + 1.0) - tieSum / (total * (total - 1.0)));
+    if ( variance <= 0.0 )
+        return 1.0; // all values tied
+    const qreal z = (u - mean - 0.5) / std::sqrt(variance);
+    return normalUpperTail(z);
+}
+
+qreal BenchmarkBaseline::minimumChange(void) const {
+    return m_minimumChange;
+}
+
+void BenchmarkBaseline::pin(void) {
+
+    // recent samples replace the baseline for any benchmarks they cover
+    QHash<QString, QList<qreal> >::const_iterator recentIter = m_recent.constBegin();
+    QHash<QString, QList<qreal> >::const_iterator recentEnd  = m_recent.constEnd();
+    for ( ; recentIter != recentEnd; ++recentIter )
+        m_baseline.insert(recentIter.key(), recentIter.value());
+
+    // start collecting new samples
+    m_recent.clear();
+}
+
+QString BenchmarkBaseline::sampleKey(const QString& testKey, const BenchmarkResult& result) {
+    return testKey + '\t' + result.dataTag + '\t' + BenchmarkResult::metricName(result.metric);
+}
+
+int BenchmarkBaseline::sampleWindow(void) const {
+    return m_sampleWindow;
+}
+
+bool BenchmarkBaseline::save(void) const {
+
+    // skip if no file
+    if ( m_filename.isEmpty() )
+        return false;
+
+    // write to temp file first, so a failed write doesn't clobber the old baseline
+    const QString tempFilename = m_filename + ".tmp";
+    QFile file(tempFilename);
+    if ( !file.open(QFile::WriteOnly | QFile::Truncate) ) {
+        qDebug() << "Could not write benchmark baseline: " << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << Constants::BaselineMagic << Constants::BaselineVersion << m_baseline << m_recent;
+    file.close();
+
+    // swap in new file
+    const bool ok = ( out.status() == QDataStream::Ok );
+    if ( ok ) {
+        QFile::remove(m_filename);
+        QFile::rename(tempFilename, m_filename);
+    } else
+        QFile::remove(tempFilename);
+    return ok;
+}
+
+void BenchmarkBaseline::setAlpha(qreal alpha) {
+    m_alpha = alpha;
+}
+
+void BenchmarkBaseline::setMinimumChange(qreal change) {
+    m_minimumChange = change;
+}
+
+void BenchmarkBaseline::setSampleWindow(int numSamples) {
+    m_sampleWindow = qMax(int(Constants::MinimumSamples), numSamples);
+}
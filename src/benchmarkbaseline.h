@@ -0,0 +1,109 @@
+#ifndef BENCHMARKBASELINE_H
+#define BENCHMARKBASELINE_H
+
+#include "benchmarkresult.h"
+#include <QHash>
+#include <QList>
+#include <QString>
+
+// result of comparing a test's recent benchmark samples with its pinned baseline
+struct BenchmarkComparison {
+
+    // enums
+    enum Status { NoBaseline = 0
+                , InsufficientSamples
+                , Unchanged
+                , Improved
+                , Regressed
+                };
+
+    // data members
+    Status  status;
+    QString dataTag;
+    BenchmarkResult::Metric metric;
+    QString unit;
+    int     baselineSamples;
+    int     currentSamples;
+    qreal   baselineMedian;
+    qreal   currentMedian;
+    qreal   change;   // relative change in median, e.g. 0.10 = 10% slower
+    qreal   pValue;   // one-sided, in the direction of the change
+
+    // ctor
+    BenchmarkComparison(void)
+        : status(BenchmarkComparison::NoBaseline)
+        , metric(BenchmarkResult::OtherMetric)
+        , baselineSamples(0)
+        , currentSamples(0)
+        , baselineMedian(0.0)
+        , currentMedian(0.0)
+        , change(0.0)
+        , pValue(1.0)
+    { }
+
+    // convenience methods
+    QString toString(void) const;
+};
+
+// pinned benchmark baseline & recent samples, for a single test directory
+//
+// every run adds one sample per measured benchmark result (keyed by test, data
+// tag, & metric). Aggregates & user-defined counters are not compared.
+//
+// pinning turns the samples collected so far into the baseline; later runs
+// compare their most recent samples against it with a one-sided Mann-Whitney U
+// test. A change is only reported if it is significant (p <= alpha) AND the
+// medians differ by at least the minimum relative change.
+//
+// all supported metrics are 'lower is better'
+class BenchmarkBaseline {
+
+    // ctor & dtor
+    public:
+        BenchmarkBaseline(void);
+        ~BenchmarkBaseline(void);
+
+    // BenchmarkBaseline interface
+    public:
+
+        // settings
+        qreal alpha(void) const;                // default: 0.05
+        void setAlpha(qreal alpha);
+        qreal minimumChange(void) const;        // default: 0.05 (5%)
+        void setMinimumChange(qreal change);
+        int sampleWindow(void) const;           // default: 5 most recent samples
+        void setSampleWindow(int numSamples);
+
+        // persistence (saves both baseline & recent samples)
+        QString fileName(void) const;
+        bool load(const QString& filename);
+        bool save(void) const;
+
+        // samples
+        void addResults(const QString& testKey, const QList<BenchmarkResult>& results);
+        QList<BenchmarkComparison> compare(const QString& testKey,
+                                           const QList<BenchmarkResult>& results) const;
+        void clear(void);
+        bool hasBaseline(void) const;
+        void pin(void);
+
+        // one-sided Mann-Whitney U p-value for 'current' being larger than 'baseline'
+        // (exact for small samples without ties, normal approximation otherwise)
+        static qreal mannWhitneyPValue(const QList<qreal>& baseline,
+                                       const QList<qreal>& current);
+
+    // internal methods
+    private:
+        static QString sampleKey(const QString& testKey, const BenchmarkResult& result);
+
+    // data members
+    private:
+        QString m_filename;
+        qreal m_alpha;
+        qreal m_minimumChange;
+        int   m_sampleWindow;
+        QHash<QString, QList<qreal> > m_baseline;
+        QHash<QString, QList<qreal> > m_recent;
+};
+
+#endif // BENCHMARKBASELINE_H
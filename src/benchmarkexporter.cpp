@@ -0,0 +1,80 @@
+#include "benchmarkexporter.h"
+#include "benchmarkresult.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+// quotes a CSV field, if needed
+static
+QString csvField(const QString& field) {
+    if ( !field.contains(',') && !field.contains('"') && !field.contains('\n') )
+        return field;
+    QString result = field;
+    result.replace("\"", "\"\"");
+    return QString("\"%1\"").arg(result);
+}
+
+// ----------------------------------
+// BenchmarkExporter implementation
+// ----------------------------------
+
+bool BenchmarkExporter::writeCsv(const TestRunner* runner, QIODevice* device) {
+
+    Q_ASSERT_X(runner, Q_FUNC_INFO, "null test runner");
+    Q_ASSERT_X(device && device->isWritable(), Q_FUNC_INFO, "invalid output device");
+
+    QTextStream out(device);
+    out << "program,suite,test,tag,metric,counter,aggregate,value,unit,iterations,total\n";
+
+    // foreach program
+    const int numPrograms = runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        TestProgram* program = runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+
+        // foreach suite
+        const int numSuites = program->suiteCount();
+        for ( int j = 0; j < numSuites; ++j ) {
+            TestSuite* suite = program->suiteAt(j);
+            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+            // foreach test
+            const int numTests = suite->testCount();
+            for ( int k = 0; k < numTests; ++k ) {
+                TestCase* test = suite->testAt(k);
+                Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+
+                // foreach benchmark result
+                const QList<BenchmarkResult> results = test->benchmarkResults();
+                foreach ( const BenchmarkResult& bm, results ) {
+                    out << csvField(program->programName()) << ','
+                        << csvField(suite->name()) << ','
+                        << csvField(test->name()) << ','
+                        << csvField(bm.dataTag) << ','
+                        << BenchmarkResult::metricName(bm.metric) << ','
+                        << csvField(bm.counterName) << ','
+                        << csvField(bm.aggregate) << ','
+                        << QString::number(bm.value, 'g', 12) << ','
+                        << csvField(bm.unit) << ','
+                        << bm.iterations << ','
+                        << QString::number(bm.total(), 'g', 12) << '\n';
+                }
+            }
+        }
+    }
+
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+bool BenchmarkExporter::writeCsv(const TestRunner* runner, const QString& filename) {
+    QFile file(filename);
+    if ( !file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text) ) {
+        qDebug() << "Could not write benchmark file: " << file.errorString();
+        return false;
+    }
+    return writeCsv(runner, &file);
+}
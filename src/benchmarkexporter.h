@@ -0,0 +1,16 @@
+#ifndef BENCHMARKEXPORTER_H
+#define BENCHMARKEXPORTER_H
+
+#include <QString>
+class QIODevice;
+class TestRunner;
+
+// writes all benchmark results from the last run as CSV, one row per result:
+// program,suite,test,tag,metric,counter,aggregate,value,unit,iterations,total
+class BenchmarkExporter {
+    public:
+        static bool writeCsv(const TestRunner* runner, QIODevice* device);
+        static bool writeCsv(const TestRunner* runner, const QString& filename);
+};
+
+#endif // BENCHMARKEXPORTER_H
@@ -0,0 +1,85 @@
+#include "benchmarkresult.h"
+#include <QtCore>
+#include <QtDebug>
+
+// --------------------------------
+// BenchmarkResult implementation
+// --------------------------------
+
+QString BenchmarkResult::defaultUnit(Metric metric) {
+    switch ( metric ) {
+        case BenchmarkResult::WallTime         : return "msecs";
+        case BenchmarkResult::CpuTicks         : return "CPU ticks";
+        case BenchmarkResult::InstructionReads : return "instruction reads";
+        case BenchmarkResult::Events           : return "events";
+        case BenchmarkResult::CpuTime          : return "msecs";
+        default:
+            return QString();
+    }
+}
+
+BenchmarkResult::Metric BenchmarkResult::metricFromName(const QString& name) {
+
+    // QTestLib uses lowercase names in Qt4 ("walltime") & CamelCase in Qt5 ("WalltimeMilliseconds")
+    const QString n = name.toLower();
+    if ( n == "walltime" || n == "walltimemilliseconds" || n == "walltimenanoseconds" )
+        return BenchmarkResult::WallTime;
+    if ( n == "cputicks" )
+        return BenchmarkResult::CpuTicks;
+    if ( n == "instructionreads" )
+        return BenchmarkResult::InstructionReads;
+    if ( n == "events" )
+        return BenchmarkResult::Events;
+    if ( n == "cputime" )
+        return BenchmarkResult::CpuTime;
+    return BenchmarkResult::OtherMetric;
+}
+
+QString BenchmarkResult::label(void) const {
+    QString result = ( counterName.isEmpty() ? metricName(metric) : counterName );
+    if ( isAggregate() )
+        result.append( QString(" (%1)").arg(aggregate) );
+    return result;
+}
+
+QString BenchmarkResult::metricName(Metric metric) {
+    switch ( metric ) {
+        case BenchmarkResult::WallTime         : return "walltime";
+        case BenchmarkResult::CpuTicks         : return "cputicks";
+        case BenchmarkResult::InstructionReads : return "instructionreads";
+        case BenchmarkResult::Events           : return "events";
+        case BenchmarkResult::CpuTime          : return "cputime";
+        default:
+            return "other";
+    }
+}
+
+qreal BenchmarkResult::totalSeconds(void) const {
+    if ( unit == "ns" ) return total() * 1e-9;
+    if ( unit == "us" ) return total() * 1e-6;
+    if ( unit == "ms" || unit == "msecs" ) return total() * 1e-3;
+    if ( unit == "s" )  return total();
+    return -1.0;
+}
+
+QString BenchmarkResult::toString(void) const {
+
+    QString result;
+    if ( !dataTag.isEmpty() )
+        result.append( QString("[%1] ").arg(dataTag) );
+    if ( !counterName.isEmpty() || isAggregate() )
+        result.append( label() + ": " );
+
+    // counters are reported as-is (often already a rate)
+    if ( !counterName.isEmpty() ) {
+        result.append( QString("%1 %2").arg(value).arg(unit) );
+        return result.trimmed();
+    }
+
+    result.append( QString("%1 %2 per iteration (total: %3, iterations: %4)")
+                   .arg(value)
+                   .arg(unit)
+                   .arg(total())
+                   .arg(iterations) );
+    return result;
+}
@@ -0,0 +1,67 @@
+#ifndef BENCHMARKRESULT_H
+#define BENCHMARKRESULT_H
+
+#include <QMetaType>
+#include <QString>
+
+struct BenchmarkResult {
+
+    // enums
+    enum Metric { OtherMetric = 0
+                , WallTime
+                , CpuTicks
+                , InstructionReads
+                , Events
+                , CpuTime
+                };
+
+    // data members
+    Metric  metric;
+    qreal   value;      // per iteration
+    qint64  iterations;
+    QString dataTag;
+    QString unit;       // e.g. "msecs", "CPU ticks"
+    QString counterName; // user-defined counter (OtherMetric only), e.g. "bytes_per_second"
+    QString aggregate;   // empty for measured runs, else e.g. "mean", "median", "stddev"
+
+    // ctors & dtor
+    BenchmarkResult(Metric m = BenchmarkResult::OtherMetric,
+                    qreal v = 0.0,
+                    qint64 iter = 1,
+                    const QString& tag = QString(),
+                    const QString& u = QString())
+        : metric(m)
+        , value(v)
+        , iterations(iter)
+        , dataTag(tag)
+        , unit(u)
+    { }
+
+    BenchmarkResult(const BenchmarkResult& other)
+        : metric(other.metric)
+        , value(other.value)
+        , iterations(other.iterations)
+        , dataTag(other.dataTag)
+        , unit(other.unit)
+        , counterName(other.counterName)
+        , aggregate(other.aggregate)
+    { }
+
+    ~BenchmarkResult(void) { }
+
+    // convenience methods
+    qreal total(void) const { return value * iterations; }
+    qreal totalSeconds(void) const; // total, if unit is a time unit ('ns', 'us', 'ms'/'msecs', 's'), else -1
+    bool isAggregate(void) const { return !aggregate.isEmpty(); }
+    QString label(void) const; // metric or counter name, w/ any aggregate
+    QString toString(void) const;
+
+    // metric names
+    static QString metricName(Metric metric);
+    static Metric metricFromName(const QString& name); // accepts QTestLib's metric names
+    static QString defaultUnit(Metric metric);
+};
+
+Q_DECLARE_METATYPE(BenchmarkResult)
+
+#endif // BENCHMARKRESULT_H
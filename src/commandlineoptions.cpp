@@ -0,0 +1,112 @@
+#include "commandlineoptions.h"
+#include <QtCore>
+#include <QtDebug>
+
+// ----------------------------------
+// CommandLineOptions implementation
+// ----------------------------------
+
+CommandLineOptions::CommandLineOptions(void)
+    : isHeadless(false)
+    , isHelpRequested(false)
+    , shouldRecurse(true)
+    , jobs(0)
+    , timeout(0.0)
+    , statusPort(-1)
+{ }
+
+CommandLineOptions::~CommandLineOptions(void) { }
+
+QString CommandLineOptions::errorString(void) const {
+    return m_errorString;
+}
+
+bool CommandLineOptions::parse(const QStringList& args) {
+
+    m_errorString.clear();
+    for ( int i = 1; i < args.size(); ++i ) {
+        const QString& arg = args.at(i);
+
+        // split '--option=value'
+        QString option = arg;
+        QString value;
+        bool hasValue = false;
+        const int equals = arg.indexOf('=');
+        if ( arg.startsWith("--") && equals > 0 ) {
+            option = arg.left(equals);
+            value = arg.mid(equals + 1);
+            hasValue = true;
+        }
+
+        // flags
+        if ( option == "--headless" ) {
+            isHeadless = true;
+            continue;
+        }
+        if ( option == "--help" || option == "-h" ) {
+            isHelpRequested = true;
+            continue;
+        }
+        if ( option == "--no-recurse" ) {
+            shouldRecurse = false;
+            continue;
+        }
+
+        // options w/ values ('--option=value' or '--option value')
+        if ( option == "--jobs"  || option == "--filter" || option == "--timeout" ||
+             option == "--junit" || option == "--json" || option == "--status-port" ||
+             option == "--status-origin" || option == "--metrics-file" || option == "--trace-file" )
+        {
+            if ( !hasValue ) {
+                if ( i + 1 >= args.size() ) {
+                    m_errorString = QString("missing value for %1").arg(option);
+                    return false;
+                }
+                value = args.at(++i);
+            }
+
+            bool ok = true;
+            if ( option == "--jobs" ) {
+                jobs = value.toInt(&ok);
+                ok = ok && jobs > 0;
+            } else if ( option == "--timeout" ) {
+                timeout = value.toDouble(&ok);
+                ok = ok && timeout > 0.0;
+            } else if ( option == "--status-port" ) {
+                statusPort = value.toInt(&ok);
+                ok = ok && statusPort >= 0 && statusPort <= 65535;
+            } else if ( option == "--filter" ) {
+                filter = value;
+            } else if ( value.isEmpty() ) {
+                ok = false;
+            } else if ( option == "--status-origin" ) {
+                statusOrigin = value;
+            } else {
+                // output files
+                const QString filename = QFileInfo(value).absoluteFilePath();
+                if ( option == "--junit" )
+                    junitFiles.append(filename);
+                else if ( option == "--json" )
+                    jsonFiles.append(filename);
+                else if ( option == "--metrics-file" )
+                    metricsFile = filename;
+                else
+                    traceFile = filename;
+            }
+
+            if ( !ok ) {
+                m_errorString = QString("invalid value for %1: %2").arg(option, value);
+                return false;
+            }
+            continue;
+        }
+
+        if ( arg.startsWith('-') ) {
+            m_errorString = QString("unknown option: %1").arg(arg);
+            return false;
+        }
+        positionalArgs.append(arg);
+    }
+
+    return true;
+}
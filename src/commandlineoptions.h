@@ -0,0 +1,47 @@
+#ifndef COMMANDLINEOPTIONS_H
+#define COMMANDLINEOPTIONS_H
+
+#include <QString>
+#include <QStringList>
+
+// edgecase's command-line options, parsed the same way for the GUI & --headless
+//
+// options w/ values may be given as '--option=value' or '--option value'.
+// The GUI only uses the status port & origin; the rest are for --headless
+// (see HeadlessRunner::usage()).
+class CommandLineOptions {
+
+    // ctor & dtor
+    public:
+        CommandLineOptions(void);
+        ~CommandLineOptions(void);
+
+    // CommandLineOptions interface
+    public:
+
+        // returns false on invalid args (see errorString()), leaving the rest unparsed
+        bool parse(const QStringList& args);
+        QString errorString(void) const;
+
+    // options (file names are absolute)
+    public:
+        bool isHeadless;
+        bool isHelpRequested;
+        bool shouldRecurse;
+        int  jobs;              // 0 if not given
+        qreal timeout;          // seconds, 0 if not given
+        QString filter;         // empty if not given
+        QStringList junitFiles;
+        QStringList jsonFiles;
+        int  statusPort;        // -1 if not given
+        QString statusOrigin;   // origin allowed to read status from a browser, empty if not given
+        QString metricsFile;
+        QString traceFile;
+        QStringList positionalArgs;
+
+    // data members
+    private:
+        QString m_errorString;
+};
+
+#endif // COMMANDLINEOPTIONS_H
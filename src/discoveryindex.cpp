@@ -0,0 +1,154 @@
+#include "discoveryindex.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+    const quint32 IndexMagic   = 0xEDC41D01;
+
+    // bump whenever program classification changes (new types, new markers),
+    // so executables cached under the old rules are classified again
+    //   2 - GoogleBenchmark programs
+    const quint32 IndexVersion = 2;
+
+    // directories modified this close to the start of a scan may change again
+    // within the same mtime tick, so they are not trusted on the next scan
+    const qint64 RecentChangeWindow = 2000; // msecs
+} // namespace Constants
+
+// -------------------------------
+// DiscoveryIndex implementation
+// -------------------------------
+
+DiscoveryIndex::DiscoveryIndex(void)
+    : m_scanStartTime(0)
+{ }
+
+DiscoveryIndex::~DiscoveryIndex(void) { }
+
+void DiscoveryIndex::begin(const QString& filename) {
+
+    QMutexLocker locker(&m_mutex);
+
+    // reset state
+    m_filename = filename;
+    m_scanStartTime = QDateTime::currentMSecsSinceEpoch();
+    m_previous.clear();
+    m_current.clear();
+
+    // open index file (missing file is not an error, just an empty index)
+    QFile file(filename);
+    if ( !file.open(QFile::ReadOnly) )
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    // check header
+    quint32 magic;
+    quint32 version;
+    in >> magic >> version;
+    if ( magic != Constants::IndexMagic || version != Constants::IndexVersion )
+        return;
+
+    // read directory entries
+    qint32 numDirectories;
+    in >> numDirectories;
+    for ( qint32 i = 0; i < numDirectories && in.status() == QDataStream::Ok; ++i ) {
+        QString path;
+        Directory dir;
+        qint32 numFiles;
+        in >> path >> dir.mtime >> dir.subdirectories >> numFiles;
+        for ( qint32 j = 0; j < numFiles && in.status() == QDataStream::Ok; ++j ) {
+            File f;
+            qint32 type;
+            in >> f.filepath >> f.mtime >> f.size >> type;
+            f.type = static_cast<ProgramInfo::ProgramType>(type);
+            dir.files.append(f);
+        }
+        m_previous.insert(path, dir);
+    }
+
+    // discard partially-read (corrupt) index
+    if ( in.status() != QDataStream::Ok ) {
+        qDebug() << "Discarding corrupt discovery index: " << filename;
+        m_previous.clear();
+    }
+}
+
+bool DiscoveryIndex::end(bool isFullScan) {
+
+    QMutexLocker locker(&m_mutex);
+
+    // skip if no scan was started
+    if ( m_filename.isEmpty() )
+        return false;
+
+    // keep directories we didn't get to this time
+    if ( !isFullScan ) {
+        QHash<QString, Directory>::const_iterator prevIter = m_previous.constBegin();
+        QHash<QString, Directory>::const_iterator prevEnd  = m_previous.constEnd();
+        for ( ; prevIter != prevEnd; ++prevIter ) {
+            if ( !m_current.contains(prevIter.key()) )
+                m_current.insert(prevIter.key(), prevIter.value());
+        }
+    }
+
+    // write to temp file first, so a failed write doesn't clobber the old index
+    const QString tempFilename = m_filename + ".tmp";
+    QFile file(tempFilename);
+    if ( !file.open(QFile::WriteOnly | QFile::Truncate) ) {
+        qDebug() << "Could not write discovery index: " << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+    out << Constants::IndexMagic << Constants::IndexVersion << qint32(m_current.size());
+
+    QHash<QString, Directory>::const_iterator dirIter = m_current.constBegin();
+    QHash<QString, Directory>::const_iterator dirEnd  = m_current.constEnd();
+    for ( ; dirIter != dirEnd; ++dirIter ) {
+        const Directory& dir = dirIter.value();
+        out << dirIter.key() << dir.mtime << dir.subdirectories << qint32(dir.files.size());
+        foreach ( const File& f, dir.files )
+            out << f.filepath << f.mtime << f.size << qint32(f.type);
+    }
+    file.close();
+
+    // swap in new index
+    const bool ok = ( out.status() == QDataStream::Ok );
+    if ( ok ) {
+        QFile::remove(m_filename);
+        QFile::rename(tempFilename, m_filename);
+    } else
+        QFile::remove(tempFilename);
+
+    // release memory
+    m_filename.clear();
+    m_previous.clear();
+    m_current.clear();
+    return ok;
+}
+
+void DiscoveryIndex::insertDirectory(const QString& path, const Directory& dir) {
+
+    QMutexLocker locker(&m_mutex);
+
+    // don't trust directories modified right around the time of this scan
+    Directory entry(dir);
+    if ( entry.mtime >= m_scanStartTime - Constants::RecentChangeWindow )
+        entry.mtime = -1;
+    m_current.insert(path, entry);
+}
+
+bool DiscoveryIndex::previousDirectory(const QString& path, Directory* dir) const {
+
+    Q_ASSERT_X(dir, Q_FUNC_INFO, "null directory entry");
+
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, Directory>::const_iterator found = m_previous.constFind(path);
+    if ( found == m_previous.constEnd() )
+        return false;
+    *dir = found.value();
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef DISCOVERYINDEX_H
+#define DISCOVERYINDEX_H
+
+#include "programinfo.h"
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+
+// on-disk record of a previous directory scan, so that directories whose mtime
+// hasn't changed can be reused without listing their contents or re-classifying
+// their executables
+//
+// N.B. - a directory's mtime only changes when entries are added, removed, or
+//        renamed. Build tools normally replace binaries (changing the mtime), but
+//        a binary rewritten in place keeps its old classification until its
+//        directory changes.
+//
+// lookups & inserts are thread-safe
+class DiscoveryIndex {
+
+    // index entries
+    public:
+        struct File {
+            QString filepath;
+            qint64  mtime;
+            qint64  size;
+            ProgramInfo::ProgramType type; // including Unknown ("not a test") entries
+        };
+
+        struct Directory {
+            qint64 mtime;                // -1 if not trusted (changed too recently)
+            QStringList subdirectories;  // names, not full paths (none pruned)
+            QList<File> files;           // candidate executables
+        };
+
+    // ctor & dtor
+    public:
+        DiscoveryIndex(void);
+        ~DiscoveryIndex(void);
+
+    // DiscoveryIndex interface
+    public:
+
+        // start a scan, loading the previous one from disk (if any)
+        void begin(const QString& filename);
+
+        // finish a scan, saving results to disk
+        // if not a full scan (limited depth, etc), unvisited directories are kept
+        bool end(bool isFullScan);
+
+        // directory data from previous scan, regardless of whether it's still up-to-date
+        bool previousDirectory(const QString& path, Directory* dir) const;
+
+        // store directory data for current scan
+        void insertDirectory(const QString& path, const Directory& dir);
+
+    // data members
+    private:
+        mutable QMutex m_mutex;
+        QString m_filename;
+        qint64  m_scanStartTime;
+        QHash<QString, Directory> m_previous;
+        QHash<QString, Directory> m_current;
+};
+
+#endif // DISCOVERYINDEX_H
@@ -0,0 +1,278 @@
+#include "elfinspector.h"
+#include <QtCore>
+#include <QtDebug>
+#include <cstring>
+
+namespace Constants {
+
+    // ELF identification
+    enum { ElfIdentSize   = 16
+         , ElfClassOffset = 4
+         , ElfDataOffset  = 5
+         , ElfClass32     = 1
+         , ElfClass64     = 2
+         , ElfDataLsb     = 1
+         , ElfDataMsb     = 2
+         };
+
+    // object file types
+    enum { ElfTypeExec = 2
+         , ElfTypeDyn  = 3
+         };
+
+    // section, segment, & dynamic entry types
+    enum { SectionSymTab  = 2
+         , SectionDynamic = 6
+         , SectionDynSym  = 11
+         , SegmentInterp  = 3
+         , DynamicNull    = 0
+         , DynamicNeeded  = 1
+         };
+
+} // namespace Constants
+
+// -----------------------------
+// ElfInspector implementation
+// -----------------------------
+
+ElfInspector::ElfInspector(const QString& filepath)
+    : m_file(filepath)
+    , m_data(0)
+    , m_size(0)
+    , m_isValid(false)
+    , m_is64Bit(false)
+    , m_isBigEndian(false)
+    , m_isExecutable(false)
+{
+    // map file contents
+    if ( !m_file.open(QFile::ReadOnly) )
+        return;
+    m_size = m_file.size();
+    if ( m_size < Constants::ElfIdentSize )
+        return;
+    m_data = m_file.map(0, m_size);
+    if ( m_data == 0 )
+        return;
+
+    // read headers & section table
+    parseHeaders();
+}
+
+ElfInspector::~ElfInspector(void) {
+    if ( m_data )
+        m_file.unmap(m_data);
+}
+
+bool ElfInspector::hasSymbolWithPrefix(const QList<QByteArray>& prefixes) const {
+
+    if ( !m_isValid )
+        return false;
+
+    // check both dynamic & (if not stripped) static symbol tables
+    foreach ( const Section& section, m_sections ) {
+        if ( section.type != Constants::SectionDynSym && section.type != Constants::SectionSymTab )
+            continue;
+
+        // fetch associated string table
+        if ( section.link >= quint32(m_sections.size()) )
+            continue;
+        const Section& stringTable = m_sections.at(section.link);
+
+        // st_name is the first field of a symbol entry, for both 32- & 64-bit ELF
+        const quint64 entrySize = ( section.entrySize != 0 ? section.entrySize : (m_is64Bit ? 24 : 16) );
+        const quint64 numSymbols = section.size / entrySize;
+        for ( quint64 i = 0; i < numSymbols; ++i ) {
+            const char* name = stringAt(stringTable, read32(section.offset + i*entrySize));
+            if ( name == 0 || name[0] == '\0' )
+                continue;
+
+            foreach ( const QByteArray& prefix, prefixes ) {
+                if ( qstrncmp(name, prefix.constData(), prefix.size()) == 0 )
+                    return true;
+            }
+        }
+    }
+
+    // not found
+    return false;
+}
+
+bool ElfInspector::inBounds(quint64 offset, quint64 size) const {
+    return offset <= quint64(m_size) && size <= quint64(m_size) - offset;
+}
+
+bool ElfInspector::isExecutable(void) const {
+    return m_isValid && m_isExecutable;
+}
+
+bool ElfInspector::isValid(void) const {
+    return m_isValid;
+}
+
+QStringList ElfInspector::neededLibraries(void) const {
+
+    QStringList result;
+    if ( !m_isValid )
+        return result;
+
+    foreach ( const Section& section, m_sections ) {
+        if ( section.type != Constants::SectionDynamic )
+            continue;
+
+        // fetch associated string table
+        if ( section.link >= quint32(m_sections.size()) )
+            continue;
+        const Section& stringTable = m_sections.at(section.link);
+
+        // read (tag, value) entries until DT_NULL
+        const quint64 wordSize  = ( m_is64Bit ? 8 : 4 );
+        const quint64 numEntries = section.size / (2*wordSize);
+        for ( quint64 i = 0; i < numEntries; ++i ) {
+            const quint64 entryOffset = section.offset + i*2*wordSize;
+            const quint64 tag = readWord(entryOffset);
+            if ( tag == Constants::DynamicNull )
+                break;
+            if ( tag == Constants::DynamicNeeded ) {
+                const char* name = stringAt(stringTable, readWord(entryOffset + wordSize));
+                if ( name )
+                    result.append(QString::fromLatin1(name));
+            }
+        }
+    }
+
+    return result;
+}
+
+void ElfInspector::parseHeaders(void) {
+
+    // check magic number
+    if ( m_data[0] != 0x7f || m_data[1] != 'E' || m_data[2] != 'L' || m_data[3] != 'F' )
+        return;
+
+    // check class & byte order
+    const uchar elfClass = m_data[Constants::ElfClassOffset];
+    const uchar elfData  = m_data[Constants::ElfDataOffset];
+    if ( elfClass != Constants::ElfClass32 && elfClass != Constants::ElfClass64 )
+        return;
+    if ( elfData != Constants::ElfDataLsb && elfData != Constants::ElfDataMsb )
+        return;
+    m_is64Bit     = ( elfClass == Constants::ElfClass64 );
+    m_isBigEndian = ( elfData  == Constants::ElfDataMsb );
+
+    // make sure full file header is present
+    const quint64 headerSize = ( m_is64Bit ? 64 : 52 );
+    if ( !inBounds(0, headerSize) )
+        return;
+
+    // read file header fields
+    const quint16 type = read16(16);
+    quint64 programHeaderOffset;
+    quint64 sectionHeaderOffset;
+    quint16 programHeaderSize;
+    quint16 programHeaderCount;
+    quint16 sectionHeaderSize;
+    quint16 sectionHeaderCount;
+    if ( m_is64Bit ) {
+        programHeaderOffset = read64(32);
+        sectionHeaderOffset = read64(40);
+        programHeaderSize   = read16(54);
+        programHeaderCount  = read16(56);
+        sectionHeaderSize   = read16(58);
+        sectionHeaderCount  = read16(60);
+    } else {
+        programHeaderOffset = read32(28);
+        sectionHeaderOffset = read32(32);
+        programHeaderSize   = read16(42);
+        programHeaderCount  = read16(44);
+        sectionHeaderSize   = read16(46);
+        sectionHeaderCount  = read16(48);
+    }
+
+    // read section headers
+    const quint64 minSectionHeaderSize = ( m_is64Bit ? 64 : 40 );
+    if ( sectionHeaderCount > 0 ) {
+        if ( sectionHeaderSize < minSectionHeaderSize ||
+             !inBounds(sectionHeaderOffset, quint64(sectionHeaderSize)*sectionHeaderCount) )
+        {
+            return;
+        }
+
+        for ( quint16 i = 0; i < sectionHeaderCount; ++i ) {
+            const quint64 base = sectionHeaderOffset + quint64(i)*sectionHeaderSize;
+            Section section;
+            section.type = read32(base + 4);
+            if ( m_is64Bit ) {
+                section.offset    = read64(base + 24);
+                section.size      = read64(base + 32);
+                section.link      = read32(base + 40);
+                section.entrySize = read64(base + 56);
+            } else {
+                section.offset    = read32(base + 16);
+                section.size      = read32(base + 20);
+                section.link      = read32(base + 24);
+                section.entrySize = read32(base + 36);
+            }
+
+            // treat out-of-range sections (e.g. SHT_NOBITS) as empty
+            if ( !inBounds(section.offset, section.size) )
+                section.size = 0;
+            m_sections.append(section);
+        }
+    }
+
+    // determine if executable - position-independent executables share ET_DYN with
+    // shared libraries, but only executables request a program interpreter
+    if ( type == Constants::ElfTypeExec )
+        m_isExecutable = true;
+    else if ( type == Constants::ElfTypeDyn && programHeaderSize >= 4 &&
+              inBounds(programHeaderOffset, quint64(programHeaderSize)*programHeaderCount) )
+    {
+        for ( quint16 i = 0; i < programHeaderCount; ++i ) {
+            const quint64 base = programHeaderOffset + quint64(i)*programHeaderSize;
+            if ( read32(base) == Constants::SegmentInterp ) {
+                m_isExecutable = true;
+                break;
+            }
+        }
+    }
+
+    // if we get here, file is OK
+    m_isValid = true;
+}
+
+quint16 ElfInspector::read16(quint64 offset) const {
+    if ( !inBounds(offset, 2) )
+        return 0;
+    const uchar* src = m_data + offset;
+    return ( m_isBigEndian ? qFromBigEndian<quint16>(src) : qFromLittleEndian<quint16>(src) );
+}
+
+quint32 ElfInspector::read32(quint64 offset) const {
+    if ( !inBounds(offset, 4) )
+        return 0;
+    const uchar* src = m_data + offset;
+    return ( m_isBigEndian ? qFromBigEndian<quint32>(src) : qFromLittleEndian<quint32>(src) );
+}
+
+quint64 ElfInspector::read64(quint64 offset) const {
+    if ( !inBounds(offset, 8) )
+        return 0;
+    const uchar* src = m_data + offset;
+    return ( m_isBigEndian ? qFromBigEndian<quint64>(src) : qFromLittleEndian<quint64>(src) );
+}
+
+quint64 ElfInspector::readWord(quint64 offset) const {
+    return ( m_is64Bit ? read64(offset) : read32(offset) );
+}
+
+const char* ElfInspector::stringAt(const Section& stringTable, quint64 index) const {
+
+    // make sure the string is inside the table & null-terminated
+    if ( index >= stringTable.size )
+        return 0;
+    const char* begin = reinterpret_cast<const char*>(m_data + stringTable.offset + index);
+    const size_t maxLength = size_t(stringTable.size - index);
+    if ( std::memchr(begin, '\0', maxLength) == 0 )
+        return 0;
+    return begin;
+}
@@ -0,0 +1,59 @@
+#ifndef ELFINSPECTOR_H
+#define ELFINSPECTOR_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QStringList>
+
+// read-only view of an ELF binary's headers, dynamic section & symbol tables
+// (file contents are memory-mapped, nothing is loaded or executed)
+class ElfInspector {
+
+    // ctor & dtor
+    public:
+        explicit ElfInspector(const QString& filepath);
+        ~ElfInspector(void);
+
+    // ElfInspector interface
+    public:
+        bool isValid(void) const;       // well-formed ELF file (any class/byte order)
+        bool isExecutable(void) const;  // ET_EXEC, or ET_DYN w/ program interpreter (PIE)
+
+        // DT_NEEDED entries from the dynamic section
+        QStringList neededLibraries(void) const;
+
+        // true if any symbol name (.dynsym or .symtab) starts with one of the prefixes
+        bool hasSymbolWithPrefix(const QList<QByteArray>& prefixes) const;
+
+    // internal methods
+    private:
+        struct Section {
+            quint32 type;
+            quint64 offset;
+            quint64 size;
+            quint32 link;
+            quint64 entrySize;
+        };
+
+        bool inBounds(quint64 offset, quint64 size) const;
+        void parseHeaders(void);
+        quint16 read16(quint64 offset) const;
+        quint32 read32(quint64 offset) const;
+        quint64 read64(quint64 offset) const;
+        quint64 readWord(quint64 offset) const; // 32- or 64-bit, depending on ELF class
+        const char* stringAt(const Section& stringTable, quint64 index) const;
+
+    // data members
+    private:
+        QFile  m_file;
+        uchar* m_data;
+        qint64 m_size;
+        bool   m_isValid;
+        bool   m_is64Bit;
+        bool   m_isBigEndian;
+        bool   m_isExecutable;
+        QList<Section> m_sections;
+};
+
+#endif // ELFINSPECTOR_H
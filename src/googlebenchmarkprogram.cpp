@@ -0,0 +1,314 @@
+#include "googlebenchmarkprogram.h"
+#include "jsonreader.h"
+#include "testcase.h"
+#include "testresultbatch.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+    // longest filter passed on the command line (see GoogleTestProgram)
+    enum { MaxFilterArgLength = 16 * 1024 };
+} // namespace Constants
+
+// keys that aren't user-defined counters
+// (built before main(), so it's safe to share between parser threads)
+static const QStringList ReservedKeys = QStringList()
+    << "name" << "run_name" << "run_type" << "family_index" << "per_family_instance_index"
+    << "repetitions" << "repetition_index" << "threads" << "iterations" << "real_time"
+    << "cpu_time" << "time_unit" << "aggregate_name" << "aggregate_unit"
+    << "error_occurred" << "error_message" << "skipped" << "label";
+
+// aggregate name suffixes, for older versions without 'run_type'
+static const QStringList AggregateNames = QStringList() << "mean" << "median" << "stddev" << "cv";
+
+// returns seconds per Google Benchmark 'time_unit'
+static
+qreal secondsPerUnit(const QString& timeUnit) {
+    if ( timeUnit == "ns" ) return 1e-9;
+    if ( timeUnit == "us" ) return 1e-6;
+    if ( timeUnit == "ms" ) return 1e-3;
+    if ( timeUnit == "s" )  return 1.0;
+    return 1e-9; // library default
+}
+
+// returns regex-escaped benchmark name
+static
+QString escapeName(const QString& name) {
+    static const QString special("\\^$.|?*+()[]{}");
+    QString result;
+    result.reserve(name.size());
+    foreach ( const QChar& c, name ) {
+        if ( special.contains(c) )
+            result.append('\\');
+        result.append(c);
+    }
+    return result;
+}
+
+// ---------------------------------------
+// GoogleBenchmarkProgram implementation
+// ---------------------------------------
+
+GoogleBenchmarkProgram::GoogleBenchmarkProgram(const QString& filepath, QObject* parent)
+    : TestProgram(filepath, parent)
+{ }
+
+GoogleBenchmarkProgram::~GoogleBenchmarkProgram(void) { }
+
+QString GoogleBenchmarkProgram::filterRegex(void) const {
+
+    // no filter needed if everything is enabled
+    if ( enabledTestCount() == totalTestCount() )
+        return QString();
+
+    // match whole families where possible, otherwise individual benchmarks
+    QStringList patterns;
+    const int numSuites = suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        TestSuite* suite = suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+        const int numEnabled = suite->enabledTestCount();
+        if ( numEnabled == 0 )
+            continue;
+        if ( numEnabled == suite->testCount() ) {
+            patterns.append( escapeName(suite->name()) + "(/.*)?" );
+            continue;
+        }
+
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests; ++j ) {
+            TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            if ( test->isEnabled() )
+                patterns.append( escapeName(test->name()) );
+        }
+    }
+
+    return QString("^(%1)$").arg(patterns.join("|"));
+}
+
+QString GoogleBenchmarkProgram::jsonFilename(void) const {
+    return fileName() + ".json";
+}
+
+QStringList GoogleBenchmarkProgram::listingArgs(void) const {
+    return QStringList() << "--benchmark_list_tests";
+}
+
+QMap<QString, QStringList> GoogleBenchmarkProgram::parseTestListing(QByteArray output, QStringList* errors) {
+
+    Q_ASSERT_X(errors, Q_FUNC_INFO, "null errror list");
+    errors->clear();
+
+    QMap<QString, QStringList> listing;
+
+    // parse output, one benchmark name per line
+    QString line;
+    QBuffer outputBuffer(&output);
+    outputBuffer.open(QBuffer::ReadOnly);
+    while ( outputBuffer.canReadLine() ) {
+        line = QString::fromUtf8(outputBuffer.readLine()).trimmed();
+        if ( line.isEmpty() )
+            continue;
+
+        // family name is everything before any args ("BM_Foo/8/real_time")
+        const int slash = line.indexOf('/');
+        const QString suiteName = ( slash > 0 ? line.left(slash) : line );
+
+        QStringList& testList = listing[suiteName];
+        if ( !testList.contains(line) )
+            testList.append(line);
+    }
+
+    // return result
+    return listing;
+}
+
+bool GoogleBenchmarkProgram::parseTestResults(TestResultBatch* batch, QStringList* errors) {
+
+    Q_ASSERT_X(batch, Q_FUNC_INFO, "null result batch");
+    Q_ASSERT_X(errors, Q_FUNC_INFO, "null string list");
+    errors->clear();
+
+    // open JSON file
+    QFile jsonFile(jsonFilename());
+    if ( !jsonFile.open(QFile::ReadOnly) ) {
+        errors->append(jsonFile.errorString());
+        return false;
+    }
+
+    // parse JSON
+    QString parseError;
+    const QVariant document = JsonReader::parse(jsonFile.readAll(), &parseError);
+    if ( !parseError.isEmpty() ) {
+        errors->append(parseError);
+        return false;
+    }
+    const QVariantMap root = document.toMap();
+    if ( !root.contains("benchmarks") ) {
+        errors->append("File is not readable as Google Benchmark result");
+        return false;
+    }
+
+    // read each benchmark run
+    const QVariantList benchmarks = root.value("benchmarks").toList();
+    foreach ( const QVariant& benchmark, benchmarks ) {
+        if ( !readBenchmarkResult(batch, benchmark.toMap(), errors) )
+            return false;
+    }
+
+    // suite & program times are the sum of their benchmarks' times
+    // (const lookups, so unreported tests stay unreported)
+    const TestResultBatch* results = batch;
+    qreal programTime = 0.0;
+    const int numSuites = batch->suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        if ( !batch->hasReportedTests(i) )
+            continue;
+
+        qreal suiteTime = 0.0;
+        bool hasRunTests = false;
+        const int numTests = batch->testCount(i);
+        for ( int j = 0; j < numTests; ++j ) {
+            const TestResultBatch::TestResult& test = results->result(i, j);
+            if ( test.time >= 0.0 )
+                suiteTime += test.time;
+            hasRunTests = ( hasRunTests || test.wasRun );
+        }
+
+        if ( hasRunTests )
+            batch->setSuiteTime(i, suiteTime);
+        programTime += suiteTime;
+    }
+    batch->setProgramTime(programTime);
+
+    // if we get here, should be OK
+    return true;
+}
+
+bool GoogleBenchmarkProgram::readBenchmarkResult(TestResultBatch* batch,
+                                                 const QVariantMap& benchmark,
+                                                 QStringList* errors)
+{
+    // determine benchmark instance name & whether this is an aggregate
+    const QString name = benchmark.value("name").toString();
+    QString runName   = benchmark.value("run_name", name).toString();
+    QString aggregate = benchmark.value("aggregate_name").toString();
+    if ( !benchmark.contains("run_type") ) {
+        foreach ( const QString& aggregateName, AggregateNames ) {
+            if ( name.endsWith("_" + aggregateName) ) {
+                aggregate = aggregateName;
+                runName = name.left(name.size() - aggregateName.size() - 1);
+                break;
+            }
+        }
+    } else if ( benchmark.value("run_type").toString() != "aggregate" )
+        aggregate.clear();
+
+    // fetch test case
+    const int slash = runName.indexOf('/');
+    const QString suiteName = ( slash > 0 ? runName.left(slash) : runName );
+    const int suite = batch->suiteIndex(suiteName);
+    const int testIndex = batch->testIndex(suite, runName);
+    if ( testIndex < 0 ) {
+        errors->append(QString("Could not find benchmark listing for ")+runName);
+        return false;
+    }
+    TestResultBatch::TestResult& test = batch->result(suite, testIndex);
+
+    // errors & skips
+    const QString errorMessage = benchmark.value("error_message").toString();
+    if ( benchmark.value("error_occurred").toBool() ) {
+        test.wasRun = true;
+        test.passed = false;
+        test.failureMessages.append(errorMessage);
+        return true;
+    }
+    if ( !errorMessage.isEmpty() ) {
+        test.otherMessages.append( QString("Skipped: %1").arg(errorMessage) );
+        return true;
+    }
+
+    // a benchmark 'passes' if every run of it completed
+    if ( !test.wasRun ) {
+        test.wasRun = true;
+        test.passed = true;
+    }
+
+    // times
+    const QString timeUnit = benchmark.value("time_unit", "ns").toString();
+    const qint64 iterations = benchmark.value("iterations").toLongLong();
+    const bool isPercentage = ( benchmark.value("aggregate_unit").toString() == "percentage" );
+    const QString unit = ( isPercentage ? QString("%") : timeUnit );
+    const qreal scale  = ( isPercentage ? 100.0 : 1.0 );
+
+    if ( benchmark.contains("real_time") ) {
+        BenchmarkResult result(BenchmarkResult::WallTime,
+                               benchmark.value("real_time").toDouble() * scale,
+                               iterations, QString(), unit);
+        result.aggregate = aggregate;
+        test.benchmarkResults.append(result);
+
+        // measured runs add to the test's time
+        if ( aggregate.isEmpty() ) {
+            const qreal seconds = result.total() * secondsPerUnit(timeUnit);
+            test.time = ( test.time >= 0.0 ? test.time + seconds : seconds );
+        }
+    }
+
+    if ( benchmark.contains("cpu_time") ) {
+        BenchmarkResult result(BenchmarkResult::CpuTime,
+                               benchmark.value("cpu_time").toDouble() * scale,
+                               iterations, QString(), unit);
+        result.aggregate = aggregate;
+        test.benchmarkResults.append(result);
+    }
+
+    // user-defined (& built-in rate) counters
+    QVariantMap::const_iterator keyIter = benchmark.constBegin();
+    QVariantMap::const_iterator keyEnd  = benchmark.constEnd();
+    for ( ; keyIter != keyEnd; ++keyIter ) {
+        const QString& key = keyIter.key();
+        if ( ReservedKeys.contains(key) || keyIter.value().type() != QVariant::Double )
+            continue;
+
+        BenchmarkResult result(BenchmarkResult::OtherMetric, keyIter.value().toDouble(), 1);
+        result.counterName = key;
+        result.aggregate   = aggregate;
+        if ( key == "bytes_per_second" )
+            result.unit = "bytes/s";
+        else if ( key == "items_per_second" )
+            result.unit = "items/s";
+        test.benchmarkResults.append(result);
+    }
+
+    // optional label, reported once
+    const QString label = benchmark.value("label").toString();
+    if ( !label.isEmpty() && !test.otherMessages.contains(label) )
+        test.otherMessages.append(label);
+
+    // if we get here, should be OK
+    return true;
+}
+
+QStringList GoogleBenchmarkProgram::runTestArgs(QString* error) const {
+
+    Q_UNUSED(error);
+    QStringList args;
+
+    // add our JSON output filename (making sure we're starting with a fresh one)
+    QFile::remove(jsonFilename());
+    args << QString("--benchmark_out=%1").arg(jsonFilename())
+         << "--benchmark_out_format=json";
+
+    // add any benchmark filter that applies
+    // (if too long, just run everything - results for disabled benchmarks are still valid)
+    const QString filter = filterRegex();
+    if ( !filter.isEmpty() && filter.size() <= Constants::MaxFilterArgLength )
+        args << QString("--benchmark_filter=%1").arg(filter);
+
+    // return arg list
+    return args;
+}
@@ -0,0 +1,38 @@
+#ifndef GOOGLEBENCHMARKPROGRAM_H
+#define GOOGLEBENCHMARKPROGRAM_H
+
+#include "testprogram.h"
+#include <QVariantMap>
+
+// Google Benchmark (https://github.com/google/benchmark) executables
+//
+// each benchmark family ("BM_Foo") is a suite, & each of its instances
+// ("BM_Foo/8", "BM_Foo/64/real_time", etc) is a test case
+class GoogleBenchmarkProgram : public TestProgram {
+
+    Q_OBJECT
+
+    // ctor & dtor
+    public:
+        GoogleBenchmarkProgram(const QString& filepath, QObject* parent = 0);
+        ~GoogleBenchmarkProgram(void);
+
+    // TestProgram implementation
+    protected:
+
+        // provide command line args for each run type
+        QStringList listingArgs(void) const;
+        QStringList runTestArgs(QString* error) const;
+
+        // derived classes should output
+        QMap<QString, QStringList> parseTestListing(QByteArray output, QStringList* errors);
+        bool parseTestResults(TestResultBatch* batch, QStringList* errors);
+
+    // internal methods
+    private:
+        QString filterRegex(void) const;
+        QString jsonFilename(void) const;
+        bool readBenchmarkResult(TestResultBatch* batch, const QVariantMap& benchmark, QStringList* errors);
+};
+
+#endif // GOOGLEBENCHMARKPROGRAM_H
@@ -0,0 +1,74 @@
+#include "googletestfilter.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+// ---------------------------------
+// GoogleTestFilter implementation
+// ---------------------------------
+
+QString GoogleTestFilter::fromEnabledTests(const TestProgram* program) {
+
+    // sanity check
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    if ( program == 0 )
+        return QString();
+
+    // no filter needed if everything is enabled
+    const int totalCount   = program->totalTestCount();
+    const int enabledCount = program->enabledTestCount();
+    if ( enabledCount == totalCount )
+        return QString();
+
+    // exclude everything if nothing is enabled
+    if ( enabledCount == 0 )
+        return QString("-*");
+
+    // build both positive ("run these") & negative ("run all but these") patterns,
+    // using whole-suite wildcards wherever a suite is fully enabled (or disabled)
+    QStringList positive;
+    QStringList negative;
+
+    const QLatin1String dot(".");
+    const QLatin1String wildcard(".*");
+
+    // for each suite
+    const int numSuites = program->suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null suite");
+
+        const QString& suiteName = suite->name();
+        const int suiteEnabledCount = suite->enabledTestCount();
+
+        // all tests enabled
+        if ( suiteEnabledCount == suite->testCount() )
+            positive.append(suiteName + wildcard);
+
+        // no tests enabled
+        else if ( suiteEnabledCount == 0 )
+            negative.append(suiteName + wildcard);
+
+        // some tests enabled, list them individually
+        else {
+            const int numTests = suite->testCount();
+            for ( int j = 0; j < numTests; ++j ) {
+                TestCase* test = suite->testAt(j);
+                Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+
+                const QString pattern = suiteName + dot + test->name();
+                if ( test->isEnabled() )
+                    positive.append(pattern);
+                else
+                    negative.append(pattern);
+            }
+        }
+    }
+
+    // return whichever form is shorter
+    const QString positiveFilter = positive.join(":");
+    const QString negativeFilter = QString("-") + negative.join(":");
+    return ( negativeFilter.size() < positiveFilter.size() ? negativeFilter : positiveFilter );
+}
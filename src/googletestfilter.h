@@ -0,0 +1,14 @@
+#ifndef GOOGLETESTFILTER_H
+#define GOOGLETESTFILTER_H
+
+#include <QString>
+class TestProgram;
+
+// builds the shortest --gtest_filter value equivalent to a program's enabled tests
+class GoogleTestFilter {
+    public:
+        // returns empty string if all tests are enabled (no filter needed)
+        static QString fromEnabledTests(const TestProgram* program);
+};
+
+#endif // GOOGLETESTFILTER_H
@@ -1,53 +1,33 @@
 #include "googletestprogram.h"
+#include "googletestfilter.h"
 #include "testcase.h"
+#include "testresultbatch.h"
 #include "testsuite.h"
 #include <QtCore>
 #include <QtDebug>
 
+namespace Constants {
+    // longest filter passed directly on the command line, well under the
+    // per-argument limit on Linux (128K) & whole command line limit on Windows (32K)
+    enum { MaxFilterArgLength = 16 * 1024 };
+
+    // flag file for longer filters, in the system's temp directory
+    const char* const FilterFileTemplate = "edgecase-XXXXXX.filter";
+} // namespace Constants
+
 // ----------------------------------
 // GoogleTestProgram implementation
 // ----------------------------------
 
 GoogleTestProgram::GoogleTestProgram(const QString& filepath, QObject* parent)
     : TestProgram(filepath, parent)
-{ }
-
-GoogleTestProgram::~GoogleTestProgram(void) { }
-
-QString GoogleTestProgram::filterArg(void) const {
-
-    // TODO: check here for 'enabled' suites & tests
-
-    QString filter;
-    QTextStream s(&filter);
-
-    const QLatin1String dot(".");
-    const QLatin1String colon(":");
-
-    // for each suite
-    const int numSuites = suiteCount();
-    for ( int i = 0; i < numSuites; ++i ) {
-        TestSuite* suite = suiteAt(i);
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null suite");
-
-        const QString& suiteName = suite->name();
-
-        // for each test in suite
-        const int numTests = suite->testCount();
-        for ( int j = 0; j < numTests; ++j ) {
-            TestCase* test = suite->testAt(j);
-            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-
-            s << suiteName << dot << test->name() << colon;
-        }
-    }
-
-    // if not empty, remove the trailing colon
-    if ( !filter.isEmpty() )
-        filter.chop(1);
+    , m_filterFile(0)
+{
+    connect(this, SIGNAL(resultsReady(TestProgram*)), SLOT(removeFilterFile()));
+}
 
-    // return result
-    return filter;
+GoogleTestProgram::~GoogleTestProgram(void) {
+    removeFilterFile();
 }
 
 QStringList GoogleTestProgram::listingArgs(void) const {
@@ -55,6 +35,51 @@ QStringList GoogleTestProgram::listingArgs(void) const {
 }
 
 
+TestProgram::OutputMarker GoogleTestProgram::parseOutputLine(const QByteArray& line,
+                                                             QString* suiteName,
+                                                             QString* testName) const
+{
+    static const QByteArray runTag("[ RUN      ] ");
+    static const QByteArray endTags[] = { QByteArray("[       OK ] ")
+                                        , QByteArray("[  FAILED  ] ")
+                                        , QByteArray("[  SKIPPED ] ")
+                                        };
+
+    // check for marker tags
+    OutputMarker marker = TestProgram::NoMarker;
+    int tagSize = 0;
+    if ( line.startsWith(runTag) ) {
+        marker  = TestProgram::TestStarted;
+        tagSize = runTag.size();
+    } else {
+        for ( size_t i = 0; i < sizeof(endTags)/sizeof(endTags[0]); ++i ) {
+            if ( line.startsWith(endTags[i]) ) {
+                marker  = TestProgram::TestFinished;
+                tagSize = endTags[i].size();
+                break;
+            }
+        }
+    }
+    if ( marker == TestProgram::NoMarker )
+        return marker;
+
+    // fetch "Suite.Test" (drop any trailing " (N ms)", ", where GetParam() = ...", etc.)
+    QByteArray name = line.mid(tagSize);
+    const int nameEnd = name.indexOf(' ');
+    if ( nameEnd != -1 )
+        name.truncate(nameEnd);
+    if ( name.endsWith(',') )
+        name.chop(1);
+
+    // split into suite & test names
+    const int dot = name.indexOf('.');
+    if ( dot <= 0 || dot == name.size()-1 )
+        return TestProgram::NoMarker;
+    *suiteName = QString::fromUtf8(name.left(dot));
+    *testName  = QString::fromUtf8(name.mid(dot+1));
+    return marker;
+}
+
 QMap<QString, QStringList> GoogleTestProgram::parseTestListing(QByteArray output, QStringList* errors) {
 
     Q_ASSERT_X(errors, Q_FUNC_INFO, "null errror list");
@@ -70,8 +95,15 @@ QMap<QString, QStringList> GoogleTestProgram::parseTestListing(QByteArray output
     while ( outputBuffer.canReadLine() ) {
         line = outputBuffer.readLine();
 
+        // remove any trailing comment (e.g. "  # GetParam() = 42" for parameterized tests)
+        const int commentStart = line.indexOf('#');
+        if ( commentStart != -1 )
+            line.truncate(commentStart);
+
         // remove leading & trailing whitespaces
         line = line.trimmed();
+        if ( line.isEmpty() )
+            continue;
 
         // if TestSuite name
         if ( line.endsWith('.') ) {
@@ -108,8 +140,9 @@ QMap<QString, QStringList> GoogleTestProgram::parseTestListing(QByteArray output
     return listing;
 }
 
-bool GoogleTestProgram::parseTestResults(QStringList* errors) {
+bool GoogleTestProgram::parseTestResults(TestResultBatch* batch, QStringList* errors) {
 
+    Q_ASSERT_X(batch, Q_FUNC_INFO, "null result batch");
     Q_ASSERT_X(errors, Q_FUNC_INFO, "null string list");
     errors->clear();
 
@@ -122,10 +155,10 @@ bool GoogleTestProgram::parseTestResults(QStringList* errors) {
 
     // parse XML file for program results
     m_xml.setDevice(&xmlFile);
-    return readProgramResult(errors);
+    return readProgramResult(batch, errors);
 }
 
-bool GoogleTestProgram::readProgramResult(QStringList* errors) {
+bool GoogleTestProgram::readProgramResult(TestResultBatch* batch, QStringList* errors) {
 
     // fetch top-level "testsuites" element
     if ( !m_xml.readNextStartElement() || m_xml.name() != "testsuites") {
@@ -137,14 +170,14 @@ bool GoogleTestProgram::readProgramResult(QStringList* errors) {
     const QXmlStreamAttributes& attributes = m_xml.attributes();
     const QString& timeString = attributes.value("time").toString();
     if ( !timeString.isEmpty() )
-        setTime(timeString.toDouble());
+        batch->setProgramTime(timeString.toDouble());
 
     // read through "testsuite" elements within top-level "testsuites"
     while ( !m_xml.atEnd() && m_xml.readNextStartElement() ) {
 
         // if "testsuite" element, attempt to parse (ignore other elements)
         if ( m_xml.name() == "testsuite" ) {
-            if ( !readSuiteResult(errors) )
+            if ( !readSuiteResult(batch, errors) )
                 return false;
         } else
             m_xml.skipCurrentElement();
@@ -160,7 +193,7 @@ bool GoogleTestProgram::readProgramResult(QStringList* errors) {
     return true;
 }
 
-bool GoogleTestProgram::readSuiteResult(QStringList* errors) {
+bool GoogleTestProgram::readSuiteResult(TestResultBatch* batch, QStringList* errors) {
 
     // sanity check
     Q_ASSERT_X(m_xml.isStartElement() && m_xml.name() == "testsuite",
@@ -169,8 +202,8 @@ bool GoogleTestProgram::readSuiteResult(QStringList* errors) {
     // fetch test suite for this element
     const QXmlStreamAttributes& attributes = m_xml.attributes();
     const QString& suiteName = attributes.value("name").toString();
-    TestSuite* suite = suiteForName(suiteName);
-    if ( suite == 0 ) {
+    const int suite = batch->suiteIndex(suiteName);
+    if ( suite < 0 ) {
         errors->append(QString("Could not find test suite listing for ")+suiteName);
         return false;
     }
@@ -178,14 +211,14 @@ bool GoogleTestProgram::readSuiteResult(QStringList* errors) {
     // set time elapsed for test suite
     const QString& timeString = attributes.value("time").toString();
     if ( !timeString.isEmpty() )
-        suite->setTime(timeString.toDouble());
+        batch->setSuiteTime(suite, timeString.toDouble());
 
     // read through "testcase" elements withing our "testsuite"
     while ( !m_xml.atEnd() && m_xml.readNextStartElement() ) {
 
         // if "testcase" element, attempt to parse (ignore other elements)
         if ( m_xml.name() == "testcase" ) {
-            if ( !readTestResult(suite, errors) )
+            if ( !readTestResult(batch, suite, errors) )
                 return false;
         } else
             m_xml.skipCurrentElement();
@@ -201,35 +234,36 @@ bool GoogleTestProgram::readSuiteResult(QStringList* errors) {
     return true;
 }
 
-bool GoogleTestProgram::readTestResult(TestSuite* suite, QStringList* errors) {
+bool GoogleTestProgram::readTestResult(TestResultBatch* batch, int suite, QStringList* errors) {
 
     // sanity check
-    Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+    Q_ASSERT_X(batch, Q_FUNC_INFO, "null result batch");
     Q_ASSERT_X(m_xml.isStartElement() && m_xml.name() == "testcase",
                Q_FUNC_INFO, "unexpected root element here");
 
     // fetch test case for this element
     const QXmlStreamAttributes attributes = m_xml.attributes();
     const QString& testName = attributes.value("name").toString();
-    TestCase* test = suite->testForName(testName);
-    if ( test == 0 ) {
+    const int testIndex = batch->testIndex(suite, testName);
+    if ( testIndex < 0 ) {
         errors->append(QString("Could not find test case listing for ")+testName);
         return false;
     }
+    TestResultBatch::TestResult& test = batch->result(suite, testIndex);
 
     // set time elapsed for test case
     const QString& timeString = attributes.value("time").toString();
     if ( !timeString.isEmpty() )
-        test->setTime(timeString.toDouble());
+        test.time = timeString.toDouble();
 
     // if not run, set status accordingly
     const QString& status = attributes.value("status").toString();
     if ( status == "notrun" )
-        test->setWasRun(false);
+        test.wasRun = false;
     // otherwise, check for failure messages
     else {
-        test->setPassed(true);
-        test->setWasRun(true);
+        test.passed = true;
+        test.wasRun = true;
 
         // read through remaining 'start' elements in testcase
         while ( !m_xml.atEnd() && m_xml.readNextStartElement() ) {
@@ -239,8 +273,8 @@ bool GoogleTestProgram::readTestResult(TestSuite* suite, QStringList* errors) {
                 const QString& msg = m_xml.readElementText();
 
                 // add message to our test & update its status flag
-                test->addFailureMessage(msg);
-                test->setPassed(false);
+                test.failureMessages.append(msg);
+                test.passed = false;
             } else
                 m_xml.skipCurrentElement();
 
@@ -256,8 +290,15 @@ bool GoogleTestProgram::readTestResult(TestSuite* suite, QStringList* errors) {
     return true;
 }
 
-QStringList GoogleTestProgram::runTestArgs(void) const {
+void GoogleTestProgram::removeFilterFile(void) {
+    // (temporary file is deleted along w/ its object)
+    delete m_filterFile;
+    m_filterFile = 0;
+}
+
+QStringList GoogleTestProgram::runTestArgs(QString* error) const {
 
+    Q_ASSERT_X(error, Q_FUNC_INFO, "null error string");
     QStringList args;
 
     // add our XML output filename (making sure we're starting with a fresh one)
@@ -265,9 +306,33 @@ QStringList GoogleTestProgram::runTestArgs(void) const {
     args << QString("--gtest_output=xml:%1").arg(xmlFilename());
 
     // add any test filters that apply
-    const QString filter = filterArg();
-    if ( !filter.isEmpty() )
-        args << QString("--gest_filter=%1").arg(filter);
+    delete m_filterFile;
+    m_filterFile = 0;
+    const QString filter = GoogleTestFilter::fromEnabledTests(this);
+    if ( !filter.isEmpty() ) {
+
+        // pass short filters directly
+        if ( filter.size() <= Constants::MaxFilterArgLength )
+            args << QString("--gtest_filter=%1").arg(filter);
+
+        // otherwise, write filter to a flag file & point GoogleTest there
+        // (a temporary file, removed once the run's results are in)
+        else {
+            m_filterFile = new QTemporaryFile(QDir::tempPath() + "/" + Constants::FilterFileTemplate);
+            if ( m_filterFile->open() ) {
+                m_filterFile->write( QString("--gtest_filter=%1\n").arg(filter).toUtf8() );
+                m_filterFile->close();
+                args << QString("--gtest_flagfile=%1").arg(m_filterFile->fileName());
+            }
+
+            // if that fails, the run fails (running everything could take many times longer)
+            else {
+                *error = QString("Could not write test filter file: %1").arg(m_filterFile->errorString());
+                delete m_filterFile;
+                m_filterFile = 0;
+            }
+        }
+    }
 
     // return arg list
     return args;
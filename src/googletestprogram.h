@@ -3,6 +3,7 @@
 
 #include "testprogram.h"
 #include <QXmlStreamReader>
+class QTemporaryFile;
 
 class GoogleTestProgram : public TestProgram {
 
@@ -18,22 +19,27 @@ class GoogleTestProgram : public TestProgram {
 
         // provide command line args for each run type
         QStringList listingArgs(void) const;
-        QStringList runTestArgs(void) const;
+        QStringList runTestArgs(QString* error) const;
 
         // derived classes should output
         QMap<QString, QStringList> parseTestListing(QByteArray output, QStringList* errors);
-        bool parseTestResults(QStringList* errors);
+        bool parseTestResults(TestResultBatch* batch, QStringList* errors);
+
+        // "[ RUN      ] Suite.Test" & "[       OK ] Suite.Test (N ms)" lines
+        OutputMarker parseOutputLine(const QByteArray& line, QString* suiteName, QString* testName) const;
 
     // internal methods
+    private slots:
+        void removeFilterFile(void);
     private:
-        QString filterArg(void) const;
-        bool readProgramResult(QStringList* errors);
-        bool readSuiteResult(QStringList* errors);
-        bool readTestResult(TestSuite* suite, QStringList* errors);
+        bool readProgramResult(TestResultBatch* batch, QStringList* errors);
+        bool readSuiteResult(TestResultBatch* batch, QStringList* errors);
+        bool readTestResult(TestResultBatch* batch, int suite, QStringList* errors);
 
     // data members
     private:
         QXmlStreamReader m_xml;
+        mutable QTemporaryFile* m_filterFile; // flag file for a long filter, kept until the run's results are in
 };
 
 #endif // GOOGLETESTPROGRAM_H
@@ -0,0 +1,338 @@
+#include "headlessrunner.h"
+#include "commandlineoptions.h"
+#include "resultexporter.h"
+#include "statusserver.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+    enum { ExitSuccess = 0
+         , ExitFailure = 1
+         , ExitUsage   = 2
+         };
+    const char* const Indent = "        ";
+} // namespace Constants
+
+// ------------------------------
+// HeadlessRunner implementation
+// ------------------------------
+
+HeadlessRunner::HeadlessRunner(QObject* parent)
+    : QObject(parent)
+    , m_runner(new TestRunner(this))
+    , m_shouldRecurse(true)
+    , m_statusServer(0)
+    , m_programsToRun(0)
+    , m_programsFinished(0)
+    , m_out(stdout)
+    , m_err(stderr)
+{
+    connect(m_runner, SIGNAL(listTestsFinished()), SLOT(onListTestsFinished()));
+    connect(m_runner, SIGNAL(runTestsFinished()),  SLOT(onRunTestsFinished()));
+    connect(m_runner, SIGNAL(testResultsReady(TestProgram*)),
+            SLOT(onTestResultsReady(TestProgram*)));
+}
+
+HeadlessRunner::~HeadlessRunner(void) { }
+
+int HeadlessRunner::applyFilter(void) {
+
+    const bool hasFilter = !m_positivePatterns.isEmpty() || !m_negativePatterns.isEmpty();
+    int numEnabled = 0;
+
+    // enable each test that matches our filter (all tests, if no filter)
+    const int numPrograms = m_runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        TestProgram* program = m_runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+
+        const int numSuites = program->suiteCount();
+        for ( int j = 0; j < numSuites; ++j ) {
+            TestSuite* suite = program->suiteAt(j);
+            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+            const int numTests = suite->testCount();
+            for ( int k = 0; k < numTests; ++k ) {
+                TestCase* test = suite->testAt(k);
+                Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+                if ( hasFilter )
+                    test->setEnabled( matchesFilter(suite->name(), test->name()) );
+                if ( test->isEnabled() )
+                    ++numEnabled;
+            }
+        }
+
+        if ( program->hasRunnableTests() )
+            ++m_programsToRun;
+    }
+
+    return numEnabled;
+}
+
+void HeadlessRunner::finish(int exitCode) {
+    m_out.flush();
+    m_err.flush();
+    QCoreApplication::exit(exitCode);
+}
+
+bool HeadlessRunner::matchesFilter(const QString& suiteName, const QString& testName) const {
+
+    // patterns match either 'Suite.Test' or just the test name
+    const QString fullName = suiteName + '.' + testName;
+
+    bool isIncluded = m_positivePatterns.isEmpty();
+    foreach ( const QRegExp& pattern, m_positivePatterns ) {
+        if ( pattern.exactMatch(fullName) || pattern.exactMatch(testName) ) {
+            isIncluded = true;
+            break;
+        }
+    }
+    if ( !isIncluded )
+        return false;
+
+    foreach ( const QRegExp& pattern, m_negativePatterns ) {
+        if ( pattern.exactMatch(fullName) || pattern.exactMatch(testName) )
+            return false;
+    }
+    return true;
+}
+
+void HeadlessRunner::onListTestsFinished(void) {
+
+    // report programs that couldn't be listed
+    const int numPrograms = m_runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        TestProgram* program = m_runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        if ( program->hasError() ) {
+            m_erroredPrograms.insert(program);
+            printError( QString("ERROR %1: %2").arg(relativeName(program), program->errorString()) );
+        }
+    }
+
+    // apply filter & run whatever is left
+    const int numEnabled = applyFilter();
+    printLine( QString("Running %1 of %2 tests in %3 of %4 programs")
+                   .arg(numEnabled)
+                   .arg(m_runner->totalTestCount())
+                   .arg(m_programsToRun)
+                   .arg(numPrograms) );
+    m_runner->runTests();
+}
+
+void HeadlessRunner::onRunTestsFinished(void) {
+
+    const int numFailed = m_runner->failedTestCount();
+
+    // complete any result files
+    bool isExported = true;
+    foreach ( ResultExporter* exporter, m_exporters ) {
+        if ( exporter->finish() )
+            printLine( QString("Results written to %1").arg(exporter->fileName()) );
+        else {
+            printError(exporter->errorString());
+            isExported = false;
+        }
+    }
+
+    // print summary
+    QString summary = QString("%1 tests run: %2 passed, %3 failed, %4 regressed")
+                          .arg(m_runner->runTestCount())
+                          .arg(m_runner->passedTestCount())
+                          .arg(numFailed)
+                          .arg(m_runner->regressedTestCount());
+    if ( !m_erroredPrograms.isEmpty() )
+        summary += QString(", %1 program errors").arg(m_erroredPrograms.size());
+    summary += QString(" (%1 s)").arg(m_timer.elapsed() / 1000.0, 0, 'f', 2);
+    printLine(summary);
+
+    finish( (numFailed > 0 || !m_erroredPrograms.isEmpty() || !isExported) ? Constants::ExitFailure
+                                                                           : Constants::ExitSuccess );
+}
+
+void HeadlessRunner::onTestResultsReady(TestProgram* program) {
+
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    ++m_programsFinished;
+
+    // '[ 3/12] FAIL  path/to/test_exe (25 run, 2 failed, 1.20 s)'
+    const int width = QString::number(m_programsToRun).size();
+    const QString counter = QString("[%1/%2]").arg(m_programsFinished, width).arg(m_programsToRun);
+
+    QString status;
+    if ( program->hasError() ) {
+        m_erroredPrograms.insert(program);
+        status = "ERROR";
+    } else if ( program->hasFailedTests() )
+        status = "FAIL ";
+    else
+        status = "PASS ";
+
+    QString details = QString("%1 run").arg(program->runTestCount());
+    if ( program->hasFailedTests() )
+        details += QString(", %1 failed").arg(program->failedTestCount());
+    if ( program->hasRegressedTests() )
+        details += QString(", %1 regressed").arg(program->regressedTestCount());
+    if ( program->hasTime() )
+        details += QString(", %1 s").arg(program->time(), 0, 'f', 2);
+
+    printLine( QString("%1 %2 %3 (%4)").arg(counter, status, relativeName(program), details) );
+
+    // list what went wrong
+    if ( program->hasError() )
+        printLine( Constants::Indent + program->errorString() );
+    if ( !program->hasFailedTests() )
+        return;
+
+    const int numSuites = program->suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+        if ( !suite->hasFailedTests() )
+            continue;
+
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests; ++j ) {
+            TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            if ( test->wasRun() && !test->passed() )
+                printLine( QString("%1FAILED %2.%3").arg(Constants::Indent, suite->name(), test->name()) );
+        }
+    }
+}
+
+bool HeadlessRunner::parseArguments(const QStringList& args, int* exitCode) {
+
+    Q_ASSERT_X(exitCode, Q_FUNC_INFO, "null exit code");
+    *exitCode = Constants::ExitUsage;
+
+    // (same parsing as the GUI's)
+    CommandLineOptions options;
+    if ( !options.parse(args) ) {
+        printError(options.errorString());
+        return false;
+    }
+    if ( options.isHelpRequested ) {
+        printLine(usage());
+        *exitCode = Constants::ExitSuccess;
+        return false;
+    }
+
+    // runner settings
+    m_shouldRecurse = options.shouldRecurse;
+    if ( options.jobs > 0 )
+        m_runner->setMaxConcurrentPrograms(options.jobs);
+    if ( options.timeout > 0.0 )
+        m_runner->setProgramTimeout( qRound(options.timeout * 1000.0) );
+    if ( !options.metricsFile.isEmpty() )
+        m_runner->setMetricsFileName(options.metricsFile);
+    if ( !options.traceFile.isEmpty() )
+        m_runner->setTraceFileName(options.traceFile);
+    setFilter(options.filter);
+
+    // live status
+    if ( options.statusPort >= 0 ) {
+        m_statusServer = new StatusServer(m_runner, this);
+        m_statusServer->setAllowedOrigin(options.statusOrigin);
+        if ( !m_statusServer->listen(options.statusPort) ) {
+            printError( QString("could not serve status on port %1: %2")
+                            .arg(options.statusPort)
+                            .arg(m_statusServer->errorString()) );
+            return false;
+        }
+        printLine( QString("Serving status at http://127.0.0.1:%1/").arg(m_statusServer->port()) );
+    }
+
+    // result files
+    foreach ( const QString& filename, options.junitFiles ) {
+        ResultExporter* exporter = new ResultExporter(ResultExporter::JUnitXml, filename, this);
+        exporter->attach(m_runner);
+        m_exporters.append(exporter);
+    }
+    foreach ( const QString& filename, options.jsonFiles ) {
+        ResultExporter* exporter = new ResultExporter(ResultExporter::Json, filename, this);
+        exporter->attach(m_runner);
+        m_exporters.append(exporter);
+    }
+
+    // test directory
+    if ( options.positionalArgs.size() != 1 ) {
+        printError(usage());
+        return false;
+    }
+    const QFileInfo dirInfo(options.positionalArgs.first());
+    if ( !dirInfo.isDir() ) {
+        printError( QString("not a directory: %1").arg(options.positionalArgs.first()) );
+        return false;
+    }
+    m_directory = dirInfo.absoluteFilePath();
+
+    // if we get here, OK to start
+    *exitCode = Constants::ExitSuccess;
+    return true;
+}
+
+void HeadlessRunner::printError(const QString& message) {
+    m_err << message << '\n';
+    m_err.flush();
+}
+
+void HeadlessRunner::printLine(const QString& line) {
+    m_out << line << '\n';
+    m_out.flush();
+}
+
+QString HeadlessRunner::relativeName(const TestProgram* program) const {
+    return QDir(m_directory).relativeFilePath(program->fileName());
+}
+
+void HeadlessRunner::setFilter(const QString& filter) {
+
+    // GoogleTest-style: 'Positive1:Positive2-Negative1:Negative2'
+    const int dash = filter.indexOf('-');
+    const QString positive = ( dash >= 0 ? filter.left(dash) : filter );
+    const QString negative = ( dash >= 0 ? filter.mid(dash + 1) : QString() );
+
+    m_positivePatterns.clear();
+    m_negativePatterns.clear();
+    foreach ( const QString& pattern, positive.split(':', QString::SkipEmptyParts) )
+        m_positivePatterns.append( QRegExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard) );
+    foreach ( const QString& pattern, negative.split(':', QString::SkipEmptyParts) )
+        m_negativePatterns.append( QRegExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard) );
+}
+
+void HeadlessRunner::start(void) {
+    m_timer.start();
+    m_runner->listTests(m_directory, m_shouldRecurse);
+}
+
+QString HeadlessRunner::usage(void) {
+    return QString(
+        "usage: edgecase --headless [options] <directory>\n"
+        "\n"
+        "Lists & runs all test programs found in <directory>.\n"
+        "Exits with 0 if all tests pass, 1 on any failure or program error.\n"
+        "\n"
+        "options:\n"
+        "  --jobs=N          run at most N programs at once (default: number of CPUs)\n"
+        "  --filter=PATTERN  only run matching tests, as 'Pos1:Pos2-Neg1:Neg2'\n"
+        "                    (wildcards, matched against 'Suite.Test' or the test name)\n"
+        "  --timeout=SECS    fail any program still running after SECS (default: no limit)\n"
+        "  --junit=FILE      write results as JUnit XML, as each program finishes\n"
+        "  --json=FILE       write results as JSON, as each program finishes\n"
+        "  --status-port=N   serve live status on localhost:N (0 = any free port)\n"
+        "                    GET /status, /programs (JSON), /events (server-sent events),\n"
+        "                    & /metrics (Prometheus)\n"
+        "  --status-origin=ORIGIN  let pages from ORIGIN (e.g. http://host:port) read\n"
+        "                    the status from a browser (default: no other origin)\n"
+        "  --metrics-file=FILE  write runner overhead metrics (Prometheus text) to FILE\n"
+        "                    (default: ~/.edgecase/metrics/)\n"
+        "  --trace-file=FILE  write the run's timeline (Chrome trace-event JSON) to FILE\n"
+        "                    (default: ~/.edgecase/traces/)\n"
+        "  --no-recurse      don't search subdirectories\n"
+        "  --help            show this message");
+}
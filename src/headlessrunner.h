@@ -0,0 +1,76 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QRegExp>
+#include <QSet>
+#include <QStringList>
+#include <QTextStream>
+class ResultExporter;
+class StatusServer;
+class TestProgram;
+class TestRunner;
+
+// command-line driver for TestRunner (for CI, etc.)
+//
+// lists & runs all test programs found in a directory without any GUI,
+// printing one line per finished program & a summary. The application's
+// exit code is 0 if everything passed, 1 on any failed test or program
+// error, 2 on invalid arguments.
+class HeadlessRunner : public QObject {
+
+    Q_OBJECT
+
+    // ctor & dtor
+    public:
+        explicit HeadlessRunner(QObject* parent = 0);
+        ~HeadlessRunner(void);
+
+    // HeadlessRunner interface
+    public slots:
+        void start(void);
+    public:
+        // returns false if there's nothing to run (help requested, or invalid
+        // args - after printing why), with the exit code to use
+        bool parseArguments(const QStringList& args, int* exitCode);
+        static QString usage(void);
+
+    // internal methods
+    private slots:
+        void onListTestsFinished(void);
+        void onRunTestsFinished(void);
+        void onTestResultsReady(TestProgram* program);
+    private:
+        int applyFilter(void);
+        void finish(int exitCode);
+        bool matchesFilter(const QString& suiteName, const QString& testName) const;
+        void printError(const QString& message);
+        void printLine(const QString& line);
+        QString relativeName(const TestProgram* program) const;
+        void setFilter(const QString& filter);
+
+    // data members
+    private:
+        TestRunner* m_runner;
+
+        // options
+        QString m_directory;
+        bool m_shouldRecurse;
+        QList<QRegExp> m_positivePatterns;
+        QList<QRegExp> m_negativePatterns;
+        QList<ResultExporter*> m_exporters;
+        StatusServer* m_statusServer;
+
+        // progress
+        QElapsedTimer m_timer;
+        int m_programsToRun;
+        int m_programsFinished;
+        QSet<const TestProgram*> m_erroredPrograms; // while listing or running (counted once)
+
+        QTextStream m_out;
+        QTextStream m_err;
+};
+
+#endif // HEADLESSRUNNER_H
@@ -0,0 +1,892 @@
+#include "historystore.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testsuite.h"
+#include <QtConcurrentRun>
+#include <QtCore>
+#include <QtDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace Constants {
+    const quint32 HistoryMagic    = 0xEDC4B157;
+    const quint32 HistoryVersion  = 2;
+    const quint32 BlockMagic      = 0xEDC4B10C;
+    const int     FileHeaderSize  = 8;  // magic, version
+    const int     BlockHeaderSize = 16; // magic, header size, test columns size, benchmarks size
+
+    // version 1: benchmark values follow the test columns, compressed together
+    const quint32 OldHistoryVersion  = 1;
+    const int     OldBlockHeaderSize = 12;
+
+    // decoded columns kept for repeat queries (e.g. selecting tests in turn)
+    const int     ColumnCacheSize = 32 * 1024 * 1024; // bytes
+
+    const quint8  StatusMask      = 0x03;
+    const quint8  RegressionFlag  = 0x04;
+
+    // expired blocks are only dropped once they're at least this fraction of the
+    // file, so that a daily run doesn't rewrite the whole store every time
+    const qreal   CompactionThreshold = 0.10;
+
+    const qint64  MsecsPerDay = Q_INT64_C(24) * 60 * 60 * 1000;
+} // namespace Constants
+
+// -----------------------------------------------------
+// encoding helpers
+// -----------------------------------------------------
+
+static
+void writeVarint(QByteArray* out, quint64 value) {
+    while ( value >= 0x80 ) {
+        out->append( char((value & 0x7f) | 0x80) );
+        value >>= 7;
+    }
+    out->append( char(value) );
+}
+
+static
+void writeSignedVarint(QByteArray* out, qint64 value) {
+    writeVarint(out, (quint64(value) << 1) ^ quint64(value >> 63)); // zigzag
+}
+
+// -1 (unknown) is stored as 0
+static
+void writeTime(QByteArray* out, qint64 usecs) {
+    writeVarint(out, ( usecs < 0 ? 0 : quint64(usecs) + 1 ));
+}
+
+static
+void writeDouble(QByteArray* out, double value) {
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = qToLittleEndian(bits);
+    out->append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+}
+
+static
+void writeString(QByteArray* out, const QString& s) {
+    const QByteArray utf8 = s.toUtf8();
+    writeVarint(out, quint64(utf8.size()));
+    out->append(utf8);
+}
+
+static
+void writeUInt32(QByteArray* out, quint32 value) {
+    value = qToLittleEndian(value);
+    out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// bounds-checked reader for the above (sets ok to false on any overrun)
+struct ByteReader {
+
+    const char* p;
+    const char* end;
+    bool ok;
+
+    ByteReader(const QByteArray& data)
+        : p(data.constData())
+        , end(data.constData() + data.size())
+        , ok(true)
+    { }
+
+    quint64 varint(void) {
+        quint64 result = 0;
+        for ( int shift = 0; p < end && shift < 64; shift += 7 ) {
+            const uchar b = uchar(*p++);
+            result |= quint64(b & 0x7f) << shift;
+            if ( (b & 0x80) == 0 )
+                return result;
+        }
+        ok = false;
+        return 0;
+    }
+
+    qint64 signedVarint(void) {
+        const quint64 v = varint();
+        return qint64(v >> 1) ^ -qint64(v & 1);
+    }
+
+    qint64 time(void) {
+        return qint64(varint()) - 1;
+    }
+
+    double real(void) {
+        if ( end - p < 8 ) {
+            ok = false;
+            return 0.0;
+        }
+        quint64 bits;
+        memcpy(&bits, p, sizeof(bits));
+        p += sizeof(bits);
+        bits = qFromLittleEndian(bits);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    QString string(void) {
+        const quint64 size = varint();
+        if ( !ok || quint64(end - p) < size ) {
+            ok = false;
+            return QString();
+        }
+        const QString s = QString::fromUtf8(p, int(size));
+        p += size;
+        return s;
+    }
+
+    quint8 byte(void) {
+        if ( p >= end ) {
+            ok = false;
+            return 0;
+        }
+        return quint8(*p++);
+    }
+};
+
+static
+quint32 readUInt32(const char* data) {
+    quint32 value;
+    memcpy(&value, data, sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+// benchmark results are keyed by everything but their value & iteration count
+static
+QString benchmarkKey(const BenchmarkResult& result) {
+    return ( QStringList()
+           << result.dataTag
+           << BenchmarkResult::metricName(result.metric)
+           << result.counterName
+           << result.aggregate
+           << result.unit
+           ).join("\t");
+}
+
+static
+BenchmarkResult benchmarkFromKey(const QString& key, qint64 iterations, double value) {
+    const QStringList fields = key.split('\t');
+    BenchmarkResult result(BenchmarkResult::metricFromName(fields.value(1)), value, iterations, fields.value(0), fields.value(4));
+    result.counterName = fields.value(2);
+    result.aggregate   = fields.value(3);
+    return result;
+}
+
+// approximate size of decoded columns, for the cache
+static
+int columnsCost(int numTests, int numBenchmarks) {
+    return numTests * int(sizeof(qint32) + sizeof(quint8) + sizeof(qint64) + sizeof(qint32)) +
+           numBenchmarks * int(sizeof(qint32) + sizeof(qint64) + sizeof(double));
+}
+
+// per-test totals, for slowestTests() & recentTimes()
+struct TimeAccumulator {
+    qreal  totalTime;
+    qreal  maxTime;
+    int    runCount;
+    qint64 lastTimestamp;
+};
+
+// -----------------------------
+// HistoryStore implementation
+// -----------------------------
+
+HistoryStore::HistoryStore(void)
+    : m_retentionDays(365)
+    , m_validSize(0)
+    , m_isOldFormat(false)
+    , m_columnCache(Constants::ColumnCacheSize)
+    , m_isWriting(false)
+{ }
+
+HistoryStore::~HistoryStore(void) {
+    close();
+}
+
+bool HistoryStore::appendRecord(const RunRecord& record) {
+
+    Q_ASSERT_X(m_file.isOpen(), Q_FUNC_INFO, "history store not open");
+
+    // assign ids, noting any new names (which are stored in this block)
+    const int previousNameCount = m_names.size();
+    QStringList newNames;
+    const qint32 programId = idForName(record.programName, &newNames);
+
+    // build columns
+    QByteArray idColumn;
+    QByteArray statusColumn;
+    QByteArray timeColumn;
+    QByteArray benchmarkCountColumn;
+    QByteArray benchmarkColumn;
+    qint32 previousId = 0;
+    foreach ( const TestRecord& test, record.tests ) {
+        const qint32 testId = idForName(test.key, &newNames);
+        writeSignedVarint(&idColumn, testId - previousId);
+        previousId = testId;
+        statusColumn.append( char(test.status) );
+        writeTime(&timeColumn, test.timeUsecs);
+        writeVarint(&benchmarkCountColumn, quint64(test.benchmarks.size()));
+        foreach ( const BenchmarkRecord& bm, test.benchmarks ) {
+            writeVarint(&benchmarkColumn, quint64(idForName(bm.key, &newNames)));
+            writeSignedVarint(&benchmarkColumn, bm.iterations);
+            writeDouble(&benchmarkColumn, bm.value);
+        }
+    }
+    const QByteArray columns = qCompress(idColumn + statusColumn + timeColumn + benchmarkCountColumn);
+    const QByteArray benchmarkColumns = ( benchmarkColumn.isEmpty() ? QByteArray() : qCompress(benchmarkColumn) );
+
+    // build header
+    QByteArray header;
+    writeSignedVarint(&header, record.timestamp);
+    writeVarint(&header, quint64(programId));
+    writeTime(&header, record.timeUsecs);
+    writeVarint(&header, quint64(newNames.size()));
+    foreach ( const QString& name, newNames )
+        writeString(&header, name);
+    writeVarint(&header, quint64(record.tests.size()));
+
+    QByteArray block;
+    writeUInt32(&block, Constants::BlockMagic);
+    writeUInt32(&block, quint32(header.size()));
+    writeUInt32(&block, quint32(columns.size()));
+    writeUInt32(&block, quint32(benchmarkColumns.size()));
+    block.append(header);
+    block.append(columns);
+    block.append(benchmarkColumns);
+
+    // write block, dropping any partial block left by an earlier failure
+    bool ok = ( m_file.size() == m_validSize || m_file.resize(m_validSize) );
+    ok = ok && m_file.seek(m_validSize);
+    ok = ok && ( m_file.write(block) == block.size() );
+    ok = ok && m_file.flush();
+    if ( !ok ) {
+        qDebug() << "Could not write test history: " << m_file.errorString();
+
+        // forget names that didn't make it to disk
+        while ( m_names.size() > previousNameCount )
+            m_ids.remove( m_names.takeLast() );
+        return false;
+    }
+
+    // store block info
+    BlockInfo info;
+    info.columnsOffset = m_validSize + Constants::BlockHeaderSize + header.size();
+    info.columnsSize    = columns.size();
+    info.benchmarksSize = benchmarkColumns.size();
+    info.timestamp      = record.timestamp;
+    info.timeUsecs      = record.timeUsecs;
+    info.programId      = programId;
+    info.testCount      = record.tests.size();
+    m_blocksByProgram[programId].append(m_blocks.size());
+    m_blocks.append(info);
+    m_validSize += block.size();
+    return true;
+}
+
+bool HistoryStore::appendRun(const TestProgram* program, qint64 timestamp) {
+
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    if ( !isOpen() )
+        return false;
+
+    RunRecord record;
+    record.timestamp   = ( timestamp < 0 ? QDateTime::currentMSecsSinceEpoch() : timestamp );
+    record.programName = program->fileName();
+    record.timeUsecs   = ( program->hasTime() ? qRound64(program->time() * 1e6) : -1 );
+
+    // foreach test that was (supposed to be) run
+    const int numSuites = program->suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests; ++j ) {
+            TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            if ( !test->isEnabled() && !test->wasRun() )
+                continue;
+
+            TestRecord testRecord;
+            testRecord.key = suite->name() + '\t' + test->name();
+            testRecord.status = ( !test->wasRun() ? HistoryStore::NotRun
+                                                  : test->passed() ? HistoryStore::Passed
+                                                                   : HistoryStore::Failed );
+            if ( test->hasBenchmarkRegression() )
+                testRecord.status |= Constants::RegressionFlag;
+            testRecord.timeUsecs = ( test->hasTime() ? qRound64(test->time() * 1e6) : -1 );
+
+            const QList<BenchmarkResult> benchmarks = test->benchmarkResults();
+            foreach ( const BenchmarkResult& bm, benchmarks ) {
+                BenchmarkRecord bmRecord;
+                bmRecord.key        = benchmarkKey(bm);
+                bmRecord.iterations = bm.iterations;
+                bmRecord.value      = bm.value;
+                testRecord.benchmarks.append(bmRecord);
+            }
+
+            record.tests.append(testRecord);
+        }
+    }
+
+    // encode & write in the background (one writer at a time, keeps runs in order)
+    QMutexLocker locker(&m_pendingMutex);
+    m_pendingRuns.append(record);
+    if ( !m_isWriting ) {
+        m_isWriting = true;
+        m_writer = QtConcurrent::run(this, &HistoryStore::writePending);
+    }
+    return true;
+}
+
+void HistoryStore::close(void) {
+    waitForWrites();
+    m_file.close();
+    m_names.clear();
+    m_ids.clear();
+    m_blocks.clear();
+    m_blocksByProgram.clear();
+    m_validSize = 0;
+    m_isOldFormat = false;
+    m_columnCache.clear();
+}
+
+bool HistoryStore::columnsForBlock(int index, bool withBenchmarks, Columns* columns) const {
+
+    Q_ASSERT_X(index >= 0 && index < m_blocks.size(), Q_FUNC_INFO, "invalid block index");
+    Q_ASSERT_X(columns, Q_FUNC_INFO, "null columns");
+
+    // (copies are shallow)
+    const Columns* cached = m_columnCache.object(index);
+    if ( cached && ( cached->hasBenchmarkValues || !withBenchmarks ) ) {
+        *columns = *cached;
+        return true;
+    }
+
+    if ( !decodeColumns(m_blocks.at(index), withBenchmarks, columns) )
+        return false;
+    m_columnCache.insert(index, new Columns(*columns),
+                         columnsCost(columns->testIds.size(), columns->benchmarkValues.size()));
+    return true;
+}
+
+bool HistoryStore::compact(void) {
+
+    if ( !isOpen() )
+        return false;
+    waitForWrites();
+
+    const qint64 cutoff = ( m_retentionDays > 0
+                            ? QDateTime::currentMSecsSinceEpoch() - m_retentionDays * Constants::MsecsPerDay
+                            : Q_INT64_C(0) );
+
+    // copy unexpired runs to a new store, one at a time (its dictionary only gets names still in use)
+    const QString filename = m_filename;
+    const QString tempFilename = filename + ".tmp";
+    QFile::remove(tempFilename);
+    bool ok = true;
+    {
+        HistoryStore compacted;
+        compacted.setRetentionDays(0);
+        ok = compacted.open(tempFilename);
+
+        const int numBlocks = m_blocks.size();
+        for ( int i = 0; i < numBlocks && ok; ++i ) {
+            if ( m_blocks.at(i).timestamp < cutoff )
+                continue;
+
+            // skip any blocks we can't read, rather than lose the rest
+            RunRecord record;
+            if ( recordForBlock(i, &record) )
+                ok = compacted.appendRecord(record);
+        }
+    }
+
+    if ( !ok ) {
+        qDebug() << "Could not compact test history: " << filename;
+        QFile::remove(tempFilename);
+        return false;
+    }
+
+    // swap in compacted file
+    close();
+    QFile::remove(filename);
+    QFile::rename(tempFilename, filename);
+
+    // reopen (w/o re-applying retention, in case of clock changes)
+    const int retentionDays = m_retentionDays;
+    m_retentionDays = 0;
+    ok = open(filename);
+    m_retentionDays = retentionDays;
+    return ok;
+}
+
+bool HistoryStore::decodeColumns(const BlockInfo& block, bool withBenchmarks, Columns* columns) const {
+
+    Q_ASSERT_X(columns, Q_FUNC_INFO, "null columns");
+
+    // read & decompress test columns
+    if ( !m_file.seek(block.columnsOffset) )
+        return false;
+    const QByteArray data = qUncompress(m_file.read(block.columnsSize));
+    if ( data.isEmpty() && block.testCount > 0 )
+        return false;
+
+    ByteReader in(data);
+    const int numTests = block.testCount;
+    columns->testIds.resize(numTests);
+    columns->statuses.resize(numTests);
+    columns->timeUsecs.resize(numTests);
+    columns->benchmarkCounts.resize(numTests);
+
+    qint32 id = 0;
+    for ( int i = 0; i < numTests; ++i ) {
+        id += qint32(in.signedVarint());
+        columns->testIds[i] = id;
+    }
+    for ( int i = 0; i < numTests; ++i )
+        columns->statuses[i] = in.byte();
+    for ( int i = 0; i < numTests; ++i )
+        columns->timeUsecs[i] = in.time();
+
+    int numBenchmarks = 0;
+    for ( int i = 0; i < numTests; ++i ) {
+        columns->benchmarkCounts[i] = qint32(in.varint());
+        numBenchmarks += columns->benchmarkCounts[i];
+    }
+
+    // benchmark values, if asked for (old format blocks have them anyway)
+    columns->hasBenchmarkValues = ( withBenchmarks || block.benchmarksSize < 0 );
+    if ( !columns->hasBenchmarkValues )
+        numBenchmarks = 0;
+    QByteArray benchmarkData;
+    if ( numBenchmarks > 0 && block.benchmarksSize >= 0 && in.ok ) {
+        if ( !m_file.seek(block.columnsOffset + block.columnsSize) )
+            return false;
+        benchmarkData = qUncompress(m_file.read(block.benchmarksSize));
+        if ( benchmarkData.isEmpty() )
+            return false;
+        in = ByteReader(benchmarkData);
+    }
+
+    columns->benchmarkKeyIds.resize(numBenchmarks);
+    columns->benchmarkIterations.resize(numBenchmarks);
+    columns->benchmarkValues.resize(numBenchmarks);
+    for ( int i = 0; i < numBenchmarks && in.ok; ++i ) {
+        columns->benchmarkKeyIds[i]     = qint32(in.varint());
+        columns->benchmarkIterations[i] = in.signedVarint();
+        columns->benchmarkValues[i]     = in.real();
+    }
+
+    // make sure all ids are valid
+    if ( !in.ok )
+        return false;
+    foreach ( qint32 testId, columns->testIds ) {
+        if ( testId < 0 || testId >= m_names.size() )
+            return false;
+    }
+    foreach ( qint32 keyId, columns->benchmarkKeyIds ) {
+        if ( keyId < 0 || keyId >= m_names.size() )
+            return false;
+    }
+    return true;
+}
+
+QString HistoryStore::fileName(void) const {
+    return m_filename;
+}
+
+qint64 HistoryStore::fileSize(void) const {
+    waitForWrites();
+    return m_validSize;
+}
+
+qint32 HistoryStore::idForName(const QString& name, QStringList* newNames) {
+
+    QHash<QString, qint32>::const_iterator found = m_ids.constFind(name);
+    if ( found != m_ids.constEnd() )
+        return found.value();
+
+    const qint32 id = m_names.size();
+    m_names.append(name);
+    m_ids.insert(name, id);
+    newNames->append(name);
+    return id;
+}
+
+bool HistoryStore::isOpen(void) const {
+    return m_file.isOpen();
+}
+
+bool HistoryStore::load(void) {
+
+    const qint64 fileSize = m_file.size();
+
+    // new file, write header
+    if ( fileSize == 0 ) {
+        QByteArray header;
+        writeUInt32(&header, Constants::HistoryMagic);
+        writeUInt32(&header, Constants::HistoryVersion);
+        if ( m_file.write(header) != header.size() || !m_file.flush() )
+            return false;
+        m_validSize = header.size();
+        return true;
+    }
+
+    // check header
+    const QByteArray fileHeader = m_file.read(Constants::FileHeaderSize);
+    const quint32 version = ( fileHeader.size() == Constants::FileHeaderSize ? readUInt32(fileHeader.constData() + 4) : 0 );
+    if ( fileHeader.size() != Constants::FileHeaderSize ||
+         readUInt32(fileHeader.constData()) != Constants::HistoryMagic ||
+         ( version != Constants::HistoryVersion && version != Constants::OldHistoryVersion ) )
+    {
+        qDebug() << "Not a readable test history file: " << m_filename;
+        return false;
+    }
+    m_isOldFormat = ( version == Constants::OldHistoryVersion );
+    const int blockHeaderSize = ( m_isOldFormat ? Constants::OldBlockHeaderSize : Constants::BlockHeaderSize );
+
+    // read block headers, stopping at the first incomplete or invalid block
+    qint64 offset = Constants::FileHeaderSize;
+    while ( offset + blockHeaderSize <= fileSize ) {
+
+        if ( !m_file.seek(offset) )
+            break;
+        const QByteArray blockHeader = m_file.read(blockHeaderSize);
+        if ( blockHeader.size() != blockHeaderSize ||
+             readUInt32(blockHeader.constData()) != Constants::BlockMagic )
+            break;
+        const qint64 headerSize     = readUInt32(blockHeader.constData() + 4);
+        const qint64 columnsSize    = readUInt32(blockHeader.constData() + 8);
+        const qint64 benchmarksSize = ( m_isOldFormat ? 0 : readUInt32(blockHeader.constData() + 12) );
+        const qint64 blockEnd = offset + blockHeaderSize + headerSize + columnsSize + benchmarksSize;
+        if ( blockEnd > fileSize )
+            break;
+
+        // parse header
+        const QByteArray header = m_file.read(headerSize);
+        ByteReader in(header);
+        BlockInfo info;
+        info.timestamp = in.signedVarint();
+        info.programId = qint32(in.varint());
+        info.timeUsecs = in.time();
+        const quint64 numNewNames = in.varint();
+        QStringList newNames;
+        for ( quint64 i = 0; i < numNewNames && in.ok; ++i )
+            newNames.append(in.string());
+        info.testCount     = qint32(in.varint());
+        info.columnsOffset  = offset + blockHeaderSize + headerSize;
+        info.columnsSize    = qint32(columnsSize);
+        info.benchmarksSize = ( m_isOldFormat ? -1 : qint32(benchmarksSize) );
+        if ( !in.ok )
+            break;
+
+        // add names to dictionary
+        foreach ( const QString& name, newNames ) {
+            m_ids.insert(name, m_names.size());
+            m_names.append(name);
+        }
+        if ( info.programId < 0 || info.programId >= m_names.size() )
+            break;
+
+        m_blocksByProgram[info.programId].append(m_blocks.size());
+        m_blocks.append(info);
+        offset = blockEnd;
+    }
+
+    // anything after the last good block is overwritten by the next append
+    m_validSize = offset;
+    if ( m_validSize < fileSize )
+        qDebug() << "Ignoring incomplete test history data at end of " << m_filename;
+    return true;
+}
+
+bool HistoryStore::open(const QString& filename) {
+
+    close();
+    m_filename = filename;
+    m_file.setFileName(filename);
+    if ( !m_file.open(QFile::ReadWrite) ) {
+        qDebug() << "Could not open test history: " << m_file.errorString();
+        return false;
+    }
+
+    // read existing history
+    if ( !load() ) {
+        close();
+        return false;
+    }
+
+    // old format files are rewritten before anything is appended to them
+    if ( m_isOldFormat ) {
+        if ( compact() )
+            return true;
+        qDebug() << "Could not convert test history: " << filename;
+        close();
+        return false;
+    }
+
+    // apply retention policy, once enough runs have expired to be worth a rewrite
+    if ( m_retentionDays > 0 && !m_blocks.isEmpty() ) {
+        const qint64 cutoff = QDateTime::currentMSecsSinceEpoch() - m_retentionDays * Constants::MsecsPerDay;
+        int numExpired = 0;
+        foreach ( const BlockInfo& block, m_blocks ) {
+            if ( block.timestamp < cutoff )
+                ++numExpired;
+        }
+        if ( numExpired > 0 && numExpired >= m_blocks.size() * Constants::CompactionThreshold )
+            return compact();
+    }
+
+    return true;
+}
+
+QHash<QString, HistoryStore::ProgramTimes> HistoryStore::recentTimes(const QStringList& programNames,
+                                                                     int maxRuns) const
+{
+    waitForWrites();
+    QHash<QString, ProgramTimes> results;
+
+    // foreach program with history
+    foreach ( const QString& programName, programNames ) {
+        const QHash<qint32, QVector<int> >::const_iterator found = m_blocksByProgram.constFind( m_ids.value(programName, -1) );
+        if ( found == m_blocksByProgram.constEnd() )
+            continue;
+
+        // accumulate times from its latest runs
+        const QVector<int>& blocks = found.value();
+        TimeAccumulator programAccumulator = { 0.0, 0.0, 0, 0 };
+        QHash<qint32, TimeAccumulator> testAccumulators;
+        const int firstBlock = qMax(0, blocks.size() - maxRuns);
+        for ( int b = blocks.size() - 1; b >= firstBlock; --b ) {
+            const BlockInfo& block = m_blocks.at(blocks.at(b));
+            if ( block.timeUsecs >= 0 ) {
+                programAccumulator.totalTime += block.timeUsecs / 1e6;
+                programAccumulator.runCount  += 1;
+            }
+
+            Columns columns;
+            if ( !columnsForBlock(blocks.at(b), false, &columns) )
+                continue;
+
+            for ( int i = 0; i < block.testCount; ++i ) {
+                const qint64 usecs = columns.timeUsecs.at(i);
+                if ( usecs < 0 )
+                    continue;
+                TimeAccumulator& acc = testAccumulators[ columns.testIds.at(i) ];
+                acc.totalTime += usecs / 1e6;
+                acc.runCount  += 1;
+            }
+        }
+
+        // build result
+        if ( programAccumulator.runCount == 0 && testAccumulators.isEmpty() )
+            continue;
+        ProgramTimes& times = results[programName];
+        if ( programAccumulator.runCount > 0 )
+            times.programTime = programAccumulator.totalTime / programAccumulator.runCount;
+        QHash<qint32, TimeAccumulator>::const_iterator testIter = testAccumulators.constBegin();
+        QHash<qint32, TimeAccumulator>::const_iterator testEnd  = testAccumulators.constEnd();
+        for ( ; testIter != testEnd; ++testIter )
+            times.testTimes.insert( m_names.at(testIter.key()), testIter->totalTime / testIter->runCount );
+    }
+    return results;
+}
+
+bool HistoryStore::recordForBlock(int index, RunRecord* record) const {
+
+    Q_ASSERT_X(record, Q_FUNC_INFO, "null record");
+
+    // (not cached, this is a one-off pass over everything)
+    const BlockInfo& block = m_blocks.at(index);
+    Columns columns;
+    if ( !decodeColumns(block, true, &columns) )
+        return false;
+
+    record->timestamp   = block.timestamp;
+    record->programName = m_names.at(block.programId);
+    record->timeUsecs   = block.timeUsecs;
+    record->tests.clear();
+
+    int benchmarkIndex = 0;
+    for ( int i = 0; i < block.testCount; ++i ) {
+        TestRecord test;
+        test.key       = m_names.at(columns.testIds.at(i));
+        test.status    = columns.statuses.at(i);
+        test.timeUsecs = columns.timeUsecs.at(i);
+        for ( int j = 0; j < columns.benchmarkCounts.at(i); ++j, ++benchmarkIndex ) {
+            BenchmarkRecord bm;
+            bm.key        = m_names.at(columns.benchmarkKeyIds.at(benchmarkIndex));
+            bm.iterations = columns.benchmarkIterations.at(benchmarkIndex);
+            bm.value      = columns.benchmarkValues.at(benchmarkIndex);
+            test.benchmarks.append(bm);
+        }
+        record->tests.append(test);
+    }
+    return true;
+}
+
+int HistoryStore::retentionDays(void) const {
+    return m_retentionDays;
+}
+
+int HistoryStore::runCount(void) const {
+    waitForWrites();
+    return m_blocks.size();
+}
+
+void HistoryStore::setRetentionDays(int days) {
+    m_retentionDays = qMax(0, days);
+}
+
+QList<HistoryStore::TestTime> HistoryStore::slowestTests(int count, qint64 since) const {
+
+    waitForWrites();
+
+    // accumulate times for each (program, test) in range (times only, no benchmark values)
+    QHash<quint64, TimeAccumulator> accumulators;
+    const int numBlocks = m_blocks.size();
+    for ( int b = 0; b < numBlocks; ++b ) {
+        const BlockInfo& block = m_blocks.at(b);
+        if ( block.timestamp < since )
+            continue;
+
+        Columns columns;
+        if ( !columnsForBlock(b, false, &columns) )
+            continue;
+
+        for ( int i = 0; i < block.testCount; ++i ) {
+            const qint64 usecs = columns.timeUsecs.at(i);
+            if ( usecs < 0 )
+                continue;
+            const qreal time = usecs / 1e6;
+
+            const quint64 key = ( quint64(block.programId) << 32 ) | quint32(columns.testIds.at(i));
+            QHash<quint64, TimeAccumulator>::iterator found = accumulators.find(key);
+            if ( found == accumulators.end() ) {
+                TimeAccumulator acc = { time, time, 1, block.timestamp };
+                accumulators.insert(key, acc);
+            } else {
+                TimeAccumulator& acc = found.value();
+                acc.totalTime += time;
+                acc.maxTime = qMax(acc.maxTime, time);
+                acc.runCount += 1;
+                acc.lastTimestamp = qMax(acc.lastTimestamp, block.timestamp);
+            }
+        }
+    }
+
+    // rank by mean time
+    QVector< QPair<qreal, quint64> > ranking;
+    ranking.reserve(accumulators.size());
+    QHash<quint64, TimeAccumulator>::const_iterator accIter = accumulators.constBegin();
+    QHash<quint64, TimeAccumulator>::const_iterator accEnd  = accumulators.constEnd();
+    for ( ; accIter != accEnd; ++accIter )
+        ranking.append( qMakePair(-accIter->totalTime / accIter->runCount, accIter.key()) );
+    const int numResults = qMin(qMax(count, 0), ranking.size());
+    std::partial_sort(ranking.begin(), ranking.begin() + numResults, ranking.end());
+
+    // build results
+    QList<TestTime> results;
+    for ( int i = 0; i < numResults; ++i ) {
+        const quint64 key = ranking.at(i).second;
+        const TimeAccumulator& acc = accumulators[key];
+        const QString testKey = m_names.at( qint32(key & 0xffffffff) );
+        const int tab = testKey.indexOf('\t');
+
+        TestTime result;
+        result.programName   = m_names.at( qint32(key >> 32) );
+        result.suiteName     = testKey.left(tab);
+        result.testName      = testKey.mid(tab + 1);
+        result.meanTime      = acc.totalTime / acc.runCount;
+        result.maxTime       = acc.maxTime;
+        result.runCount      = acc.runCount;
+        result.lastTimestamp = acc.lastTimestamp;
+        results.append(result);
+    }
+    return results;
+}
+
+QList<HistoryStore::Sample> HistoryStore::testHistory(const QString& programName,
+                                                      const QString& suiteName,
+                                                      const QString& testName,
+                                                      qint64 since) const
+{
+    waitForWrites();
+    QList<Sample> samples;
+
+    // look up ids (if either is unknown, there's no history)
+    const qint32 programId = m_ids.value(programName, -1);
+    const qint32 testId    = m_ids.value(suiteName + '\t' + testName, -1);
+    if ( programId < 0 || testId < 0 )
+        return samples;
+
+    // foreach run of the program
+    // (tests are usually listed in the same order each run, so try the last row first)
+    const QVector<int> blocks = m_blocksByProgram.value(programId);
+    int row = 0;
+    foreach ( int b, blocks ) {
+        const BlockInfo& block = m_blocks.at(b);
+        if ( block.timestamp < since )
+            continue;
+
+        Columns columns;
+        if ( !columnsForBlock(b, false, &columns) )
+            continue;
+
+        // find test in run
+        if ( row >= block.testCount || columns.testIds.at(row) != testId ) {
+            row = columns.testIds.indexOf(testId);
+            if ( row < 0 ) {
+                row = 0;
+                continue;
+            }
+        }
+
+        Sample sample;
+        const quint8 status = columns.statuses.at(row);
+        const qint64 usecs  = columns.timeUsecs.at(row);
+        sample.timestamp = block.timestamp;
+        sample.time      = ( usecs < 0 ? -1.0 : usecs / 1e6 );
+        sample.status    = static_cast<Status>(status & Constants::StatusMask);
+        sample.hasBenchmarkRegression = ( (status & Constants::RegressionFlag) != 0 );
+
+        // benchmark values, only for tests that have them
+        const int numBenchmarks = columns.benchmarkCounts.at(row);
+        if ( numBenchmarks > 0 && columnsForBlock(b, true, &columns) ) {
+            int benchmarkIndex = 0;
+            for ( int i = 0; i < row; ++i )
+                benchmarkIndex += columns.benchmarkCounts.at(i);
+            for ( int j = 0; j < numBenchmarks; ++j, ++benchmarkIndex ) {
+                sample.benchmarks.append( benchmarkFromKey(m_names.at(columns.benchmarkKeyIds.at(benchmarkIndex)),
+                                                           columns.benchmarkIterations.at(benchmarkIndex),
+                                                           columns.benchmarkValues.at(benchmarkIndex)) );
+            }
+        }
+        samples.append(sample);
+    }
+
+    return samples;
+}
+
+void HistoryStore::waitForWrites(void) const {
+    m_writer.waitForFinished();
+}
+
+void HistoryStore::writePending(void) {
+
+    // until the queue is empty
+    forever {
+        RunRecord record;
+        {
+            QMutexLocker locker(&m_pendingMutex);
+            if ( m_pendingRuns.isEmpty() ) {
+                m_isWriting = false;
+                return;
+            }
+            record = m_pendingRuns.takeFirst();
+        }
+        appendRecord(record);
+    }
+}
@@ -0,0 +1,179 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include "benchmarkresult.h"
+#include <QByteArray>
+#include <QCache>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+class TestProgram;
+
+// append-only record of test results, for a single test directory
+//
+// each program run is appended as one block:
+//   - a small uncompressed header (timestamp, program, any names not seen before)
+//   - compressed test columns (test ids, statuses, durations, benchmark counts),
+//     with ids delta-encoded & numbers stored as varints
+//   - compressed benchmark values, separately (only decoded when asked for)
+//
+// names (programs, tests, benchmark keys) are stored once, in the block that
+// first uses them. Opening the store only reads block headers, & indexes them
+// by program; queries decode just the blocks (& columns) they need, keeping
+// recently decoded columns in a small cache. Blocks older than the retention
+// period are dropped by compact(), which also rebuilds the name dictionary.
+//
+// runs are written in the background, in the order they were appended;
+// queries wait for any pending writes, so they always see every appended run.
+class HistoryStore {
+
+    // query results
+    public:
+        enum Status { NotRun = 0
+                    , Passed
+                    , Failed
+                    };
+
+        struct Sample {
+            qint64 timestamp;   // msecs since epoch
+            qreal  time;        // seconds, -1 if unknown
+            Status status;
+            bool   hasBenchmarkRegression;
+            QList<BenchmarkResult> benchmarks;
+        };
+
+        struct TestTime {
+            QString programName; // full path
+            QString suiteName;
+            QString testName;
+            qreal   meanTime;    // seconds
+            qreal   maxTime;     // seconds
+            int     runCount;
+            qint64  lastTimestamp;
+        };
+
+        struct ProgramTimes {
+            qreal programTime;                // mean run time, seconds, -1 if unknown
+            QHash<QString, qreal> testTimes;  // mean time by 'suite\ttest', seconds
+
+            ProgramTimes(void) : programTime(-1.0) { }
+        };
+
+    // ctor & dtor
+    public:
+        HistoryStore(void);
+        ~HistoryStore(void);
+
+    // HistoryStore interface
+    public:
+
+        // file access (open() applies the retention policy)
+        bool open(const QString& filename);
+        void close(void);
+        bool isOpen(void) const;
+        QString fileName(void) const;
+        qint64 fileSize(void) const;
+
+        // retention settings
+        int retentionDays(void) const;          // default: 365, 0 = keep everything
+        void setRetentionDays(int days);
+
+        // record a program's latest results (written in the background)
+        bool appendRun(const TestProgram* program, qint64 timestamp = -1);
+
+        // queries
+        int runCount(void) const;
+        QList<Sample> testHistory(const QString& programName,
+                                  const QString& suiteName,
+                                  const QString& testName,
+                                  qint64 since = 0) const;
+        QList<TestTime> slowestTests(int count, qint64 since = 0) const;
+
+        // mean times over each program's most recent runs (by full path, programs
+        // without history are left out)
+        QHash<QString, ProgramTimes> recentTimes(const QStringList& programNames, int maxRuns = 3) const;
+
+        // drop expired runs & unused names, rewriting the file
+        bool compact(void);
+
+    // internal types & methods
+    private:
+        struct BlockInfo {
+            qint64 columnsOffset;
+            qint32 columnsSize;
+            qint32 benchmarksSize; // follow test columns, -1 if within them (old format)
+            qint64 timestamp;
+            qint64 timeUsecs;   // program run time, -1 if unknown
+            qint32 programId;
+            qint32 testCount;
+        };
+
+        struct BenchmarkRecord {
+            QString key;
+            qint64  iterations;
+            double  value;
+        };
+
+        struct TestRecord {
+            QString key;        // "suite\ttest"
+            quint8  status;     // Status, w/ regression flag
+            qint64  timeUsecs;  // -1 if unknown
+            QList<BenchmarkRecord> benchmarks;
+        };
+
+        struct RunRecord {
+            qint64  timestamp;
+            QString programName;
+            qint64  timeUsecs;
+            QList<TestRecord> tests;
+        };
+
+        struct Columns {
+            QVector<qint32> testIds;
+            QVector<quint8> statuses;
+            QVector<qint64> timeUsecs;
+            QVector<qint32> benchmarkCounts;
+            bool hasBenchmarkValues; // whether the below were decoded
+            QVector<qint32> benchmarkKeyIds;
+            QVector<qint64> benchmarkIterations;
+            QVector<double> benchmarkValues;
+        };
+
+        bool appendRecord(const RunRecord& record);
+        bool columnsForBlock(int index, bool withBenchmarks, Columns* columns) const;
+        bool decodeColumns(const BlockInfo& block, bool withBenchmarks, Columns* columns) const;
+        qint32 idForName(const QString& name, QStringList* newNames);
+        bool load(void);
+        bool recordForBlock(int index, RunRecord* record) const;
+        void waitForWrites(void) const;
+        void writePending(void); // worker thread
+
+    // data members
+    private:
+        QString m_filename;
+        mutable QFile m_file;
+        int m_retentionDays;
+
+        QStringList m_names;            // dictionary, by id
+        QHash<QString, qint32> m_ids;
+
+        QVector<BlockInfo> m_blocks;    // in file (& time) order
+        QHash<qint32, QVector<int> > m_blocksByProgram; // block indexes, by program id
+        qint64 m_validSize;             // end of last complete block
+        bool   m_isOldFormat;           // converted on open()
+
+        mutable QCache<int, Columns> m_columnCache; // by block index
+
+        // background writes
+        QMutex m_pendingMutex;
+        QList<RunRecord> m_pendingRuns;
+        bool m_isWriting;
+        mutable QFuture<void> m_writer;
+};
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,282 @@
+#include "jsonreader.h"
+#include <QtCore>
+#include <QtDebug>
+#if QT_VERSION >= 0x050000
+#  include <QJsonDocument>
+#endif
+
+#if QT_VERSION < 0x050000
+
+namespace Constants {
+    enum { MaxNestingDepth = 512 };
+} // namespace Constants
+
+// -----------------------------------------------------
+// recursive-descent JSON parser (RFC 7159), for Qt4
+// -----------------------------------------------------
+
+class JsonParser {
+
+    public:
+        JsonParser(const QByteArray& data)
+            : m_data(data)
+            , m_pos(0)
+        { }
+
+        bool parse(QVariant* value, QString* error) {
+            bool ok = parseValue(value, 0);
+            if ( ok ) {
+                skipWhitespace();
+                if ( !atEnd() )
+                    ok = setError("unexpected trailing data");
+            }
+            if ( !ok && error )
+                *error = QString("%1 at offset %2").arg(m_error).arg(m_pos);
+            return ok;
+        }
+
+    private:
+
+        bool atEnd(void) const { return m_pos >= m_data.size(); }
+        char peek(void) const { return ( atEnd() ? '\0' : m_data.at(m_pos) ); }
+
+        bool setError(const QString& error) {
+            m_error = error;
+            return false;
+        }
+
+        void skipWhitespace(void) {
+            while ( !atEnd() ) {
+                const char c = m_data.at(m_pos);
+                if ( c != ' ' && c != '\t' && c != '\n' && c != '\r' )
+                    break;
+                ++m_pos;
+            }
+        }
+
+        bool parseValue(QVariant* value, int depth) {
+
+            if ( depth > Constants::MaxNestingDepth )
+                return setError("nesting too deep");
+
+            skipWhitespace();
+            const char c = peek();
+            if ( c == '{' ) return parseObject(value, depth);
+            if ( c == '[' ) return parseArray(value, depth);
+            if ( c == '"' ) {
+                QString s;
+                if ( !parseString(&s) )
+                    return false;
+                *value = s;
+                return true;
+            }
+            if ( c == '-' || (c >= '0' && c <= '9') ) return parseNumber(value);
+            if ( parseLiteral("true") )  { *value = true;  return true; }
+            if ( parseLiteral("false") ) { *value = false; return true; }
+            if ( parseLiteral("null") )  { *value = QVariant(); return true; }
+            return setError("unexpected character");
+        }
+
+        bool parseLiteral(const char* literal) {
+            const int length = qstrlen(literal);
+            if ( m_data.mid(m_pos, length) != literal )
+                return false;
+            m_pos += length;
+            return true;
+        }
+
+        bool parseObject(QVariant* value, int depth) {
+
+            ++m_pos; // '{'
+            QVariantMap map;
+
+            skipWhitespace();
+            if ( peek() == '}' ) {
+                ++m_pos;
+                *value = map;
+                return true;
+            }
+
+            forever {
+                // "key"
+                skipWhitespace();
+                if ( peek() != '"' )
+                    return setError("expected object key");
+                QString key;
+                if ( !parseString(&key) )
+                    return false;
+
+                // :
+                skipWhitespace();
+                if ( peek() != ':' )
+                    return setError("expected ':'");
+                ++m_pos;
+
+                // value
+                QVariant member;
+                if ( !parseValue(&member, depth+1) )
+                    return false;
+                map.insert(key, member);
+
+                // , or }
+                skipWhitespace();
+                const char c = peek();
+                ++m_pos;
+                if ( c == '}' )
+                    break;
+                if ( c != ',' ) {
+                    --m_pos;
+                    return setError("expected ',' or '}'");
+                }
+            }
+
+            *value = map;
+            return true;
+        }
+
+        bool parseArray(QVariant* value, int depth) {
+
+            ++m_pos; // '['
+            QVariantList list;
+
+            skipWhitespace();
+            if ( peek() == ']' ) {
+                ++m_pos;
+                *value = list;
+                return true;
+            }
+
+            forever {
+                QVariant element;
+                if ( !parseValue(&element, depth+1) )
+                    return false;
+                list.append(element);
+
+                // , or ]
+                skipWhitespace();
+                const char c = peek();
+                ++m_pos;
+                if ( c == ']' )
+                    break;
+                if ( c != ',' ) {
+                    --m_pos;
+                    return setError("expected ',' or ']'");
+                }
+            }
+
+            *value = list;
+            return true;
+        }
+
+        bool parseNumber(QVariant* value) {
+            const int start = m_pos;
+            while ( !atEnd() ) {
+                const char c = m_data.at(m_pos);
+                if ( (c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E' )
+                    break;
+                ++m_pos;
+            }
+            bool ok = false;
+            const double d = m_data.mid(start, m_pos - start).toDouble(&ok);
+            if ( !ok ) {
+                m_pos = start;
+                return setError("invalid number");
+            }
+            *value = d;
+            return true;
+        }
+
+        bool parseHex4(ushort* code) {
+            if ( m_pos + 4 > m_data.size() )
+                return setError("truncated escape");
+            bool ok = false;
+            *code = m_data.mid(m_pos, 4).toUShort(&ok, 16);
+            if ( !ok )
+                return setError("invalid escape");
+            m_pos += 4;
+            return true;
+        }
+
+        bool parseString(QString* s) {
+
+            ++m_pos; // '"'
+            int runStart = m_pos;
+
+            while ( !atEnd() ) {
+                const char c = m_data.at(m_pos);
+
+                // end of string
+                if ( c == '"' ) {
+                    s->append( QString::fromUtf8(m_data.constData() + runStart, m_pos - runStart) );
+                    ++m_pos;
+                    return true;
+                }
+
+                // plain (UTF-8) characters are copied in runs
+                if ( c != '\\' ) {
+                    ++m_pos;
+                    continue;
+                }
+
+                // escape sequence
+                s->append( QString::fromUtf8(m_data.constData() + runStart, m_pos - runStart) );
+                ++m_pos;
+                if ( atEnd() )
+                    break;
+                const char e = m_data.at(m_pos++);
+                switch ( e ) {
+                    case '"'  : s->append(QChar('"'));  break;
+                    case '\\' : s->append(QChar('\\')); break;
+                    case '/'  : s->append(QChar('/'));  break;
+                    case 'b'  : s->append(QChar('\b')); break;
+                    case 'f'  : s->append(QChar('\f')); break;
+                    case 'n'  : s->append(QChar('\n')); break;
+                    case 'r'  : s->append(QChar('\r')); break;
+                    case 't'  : s->append(QChar('\t')); break;
+                    case 'u'  : {
+                        ushort code;
+                        if ( !parseHex4(&code) )
+                            return false;
+                        s->append(QChar(code)); // surrogate pairs come through as two escapes
+                        break;
+                    }
+                    default:
+                        return setError("invalid escape");
+                }
+                runStart = m_pos;
+            }
+
+            return setError("unterminated string");
+        }
+
+    private:
+        const QByteArray& m_data;
+        int m_pos;
+        QString m_error;
+};
+
+#endif // QT_VERSION < 0x050000
+
+// ---------------------------
+// JsonReader implementation
+// ---------------------------
+
+QVariant JsonReader::parse(const QByteArray& json, QString* error) {
+
+#if QT_VERSION >= 0x050000
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if ( parseError.error != QJsonParseError::NoError ) {
+        if ( error )
+            *error = QString("%1 at offset %2").arg(parseError.errorString()).arg(parseError.offset);
+        return QVariant();
+    }
+    return doc.toVariant();
+#else
+    QVariant value;
+    JsonParser parser(json);
+    if ( !parser.parse(&value, error) )
+        return QVariant();
+    return value;
+#endif
+}
@@ -0,0 +1,15 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+
+// parses a JSON document into QVariant(Map|List), QString, double, bool, or null
+// (uses QJsonDocument in Qt5, a small built-in parser in Qt4)
+class JsonReader {
+    public:
+        static QVariant parse(const QByteArray& json, QString* error);
+};
+
+#endif // JSONREADER_H
@@ -0,0 +1,47 @@
+#include "jsonwriter.h"
+#include <QtCore>
+#include <QtDebug>
+
+// ---------------------------
+// JsonWriter implementation
+// ---------------------------
+
+QString JsonWriter::boolean(bool value) {
+    return ( value ? "true" : "false" );
+}
+
+QString JsonWriter::number(double value) {
+    if ( qIsNaN(value) || qIsInf(value) )
+        return "null";
+    return QString::number(value, 'g', 12);
+}
+
+QString JsonWriter::string(const QString& text) {
+    QString result;
+    result.reserve(text.size() + 2);
+    result.append('"');
+    foreach ( const QChar& c, text ) {
+        switch ( c.unicode() ) {
+            case '"'  : result.append("\\\""); break;
+            case '\\' : result.append("\\\\"); break;
+            case '\n' : result.append("\\n");  break;
+            case '\r' : result.append("\\r");  break;
+            case '\t' : result.append("\\t");  break;
+            default:
+                if ( c.unicode() < 0x20 )
+                    result.append( QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0')) );
+                else
+                    result.append(c);
+                break;
+        }
+    }
+    result.append('"');
+    return result;
+}
+
+QString JsonWriter::stringList(const QStringList& list) {
+    QStringList items;
+    foreach ( const QString& s, list )
+        items.append( string(s) );
+    return QString("[%1]").arg(items.join(","));
+}
@@ -0,0 +1,17 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QString>
+#include <QStringList>
+
+// formats JSON values, for output that's written piece by piece
+// (streamed files, event messages) rather than built as a document
+class JsonWriter {
+    public:
+        static QString string(const QString& text);          // quoted & escaped
+        static QString stringList(const QStringList& list);  // array of strings
+        static QString number(double value);                 // 'null' if NaN or infinite
+        static QString boolean(bool value);
+};
+
+#endif // JSONWRITER_H
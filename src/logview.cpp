@@ -0,0 +1,469 @@
+#include "logview.h"
+#include <QtGui>
+#include <QtDebug>
+#include <cstring>
+
+namespace Constants {
+
+    const int Margin   = 4; // pixels, left of text
+    const int TabWidth = 8; // spaces
+
+    // longest part of a line that's painted (search & copy use the whole line)
+    const qint64 MaxLineBytesShown = 16 * 1024;
+
+    // background of current search match
+    const char* const MatchColor = "#ffff66";
+
+} // namespace Constants
+
+// returns text with tabs expanded to spaces
+static
+QString expandTabs(const QString& text) {
+    if ( !text.contains('\t') )
+        return text;
+    QString result;
+    result.reserve(text.size() + Constants::TabWidth);
+    foreach ( const QChar& c, text ) {
+        if ( c == '\t' )
+            result.append( QString(Constants::TabWidth - (result.size() % Constants::TabWidth), ' ') );
+        else
+            result.append(c);
+    }
+    return result;
+}
+
+// adds start of each line in data (offset by base) to lineStarts, returns longest line's size
+//
+// a line starts at data's start & after every newline, except a final one
+static
+qint64 indexLines(const char* data, qint64 size, qint64 base, QVector<qint64>* lineStarts) {
+
+    Q_ASSERT_X(lineStarts, Q_FUNC_INFO, "null line starts");
+    if ( data == 0 || size <= 0 )
+        return 0;
+
+    qint64 longest = 0;
+    const char* lineStart = data;
+    const char* end = data + size;
+    lineStarts->append(base);
+    while ( lineStart < end ) {
+        const char* newline = static_cast<const char*>( std::memchr(lineStart, '\n', end - lineStart) );
+        const char* lineEnd = ( newline ? newline : end );
+        longest = qMax(longest, qint64(lineEnd - lineStart));
+        if ( newline == 0 || newline + 1 == end )
+            break;
+        lineStart = newline + 1;
+        lineStarts->append( base + (lineStart - data) );
+    }
+    return longest;
+}
+
+// ----------------------------
+// LogView::Chunk implementation
+// ----------------------------
+
+LogView::Chunk::Chunk(void)
+    : source(0)
+    , isLocal8Bit(false)
+    , firstLine(0)
+{ }
+
+LogView::Chunk::~Chunk(void) {
+    delete source;
+}
+
+qint64 LogView::Chunk::size(void) const {
+    return ( source ? source->size() : qint64(bytes.size()) );
+}
+
+// ----------------------------
+// LogView implementation
+// ----------------------------
+
+LogView::LogView(QWidget* parent)
+    : QAbstractScrollArea(parent)
+    , m_lineCount(0)
+    , m_maxLineLength(0)
+    , m_selectionAnchor(-1)
+    , m_selectionEnd(-1)
+    , m_matchLine(-1)
+    , m_matchColumn(0)
+    , m_matchLength(0)
+{
+    // logs line up better in a fixed-width font
+    QFont logFont("Monospace");
+    logFont.setStyleHint(QFont::TypeWriter);
+    setFont(logFont);
+
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setBackgroundRole(QPalette::Base);
+    viewport()->setAutoFillBackground(true);
+    verticalScrollBar()->setSingleStep(1);
+}
+
+LogView::~LogView(void) {
+    qDeleteAll(m_chunks);
+}
+
+void LogView::appendChunk(Chunk* chunk) {
+
+    Q_ASSERT_X(chunk, Q_FUNC_INFO, "null chunk");
+
+    // index chunk's lines (a source's bytes are read in place)
+    chunk->firstLine = m_lineCount;
+    const QByteArray bytes = ( chunk->source ? chunk->source->read(0, chunk->source->size())
+                                             : chunk->bytes );
+    const qint64 longest = indexLines(bytes.constData(), bytes.size(), 0, &chunk->lineStarts);
+    m_maxLineLength = qMax(m_maxLineLength, longest);
+    if ( chunk->lineStarts.isEmpty() ) {
+        delete chunk;
+        return;
+    }
+
+    m_chunks.append(chunk);
+    m_lineCount += chunk->lineStarts.size();
+    updateScrollBars();
+    viewport()->update();
+}
+
+void LogView::appendLine(const QString& text) {
+
+    QByteArray bytes = text.toUtf8();
+    bytes.append('\n');
+
+    // add to our own (UTF-8) text, if that's what we have last
+    Chunk* last = ( m_chunks.isEmpty() ? 0 : m_chunks.last() );
+    if ( last && last->source == 0 && !last->isLocal8Bit ) {
+        const qint64 base = last->bytes.size();
+        last->bytes.append(bytes);
+        const qint64 longest = indexLines(bytes.constData(), bytes.size(), base, &last->lineStarts);
+        m_maxLineLength = qMax(m_maxLineLength, longest);
+        m_lineCount = last->firstLine + last->lineStarts.size();
+        updateScrollBars();
+        viewport()->update();
+        return;
+    }
+
+    // otherwise start a new chunk
+    Chunk* chunk = new Chunk;
+    chunk->bytes = bytes;
+    appendChunk(chunk);
+}
+
+void LogView::appendLocal8Bit(const QByteArray& text) {
+
+    if ( text.isEmpty() )
+        return;
+
+    // deep copy (text may be a view into someone else's memory)
+    Chunk* chunk = new Chunk;
+    chunk->bytes = QByteArray(text.constData(), text.size());
+    chunk->isLocal8Bit = true;
+    appendChunk(chunk);
+}
+
+void LogView::appendSource(Source* source) {
+
+    Q_ASSERT_X(source, Q_FUNC_INFO, "null source");
+    if ( source == 0 )
+        return;
+
+    Chunk* chunk = new Chunk;
+    chunk->source = source;
+    chunk->isLocal8Bit = true;
+    appendChunk(chunk);
+}
+
+int LogView::chunkForLine(int index) const {
+
+    // last chunk starting at or before line
+    int low  = 0;
+    int high = m_chunks.size() - 1;
+    while ( low < high ) {
+        const int middle = (low + high + 1) / 2;
+        if ( m_chunks.at(middle)->firstLine <= index )
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+void LogView::clear(void) {
+    qDeleteAll(m_chunks);
+    m_chunks.clear();
+    m_lineCount = 0;
+    m_maxLineLength = 0;
+    m_selectionAnchor = -1;
+    m_selectionEnd = -1;
+    m_matchLine = -1;
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    viewport()->update();
+}
+
+void LogView::clearFind(void) {
+    m_matchLine = -1;
+    m_matchColumn = 0;
+    m_matchLength = 0;
+    viewport()->update();
+}
+
+bool LogView::find(const QString& text, bool backward) {
+
+    if ( text.isEmpty() || m_lineCount == 0 ) {
+        clearFind();
+        return false;
+    }
+
+    // search from current match (or from the start/end), wrapping around once
+    const bool hasMatch = ( m_matchLine >= 0 && m_matchLine < m_lineCount );
+    const int startLine = ( hasMatch ? m_matchLine : (backward ? m_lineCount - 1 : 0) );
+    const int from = ( backward ? m_matchColumn - 1 : m_matchColumn + 1 );
+    for ( int n = 0; n <= m_lineCount; ++n ) {
+        const int index = ( backward ? (startLine - n % m_lineCount + m_lineCount) % m_lineCount
+                                     : (startLine + n) % m_lineCount );
+        const QString lineString = line(index);
+
+        int column = -1;
+        if ( n == 0 && hasMatch ) {
+            if ( backward )
+                column = ( from >= 0 ? lineString.lastIndexOf(text, from, Qt::CaseInsensitive) : -1 );
+            else
+                column = lineString.indexOf(text, from, Qt::CaseInsensitive);
+        } else {
+            column = ( backward ? lineString.lastIndexOf(text, -1, Qt::CaseInsensitive)
+                                : lineString.indexOf(text, 0, Qt::CaseInsensitive) );
+        }
+        if ( column < 0 )
+            continue;
+
+        // found: show it
+        m_matchLine   = index;
+        m_matchColumn = column;
+        m_matchLength = text.size();
+
+        const int numVisible = visibleLineCount();
+        if ( index < firstVisibleLine() || index >= firstVisibleLine() + numVisible )
+            scrollToLine( index - numVisible / 2 );
+
+        const int matchX = fontMetrics().width( expandTabs(lineString.left(column)) );
+        const int scrollX = horizontalScrollBar()->value();
+        if ( matchX < scrollX || matchX > scrollX + viewport()->width() - 2 * Constants::Margin )
+            horizontalScrollBar()->setValue( matchX - viewport()->width() / 3 );
+
+        viewport()->update();
+        return true;
+    }
+
+    clearFind();
+    return false;
+}
+
+int LogView::firstVisibleLine(void) const {
+    return verticalScrollBar()->value();
+}
+
+void LogView::keyPressEvent(QKeyEvent* event) {
+
+    if ( event->matches(QKeySequence::Copy) ) {
+        const QString text = selectedText();
+        if ( !text.isEmpty() )
+            QApplication::clipboard()->setText(text);
+        return;
+    }
+
+    if ( event->matches(QKeySequence::SelectAll) ) {
+        m_selectionAnchor = ( m_lineCount > 0 ? 0 : -1 );
+        m_selectionEnd    = m_lineCount - 1;
+        viewport()->update();
+        return;
+    }
+
+    switch ( event->key() ) {
+        case Qt::Key_Home : verticalScrollBar()->setValue( verticalScrollBar()->minimum() ); return;
+        case Qt::Key_End  : verticalScrollBar()->setValue( verticalScrollBar()->maximum() ); return;
+        default:
+            QAbstractScrollArea::keyPressEvent(event);
+            return;
+    }
+}
+
+QString LogView::line(int index) const {
+    return lineText(index, -1);
+}
+
+int LogView::lineAt(const QPoint& pos) const {
+    if ( m_lineCount == 0 )
+        return -1;
+    const int index = firstVisibleLine() + pos.y() / lineHeight();
+    return qBound(0, index, m_lineCount - 1);
+}
+
+int LogView::lineCount(void) const {
+    return m_lineCount;
+}
+
+int LogView::lineHeight(void) const {
+    return qMax(1, fontMetrics().lineSpacing());
+}
+
+QString LogView::lineText(int index, qint64 maxSize) const {
+
+    if ( index < 0 || index >= m_lineCount )
+        return QString();
+
+    // find line's bytes
+    const Chunk* chunk = m_chunks.at( chunkForLine(index) );
+    const int lineIndex = index - chunk->firstLine;
+    const qint64 start = chunk->lineStarts.at(lineIndex);
+    const qint64 end   = ( lineIndex + 1 < chunk->lineStarts.size() ? chunk->lineStarts.at(lineIndex + 1)
+                                                                    : chunk->size() );
+    qint64 size = end - start;
+    const bool isTruncated = ( maxSize >= 0 && size > maxSize );
+    if ( isTruncated )
+        size = maxSize;
+
+    QByteArray bytes = ( chunk->source ? chunk->source->read(start, size)
+                                       : chunk->bytes.mid(int(start), int(size)) );
+
+    // drop line ending
+    if ( !isTruncated ) {
+        if ( bytes.endsWith('\n') )
+            bytes.chop(1);
+        if ( bytes.endsWith('\r') )
+            bytes.chop(1);
+    }
+
+    return ( chunk->isLocal8Bit ? QString::fromLocal8Bit(bytes.constData(), bytes.size())
+                                : QString::fromUtf8(bytes.constData(), bytes.size()) );
+}
+
+void LogView::mouseDoubleClickEvent(QMouseEvent* event) {
+    const int index = lineAt(event->pos());
+    if ( index >= 0 )
+        emit lineActivated(index);
+}
+
+void LogView::mouseMoveEvent(QMouseEvent* event) {
+
+    if ( !(event->buttons() & Qt::LeftButton) || m_selectionAnchor < 0 )
+        return;
+
+    // scroll while dragging past top or bottom
+    if ( event->pos().y() < 0 )
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    else if ( event->pos().y() > viewport()->height() )
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+
+    m_selectionEnd = lineAt(event->pos());
+    viewport()->update();
+}
+
+void LogView::mousePressEvent(QMouseEvent* event) {
+
+    if ( event->button() != Qt::LeftButton )
+        return;
+
+    // select clicked line (or extend selection to it)
+    const int index = lineAt(event->pos());
+    if ( (event->modifiers() & Qt::ShiftModifier) && m_selectionAnchor >= 0 )
+        m_selectionEnd = index;
+    else {
+        m_selectionAnchor = index;
+        m_selectionEnd    = index;
+    }
+    viewport()->update();
+}
+
+void LogView::paintEvent(QPaintEvent* event) {
+
+    Q_UNUSED(event);
+
+    QPainter painter(viewport());
+    const QFontMetrics metrics = fontMetrics();
+    const QColor textColor         = palette().color(QPalette::Text);
+    const QColor selectedTextColor = palette().color(QPalette::HighlightedText);
+    const int height = lineHeight();
+    const int width  = viewport()->width();
+    const int x = Constants::Margin - horizontalScrollBar()->value();
+
+    const int selectionFirst = qMin(m_selectionAnchor, m_selectionEnd);
+    const int selectionLast  = qMax(m_selectionAnchor, m_selectionEnd);
+
+    // only lines on screen
+    const int first = firstVisibleLine();
+    const int last  = qMin(m_lineCount, first + visibleLineCount() + 1);
+    for ( int i = first; i < last; ++i ) {
+        const int y = (i - first) * height;
+        const QString text = lineText(i, Constants::MaxLineBytesShown);
+
+        const bool isSelected = ( m_selectionAnchor >= 0 && i >= selectionFirst && i <= selectionLast );
+        if ( isSelected )
+            painter.fillRect(QRect(0, y, width, height), palette().highlight());
+
+        if ( i == m_matchLine ) {
+            const int matchX     = metrics.width( expandTabs(text.left(m_matchColumn)) );
+            const int matchWidth = metrics.width( expandTabs(text.left(m_matchColumn + m_matchLength)) ) - matchX;
+            painter.fillRect(QRect(x + matchX, y, matchWidth, height), QColor(Constants::MatchColor));
+        }
+
+        painter.setPen( isSelected ? selectedTextColor : textColor );
+        painter.drawText(x, y + metrics.ascent(), expandTabs(text));
+    }
+}
+
+void LogView::resizeEvent(QResizeEvent* event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LogView::scrollContentsBy(int dx, int dy) {
+
+    // vertical scrolling is by line, so just repaint
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    viewport()->update();
+}
+
+void LogView::scrollToLine(int index) {
+    verticalScrollBar()->setValue(index);
+}
+
+QString LogView::selectedText(void) const {
+
+    if ( m_selectionAnchor < 0 )
+        return QString();
+
+    QStringList lines;
+    const int last = qMin( qMax(m_selectionAnchor, m_selectionEnd), m_lineCount - 1 );
+    for ( int i = qMin(m_selectionAnchor, m_selectionEnd); i <= last; ++i )
+        lines.append( line(i) );
+    return lines.join("\n");
+}
+
+void LogView::setPlainText(const QString& text) {
+    clear();
+    appendLine(text);
+}
+
+void LogView::updateScrollBars(void) {
+
+    // vertical: by line
+    const int numVisible = visibleLineCount();
+    verticalScrollBar()->setRange(0, qMax(0, m_lineCount - numVisible));
+    verticalScrollBar()->setPageStep(numVisible);
+
+    // horizontal: by pixel, up to longest line (estimated, decoding them all would defeat the purpose)
+    const qint64 longest = qMin(m_maxLineLength, Constants::MaxLineBytesShown);
+    const qint64 contentWidth = longest * fontMetrics().width('x') + 2 * Constants::Margin;
+    const int viewWidth = viewport()->width();
+    horizontalScrollBar()->setRange(0, int(qMax(qint64(0), contentWidth - viewWidth)));
+    horizontalScrollBar()->setPageStep(viewWidth);
+    horizontalScrollBar()->setSingleStep( fontMetrics().width('x') );
+}
+
+int LogView::visibleLineCount(void) const {
+    return qMax(1, viewport()->height() / lineHeight());
+}
@@ -0,0 +1,116 @@
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+class QKeyEvent;
+class QMouseEvent;
+class QPaintEvent;
+class QResizeEvent;
+
+// read-only, line-based text viewer for (very) large logs
+//
+// text is kept as bytes, with an index of where each line starts. Only the
+// lines currently on screen are decoded & painted, so showing 1 line or a
+// million costs about the same. Text can be appended from strings (copied),
+// or from a Source, which is read in place (e.g. a memory-mapped output log).
+//
+// supports line selection (click/drag, shift+click, Ctrl+A) & copy, and
+// case-insensitive search.
+class LogView : public QAbstractScrollArea {
+
+    Q_OBJECT
+
+    // bytes shown without copying them
+    public:
+        class Source {
+            public:
+                virtual ~Source(void) { }
+                virtual qint64 size(void) const =0;
+
+                // may return a view into someone else's memory, only valid
+                // until the next read()
+                virtual QByteArray read(qint64 offset, qint64 size) const =0;
+        };
+
+    // ctor & dtor
+    public:
+        explicit LogView(QWidget* parent = 0);
+        ~LogView(void);
+
+    // signals
+    signals:
+        void lineActivated(int index); // double-clicked
+
+    // LogView interface
+    public:
+
+        // contents
+        void clear(void);
+        void setPlainText(const QString& text);
+        void appendLine(const QString& text);      // (text may hold several lines)
+        void appendLocal8Bit(const QByteArray& text);
+        void appendSource(Source* source);         // takes ownership, local 8-bit text
+        int lineCount(void) const;
+        QString line(int index) const;
+        QString selectedText(void) const;
+
+        // scrolling
+        int firstVisibleLine(void) const;
+        void scrollToLine(int index);
+
+        // search (case-insensitive) after (or before) the current match, wrapping around
+        bool find(const QString& text, bool backward = false);
+        void clearFind(void);
+
+    // QAbstractScrollArea interface
+    protected:
+        void keyPressEvent(QKeyEvent* event);
+        void mouseDoubleClickEvent(QMouseEvent* event);
+        void mouseMoveEvent(QMouseEvent* event);
+        void mousePressEvent(QMouseEvent* event);
+        void paintEvent(QPaintEvent* event);
+        void resizeEvent(QResizeEvent* event);
+        void scrollContentsBy(int dx, int dy);
+
+    // internal methods
+    private:
+        struct Chunk;
+        void appendChunk(Chunk* chunk);
+        int chunkForLine(int index) const;
+        int lineAt(const QPoint& pos) const;
+        int lineHeight(void) const;
+        QString lineText(int index, qint64 maxSize) const;
+        int visibleLineCount(void) const;
+        void updateScrollBars(void);
+
+    // data members
+    private:
+        struct Chunk {
+            QByteArray bytes;       // own text, if no source
+            Source*    source;      // owned
+            bool       isLocal8Bit; // otherwise UTF-8
+            int        firstLine;
+            QVector<qint64> lineStarts;
+
+            Chunk(void);
+            ~Chunk(void);
+            qint64 size(void) const;
+        };
+
+        QList<Chunk*> m_chunks;
+        int m_lineCount;
+        qint64 m_maxLineLength;    // bytes, for horizontal scrolling
+
+        int m_selectionAnchor;     // -1 if no selection
+        int m_selectionEnd;
+
+        int m_matchLine;           // -1 if no match
+        int m_matchColumn;
+        int m_matchLength;
+};
+
+#endif // LOGVIEW_H
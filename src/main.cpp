@@ -1,12 +1,52 @@
 #include <QApplication>
+#include "commandlineoptions.h"
+#include "headlessrunner.h"
 #include "mainwindow.h"
+#include "statusserver.h"
+#include <QtDebug>
+
+// returns true if '--headless' is anywhere on the command line
+static
+bool isHeadless(int argc, char* argv[]) {
+    for ( int i = 1; i < argc; ++i ) {
+        if ( qstrcmp(argv[i], "--headless") == 0 )
+            return true;
+    }
+    return false;
+}
 
 int main(int argc, char *argv[]) {
 
+    // command-line mode: no GUI initialization (or display) needed
+    if ( isHeadless(argc, argv) ) {
+
+        QCoreApplication a(argc, argv);
+
+        HeadlessRunner runner;
+        int exitCode = 0;
+        if ( !runner.parseArguments(a.arguments(), &exitCode) )
+            return exitCode;
+
+        QMetaObject::invokeMethod(&runner, "start", Qt::QueuedConnection);
+        return a.exec();
+    }
+
     QApplication a(argc, argv);
 
     MainWindow w;
     w.show();
-    
+
+    // optional live status for dashboards, scripts, etc.
+    // (same parsing as --headless, though the GUI only uses the status options)
+    CommandLineOptions options;
+    if ( !options.parse(a.arguments()) )
+        qWarning() << "Invalid arguments:" << options.errorString();
+    if ( options.statusPort >= 0 ) {
+        StatusServer* server = new StatusServer(w.runner(), &w);
+        server->setAllowedOrigin(options.statusOrigin);
+        if ( !server->listen(options.statusPort) )
+            qWarning() << "Could not serve status:" << server->errorString();
+    }
+
     return a.exec();
 }
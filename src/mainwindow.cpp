@@ -1,12 +1,44 @@
 #include "mainwindow.h"
+#include "benchmarkexporter.h"
+#include "profileview.h"
+#include "resultbatcher.h"
 #include "resultdetailsview.h"
+#include "resultexporter.h"
 #include "testlistview.h"
 #include "testprogram.h"
 #include "testprogressbar.h"
+#include "testcase.h"
 #include "testrunner.h"
+#include "testselection.h"
+#include "testsuite.h"
+#include "testtreemodel.h"
 #include <QtGui>
 #include <QtDebug>
 
+// returns number of enabled tests, across all programs
+static
+int enabledTestCount(const TestRunner* runner) {
+    Q_ASSERT_X(runner, Q_FUNC_INFO, "null test runner");
+    int count = 0;
+    const int numPrograms = runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i )
+        count += runner->programAt(i)->enabledTestCount();
+    return count;
+}
+
+// enables (or disables) every listed test
+// (programs & suites already all on or off aren't visited)
+static
+void setAllTestsEnabled(TestRunner* runner, bool enabled) {
+    Q_ASSERT_X(runner, Q_FUNC_INFO, "null test runner");
+    const int numPrograms = runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        TestProgram* program = runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        program->setTestsEnabled(enabled);
+    }
+}
+
 // ---------------------------
 // MainWindow implementation
 // ---------------------------
@@ -14,17 +46,34 @@
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
     , m_runner(new TestRunner(this))
+    , m_resultBatcher(new ResultBatcher(m_runner, this))
     , m_testListView(new TestListView(m_runner))
     , m_resultDetails(new ResultDetailsView)
+    , m_profileView(new ProfileView)
     , m_progressBar(new TestProgressBar)
     , m_openAction(new QAction(QIcon(":/icons/open"), "Open test directory", this))
-    , m_runAction(new QAction(QIcon(":/icons/run"),  "Run all tests", this))
+    , m_runAction(new QAction(QIcon(":/icons/run"),  "Run selected tests", this))
+    , m_runMatchingAction(new QAction("Run matching tests", this))
+    , m_exportBenchmarksAction(new QAction("Export benchmarks", this))
+    , m_exportResultsAction(new QAction("Export results", this))
+    , m_pinBaselineAction(new QAction("Pin benchmark baseline", this))
+    , m_selectAllAction(new QAction("Select all tests", this))
+    , m_selectNoneAction(new QAction("Select no tests", this))
+    , m_saveSelectionAction(new QAction("Save selection...", this))
+    , m_selectionButton(new QToolButton)
+    , m_savedSelectionMenu(new QMenu("Run saved selection", this))
+    , m_deleteSelectionMenu(new QMenu("Delete saved selection", this))
     , m_testCountLabel(new QLabel(""))
     , m_runCountLabel(new QLabel(""))
     , m_passCountLabel(new QLabel(""))
     , m_failCountLabel(new QLabel(""))
+    , m_regressCountLabel(new QLabel(""))
+    , m_remainingTimeLabel(new QLabel(""))
+    , m_searchEdit(new QLineEdit)
+    , m_searchCountLabel(new QLabel(""))
     , m_lastDirectoryUsed("")
     , m_lastShouldRecurseChoice(true)
+    , m_shouldRestoreSelection(false)
 {
     // --------------------------------
     // setup UI
@@ -35,37 +84,96 @@ MainWindow::MainWindow(QWidget* parent)
     toolbar->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
     toolbar->addAction(m_openAction);
     toolbar->addAction(m_runAction);
+    toolbar->addAction(m_runMatchingAction);
+    toolbar->addWidget(m_selectionButton);
+    toolbar->addSeparator();
+    toolbar->addAction(m_exportResultsAction);
+    toolbar->addAction(m_exportBenchmarksAction);
+    toolbar->addAction(m_pinBaselineAction);
     addToolBar(toolbar);
     m_runAction->setEnabled(false);
+    m_runMatchingAction->setEnabled(false);
+    m_exportResultsAction->setEnabled(false);
+    m_exportBenchmarksAction->setEnabled(false);
+    m_pinBaselineAction->setEnabled(false);
+    m_exportResultsAction->setToolTip("Save all results as JUnit XML or JSON");
+    m_pinBaselineAction->setToolTip("Use benchmark results collected so far as the baseline for later runs");
+    m_runMatchingAction->setToolTip("Run only the tests matching the current search (checked tests are restored afterwards)");
+    m_runAction->setToolTip("Run the checked tests (programs with none checked are skipped)");
+
+    // checked tests: all, none, or a saved set (listed as the menu opens)
+    QMenu* selectionMenu = new QMenu(this);
+    selectionMenu->addAction(m_selectAllAction);
+    selectionMenu->addAction(m_selectNoneAction);
+    selectionMenu->addSeparator();
+    selectionMenu->addAction(m_saveSelectionAction);
+    selectionMenu->addMenu(m_savedSelectionMenu);
+    selectionMenu->addMenu(m_deleteSelectionMenu);
+    m_selectionButton->setText("Selection");
+    m_selectionButton->setMenu(selectionMenu);
+    m_selectionButton->setPopupMode(QToolButton::InstantPopup);
+    m_selectionButton->setEnabled(false);
 
     QLabel* testHeaderLabel = new QLabel("<b>Tests</b>");
     QLabel* runHeaderLabel  = new QLabel("<b>Run</b>");
     QLabel* passHeaderLabel = new QLabel("<b>Passed</b>");
     QLabel* failHeaderLabel = new QLabel("<b>Failed</b>");
+    QLabel* regressHeaderLabel = new QLabel("<b>Regressed</b>");
+    QLabel* remainingHeaderLabel = new QLabel("<b>Remaining</b>");
 
     QGridLayout* labelGridLayout = new QGridLayout;
     labelGridLayout->addWidget(testHeaderLabel,  0, 0, 1, 1, Qt::AlignCenter);
     labelGridLayout->addWidget(runHeaderLabel,   0, 1, 1, 1, Qt::AlignCenter);
     labelGridLayout->addWidget(passHeaderLabel,  0, 2, 1, 1, Qt::AlignCenter);
     labelGridLayout->addWidget(failHeaderLabel,  0, 3, 1, 1, Qt::AlignCenter);
+    labelGridLayout->addWidget(regressHeaderLabel, 0, 4, 1, 1, Qt::AlignCenter);
+    labelGridLayout->addWidget(remainingHeaderLabel, 0, 5, 1, 1, Qt::AlignCenter);
     labelGridLayout->addWidget(m_testCountLabel, 1, 0, 1, 1, Qt::AlignCenter);
     labelGridLayout->addWidget(m_runCountLabel,  1, 1, 1, 1, Qt::AlignCenter);
     labelGridLayout->addWidget(m_passCountLabel, 1, 2, 1, 1, Qt::AlignCenter);
     labelGridLayout->addWidget(m_failCountLabel, 1, 3, 1, 1, Qt::AlignCenter);
+    labelGridLayout->addWidget(m_regressCountLabel, 1, 4, 1, 1, Qt::AlignCenter);
+    labelGridLayout->addWidget(m_remainingTimeLabel, 1, 5, 1, 1, Qt::AlignCenter);
+    m_remainingTimeLabel->setToolTip("Estimated from each test's time in recent runs");
 
     QVBoxLayout* resultLayout = new QVBoxLayout;
     resultLayout->addWidget(m_progressBar);
     resultLayout->addLayout(labelGridLayout);
 
+    // search box over test tree
+    m_searchEdit->setToolTip("Filter tests by name: 'text' (substring), 'Suite.*' (glob), or '/regex/'");
+#if QT_VERSION >= 0x040700
+    m_searchEdit->setPlaceholderText("Search tests");
+#endif
+    QHBoxLayout* searchLayout = new QHBoxLayout;
+    searchLayout->setContentsMargins(0, 0, 0, 0);
+    searchLayout->addWidget(m_searchEdit, 1);
+    searchLayout->addWidget(m_searchCountLabel);
+
+    QVBoxLayout* testListLayout = new QVBoxLayout;
+    testListLayout->setContentsMargins(0, 0, 0, 0);
+    testListLayout->addLayout(searchLayout);
+    testListLayout->addWidget(m_testListView);
+    QWidget* testListPane = new QWidget;
+    testListPane->setLayout(testListLayout);
+
+    // details of selection, or run profile
+    QTabWidget* resultTabs = new QTabWidget;
+    resultTabs->addTab(m_resultDetails, "Details");
+    resultTabs->addTab(m_profileView,   "Profile");
+
     QSplitter* splitter = new QSplitter(Qt::Horizontal);
     splitter->setChildrenCollapsible(false);
-    splitter->addWidget(m_testListView);
-    splitter->addWidget(m_resultDetails);
+    splitter->addWidget(testListPane);
+    splitter->addWidget(resultTabs);
 
     QVBoxLayout* layout = new QVBoxLayout;
     layout->addLayout(resultLayout);
     layout->addWidget(splitter, 9);
 
+    // show previous results along with current ones
+    m_resultDetails->setHistoryStore(m_runner->historyStore());
+
     // initialize grayed-filled progress bar so it doesn't look like an input field
     m_progressBar->grayOut();
 
@@ -81,31 +189,53 @@ MainWindow::MainWindow(QWidget* parent)
     // --------------------------------
 
     connect(m_openAction, SIGNAL(triggered()), this,     SLOT(openDirectory()));
-    connect(m_runAction,  SIGNAL(triggered()), m_runner, SLOT(runTests()));
+    connect(m_runAction,  SIGNAL(triggered()), this,     SLOT(runSelectedTests()));
+    connect(m_runMatchingAction, SIGNAL(triggered()), this, SLOT(runMatchingTests()));
+    connect(m_exportBenchmarksAction, SIGNAL(triggered()), this, SLOT(exportBenchmarks()));
+    connect(m_exportResultsAction,    SIGNAL(triggered()), this, SLOT(exportResults()));
+    connect(m_pinBaselineAction, SIGNAL(triggered()), m_runner, SLOT(pinBenchmarkBaseline()));
+    connect(m_selectAllAction,     SIGNAL(triggered()), this, SLOT(selectAllTests()));
+    connect(m_selectNoneAction,    SIGNAL(triggered()), this, SLOT(selectNoTests()));
+    connect(m_saveSelectionAction, SIGNAL(triggered()), this, SLOT(saveSelection()));
+    connect(selectionMenu,         SIGNAL(aboutToShow()), this, SLOT(updateSelectionMenus()));
+    connect(m_savedSelectionMenu,  SIGNAL(triggered(QAction*)), this, SLOT(runSavedSelection(QAction*)));
+    connect(m_deleteSelectionMenu, SIGNAL(triggered(QAction*)), this, SLOT(deleteSavedSelection(QAction*)));
 
     connect(m_runner, SIGNAL(listTestsStarted()),  this, SLOT(onListTestsStarted()));
     connect(m_runner, SIGNAL(listTestsFinished()), this, SLOT(onListTestsFinished()));
     connect(m_runner, SIGNAL(runTestsStarted()),   this, SLOT(onRunTestsStarted()));
     connect(m_runner, SIGNAL(runTestsFinished()),  this, SLOT(onRunTestsFinished()));
-    connect(m_runner, SIGNAL(testResultsReady(TestProgram*)), this, SLOT(onTestResultsReady(TestProgram*)));
+    connect(m_resultBatcher, SIGNAL(resultsReady(QList<TestProgram*>)), this, SLOT(onTestResultsReady(QList<TestProgram*>)));
+    connect(m_runner, SIGNAL(benchmarkBaselineChanged()), this, SLOT(onBenchmarkBaselineChanged()));
 
     connect(m_runner, SIGNAL(listTestsStarted()),  m_testListView, SLOT(onListTestsStarted()));
     connect(m_runner, SIGNAL(listTestsFinished()), m_testListView, SLOT(onListTestsFinished()));
     connect(m_runner, SIGNAL(runTestsStarted()),   m_testListView, SLOT(onRunTestsStarted()));
     connect(m_runner, SIGNAL(runTestsFinished()),  m_testListView, SLOT(onRunTestsFinished()));
-    connect(m_runner, SIGNAL(testResultsReady(TestProgram*)), m_testListView, SLOT(onTestResultsReady(TestProgram*)));
+    connect(m_resultBatcher, SIGNAL(resultsReady(QList<TestProgram*>)),
+            m_testListView,  SLOT(onTestResultsBatchReady(QList<TestProgram*>)));
+    connect(m_runner, SIGNAL(benchmarkBaselineChanged()),     m_testListView, SLOT(onBenchmarkBaselineChanged()));
+    connect(m_searchEdit,   SIGNAL(textChanged(QString)),    m_testListView, SLOT(setSearchQuery(QString)));
+    connect(m_testListView, SIGNAL(searchResultsChanged(int)), this,         SLOT(onSearchResultsChanged(int)));
+    connect(m_testListView, SIGNAL(testSelectionChanged()),    this,         SLOT(onTestSelectionChanged()));
 
     connect(m_runner, SIGNAL(listTestsStarted()),  m_resultDetails, SLOT(onListTestsStarted()));
     connect(m_runner, SIGNAL(listTestsFinished()), m_resultDetails, SLOT(onListTestsFinished()));
     connect(m_runner, SIGNAL(runTestsStarted()),   m_resultDetails, SLOT(onRunTestsStarted()));
     connect(m_runner, SIGNAL(runTestsFinished()),  m_resultDetails, SLOT(onRunTestsFinished()));
 
+    connect(m_runner, SIGNAL(listTestsStarted()), m_profileView, SLOT(onListTestsStarted()));
+    connect(m_runner, SIGNAL(runTestsStarted()),  m_profileView, SLOT(onRunTestsStarted()));
+    connect(m_resultBatcher, SIGNAL(resultsReady(QList<TestProgram*>)),
+            m_profileView,   SLOT(onTestResultsBatchReady(QList<TestProgram*>)));
+
     connect(m_runner, SIGNAL(listTestsStarted()),            m_progressBar, SLOT(reset()));
     connect(m_runner, SIGNAL(runTestsStarted()),             m_progressBar, SLOT(reset()));
     connect(m_runner, SIGNAL(listTestsFinished()),           m_progressBar, SLOT(setFinished()));
     connect(m_runner, SIGNAL(runTestsFinished()),            m_progressBar, SLOT(setFinished()));
     connect(m_runner, SIGNAL(progressRangeChanged(int,int)), m_progressBar, SLOT(setRange(int,int)));
     connect(m_runner, SIGNAL(progressValueChanged(int)),     m_progressBar, SLOT(setValue(int)));
+    connect(m_runner, SIGNAL(remainingTimeChanged(int)),     this,          SLOT(onRemainingTimeChanged(int)));
 
     connect(m_testListView,  SIGNAL(testCaseSelected(TestCase*)),
             m_resultDetails, SLOT(onTestCaseSelected(TestCase*)));
@@ -115,18 +245,85 @@ MainWindow::MainWindow(QWidget* parent)
 
     connect(m_testListView,  SIGNAL(testProgramSelected(TestProgram*)),
             m_resultDetails, SLOT(onTestProgramSelected(TestProgram*)));
+
+    connect(m_profileView,   SIGNAL(testCaseSelected(TestCase*)),
+            m_resultDetails, SLOT(onTestCaseSelected(TestCase*)));
+    connect(m_profileView,   SIGNAL(testSuiteSelected(TestSuite*)),
+            m_resultDetails, SLOT(onTestSuiteSelected(TestSuite*)));
+    connect(m_profileView,   SIGNAL(testProgramSelected(TestProgram*)),
+            m_resultDetails, SLOT(onTestProgramSelected(TestProgram*)));
 }
 
 MainWindow::~MainWindow(void) { }
 
+void MainWindow::deleteSavedSelection(QAction* action) {
+    Q_ASSERT_X(action, Q_FUNC_INFO, "null action");
+    TestSelection::remove( action->data().toString() );
+}
+
 void MainWindow::disableActions(void) {
     m_openAction->setEnabled(false);
     m_runAction->setEnabled(false);
+    m_runMatchingAction->setEnabled(false);
+    m_selectionButton->setEnabled(false);
+    m_exportBenchmarksAction->setEnabled(false);
+    m_exportResultsAction->setEnabled(false);
+    m_pinBaselineAction->setEnabled(false);
 }
 
 void MainWindow::enableActions(void) {
     m_openAction->setEnabled(true);
-    m_runAction->setEnabled(true);
+    m_runAction->setEnabled( enabledTestCount(m_runner) > 0 );
+    m_runMatchingAction->setEnabled( m_testListView->searchMatchCount() > 0 );
+    m_selectionButton->setEnabled(true);
+    m_exportBenchmarksAction->setEnabled(true);
+    m_exportResultsAction->setEnabled(true);
+    m_pinBaselineAction->setEnabled(true);
+}
+
+void MainWindow::exportBenchmarks(void) {
+
+    // let user select output file
+    const QString filename = QFileDialog::getSaveFileName(this,
+                                                          "Export Benchmarks",
+                                                          m_lastDirectoryUsed,
+                                                          "CSV files (*.csv)");
+    if ( filename.isEmpty() )
+        return;
+
+    // write results
+    if ( !BenchmarkExporter::writeCsv(m_runner, filename) )
+        QMessageBox::warning(this, "Export Benchmarks", "Could not write file: " + filename);
+}
+
+void MainWindow::exportResults(void) {
+
+    // let user select output file (format is picked by extension)
+    const QString filename = QFileDialog::getSaveFileName(this,
+                                                          "Export Results",
+                                                          m_lastDirectoryUsed,
+                                                          "JUnit XML files (*.xml);;JSON files (*.json)");
+    if ( filename.isEmpty() )
+        return;
+
+    // write results
+    QString error;
+    if ( !ResultExporter::exportResults(m_runner,
+                                        ResultExporter::formatForFileName(filename),
+                                        filename,
+                                        &error) )
+    {
+        QMessageBox::warning(this, "Export Results", error);
+    }
+}
+
+bool MainWindow::isIdle(void) const {
+    // (open action is disabled during listing & runs)
+    return m_openAction->isEnabled();
+}
+
+void MainWindow::onBenchmarkBaselineChanged(void) {
+    m_regressCountLabel->setText(QString::number(m_runner->regressedTestCount()));
 }
 
 void MainWindow::onListTestsFinished(void) {
@@ -139,21 +336,56 @@ void MainWindow::onListTestsFinished(void) {
     m_runCountLabel->setText("0");
     m_passCountLabel->setText("0");
     m_failCountLabel->setText("0");
+    m_regressCountLabel->setText("0");
 }
 
 void MainWindow::onListTestsStarted(void) {
 
     disableActions();
 
+    // (patterns would be applied to the new listing's tests)
+    m_shouldRestoreSelection = false;
+    m_selectionToRestore.clear();
+
     // clear all count labels
     m_testCountLabel->clear();
     m_runCountLabel->clear();
     m_passCountLabel->clear();
     m_failCountLabel->clear();
+    m_regressCountLabel->clear();
+    m_remainingTimeLabel->clear();
+}
+
+void MainWindow::onRemainingTimeChanged(int seconds) {
+
+    if ( seconds < 0 ) {
+        m_remainingTimeLabel->setText("?");
+        return;
+    }
+
+    // e.g. '1:02:05', '2:05', '0:05'
+    const int hours   = seconds / 3600;
+    const int minutes = (seconds / 60) % 60;
+    const int secs    = seconds % 60;
+    if ( hours > 0 )
+        m_remainingTimeLabel->setText( QString("%1:%2:%3").arg(hours).arg(minutes, 2, 10, QChar('0')).arg(secs, 2, 10, QChar('0')) );
+    else
+        m_remainingTimeLabel->setText( QString("%1:%2").arg(minutes).arg(secs, 2, 10, QChar('0')) );
 }
 
 void MainWindow::onRunTestsFinished(void) {
+
     enableActions();
+    m_remainingTimeLabel->clear();
+
+    // put back checked tests, if overridden by "Run matching tests"
+    if ( m_shouldRestoreSelection ) {
+        m_shouldRestoreSelection = false;
+        TestSelection::apply(m_runner, m_selectionToRestore);
+        m_selectionToRestore.clear();
+        m_testListView->testModel()->updateAll();
+        onTestSelectionChanged();
+    }
 }
 
 void MainWindow::onRunTestsStarted(void) {
@@ -164,23 +396,50 @@ void MainWindow::onRunTestsStarted(void) {
     m_runCountLabel->clear();
     m_passCountLabel->clear();
     m_failCountLabel->clear();
+    m_regressCountLabel->clear();
 }
 
-void MainWindow::onTestResultsReady(TestProgram* program) {
+void MainWindow::onSearchResultsChanged(int matchCount) {
+
+    // match count, or whether we're still indexing
+    if ( matchCount >= 0 )
+        m_searchCountLabel->setText( QString("%1 matching").arg(matchCount) );
+    else if ( !m_searchEdit->text().trimmed().isEmpty() && !m_testListView->isSearchIndexReady() )
+        m_searchCountLabel->setText("Indexing...");
+    else
+        m_searchCountLabel->clear();
+
+    // only while idle
+    m_runMatchingAction->setEnabled( isIdle() && matchCount > 0 );
+}
+
+void MainWindow::onTestResultsReady(const QList<TestProgram*>& programs) {
 
     // check for any errors, update progress bar
-    if ( program->hasFailedTests() )
-        m_progressBar->setError(true);
+    foreach ( TestProgram* program, programs ) {
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        if ( program->hasFailedTests() || program->hasError() ) {
+            m_progressBar->setError(true);
+            break;
+        }
+    }
 
     // fetch result summary & update labels
     const int totalTestCount = m_runner->totalTestCount();
     const int totalRunCount  = m_runner->runTestCount();
     const int totalPassCount = m_runner->passedTestCount();
     const int totalFailCount = m_runner->failedTestCount();
+    const int totalRegressCount = m_runner->regressedTestCount();
     m_testCountLabel->setText(QString::number(totalTestCount));
     m_runCountLabel->setText(QString::number(totalRunCount));
     m_passCountLabel->setText(QString::number(totalPassCount));
     m_failCountLabel->setText(QString::number(totalFailCount));
+    m_regressCountLabel->setText(QString::number(totalRegressCount));
+}
+
+void MainWindow::onTestSelectionChanged(void) {
+    if ( isIdle() )
+        m_runAction->setEnabled( enabledTestCount(m_runner) > 0 );
 }
 
 void MainWindow::openDirectory(void) {
@@ -200,6 +459,100 @@ void MainWindow::openDirectory(void) {
     }
 }
 
+void MainWindow::runMatchingTests(void) {
+
+    const QList<TestCase*> matchingTests = m_testListView->matchingTests();
+    if ( matchingTests.isEmpty() )
+        return;
+
+    // selection becomes the search's matches for this run only (the checked
+    // tests are kept, & put back once it finishes)
+    if ( !isIdle() )
+        return;
+    m_selectionToRestore = TestSelection::fromEnabledTests(m_runner);
+    m_shouldRestoreSelection = true;
+    setAllTestsEnabled(m_runner, false);
+    foreach ( TestCase* test, matchingTests )
+        test->setEnabled(true);
+    m_testListView->testModel()->updateAll();
+    onTestSelectionChanged();
+    m_runner->runTests();
+}
+
+void MainWindow::runSavedSelection(QAction* action) {
+
+    Q_ASSERT_X(action, Q_FUNC_INFO, "null action");
+
+    // select, & run, in one go
+    const int numSelected = TestSelection::apply(m_runner, TestSelection::load(action->data().toString()));
+    m_testListView->testModel()->updateAll();
+    onTestSelectionChanged();
+    if ( numSelected == 0 ) {
+        QMessageBox::information(this, "Run Saved Selection",
+                                 QString("None of the tests in '%1' were found.").arg(action->data().toString()));
+        return;
+    }
+    m_runner->runTests();
+}
+
+void MainWindow::runSelectedTests(void) {
+    m_runner->runTests();
+}
+
+TestRunner* MainWindow::runner(void) const {
+    return m_runner;
+}
+
+void MainWindow::saveSelection(void) {
+
+    bool ok = false;
+    const QString name = QInputDialog::getText(this,
+                                               "Save Selection",
+                                               "Name for the checked tests:",
+                                               QLineEdit::Normal,
+                                               QString(),
+                                               &ok).trimmed();
+    if ( !ok || name.isEmpty() )
+        return;
+
+    // confirm replacing an existing one
+    if ( TestSelection::savedNames().contains(name) ) {
+        const QMessageBox::StandardButton answer =
+                QMessageBox::question(this, "Save Selection",
+                                      QString("Replace the saved selection '%1'?").arg(name),
+                                      QMessageBox::Yes | QMessageBox::No);
+        if ( answer != QMessageBox::Yes )
+            return;
+    }
+    TestSelection::save(name, TestSelection::fromEnabledTests(m_runner));
+}
+
+void MainWindow::selectAllTests(void) {
+    setAllTestsEnabled(m_runner, true);
+    m_testListView->testModel()->updateAll();
+    onTestSelectionChanged();
+}
+
+void MainWindow::selectNoTests(void) {
+    setAllTestsEnabled(m_runner, false);
+    m_testListView->testModel()->updateAll();
+    onTestSelectionChanged();
+}
+
+void MainWindow::updateSelectionMenus(void) {
+
+    m_savedSelectionMenu->clear();
+    m_deleteSelectionMenu->clear();
+
+    const QStringList names = TestSelection::savedNames();
+    foreach ( const QString& name, names ) {
+        m_savedSelectionMenu->addAction(name)->setData(name);
+        m_deleteSelectionMenu->addAction(name)->setData(name);
+    }
+    m_savedSelectionMenu->setEnabled( !names.isEmpty() );
+    m_deleteSelectionMenu->setEnabled( !names.isEmpty() );
+}
+
 // ---------------------------------------
 // DirectoryChooserDialog implementation
 // ---------------------------------------
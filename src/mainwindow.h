@@ -2,9 +2,12 @@
 #define MAINWINDOW_H
 
 #include <QDialog>
+#include <QList>
 #include <QMainWindow>
 #include <QString>
 
+class ProfileView;
+class ResultBatcher;
 class ResultDetailsView;
 class TestListView;
 class TestProgram;
@@ -15,7 +18,9 @@ class QAction;
 class QCheckBox;
 class QLabel;
 class QLineEdit;
+class QMenu;
 class QPushButton;
+class QToolButton;
 
 // our main application window
 class MainWindow : public QMainWindow {
@@ -27,35 +32,74 @@ class MainWindow : public QMainWindow {
         explicit MainWindow(QWidget* parent = 0);
         ~MainWindow(void);
 
+    // MainWindow interface
+    public:
+        TestRunner* runner(void) const;
+
     // internal methods
     private slots:
 
+        void onBenchmarkBaselineChanged(void);
         void onListTestsStarted(void);
         void onListTestsFinished(void);
+        void onRemainingTimeChanged(int seconds);
         void onRunTestsStarted(void);
         void onRunTestsFinished(void);
-        void onTestResultsReady(TestProgram* program);
+        void onSearchResultsChanged(int matchCount);
+        void onTestResultsReady(const QList<TestProgram*>& programs);
+        void onTestSelectionChanged(void);
+        void deleteSavedSelection(QAction* action);
+        void exportBenchmarks(void);
+        void exportResults(void);
         void openDirectory(void);
+        void runMatchingTests(void);
+        void runSavedSelection(QAction* action);
+        void runSelectedTests(void);
+        void saveSelection(void);
+        void selectAllTests(void);
+        void selectNoTests(void);
+        void updateSelectionMenus(void);
     private:
         void disableActions(void);
         void enableActions(void);
+        bool isIdle(void) const;
 
     // data members
     private:
         TestRunner*        m_runner;
+        ResultBatcher*     m_resultBatcher;     // results, as (at most) one update per frame
         TestListView*      m_testListView;
         ResultDetailsView* m_resultDetails;
+        ProfileView*       m_profileView;       // slowest tests, suites & programs
         TestProgressBar*   m_progressBar;
 
         QAction* m_openAction;
         QAction* m_runAction;
+        QAction* m_runMatchingAction;
+        QAction* m_exportBenchmarksAction;
+        QAction* m_exportResultsAction;
+        QAction* m_pinBaselineAction;
+        QAction* m_selectAllAction;
+        QAction* m_selectNoneAction;
+        QAction* m_saveSelectionAction;
+        QToolButton* m_selectionButton;
+        QMenu*   m_savedSelectionMenu;   // run a named selection
+        QMenu*   m_deleteSelectionMenu;
         QLabel*  m_testCountLabel;
         QLabel*  m_runCountLabel;
         QLabel*  m_passCountLabel;
         QLabel*  m_failCountLabel;
+        QLabel*  m_regressCountLabel;
+        QLabel*  m_remainingTimeLabel;
+        QLineEdit* m_searchEdit;
+        QLabel*    m_searchCountLabel;
 
         QString m_lastDirectoryUsed;
         bool    m_lastShouldRecurseChoice;
+
+        // checked tests from before "Run matching tests", put back after its run
+        QStringList m_selectionToRestore;
+        bool        m_shouldRestoreSelection;
 };
 
 // helper dialog
@@ -0,0 +1,100 @@
+#include "messagestore.h"
+#include <QtCore>
+#include <QtDebug>
+
+// in-memory size of a message
+static inline
+qint64 messageBytes(const QString& msg) {
+    return qint64(msg.size()) * qint64(sizeof(QChar));
+}
+
+// -----------------------------
+// MessageStore implementation
+// -----------------------------
+
+MessageStore::MessageStore(qint64 memoryBudget, int spillThreshold)
+    : m_memoryBudget(memoryBudget)
+    , m_spillThreshold(spillThreshold)
+    , m_memoryUsed(0)
+    , m_file(0)
+{ }
+
+MessageStore::~MessageStore(void) {
+    delete m_file;
+}
+
+bool MessageStore::append(const QString& msg, qint64* offset, qint64* size) {
+
+    Q_ASSERT_X(offset && size, Q_FUNC_INFO, "null output parameter");
+
+    QMutexLocker locker(&m_mutex);
+
+    // create temp file if needed
+    if ( m_file == 0 ) {
+        m_file = new QTemporaryFile(QDir::tempPath() + "/edgecase-messages-XXXXXX");
+        if ( !m_file->open() ) {
+            qDebug() << "Could not create message store: " << m_file->errorString();
+            delete m_file;
+            m_file = 0;
+            return false;
+        }
+    }
+
+    // append message
+    const QByteArray data = msg.toUtf8();
+    const qint64 end = m_file->size();
+    if ( !m_file->seek(end) || m_file->write(data) != data.size() ) {
+        qDebug() << "Could not write to message store: " << m_file->errorString();
+        return false;
+    }
+
+    *offset = end;
+    *size   = data.size();
+    return true;
+}
+
+void MessageStore::clear(void) {
+    QMutexLocker locker(&m_mutex);
+    m_memoryUsed = 0;
+    delete m_file;
+    m_file = 0;
+}
+
+qint64 MessageStore::diskUsed(void) const {
+    QMutexLocker locker(&m_mutex);
+    return ( m_file ? m_file->size() : 0 );
+}
+
+qint64 MessageStore::memoryUsed(void) const {
+    QMutexLocker locker(&m_mutex);
+    return m_memoryUsed;
+}
+
+QString MessageStore::read(qint64 offset, qint64 size) const {
+
+    QMutexLocker locker(&m_mutex);
+
+    if ( m_file == 0 || !m_file->seek(offset) )
+        return QString();
+    return QString::fromUtf8( m_file->read(size) );
+}
+
+void MessageStore::release(const QString& msg) {
+    QMutexLocker locker(&m_mutex);
+    m_memoryUsed = qMax(qint64(0), m_memoryUsed - messageBytes(msg));
+}
+
+bool MessageStore::reserve(const QString& msg) {
+
+    // large messages always go to disk
+    if ( msg.size() > m_spillThreshold )
+        return false;
+
+    // otherwise keep in memory, if there's room
+    QMutexLocker locker(&m_mutex);
+    const qint64 bytes = messageBytes(msg);
+    if ( m_memoryUsed + bytes > m_memoryBudget )
+        return false;
+    m_memoryUsed += bytes;
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef MESSAGESTORE_H
+#define MESSAGESTORE_H
+
+#include <QMutex>
+#include <QString>
+class QTemporaryFile;
+
+// keeps result message text within a memory budget, by writing large messages
+// (or all messages, once the budget is used up) to an append-only temp file
+//
+// all methods are thread-safe
+class MessageStore {
+
+    // ctor & dtor
+    public:
+        explicit MessageStore(qint64 memoryBudget = 128*1024*1024, // bytes
+                              int spillThreshold  = 16*1024);      // characters
+        ~MessageStore(void);
+
+    // MessageStore interface
+    public:
+
+        // returns true (& reserves its memory) if message should stay in memory
+        bool reserve(const QString& msg);
+        void release(const QString& msg);
+
+        // writes message to disk, returning its location
+        bool append(const QString& msg, qint64* offset, qint64* size);
+        QString read(qint64 offset, qint64 size) const;
+
+        // drop all messages (memory accounting & disk contents)
+        void clear(void);
+
+        qint64 memoryUsed(void) const;
+        qint64 diskUsed(void) const;
+
+    // data members
+    private:
+        mutable QMutex m_mutex;
+        const qint64 m_memoryBudget;
+        const int    m_spillThreshold;
+        qint64       m_memoryUsed;
+        QTemporaryFile* m_file; // created on first use
+};
+
+#endif // MESSAGESTORE_H
@@ -0,0 +1,115 @@
+#include "outputlog.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+
+    // in the system's temp directory
+    const char* const LogFileTemplate = "edgecase-XXXXXX.log";
+
+} // namespace Constants
+
+// --------------------------
+// OutputLog implementation
+// --------------------------
+
+OutputLog::OutputLog(void)
+    : m_file(0)
+    , m_map(0)
+    , m_mapSize(0)
+    , m_size(0)
+    , m_isWritable(false)
+{ }
+
+OutputLog::~OutputLog(void) {
+    remove();
+}
+
+qint64 OutputLog::append(const QByteArray& data) {
+
+    if ( !m_isWritable )
+        return -1;
+
+    // the mapping may need to grow after this, so drop it now
+    unmap();
+
+    const qint64 offset = m_size;
+    if ( m_file->write(data) != data.size() ) {
+        qDebug() << "Could not write output log: " << m_file->errorString();
+        return -1;
+    }
+    m_size += data.size();
+    return offset;
+}
+
+void OutputLog::close(void) {
+    m_isWritable = false;
+    if ( m_file )
+        m_file->flush();
+}
+
+QByteArray OutputLog::data(qint64 offset, qint64 size) const {
+
+    // sanity checks
+    if ( offset < 0 || size <= 0 || offset + size > m_size )
+        return QByteArray();
+
+    // (re-)map file if needed
+    if ( m_map == 0 || offset + size > m_mapSize ) {
+        unmap();
+        m_file->flush();
+        m_map = m_file->map(0, m_size);
+        if ( m_map == 0 )
+            return QByteArray();
+        m_mapSize = m_size;
+    }
+
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(m_map + offset), int(size));
+}
+
+QString OutputLog::fileName(void) const {
+    return ( m_file ? m_file->fileName() : QString() );
+}
+
+bool OutputLog::isOpen(void) const {
+    return m_isWritable;
+}
+
+bool OutputLog::open(void) {
+
+    // drop any previous log
+    remove();
+
+    // create new file, for reading & writing
+    m_file = new QTemporaryFile(QDir::tempPath() + "/" + Constants::LogFileTemplate);
+    if ( !m_file->open() ) {
+        qDebug() << "Could not open output log: " << m_file->errorString();
+        remove();
+        return false;
+    }
+
+    m_isWritable = true;
+    return true;
+}
+
+void OutputLog::remove(void) {
+
+    // (temporary file is deleted along w/ its object)
+    unmap();
+    delete m_file;
+    m_file = 0;
+    m_size = 0;
+    m_isWritable = false;
+}
+
+qint64 OutputLog::size(void) const {
+    return m_size;
+}
+
+void OutputLog::unmap(void) const {
+    if ( m_map ) {
+        m_file->unmap(m_map);
+        m_map = 0;
+        m_mapSize = 0;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef OUTPUTLOG_H
+#define OUTPUTLOG_H
+
+#include <QByteArray>
+#include <QString>
+class QTemporaryFile;
+
+// append-only log file, read back through a memory mapping
+//
+// the file is a temporary one (in the system's temp directory, not next to
+// the program), deleted when the next log is started or the OutputLog goes away.
+class OutputLog {
+
+    // ctor & dtor
+    public:
+        OutputLog(void);
+        ~OutputLog(void);
+
+    // OutputLog interface
+    public:
+        bool open(void);    // starts a new, empty log (deleting any previous one)
+        void close(void);   // stops writing, contents stay readable
+        void remove(void);  // deletes the log
+        bool isOpen(void) const;
+
+        QString fileName(void) const;
+        qint64 size(void) const;
+
+        // returns offset where data was written, or -1 on error
+        qint64 append(const QByteArray& data);
+
+        // returns a view directly into the mapped file (no copy is made),
+        // valid until the next call to open(), append() or data()
+        QByteArray data(qint64 offset, qint64 size) const;
+
+    // internal methods
+    private:
+        Q_DISABLE_COPY(OutputLog)
+        void unmap(void) const;
+
+    // data members
+    private:
+        QTemporaryFile* m_file; // null if no log
+        mutable uchar* m_map;
+        mutable qint64 m_mapSize;
+        qint64 m_size;
+        bool   m_isWritable;
+};
+
+#endif // OUTPUTLOG_H
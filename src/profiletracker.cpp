@@ -0,0 +1,239 @@
+#include "profiletracker.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+#include <algorithm>
+
+// heap order: the fastest entry kept ends up at the front
+static
+bool isSlower(const ProfileTracker::Entry& lhs, const ProfileTracker::Entry& rhs) {
+    return lhs.time > rhs.time;
+}
+
+// same, by CPU time
+static
+bool usesMoreCpu(const ProfileTracker::Entry& lhs, const ProfileTracker::Entry& rhs) {
+    return lhs.cpuTime > rhs.cpuTime;
+}
+
+// returns test's CPU time over its measured runs (seconds), or -1 if none reported
+static
+qreal cpuTimeForTest(const TestCase* test) {
+    qreal result = -1.0;
+    const QList<BenchmarkResult> results = test->benchmarkResults();
+    foreach ( const BenchmarkResult& benchmark, results ) {
+        if ( benchmark.metric != BenchmarkResult::CpuTime || benchmark.isAggregate() )
+            continue;
+        const qreal seconds = benchmark.totalSeconds();
+        if ( seconds >= 0.0 )
+            result = ( result >= 0.0 ? result + seconds : seconds );
+    }
+    return result;
+}
+
+// ---------------------------------------
+// ProfileTracker::Entry implementation
+// ---------------------------------------
+
+ProfileTracker::Entry::Entry(void)
+    : time(0.0)
+    , cpuTime(-1.0)
+    , program(0)
+    , suite(0)
+    , test(0)
+{ }
+
+// ---------------------------------------
+// ProfileTracker implementation
+// ---------------------------------------
+
+ProfileTracker::ProfileTracker(int capacity)
+    : m_capacity(qMax(1, capacity))
+{
+    clear();
+}
+
+ProfileTracker::~ProfileTracker(void) { }
+
+void ProfileTracker::addProgram(TestProgram* program) {
+
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+
+    qreal programTestTime = 0.0;
+    bool hasTimedTests = false;
+
+    const int numSuites = program->suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+        // tests
+        qreal suiteTestTime = 0.0;
+        bool hasTimedSuiteTests = false;
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests; ++j ) {
+            TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            if ( !test->wasRun() )
+                continue;
+            const qreal cpuTime = cpuTimeForTest(test);
+            if ( !test->hasTime() && cpuTime < 0.0 )
+                continue;
+
+            Entry entry;
+            entry.name    = suite->name() + '.' + test->name();
+            entry.time    = ( test->hasTime() ? test->time() : 0.0 );
+            entry.cpuTime = cpuTime;
+            entry.program = program;
+            entry.suite   = suite;
+            entry.test    = test;
+
+            // by CPU time, if reported
+            if ( entry.cpuTime >= 0.0 ) {
+                offer(&m_cpuTests, entry, usesMoreCpu);
+                m_totalCpuTime += entry.cpuTime;
+                ++m_cpuTestCount;
+            }
+
+            // by time
+            if ( !test->hasTime() )
+                continue;
+            offer(&m_tests, entry, isSlower);
+
+            suiteTestTime += entry.time;
+            hasTimedSuiteTests = true;
+            m_totalTestTime += entry.time;
+            ++m_testCount;
+        }
+
+        // suite, by its own time if it has one
+        if ( !suite->hasTime() && !hasTimedSuiteTests )
+            continue;
+        Entry entry;
+        entry.name    = suite->name();
+        entry.time    = ( suite->hasTime() ? suite->time() : suiteTestTime );
+        entry.program = program;
+        entry.suite   = suite;
+        offer(&m_suites, entry, isSlower);
+
+        m_totalSuiteTime += entry.time;
+        programTestTime += suiteTestTime;
+        hasTimedTests = ( hasTimedTests || hasTimedSuiteTests );
+    }
+
+    // program, by its own time, its process lifetime, or its tests' total
+    Entry entry;
+    entry.name    = program->programName();
+    entry.program = program;
+    const qreal processTime = program->lastTaskTiming().processTime;
+    if ( program->hasTime() )
+        entry.time = program->time();
+    else if ( processTime >= 0.0 )
+        entry.time = processTime;
+    else if ( hasTimedTests )
+        entry.time = programTestTime;
+    else
+        return;
+    offer(&m_programs, entry, isSlower);
+
+    m_totalProgramTime += entry.time;
+    ++m_programCount;
+}
+
+int ProfileTracker::capacity(void) const {
+    return m_capacity;
+}
+
+void ProfileTracker::clear(void) {
+    m_tests.clear();
+    m_suites.clear();
+    m_programs.clear();
+    m_cpuTests.clear();
+    m_tests.reserve(m_capacity);
+    m_suites.reserve(m_capacity);
+    m_programs.reserve(m_capacity);
+    m_cpuTests.reserve(m_capacity);
+    m_totalTestTime = 0.0;
+    m_totalSuiteTime = 0.0;
+    m_totalProgramTime = 0.0;
+    m_totalCpuTime = 0.0;
+    m_testCount = 0;
+    m_cpuTestCount = 0;
+    m_programCount = 0;
+}
+
+int ProfileTracker::cpuTestCount(void) const {
+    return m_cpuTestCount;
+}
+
+QList<ProfileTracker::Entry> ProfileTracker::mostCpuTests(void) const {
+    return sorted(m_cpuTests, usesMoreCpu);
+}
+
+void ProfileTracker::offer(QVector<Entry>* heap, const Entry& entry, EntryOrder isBefore) const {
+
+    Q_ASSERT_X(heap, Q_FUNC_INFO, "null heap");
+
+    // room left
+    if ( heap->size() < m_capacity ) {
+        heap->append(entry);
+        std::push_heap(heap->begin(), heap->end(), isBefore);
+        return;
+    }
+
+    // otherwise only if it beats the fastest one kept
+    if ( !isBefore(entry, heap->first()) )
+        return;
+    std::pop_heap(heap->begin(), heap->end(), isBefore);
+    heap->last() = entry;
+    std::push_heap(heap->begin(), heap->end(), isBefore);
+}
+
+int ProfileTracker::programCount(void) const {
+    return m_programCount;
+}
+
+void ProfileTracker::setCapacity(int capacity) {
+    m_capacity = qMax(1, capacity);
+    clear();
+}
+
+QList<ProfileTracker::Entry> ProfileTracker::slowestPrograms(void) const {
+    return sorted(m_programs, isSlower);
+}
+
+QList<ProfileTracker::Entry> ProfileTracker::slowestSuites(void) const {
+    return sorted(m_suites, isSlower);
+}
+
+QList<ProfileTracker::Entry> ProfileTracker::slowestTests(void) const {
+    return sorted(m_tests, isSlower);
+}
+
+QList<ProfileTracker::Entry> ProfileTracker::sorted(const QVector<Entry>& heap, EntryOrder isBefore) {
+    QVector<Entry> entries = heap;
+    std::stable_sort(entries.begin(), entries.end(), isBefore);
+    return entries.toList();
+}
+
+int ProfileTracker::testCount(void) const {
+    return m_testCount;
+}
+
+qreal ProfileTracker::totalCpuTime(void) const {
+    return m_totalCpuTime;
+}
+
+qreal ProfileTracker::totalProgramTime(void) const {
+    return m_totalProgramTime;
+}
+
+qreal ProfileTracker::totalSuiteTime(void) const {
+    return m_totalSuiteTime;
+}
+
+qreal ProfileTracker::totalTestTime(void) const {
+    return m_totalTestTime;
+}
@@ -0,0 +1,91 @@
+#ifndef PROFILETRACKER_H
+#define PROFILETRACKER_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+class TestCase;
+class TestProgram;
+class TestSuite;
+
+// slowest tests, suites & programs of the current run, kept up to date as each
+// program's results come in
+//
+// only the top K of each are kept (in bounded min-heaps, so each result costs
+// O(log K) whatever the size of the run), along with the total time of all
+// tests, suites & programs seen, for each entry's share of the total.
+//
+// times are those reported by the test framework (seconds). A suite or program
+// that doesn't report its own time is credited with the sum of its parts (for
+// programs, their process lifetime is preferred when known).
+//
+// tests that report CPU time (BenchmarkResult::CpuTime results, e.g. Google
+// Benchmark's 'cpu_time') are also ranked by it, summed over their measured
+// (non-aggregate) runs.
+class ProfileTracker {
+
+    // ctor & dtor
+    public:
+        explicit ProfileTracker(int capacity = 50);
+        ~ProfileTracker(void);
+
+    // ProfileTracker interface
+    public:
+
+        struct Entry {
+            QString      name;     // 'suite.test', 'suite' or 'program'
+            qreal        time;     // seconds
+            qreal        cpuTime;  // seconds, -1 if not reported (tests only)
+            TestProgram* program;  // copy, not owned
+            TestSuite*   suite;    // copy, not owned, 0 for programs
+            TestCase*    test;     // copy, not owned, 0 for suites & programs
+
+            Entry(void);
+        };
+
+        // K, entries kept for each kind
+        int capacity(void) const;
+        void setCapacity(int capacity); // drops all entries
+
+        // results
+        void addProgram(TestProgram* program); // call once per program per run
+        void clear(void);
+
+        // slowest first, at most capacity() of each
+        QList<Entry> slowestTests(void) const;
+        QList<Entry> slowestSuites(void) const;
+        QList<Entry> slowestPrograms(void) const;
+        QList<Entry> mostCpuTests(void) const;  // tests w/ a CPU time only
+
+        // totals over everything seen (not just the top K)
+        qreal totalTestTime(void) const;    // seconds
+        qreal totalSuiteTime(void) const;   // seconds
+        qreal totalProgramTime(void) const; // seconds
+        qreal totalCpuTime(void) const;     // seconds
+        int testCount(void) const;          // timed tests
+        int cpuTestCount(void) const;       // tests w/ a CPU time
+        int programCount(void) const;
+
+    // internal methods
+    private:
+        typedef bool (*EntryOrder)(const Entry& lhs, const Entry& rhs);
+        void offer(QVector<Entry>* heap, const Entry& entry, EntryOrder isBefore) const;
+        static QList<Entry> sorted(const QVector<Entry>& heap, EntryOrder isBefore);
+
+    // data members
+    private:
+        int m_capacity;
+        QVector<Entry> m_tests;     // min-heaps, fastest of the top K at the front
+        QVector<Entry> m_suites;
+        QVector<Entry> m_programs;
+        QVector<Entry> m_cpuTests;  // by CPU time
+        qreal m_totalTestTime;
+        qreal m_totalSuiteTime;
+        qreal m_totalProgramTime;
+        qreal m_totalCpuTime;
+        int   m_testCount;
+        int   m_cpuTestCount;
+        int   m_programCount;
+};
+
+#endif // PROFILETRACKER_H
@@ -0,0 +1,197 @@
+#include "profileview.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testsuite.h"
+#include <QtGui>
+#include <QtDebug>
+
+namespace Constants {
+
+    // item data, pointing back at each entry's test, suite & program
+    enum { TestRole = Qt::UserRole
+         , SuiteRole
+         , ProgramRole
+         };
+
+    // columns
+    enum { NameColumn = 0
+         , ProgramColumn
+         , TimeColumn
+         , CpuTimeColumn
+         , ShareColumn
+         };
+
+} // namespace Constants
+
+// returns a table for one kind of entry
+static
+QTreeWidget* createTable(bool hasProgramColumn, bool hasCpuTimeColumn) {
+    QTreeWidget* table = new QTreeWidget;
+    table->setRootIsDecorated(false);
+    table->setUniformRowHeights(true);
+    table->setAlternatingRowColors(true);
+    table->setHeaderLabels( QStringList() << "Name" << "Program" << "Time (s)" << "CPU time (s)" << "% of total" );
+    table->setColumnHidden(Constants::ProgramColumn, !hasProgramColumn);
+    table->setColumnHidden(Constants::CpuTimeColumn, !hasCpuTimeColumn);
+    return table;
+}
+
+// ----------------------------
+// ProfileView implementation
+// ----------------------------
+
+ProfileView::ProfileView(QWidget* parent)
+    : QWidget(parent)
+    , m_summaryLabel(new QLabel(""))
+    , m_tabs(new QTabWidget)
+    , m_testTable(createTable(true, true))
+    , m_suiteTable(createTable(true, false))
+    , m_programTable(createTable(false, false))
+    , m_cpuTable(createTable(true, true))
+    , m_isStale(false)
+{
+    m_tabs->addTab(m_testTable,    "Slowest tests");
+    m_tabs->addTab(m_suiteTable,   "Slowest suites");
+    m_tabs->addTab(m_programTable, "Slowest programs");
+    m_tabs->addTab(m_cpuTable,     "Most CPU time");
+
+    QVBoxLayout* layout = new QVBoxLayout;
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_summaryLabel);
+    layout->addWidget(m_tabs, 1);
+    setLayout(layout);
+
+    connect(m_testTable,    SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)),
+            this,           SLOT(onCurrentItemChanged(QTreeWidgetItem*)));
+    connect(m_suiteTable,   SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)),
+            this,           SLOT(onCurrentItemChanged(QTreeWidgetItem*)));
+    connect(m_programTable, SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)),
+            this,           SLOT(onCurrentItemChanged(QTreeWidgetItem*)));
+    connect(m_cpuTable,     SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)),
+            this,           SLOT(onCurrentItemChanged(QTreeWidgetItem*)));
+}
+
+ProfileView::~ProfileView(void) { }
+
+void ProfileView::clear(void) {
+    m_tracker.clear();
+    m_testTable->clear();
+    m_suiteTable->clear();
+    m_programTable->clear();
+    m_cpuTable->clear();
+    m_summaryLabel->clear();
+    m_isStale = false;
+}
+
+void ProfileView::onCurrentItemChanged(QTreeWidgetItem* current) {
+
+    if ( current == 0 )
+        return;
+
+    // most specific thing the entry is about
+    TestCase* test = current->data(Constants::NameColumn, Constants::TestRole).value<TestCase*>();
+    TestSuite* suite = current->data(Constants::NameColumn, Constants::SuiteRole).value<TestSuite*>();
+    TestProgram* program = current->data(Constants::NameColumn, Constants::ProgramRole).value<TestProgram*>();
+    if ( test )
+        emit testCaseSelected(test);
+    else if ( suite )
+        emit testSuiteSelected(suite);
+    else if ( program )
+        emit testProgramSelected(program);
+}
+
+void ProfileView::onListTestsStarted(void) {
+    // (our entries point into programs about to be deleted)
+    clear();
+}
+
+void ProfileView::onRunTestsStarted(void) {
+    clear();
+}
+
+void ProfileView::onTestResultsBatchReady(const QList<TestProgram*>& programs) {
+
+    foreach ( TestProgram* program, programs )
+        m_tracker.addProgram(program);
+
+    // tables are rebuilt when next shown
+    if ( isVisible() )
+        refresh();
+    else
+        m_isStale = true;
+}
+
+void ProfileView::refresh(void) {
+
+    m_isStale = false;
+    showEntries(m_testTable,    m_tracker.slowestTests(),    m_tracker.totalTestTime());
+    showEntries(m_suiteTable,   m_tracker.slowestSuites(),   m_tracker.totalSuiteTime());
+    showEntries(m_programTable, m_tracker.slowestPrograms(), m_tracker.totalProgramTime());
+    showEntries(m_cpuTable,     m_tracker.mostCpuTests(),    m_tracker.totalCpuTime(), true);
+
+    QString summary = QString("%1 tests: %2 s, %3 programs: %4 s")
+                          .arg(m_tracker.testCount())
+                          .arg(m_tracker.totalTestTime(), 0, 'f', 3)
+                          .arg(m_tracker.programCount())
+                          .arg(m_tracker.totalProgramTime(), 0, 'f', 3);
+    if ( m_tracker.cpuTestCount() > 0 )
+        summary.append( QString(", %1 tests w/ CPU time: %2 s")
+                            .arg(m_tracker.cpuTestCount())
+                            .arg(m_tracker.totalCpuTime(), 0, 'f', 3) );
+    m_summaryLabel->setText(summary);
+}
+
+void ProfileView::showEntries(QTreeWidget* table,
+                              const QList<ProfileTracker::Entry>& entries,
+                              qreal totalTime,
+                              bool isByCpuTime)
+{
+    Q_ASSERT_X(table, Q_FUNC_INFO, "null table");
+
+    // keep current entry's selection (without re-announcing it)
+    QTreeWidgetItem* currentItem = table->currentItem();
+    const QString currentName = ( currentItem ? currentItem->text(Constants::NameColumn) : QString() );
+    const QString currentProgram = ( currentItem ? currentItem->text(Constants::ProgramColumn) : QString() );
+
+    table->blockSignals(true);
+    table->clear();
+    QList<QTreeWidgetItem*> items;
+    QTreeWidgetItem* newCurrentItem = 0;
+    foreach ( const ProfileTracker::Entry& entry, entries ) {
+        const QString programName = entry.program->programName();
+        const qreal rankedTime = ( isByCpuTime ? entry.cpuTime : entry.time );
+        const qreal share = ( totalTime > 0.0 ? 100.0 * rankedTime / totalTime : 0.0 );
+
+        QTreeWidgetItem* item = new QTreeWidgetItem;
+        item->setText(Constants::NameColumn,    entry.name);
+        item->setText(Constants::ProgramColumn, programName);
+        item->setText(Constants::TimeColumn,    QString::number(entry.time, 'f', 3));
+        if ( entry.cpuTime >= 0.0 )
+            item->setText(Constants::CpuTimeColumn, QString::number(entry.cpuTime, 'f', 3));
+        item->setText(Constants::ShareColumn,   QString::number(share, 'f', 1));
+        item->setTextAlignment(Constants::TimeColumn,    Qt::AlignRight | Qt::AlignVCenter);
+        item->setTextAlignment(Constants::CpuTimeColumn, Qt::AlignRight | Qt::AlignVCenter);
+        item->setTextAlignment(Constants::ShareColumn,   Qt::AlignRight | Qt::AlignVCenter);
+        item->setData(Constants::NameColumn, Constants::TestRole,    QVariant::fromValue(entry.test));
+        item->setData(Constants::NameColumn, Constants::SuiteRole,   QVariant::fromValue(entry.suite));
+        item->setData(Constants::NameColumn, Constants::ProgramRole, QVariant::fromValue(entry.program));
+        items.append(item);
+
+        if ( !currentName.isEmpty() && entry.name == currentName && programName == currentProgram )
+            newCurrentItem = item;
+    }
+    table->addTopLevelItems(items);
+    if ( newCurrentItem )
+        table->setCurrentItem(newCurrentItem);
+    table->blockSignals(false);
+}
+
+void ProfileView::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    if ( m_isStale )
+        refresh();
+}
+
+const ProfileTracker& ProfileView::tracker(void) const {
+    return m_tracker;
+}
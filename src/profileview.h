@@ -0,0 +1,71 @@
+#ifndef PROFILEVIEW_H
+#define PROFILEVIEW_H
+
+#include <QList>
+#include <QWidget>
+#include "profiletracker.h"
+class QLabel;
+class QShowEvent;
+class QTabWidget;
+class QTreeWidget;
+class QTreeWidgetItem;
+class TestCase;
+class TestProgram;
+class TestSuite;
+
+// slowest tests, suites & programs of the current run (see ProfileTracker),
+// & tests using the most CPU time (where reported), with each one's share of
+// the total, updated as results come in
+//
+// the tables are only rebuilt while shown (at most once per result batch).
+class ProfileView : public QWidget {
+
+    Q_OBJECT
+
+    // ctor & dtor
+    public:
+        explicit ProfileView(QWidget* parent = 0);
+        ~ProfileView(void);
+
+    // signals
+    signals:
+        void testCaseSelected(TestCase* test);
+        void testSuiteSelected(TestSuite* suite);
+        void testProgramSelected(TestProgram* program);
+
+    // ProfileView interface
+    public slots:
+        void onListTestsStarted(void);
+        void onRunTestsStarted(void);
+        void onTestResultsBatchReady(const QList<TestProgram*>& programs); // see ResultBatcher
+    public:
+        const ProfileTracker& tracker(void) const;
+
+    // QWidget interface
+    protected:
+        void showEvent(QShowEvent* event);
+
+    // internal methods
+    private slots:
+        void onCurrentItemChanged(QTreeWidgetItem* current);
+    private:
+        void clear(void);
+        void refresh(void);
+        void showEntries(QTreeWidget* table,
+                         const QList<ProfileTracker::Entry>& entries,
+                         qreal totalTime,
+                         bool isByCpuTime = false);
+
+    // data members
+    private:
+        ProfileTracker m_tracker;
+        QLabel*      m_summaryLabel;
+        QTabWidget*  m_tabs;
+        QTreeWidget* m_testTable;
+        QTreeWidget* m_suiteTable;
+        QTreeWidget* m_programTable;
+        QTreeWidget* m_cpuTable;
+        bool m_isStale; // results came in while hidden
+};
+
+#endif // PROFILEVIEW_H
@@ -1,54 +1,71 @@
 #include "programfinder.h"
+#include "programtypeselector.h"
+#include "storagepaths.h"
 #include <QtCore>
+#include <QtDebug>
 
-QStringList ProgramFinder::lookupExecutables(const QString& startingDirectory,
-                                             bool shouldRecurse)
-{
-    // for some reason, QFileInfo and friends don't like directory paths
-    // that don't end with a separator
-    QString lookupDirectory = startingDirectory;
-    if ( !lookupDirectory.endsWith(QDir::separator()) )
-        lookupDirectory.append(QDir::separator());
-
-    // skip out early if our path is not a directory
-    const QFileInfo fi(lookupDirectory);
-    if ( !fi.exists() || !fi.isDir() )
-        return QStringList();
-
-    QDir dir = fi.dir();
-    dir.setFilter(QDir::Files | QDir::Executable);
-    QStringList executableFilenames;
-
-    // if we should recurse through all subdirectories
-    if ( shouldRecurse ) {
-        QDirIterator dirIter(dir, QDirIterator::Subdirectories);
-        while ( dirIter.hasNext() ) {
-            dirIter.next();
-            const QFileInfo exe = dirIter.fileInfo();
-            executableFilenames.append( exe.canonicalFilePath() );
+// -----------------------------------
+// DirectoryScanTask implementation
+// -----------------------------------
+
+class DirectoryScanTask : public QRunnable {
+
+    public:
+        DirectoryScanTask(ProgramFinder* finder, const QString& path, int depth)
+            : m_finder(finder)
+            , m_path(path)
+            , m_depth(depth)
+        { }
+
+        void run(void) {
+            m_finder->scanDirectory(m_path, m_depth);
         }
-    }
 
-    // otherwise, look in top level only
-    else {
-        const QFileInfoList exes = dir.entryInfoList();
-        foreach ( const QFileInfo& exe, exes )
-            executableFilenames.append( exe.canonicalFilePath() );
-    }
+    private:
+        ProgramFinder* m_finder;
+        QString m_path;
+        int m_depth;
+};
 
-    // remove all duplicates
-    executableFilenames.removeDuplicates();
+// -------------------------------
+// ProgramFinder implementation
+// -------------------------------
 
-    // attempt to remove libraries
-    // these are picked up as 'executable' by directory scan, but we can eliminate common lib types
-    QStringList result;
-    foreach ( const QString& exeFn, executableFilenames ) {
-        if ( !isProbablyLibrary(exeFn) )
-            result.append(exeFn);
-    }
+ProgramFinder::ProgramFinder(QObject* parent)
+    : QObject(parent)
+    , m_threadPool(new QThreadPool(this))
+    , m_isRunning(false)
+    , m_maxDepth(-1)
+    , m_scanDepth(-1)
+    , m_prunedDirectories(defaultPrunedDirectories())
+    , m_usesIndex(true)
+    , m_isCanceled(false)
+{
+    // directory scanning is mostly waiting on (possibly network) I/O,
+    // so use more threads than we have cores
+    m_threadPool->setMaxThreadCount( qMax(4, 2*QThread::idealThreadCount()) );
+
+    qRegisterMetaType< QList<ProgramInfo> >("QList<ProgramInfo>");
+}
 
-    // return our resulting filepaths
-    return result;
+ProgramFinder::~ProgramFinder(void) {
+    cancel();
+    m_threadPool->waitForDone();
+}
+
+void ProgramFinder::cancel(void) {
+    QMutexLocker locker(&m_mutex);
+    m_isCanceled = true;
+}
+
+QStringList ProgramFinder::defaultPrunedDirectories(void) {
+    return QStringList() << ".git" << ".hg" << ".svn"
+                         << "CMakeFiles" << ".deps" << ".libs" << ".obj" << ".moc";
+}
+
+bool ProgramFinder::isCanceled(void) {
+    QMutexLocker locker(&m_mutex);
+    return m_isCanceled;
 }
 
 bool ProgramFinder::isProbablyLibrary(const QString& filepath) {
@@ -70,3 +87,205 @@ bool ProgramFinder::isProbablyLibrary(const QString& filepath) {
     // but we can at least eliminate showing these to the user
     return false;
 }
+
+bool ProgramFinder::isRunning(void) const {
+    return m_isRunning;
+}
+
+int ProgramFinder::maxDepth(void) const {
+    return m_maxDepth;
+}
+
+void ProgramFinder::onScanFinished(void) {
+
+    // store results for next time (unless canceled, since the index would be incomplete)
+    if ( m_usesIndex && !isCanceled() ) {
+        const bool isFullScan = ( m_scanDepth < 0 );
+        m_index.end(isFullScan);
+    }
+
+    m_isRunning = false;
+    emit finished();
+}
+
+QStringList ProgramFinder::prunedDirectories(void) const {
+    return m_prunedDirectories;
+}
+
+void ProgramFinder::queueDirectory(const QString& path, int depth) {
+    m_pendingDirectoryCount.ref();
+    m_threadPool->start( new DirectoryScanTask(this, path, depth) );
+}
+
+void ProgramFinder::queueSubdirectory(const QString& path, const QString& name, int depth) {
+
+    // skip if too deep, or pruned
+    if ( m_scanDepth >= 0 && depth >= m_scanDepth )
+        return;
+    if ( QDir::match(m_prunedDirectories, name) )
+        return;
+
+    // otherwise queue it
+    queueDirectory(path + QLatin1Char('/') + name, depth+1);
+}
+
+bool ProgramFinder::reportFile(const DiscoveryIndex::File& file, QList<ProgramInfo>* programs) {
+
+    // skip non-test programs
+    if ( file.type == ProgramInfo::Unknown )
+        return false;
+
+    // make sure each program is only reported once
+    {
+        QMutexLocker locker(&m_mutex);
+        if ( m_seenFilepaths.contains(file.filepath) )
+            return false;
+        m_seenFilepaths.insert(file.filepath);
+    }
+
+    programs->append( ProgramInfo(file.filepath, file.type) );
+    return true;
+}
+
+void ProgramFinder::scanDirectory(const QString& path, int depth) {
+
+    QList<ProgramInfo> programs;
+
+    // skip the actual work if scan was canceled
+    // (but still fall through to the bookkeeping below)
+    if ( !isCanceled() ) {
+
+        const qint64 mtime = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+
+        // fetch entry from previous scan, if any
+        DiscoveryIndex::Directory previous;
+        const bool hasPrevious = m_usesIndex && m_index.previousDirectory(path, &previous);
+
+        // if directory unchanged since last scan, reuse its entry (no need to list its contents)
+        if ( hasPrevious && previous.mtime >= 0 && previous.mtime == mtime ) {
+            foreach ( const QString& name, previous.subdirectories )
+                queueSubdirectory(path, name, depth);
+            foreach ( const DiscoveryIndex::File& file, previous.files )
+                reportFile(file, &programs);
+            m_index.insertDirectory(path, previous);
+        }
+
+        // otherwise, list subdirectories & executable files
+        else {
+
+            // files from previous scan, so unchanged files don't need re-classifying
+            QHash<QString, DiscoveryIndex::File> previousFiles;
+            foreach ( const DiscoveryIndex::File& file, previous.files )
+                previousFiles.insert(file.filepath, file);
+
+            DiscoveryIndex::Directory current;
+            current.mtime = mtime;
+
+            const QDir dir(path);
+            const QFileInfoList entries = dir.entryInfoList(QDir::AllDirs | QDir::Files |
+                                                            QDir::Executable | QDir::NoDotAndDotDot);
+            foreach ( const QFileInfo& fi, entries ) {
+
+                // subdirectory
+                // (symlinked dirs are not followed, to avoid cycles & double-counting)
+                if ( fi.isDir() ) {
+                    if ( fi.isSymLink() )
+                        continue;
+                    current.subdirectories.append(fi.fileName());
+                    queueSubdirectory(path, fi.fileName(), depth);
+                }
+
+                // executable file
+                else {
+
+                    // resolve symlinks so we only report each program once
+                    // (the starting directory is canonical, so other paths already are)
+                    DiscoveryIndex::File file;
+                    file.filepath = ( fi.isSymLink() ? fi.canonicalFilePath() : fi.absoluteFilePath() );
+                    if ( file.filepath.isEmpty() || isProbablyLibrary(file.filepath) )
+                        continue;
+                    file.mtime = fi.lastModified().toMSecsSinceEpoch();
+                    file.size  = fi.size();
+
+                    // classify file, unless unchanged since last scan
+                    const QHash<QString, DiscoveryIndex::File>::const_iterator found = previousFiles.constFind(file.filepath);
+                    if ( found != previousFiles.constEnd() &&
+                         found->mtime == file.mtime &&
+                         found->size  == file.size )
+                    {
+                        file.type = found->type;
+                    }
+                    else
+                        file.type = ProgramTypeSelector::infoForFile(file.filepath).type;
+
+                    // store & report
+                    current.files.append(file);
+                    reportFile(file, &programs);
+                }
+            }
+
+            if ( m_usesIndex )
+                m_index.insertDirectory(path, current);
+        }
+
+        // report this directory's programs
+        if ( !programs.isEmpty() )
+            emit programsFound(programs);
+    }
+
+    // if this was the last pending directory, the scan is complete
+    // (posted to our own thread, so it arrives after all programsFound() signals)
+    if ( !m_pendingDirectoryCount.deref() )
+        QMetaObject::invokeMethod(this, "onScanFinished", Qt::QueuedConnection);
+}
+
+void ProgramFinder::setMaxDepth(int depth) {
+    if ( !m_isRunning )
+        m_maxDepth = depth;
+}
+
+void ProgramFinder::setPrunedDirectories(const QStringList& patterns) {
+    if ( !m_isRunning )
+        m_prunedDirectories = patterns;
+}
+
+void ProgramFinder::setUsesIndex(bool ok) {
+    if ( !m_isRunning )
+        m_usesIndex = ok;
+}
+
+void ProgramFinder::start(const QString& startingDirectory, bool shouldRecurse) {
+
+    // skip if a scan is still in progress
+    if ( m_isRunning )
+        return;
+
+    // reset scan state
+    {
+        QMutexLocker locker(&m_mutex);
+        m_isCanceled = false;
+        m_seenFilepaths.clear();
+    }
+    m_pendingDirectoryCount.fetchAndStoreOrdered(0);
+    m_scanDepth = ( shouldRecurse ? m_maxDepth : 0 );
+    m_isRunning = true;
+
+    // if our path is not a directory, finish (asynchronously, like a normal scan)
+    const QFileInfo fi(startingDirectory);
+    const QString lookupDirectory = fi.canonicalFilePath();
+    if ( lookupDirectory.isEmpty() || !fi.isDir() ) {
+        QMetaObject::invokeMethod(this, "onScanFinished", Qt::QueuedConnection);
+        return;
+    }
+
+    // load index from previous scan
+    if ( m_usesIndex )
+        m_index.begin( StoragePaths::fileForRoot("index", lookupDirectory, "idx") );
+
+    // start scan at top-level directory
+    queueDirectory(lookupDirectory, 0);
+}
+
+bool ProgramFinder::usesIndex(void) const {
+    return m_usesIndex;
+}
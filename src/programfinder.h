@@ -1,14 +1,83 @@
 #ifndef PROGRAMFINDER_H
 #define PROGRAMFINDER_H
 
+#include "discoveryindex.h"
+#include "programinfo.h"
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
 #include <QStringList>
+class QThreadPool;
 
-class ProgramFinder {
+// scans a directory tree for test programs, using a pool of worker threads
+// (subdirectories are scanned in parallel & found programs are reported as
+// each directory is finished, not just at the end of the scan)
+class ProgramFinder : public QObject {
 
+    Q_OBJECT
+
+    // ctor & dtor
+    public:
+        explicit ProgramFinder(QObject* parent = 0);
+        ~ProgramFinder(void);
+
+    // signals
+    signals:
+        void programsFound(const QList<ProgramInfo>& programs); // may be emitted many times per scan
+        void finished(void);
+
+    // ProgramFinder interface
+    public slots:
+        void start(const QString& startingDirectory, bool shouldRecurse = true);
+        void cancel(void);
     public:
-        static QStringList lookupExecutables(const QString& startingDirectory,
-                                             bool shouldRecurse = true);
+        bool isRunning(void) const;
+
+        // max subdirectory depth to descend (-1 = unlimited)
+        int maxDepth(void) const;
+        void setMaxDepth(int depth);
+
+        // directory names (wildcards allowed) that are never descended into
+        QStringList prunedDirectories(void) const;
+        void setPrunedDirectories(const QStringList& patterns);
+        static QStringList defaultPrunedDirectories(void);
+
+        // reuse results from the previous scan of the same directory (default: true)
+        bool usesIndex(void) const;
+        void setUsesIndex(bool ok);
+
         static bool isProbablyLibrary(const QString& filepath);
+
+    // internal methods
+    private slots:
+        void onScanFinished(void);
+    private:
+        friend class DirectoryScanTask;
+        bool isCanceled(void);
+        void queueDirectory(const QString& path, int depth);
+        void queueSubdirectory(const QString& path, const QString& name, int depth);
+        bool reportFile(const DiscoveryIndex::File& file, QList<ProgramInfo>* programs);
+        void scanDirectory(const QString& path, int depth);
+
+    // data members
+    private:
+        QThreadPool* m_threadPool;
+        QAtomicInt   m_pendingDirectoryCount;
+        bool         m_isRunning;
+
+        // scan settings (not modified while a scan is running)
+        int         m_maxDepth;
+        int         m_scanDepth;
+        QStringList m_prunedDirectories;
+        bool        m_usesIndex;
+
+        // shared by worker threads
+        DiscoveryIndex m_index;
+        QMutex        m_mutex;
+        bool          m_isCanceled;
+        QSet<QString> m_seenFilepaths;
 };
 
 #endif // PROGRAMFINDER_H
@@ -1,6 +1,8 @@
 #ifndef PROGRAMINFO_H
 #define PROGRAMINFO_H
 
+#include <QList>
+#include <QMetaType>
 #include <QString>
 
 struct ProgramInfo {
@@ -9,6 +11,7 @@ struct ProgramInfo {
     enum ProgramType { Unknown = 0
                      , GoogleTest
                      , QtTestLib
+                     , GoogleBenchmark
                      };
 
     // data members
@@ -30,5 +33,9 @@ struct ProgramInfo {
     ~ProgramInfo(void) { }
 };
 
+Q_DECLARE_METATYPE(ProgramInfo)
+#if QT_VERSION < 0x050000
+Q_DECLARE_METATYPE(QList<ProgramInfo>)
+#endif
 
 #endif // PROGRAMINFO_H
@@ -1,6 +1,89 @@
 #include "programtypeselector.h"
+#include "elfinspector.h"
+#include <QtConcurrentMap>
 #include <QtCore>
 #include <QtDebug>
+#ifdef Q_OS_UNIX
+#  include <sys/stat.h>
+#endif
+
+// -----------------------------------------------------
+// classification cache (keyed by device & inode, so
+// hard links & symlinks to the same binary share entries)
+// -----------------------------------------------------
+
+struct FileIdentity {
+    quint64 device;
+    quint64 inode;
+    QString path;   // only used where inodes are unavailable
+
+    bool operator==(const FileIdentity& other) const {
+        return device == other.device && inode == other.inode && path == other.path;
+    }
+};
+
+static inline
+uint qHash(const FileIdentity& id) {
+    return ::qHash(id.inode) ^ ::qHash(id.device) ^ ::qHash(id.path);
+}
+
+struct FileVersion {
+    qint64 mtime;
+    qint64 size;
+};
+
+struct CacheEntry {
+    FileVersion version;
+    ProgramInfo::ProgramType type;
+};
+
+struct ClassificationCache {
+    QMutex mutex;
+    QHash<FileIdentity, CacheEntry> entries;
+};
+
+Q_GLOBAL_STATIC(ClassificationCache, classificationCache)
+
+static
+bool fileIdentity(const QString& filepath, FileIdentity* id, FileVersion* version) {
+
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if ( ::stat(QFile::encodeName(filepath).constData(), &st) != 0 )
+        return false;
+    id->device = quint64(st.st_dev);
+    id->inode  = quint64(st.st_ino);
+    version->mtime = qint64(st.st_mtime);
+    version->size  = qint64(st.st_size);
+#else
+    const QFileInfo fi(filepath);
+    if ( !fi.exists() )
+        return false;
+    id->device = 0;
+    id->inode  = 0;
+    id->path   = fi.absoluteFilePath();
+    version->mtime = qint64(fi.lastModified().toTime_t());
+    version->size  = fi.size();
+#endif
+    return true;
+}
+
+// -----------------------------------------------------
+// filename-based detection (fallback for scripts, non-ELF
+// platforms, & statically-linked, stripped binaries)
+// -----------------------------------------------------
+
+static
+bool isGBench(const QString& filename) {
+
+    static const QStringList gbenchPrefixes = QStringList() << "gbench_" << "gbm_";
+
+    foreach ( const QString& gbenchPrefix, gbenchPrefixes ) {
+        if ( filename.startsWith(gbenchPrefix) )
+            return true;
+    }
+    return false;
+}
 
 static
 bool isGTest(const QString& filename) {
@@ -27,22 +110,111 @@ bool isQTest(const QString& filename) {
     return false;
 }
 
+static
+ProgramInfo::ProgramType typeFromFilename(const QString& filepath) {
+    const QString& fn = QFileInfo(filepath).fileName();
+    if      ( isGTest(fn) )  return ProgramInfo::GoogleTest;
+    else if ( isQTest(fn) )  return ProgramInfo::QtTestLib;
+    else if ( isGBench(fn) ) return ProgramInfo::GoogleBenchmark;
+    else
+        return ProgramInfo::Unknown;
+}
+
+// -----------------------------------------------------
+// ELF-based detection
+// -----------------------------------------------------
+
+static
+bool hasLibraryWithPrefix(const QStringList& libraries, const QStringList& prefixes) {
+    foreach ( const QString& lib, libraries ) {
+        foreach ( const QString& prefix, prefixes ) {
+            if ( lib.startsWith(prefix) )
+                return true;
+        }
+    }
+    return false;
+}
+
+static
+ProgramInfo::ProgramType typeFromElf(const QString& filepath) {
+
+    // test main() entry points (testing::UnitTest::Run(), QTest::qExec(), & benchmark::RunSpecifiedBenchmarks())
+    static const QList<QByteArray> gtestEntrySymbols  = QList<QByteArray>() << "_ZN7testing8UnitTest3RunEv";
+    static const QList<QByteArray> qtestEntrySymbols  = QList<QByteArray>() << "_ZN5QTest5qExec";
+    static const QList<QByteArray> gbenchEntrySymbols = QList<QByteArray>() << "_ZN9benchmark22RunSpecifiedBenchmarks";
+
+    // framework libraries
+    static const QStringList gtestLibraries = QStringList() << "libgtest" << "libgmock";
+    static const QStringList qtestLibraries = QStringList() << "libQtTest" << "libQt5Test" << "libQt6Test";
+    static const QStringList gbenchLibraries = QStringList() << "libbenchmark";
+
+    // skip files that we can't read as ELF
+    ElfInspector elf(filepath);
+    if ( !elf.isValid() )
+        return typeFromFilename(filepath);
+
+    // shared libraries are never test programs, regardless of name
+    if ( !elf.isExecutable() )
+        return ProgramInfo::Unknown;
+
+    // check for framework entry points
+    // (a GoogleTest program may still use some QtTest helpers, so check it first)
+    if ( elf.hasSymbolWithPrefix(gtestEntrySymbols) ) return ProgramInfo::GoogleTest;
+    if ( elf.hasSymbolWithPrefix(qtestEntrySymbols) ) return ProgramInfo::QtTestLib;
+    if ( elf.hasSymbolWithPrefix(gbenchEntrySymbols) ) return ProgramInfo::GoogleBenchmark;
+
+    // check for framework libraries
+    const QStringList libraries = elf.neededLibraries();
+    if ( hasLibraryWithPrefix(libraries, gtestLibraries) ) return ProgramInfo::GoogleTest;
+    if ( hasLibraryWithPrefix(libraries, qtestLibraries) ) return ProgramInfo::QtTestLib;
+    if ( hasLibraryWithPrefix(libraries, gbenchLibraries) ) return ProgramInfo::GoogleBenchmark;
+
+    // no signatures found (e.g. statically-linked & stripped), fall back to name
+    return typeFromFilename(filepath);
+}
+
+// -------------------------------------
+// ProgramTypeSelector implementation
+// -------------------------------------
+
 QList<ProgramInfo> ProgramTypeSelector::getInfo(const QStringList& filepaths) {
+    return QtConcurrent::blockingMapped< QList<ProgramInfo> >(filepaths, &ProgramTypeSelector::infoForFile);
+}
 
-    QList<ProgramInfo> programInfoList;
-    programInfoList.reserve(filepaths.size());
+ProgramInfo ProgramTypeSelector::infoForFile(const QString& filepath) {
 
-    foreach ( const QString& filepath, filepaths ) {
+    ProgramInfo info(filepath);
 
-        ProgramInfo info(filepath);
-        const QString& fn = QFileInfo(filepath).fileName();
-        if      ( isGTest(fn) ) info.type = ProgramInfo::GoogleTest;
-        else if ( isQTest(fn) ) info.type = ProgramInfo::QtTestLib;
-        else
-            info.type = ProgramInfo::Unknown;
+    // if we can't identify the file, classify by name only
+    FileIdentity id;
+    FileVersion version;
+    if ( !fileIdentity(filepath, &id, &version) ) {
+        info.type = typeFromFilename(filepath);
+        return info;
+    }
 
-        programInfoList.append(info);
+    // check cache for up-to-date entry
+    ClassificationCache* cache = classificationCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        QHash<FileIdentity, CacheEntry>::const_iterator found = cache->entries.constFind(id);
+        if ( found != cache->entries.constEnd() &&
+             found->version.mtime == version.mtime &&
+             found->version.size  == version.size )
+        {
+            info.type = found->type;
+            return info;
+        }
     }
 
-    return programInfoList;
+    // otherwise inspect file (outside of lock) & store result
+    info.type = typeFromElf(filepath);
+    CacheEntry entry;
+    entry.version = version;
+    entry.type    = info.type;
+    {
+        QMutexLocker locker(&cache->mutex);
+        cache->entries.insert(id, entry);
+    }
+    return info;
 }
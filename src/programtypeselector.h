@@ -6,7 +6,11 @@
 
 class ProgramTypeSelector {
     public:
+        // classifies files in parallel
         static QList<ProgramInfo> getInfo(const QStringList& filepaths);
+
+        // classifies a single file (thread-safe, results cached by inode & mtime)
+        static ProgramInfo infoForFile(const QString& filepath);
 };
 
 #endif // PROGRAMTYPESELECTOR_H
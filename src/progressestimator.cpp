@@ -0,0 +1,216 @@
+#include "progressestimator.h"
+#include "historystore.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+
+    // expected time of each test, if no test has any history (any unit will do)
+    const qreal DefaultTestTime = 1.0;   // seconds
+
+    // smallest expected time of a program, so each one counts for something
+    const qreal MinProgramTime = 0.01;   // seconds
+
+    // most of its expected time a running program is credited with
+    const qreal MaxRunningShare = 0.95;
+
+    // bounds on how much slower (or faster) than expected programs are running
+    const qreal MinSpeedRatio = 0.1;
+    const qreal MaxSpeedRatio = 10.0;
+
+} // namespace Constants
+
+// ---------------------------------------------------
+// ProgressEstimator::ProgramProgress implementation
+// ---------------------------------------------------
+
+ProgressEstimator::ProgramProgress::ProgramProgress(void)
+    : expectedTime(0.0)
+    , finishedTestTime(0.0)
+    , isStarted(false)
+    , isFinished(false)
+{ }
+
+// ----------------------------------
+// ProgressEstimator implementation
+// ----------------------------------
+
+ProgressEstimator::ProgressEstimator(void)
+    : m_expectedTime(0.0)
+    , m_finishedExpectedTime(0.0)
+    , m_finishedActualTime(0.0)
+    , m_maxConcurrentPrograms(1)
+{ }
+
+ProgressEstimator::~ProgressEstimator(void) { }
+
+qreal ProgressEstimator::completedTime(void) const {
+    qreal total = 0.0;
+    QHash<TestProgram*, ProgramProgress>::const_iterator iter = m_programs.constBegin();
+    QHash<TestProgram*, ProgramProgress>::const_iterator end  = m_programs.constEnd();
+    for ( ; iter != end; ++iter )
+        total += programCompletedTime(iter.value());
+    return total;
+}
+
+qreal ProgressEstimator::expectedTime(void) const {
+    return m_expectedTime;
+}
+
+qreal ProgressEstimator::programCompletedTime(const ProgramProgress& progress) const {
+
+    if ( progress.isFinished )
+        return progress.expectedTime;
+    if ( !progress.isStarted )
+        return 0.0;
+
+    // finished tests, or time spent (at the speed seen so far), whichever is further along
+    const qreal elapsed = progress.timer.elapsed() / 1000.0 / speedRatio();
+    const qreal completed = qMax(progress.finishedTestTime, elapsed);
+    return qMin(completed, progress.expectedTime * Constants::MaxRunningShare);
+}
+
+void ProgressEstimator::programFinished(TestProgram* program) {
+
+    QHash<TestProgram*, ProgramProgress>::iterator found = m_programs.find(program);
+    if ( found == m_programs.end() || found->isFinished )
+        return;
+
+    // note actual vs. expected time, for the speed ratio
+    ProgramProgress& progress = found.value();
+    if ( progress.isStarted ) {
+        m_finishedExpectedTime += progress.expectedTime;
+        m_finishedActualTime   += progress.timer.elapsed() / 1000.0;
+    }
+    progress.isFinished = true;
+    progress.testTimes.clear();
+}
+
+void ProgressEstimator::programStarted(TestProgram* program) {
+    QHash<TestProgram*, ProgramProgress>::iterator found = m_programs.find(program);
+    if ( found == m_programs.end() )
+        return;
+    found->isStarted = true;
+    found->timer.start();
+}
+
+qreal ProgressEstimator::remainingTime(void) const {
+
+    if ( m_expectedTime <= 0.0 )
+        return -1.0;
+
+    const qreal completed = completedTime();
+    const qreal remaining = qMax(qreal(0.0), m_expectedTime - completed);
+    const qreal ratio = speedRatio();
+
+    // expected rate: all slots busy (if there's enough left to fill them)
+    int numUnfinished = 0;
+    qreal longestLeft = 0.0;
+    QHash<TestProgram*, ProgramProgress>::const_iterator iter = m_programs.constBegin();
+    QHash<TestProgram*, ProgramProgress>::const_iterator end  = m_programs.constEnd();
+    for ( ; iter != end; ++iter ) {
+        if ( iter->isFinished )
+            continue;
+        ++numUnfinished;
+        longestLeft = qMax(longestLeft, (iter->expectedTime - programCompletedTime(iter.value())) * ratio);
+    }
+    if ( numUnfinished == 0 )
+        return 0.0;
+    const qreal expectedRate = qMin(m_maxConcurrentPrograms, numUnfinished) / ratio;
+
+    // observed rate, trusted more as the run goes on
+    const qreal elapsed = m_runTimer.elapsed() / 1000.0;
+    const qreal observedRate = ( elapsed > 0.0 ? completed / elapsed : 0.0 );
+    const qreal fraction = qBound(qreal(0.0), completed / m_expectedTime, qreal(1.0));
+    const qreal rate = fraction * observedRate + (1.0 - fraction) * expectedRate;
+
+    // a single program can't be split across slots, so the longest one left
+    // is a lower bound
+    const qreal estimate = ( rate > 0.0 ? remaining / rate : longestLeft );
+    return qMax(estimate, longestLeft);
+}
+
+qreal ProgressEstimator::speedRatio(void) const {
+    if ( m_finishedExpectedTime <= 0.0 || m_finishedActualTime <= 0.0 )
+        return 1.0;
+    return qBound(Constants::MinSpeedRatio,
+                  m_finishedActualTime / m_finishedExpectedTime,
+                  Constants::MaxSpeedRatio);
+}
+
+void ProgressEstimator::start(const QList<TestProgram*>& programs,
+                              const HistoryStore* history,
+                              int maxConcurrentPrograms)
+{
+    m_programs.clear();
+    m_expectedTime = 0.0;
+    m_finishedExpectedTime = 0.0;
+    m_finishedActualTime = 0.0;
+    m_maxConcurrentPrograms = qMax(1, maxConcurrentPrograms);
+    m_runTimer.start();
+
+    // recent times of each program's tests
+    QStringList programNames;
+    foreach ( TestProgram* program, programs )
+        programNames.append( program->fileName() );
+    QHash<QString, HistoryStore::ProgramTimes> recentTimes;
+    if ( history && history->isOpen() )
+        recentTimes = history->recentTimes(programNames);
+
+    // tests without history are expected to take as long as the average known test
+    qreal knownTotal = 0.0;
+    int numKnown = 0;
+    QHash<QString, HistoryStore::ProgramTimes>::const_iterator timesIter = recentTimes.constBegin();
+    QHash<QString, HistoryStore::ProgramTimes>::const_iterator timesEnd  = recentTimes.constEnd();
+    for ( ; timesIter != timesEnd; ++timesIter ) {
+        foreach ( qreal time, timesIter->testTimes ) {
+            knownTotal += time;
+            ++numKnown;
+        }
+    }
+    const qreal defaultTestTime = ( numKnown > 0 ? knownTotal / numKnown : Constants::DefaultTestTime );
+
+    // expected time of each program's enabled tests, plus its usual overhead
+    foreach ( TestProgram* program, programs ) {
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        const HistoryStore::ProgramTimes times = recentTimes.value( program->fileName() );
+        ProgramProgress& progress = m_programs[program];
+
+        const int numSuites = program->suiteCount();
+        for ( int i = 0; i < numSuites; ++i ) {
+            const TestSuite* suite = program->suiteAt(i);
+            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+            const int numTests = suite->testCount();
+            for ( int j = 0; j < numTests; ++j ) {
+                const TestCase* test = suite->testAt(j);
+                if ( !test->isEnabled() )
+                    continue;
+                const qreal time = times.testTimes.value(suite->name() + '\t' + test->name(), defaultTestTime);
+                progress.testTimes.insert(test, time);
+                progress.expectedTime += time;
+            }
+        }
+
+        if ( times.programTime >= 0.0 ) {
+            qreal historyTestTotal = 0.0;
+            foreach ( qreal time, times.testTimes )
+                historyTestTotal += time;
+            progress.expectedTime += qMax(qreal(0.0), times.programTime - historyTestTotal);
+        }
+
+        progress.expectedTime = qMax(progress.expectedTime, Constants::MinProgramTime);
+        m_expectedTime += progress.expectedTime;
+    }
+}
+
+void ProgressEstimator::testFinished(TestProgram* program, TestCase* test) {
+    QHash<TestProgram*, ProgramProgress>::iterator found = m_programs.find(program);
+    if ( found == m_programs.end() || found->isFinished )
+        return;
+
+    // (each test only counts once)
+    found->finishedTestTime += found->testTimes.take(test);
+}
@@ -0,0 +1,75 @@
+#ifndef PROGRESSESTIMATOR_H
+#define PROGRESSESTIMATOR_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+class HistoryStore;
+class TestCase;
+class TestProgram;
+
+// run progress, measured in expected test time rather than finished programs
+//
+// each enabled test is expected to take its mean time over recent runs (see
+// HistoryStore::recentTimes()), or the mean of all known tests if it has no
+// history. A program's expected time is its tests' total, plus its usual
+// start-up & tear-down overhead.
+//
+// a running program is credited with its finished tests (if its output has
+// per-test markers), or else with its elapsed time, but never quite with all
+// of its expected time until it finishes. The remaining time blends the
+// expected rate (all slots busy, at the predicted speed) with the rate seen so
+// far, trusting the latter more as the run goes on.
+class ProgressEstimator {
+
+    // ctor & dtor
+    public:
+        ProgressEstimator(void);
+        ~ProgressEstimator(void);
+
+    // ProgressEstimator interface
+    public:
+
+        // over the course of a run
+        void start(const QList<TestProgram*>& programs,
+                   const HistoryStore* history,
+                   int maxConcurrentPrograms);
+        void programStarted(TestProgram* program);
+        void testFinished(TestProgram* program, TestCase* test);
+        void programFinished(TestProgram* program);
+
+        // progress, in seconds of expected test time
+        qreal expectedTime(void) const;
+        qreal completedTime(void) const;
+
+        // estimated wall time until the run finishes, seconds (-1 if nothing to run)
+        qreal remainingTime(void) const;
+
+    // internal methods
+    private:
+        struct ProgramProgress;
+        qreal programCompletedTime(const ProgramProgress& progress) const;
+        qreal speedRatio(void) const;
+
+    // data members
+    private:
+        struct ProgramProgress {
+            qreal expectedTime;                    // seconds, whole program
+            qreal finishedTestTime;                // expected time of tests finished so far
+            QHash<const TestCase*, qreal> testTimes; // expected time of each unfinished test
+            QElapsedTimer timer;                   // since program started
+            bool isStarted;
+            bool isFinished;
+
+            ProgramProgress(void);
+        };
+
+        QHash<TestProgram*, ProgramProgress> m_programs;
+        QElapsedTimer m_runTimer;
+        qreal m_expectedTime;
+        qreal m_finishedExpectedTime;  // of finished programs
+        qreal m_finishedActualTime;
+        int   m_maxConcurrentPrograms;
+};
+
+#endif // PROGRESSESTIMATOR_H
@@ -1,5 +1,6 @@
 #include "qtestlibprogram.h"
 #include "testcase.h"
+#include "testresultbatch.h"
 #include "testsuite.h"
 #include <QtCore>
 #include <QtDebug>
@@ -10,10 +11,56 @@
 
 QTestLibProgram::QTestLibProgram(const QString& filepath, QObject* parent)
     : TestProgram(filepath, parent)
+    , m_reportsTotals(false)
 { }
 
 QTestLibProgram::~QTestLibProgram(void) { }
 
+QStringList QTestLibProgram::enabledFunctions(void) const {
+
+    // no list needed if everything is enabled
+    if ( enabledTestCount() == totalTestCount() )
+        return QStringList();
+
+    // test functions to run, by name (initTestCase & cleanupTestCase always
+    // run, & can't be asked for)
+    QStringList functions;
+    QSet<QString> seen;
+    const int numSuites = suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        const TestSuite* suite = suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+        if ( !suite->hasEnabledTests() )
+            continue;
+
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests; ++j ) {
+            const TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            const QString& name = test->name();
+            if ( !test->isEnabled() || name == "initTestCase" || name == "cleanupTestCase" )
+                continue;
+            if ( !seen.contains(name) ) {
+                seen.insert(name);
+                functions.append(name);
+            }
+        }
+    }
+
+    // (with only the fixtures selected, there's no way to skip the functions,
+    //  so the program isn't run at all - see hasRunnableTests())
+    return functions;
+}
+
+bool QTestLibProgram::hasRunnableTests(void) const {
+
+    if ( !hasEnabledTests() )
+        return false;
+
+    // fixtures alone would run the whole program
+    return ( enabledTestCount() == totalTestCount() || !enabledFunctions().isEmpty() );
+}
+
 QStringList QTestLibProgram::listingArgs(void) const {
     return QStringList() << "-datatags";
 }
@@ -69,8 +116,9 @@ QMap<QString, QStringList> QTestLibProgram::parseTestListing(QByteArray output,
     return listing;
 }
 
-bool QTestLibProgram::parseTestResults(QStringList* errors) {
+bool QTestLibProgram::parseTestResults(TestResultBatch* batch, QStringList* errors) {
 
+    Q_ASSERT_X(batch, Q_FUNC_INFO, "null result batch");
     Q_ASSERT_X(errors, Q_FUNC_INFO, "null string list");
     errors->clear();
 
@@ -86,10 +134,26 @@ bool QTestLibProgram::parseTestResults(QStringList* errors) {
     //        So I'm calling the readSuiteResult() method to stay consistent w/
     //        the equivalent logic in GoogleTestProgram XML parsing
     m_xml.setDevice(&xmlFile);
-    return readSuiteResult(errors);
+    m_reportsTotals = false;
+    return readSuiteResult(batch, errors);
 }
 
-bool QTestLibProgram::readSuiteResult(QStringList* errors) {
+void QTestLibProgram::readEnvironment(void) {
+
+    Q_ASSERT_X(m_xml.isStartElement() && m_xml.name().toString() == "Environment",
+               Q_FUNC_INFO, "unexpected root element here");
+
+    // Qt 4 reports each benchmark's total over all of its iterations, Qt 5
+    // (& later) reports the per-iteration value (no <Environment> = Qt 5)
+    while ( !m_xml.atEnd() && m_xml.readNextStartElement() ) {
+        if ( m_xml.name().toString() == "QtVersion" )
+            m_reportsTotals = m_xml.readElementText().trimmed().startsWith("4.");
+        else
+            m_xml.skipCurrentElement();
+    }
+}
+
+bool QTestLibProgram::readSuiteResult(TestResultBatch* batch, QStringList* errors) {
 
     // fetch top-level "TestCase" element
     if ( !m_xml.readNextStartElement() || m_xml.name().toString() != "TestCase") {
@@ -100,8 +164,8 @@ bool QTestLibProgram::readSuiteResult(QStringList* errors) {
     // fetch test suite for this element
     const QXmlStreamAttributes& attributes = m_xml.attributes();
     const QString& suiteName = attributes.value("name").toString();
-    TestSuite* suite = suiteForName(suiteName);
-    if ( suite == 0 ) {
+    const int suite = batch->suiteIndex(suiteName);
+    if ( suite < 0 ) {
         errors->append(QString("Could not find test suite listing for ")+suiteName);
         return false;
     }
@@ -109,11 +173,14 @@ bool QTestLibProgram::readSuiteResult(QStringList* errors) {
     // read through "TestFunction" elements within top-level "TestCase"  (testcases in our testsuite)
     while ( !m_xml.atEnd() && m_xml.readNextStartElement() ) {
 
-        // if "TestFunction" element, attempt to parse (ignore other elements)
+        // if "TestFunction" element, attempt to parse (ignore other elements,
+        // besides "Environment" for the Qt version)
         if ( m_xml.name().toString() == "TestFunction" ) {
-            if ( !readTestResult(suite, errors) )
+            if ( !readTestResult(batch, suite, errors) )
                 return false;
-        } else
+        } else if ( m_xml.name().toString() == "Environment" )
+            readEnvironment();
+        else
             m_xml.skipCurrentElement();
 
         // catch any XML reader errors
@@ -127,24 +194,25 @@ bool QTestLibProgram::readSuiteResult(QStringList* errors) {
     return true;
 }
 
-bool QTestLibProgram::readTestResult(TestSuite* suite, QStringList* errors) {
+bool QTestLibProgram::readTestResult(TestResultBatch* batch, int suite, QStringList* errors) {
 
     // sanity check
-    Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+    Q_ASSERT_X(batch, Q_FUNC_INFO, "null result batch");
     Q_ASSERT_X(m_xml.isStartElement() && m_xml.name().toString() == "TestFunction",
                Q_FUNC_INFO, "unexpected root element here");
 
     // fetch test case for this element
     const QXmlStreamAttributes attributes = m_xml.attributes();
     const QString& testName = attributes.value("name").toString();
-    TestCase* test = suite->testForName(testName);
-    if ( test == 0 ) {
+    const int testIndex = batch->testIndex(suite, testName);
+    if ( testIndex < 0 ) {
         errors->append(QString("Could not find test case listing for ")+testName);
         return false;
     }
+    TestResultBatch::TestResult& test = batch->result(suite, testIndex);
 
     // set wasRun flag
-    test->setWasRun(true);
+    test.wasRun = true;
 
     // parse child elements (Incidents, Messages, & Benchmarks) to set other attributes
     while ( !m_xml.atEnd() && m_xml.readNextStartElement() ) {
@@ -152,16 +220,26 @@ bool QTestLibProgram::readTestResult(TestSuite* suite, QStringList* errors) {
         // BenchmarkResult
         if ( m_xml.name().toString() == "BenchmarkResult" ) {
             const QXmlStreamAttributes bmAttr = m_xml.attributes();
-            const QString& valueString = bmAttr.value("value").toString();
-            const QString& iterString  = bmAttr.value("iterations").toString();
+            const QString& valueString  = bmAttr.value("value").toString();
+            const QString& iterString   = bmAttr.value("iterations").toString();
+            const QString& metricString = bmAttr.value("metric").toString();
             if ( !valueString.isEmpty() && !iterString.isEmpty()  ) {
-                const qreal  total      = valueString.toDouble();
-                const qint32 iterations = iterString.toInt();
-                const QString msg = QString("Benchmark : %1 msec per iteration (total: %2, iterations: %3)")
-                        .arg( total / iterations )
-                        .arg( total )
-                        .arg( iterations );
-                test->addBenchmarkMessage(msg);
+                const qreal  value      = valueString.toDouble();
+                const qint64 iterations = qMax(qint64(1), iterString.toLongLong());
+
+                // we store per-iteration values (Qt 4 reports totals, see readEnvironment())
+                BenchmarkResult result;
+                result.metric     = BenchmarkResult::metricFromName(metricString);
+                result.value      = ( m_reportsTotals ? value / iterations : value );
+                result.iterations = iterations;
+                result.dataTag    = bmAttr.value("tag").toString();
+                if ( metricString.compare("WalltimeNanoseconds", Qt::CaseInsensitive) == 0 )
+                    result.unit = "nsecs";
+                else if ( result.metric == BenchmarkResult::OtherMetric )
+                    result.unit = metricString;
+                else
+                    result.unit = BenchmarkResult::defaultUnit(result.metric);
+                test.benchmarkResults.append(result);
             }
             m_xml.skipCurrentElement();
         }
@@ -173,19 +251,19 @@ bool QTestLibProgram::readTestResult(TestSuite* suite, QStringList* errors) {
 
             // pass
             if ( resultType == "pass" ) {
-                test->setPassed(true);
+                test.passed = true;
             }
 
             // fail
             else if ( resultType == "fail" ) {
-                test->setPassed(false);
+                test.passed = false;
 
                 // read failure messages from "Description" element
                 while ( !m_xml.atEnd() && m_xml.readNextStartElement() ) {
                     if ( m_xml.name().toString() == "Description" ) {
                         if ( m_xml.readNext() && m_xml.isCDATA() ) {
                             const QString& msg = m_xml.text().toString();
-                            test->addFailureMessage(msg);
+                            test.failureMessages.append(msg);
                         }
                     } else
                         m_xml.skipCurrentElement();
@@ -212,7 +290,7 @@ bool QTestLibProgram::readTestResult(TestSuite* suite, QStringList* errors) {
                     if ( m_xml.readNext() && m_xml.isCDATA() ) {
                         const QString& contents = m_xml.text().toString();
                         const QString& msg = QString("%1 : %2").arg(msgType).arg(contents);
-                        test->addOtherMessage(msg);
+                        test.otherMessages.append(msg);
                     }
                 } else
                     m_xml.skipCurrentElement();
@@ -236,9 +314,13 @@ bool QTestLibProgram::readTestResult(TestSuite* suite, QStringList* errors) {
     return true;
 }
 
-QStringList QTestLibProgram::runTestArgs(void) const {
+QStringList QTestLibProgram::runTestArgs(QString* error) const {
+    Q_UNUSED(error);
     QStringList args;
     args << "-xml";
     args << "-o" << xmlFilename();
+
+    // only the selected test functions, if not all of them
+    args << enabledFunctions();
     return args;
 }
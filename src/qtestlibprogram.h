@@ -14,24 +14,29 @@ class QTestLibProgram : public TestProgram {
         ~QTestLibProgram(void);
 
     // TestProgram implementation
+    public:
+        bool hasRunnableTests(void) const; // not if only initTestCase/cleanupTestCase are enabled
     protected:
 
         // provide command line args for each run type
         QStringList listingArgs(void) const;
-        QStringList runTestArgs(void) const;
+        QStringList runTestArgs(QString* error) const;
 
         // derived classes should output
         QMap<QString, QStringList> parseTestListing(QByteArray output, QStringList* errors);
-        bool parseTestResults(QStringList* errors);
+        bool parseTestResults(TestResultBatch* batch, QStringList* errors);
 
     // internal methods
     private:
-        bool readSuiteResult(QStringList* errors);
-        bool readTestResult(TestSuite* suite, QStringList* errors);
+        QStringList enabledFunctions(void) const;
+        void readEnvironment(void);
+        bool readSuiteResult(TestResultBatch* batch, QStringList* errors);
+        bool readTestResult(TestResultBatch* batch, int suite, QStringList* errors);
 
     // data members
     private:
         QXmlStreamReader m_xml;
+        bool m_reportsTotals; // benchmark values are totals over all iterations (Qt 4)
 };
 
 #endif // QTESTLIBPROGRAM_H
@@ -0,0 +1,86 @@
+#include "resultbatcher.h"
+#include "runnermetrics.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+
+    const int DefaultBatchInterval = 33; // msecs
+
+} // namespace Constants
+
+// ------------------------------
+// ResultBatcher implementation
+// ------------------------------
+
+ResultBatcher::ResultBatcher(TestRunner* runner, QObject* parent)
+    : QObject(parent)
+    , m_runner(runner)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(Constants::DefaultBatchInterval);
+    connect(m_timer, SIGNAL(timeout()), SLOT(flush()));
+
+    Q_ASSERT_X(m_runner, Q_FUNC_INFO, "null test runner");
+    connect(m_runner, SIGNAL(testResultsReady(TestProgram*)), SLOT(onTestResultsReady(TestProgram*)));
+    connect(m_runner, SIGNAL(runTestsFinishing()), SLOT(flush()));
+    connect(m_runner, SIGNAL(listTestsStarted()), SLOT(discard()));
+}
+
+ResultBatcher::~ResultBatcher(void) { }
+
+void ResultBatcher::discard(void) {
+    m_timer->stop();
+    m_pendingPrograms.clear();
+    m_pendingSet.clear();
+}
+
+void ResultBatcher::flush(void) {
+
+    m_timer->stop();
+    if ( m_pendingPrograms.isEmpty() )
+        return;
+
+    // clear our state before notifying (receivers may re-enter)
+    const QList<TestProgram*> programs = m_pendingPrograms;
+    m_pendingPrograms.clear();
+    m_pendingSet.clear();
+
+    // time the receivers' work (view updates, etc.)
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 start = m_runner->traceTime();
+    emit resultsReady(programs);
+    const QString name = ( programs.size() == 1 ? "update views: " + programs.first()->programName()
+                                                : QString("update views: %1 programs").arg(programs.size()) );
+    m_runner->recordDispatch(name, start, RunnerMetrics::elapsedSeconds(timer));
+}
+
+int ResultBatcher::interval(void) const {
+    return m_timer->interval();
+}
+
+void ResultBatcher::onTestResultsReady(TestProgram* program) {
+
+    // sanity check
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    if ( program == 0 )
+        return;
+
+    // each program once per batch
+    if ( !m_pendingSet.contains(program) ) {
+        m_pendingSet.insert(program);
+        m_pendingPrograms.append(program);
+    }
+
+    // first result since last batch starts the clock
+    if ( !m_timer->isActive() )
+        m_timer->start();
+}
+
+void ResultBatcher::setInterval(int msecs) {
+    m_timer->setInterval( qMax(0, msecs) );
+}
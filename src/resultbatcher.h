@@ -0,0 +1,54 @@
+#ifndef RESULTBATCHER_H
+#define RESULTBATCHER_H
+
+#include <QList>
+#include <QObject>
+#include <QSet>
+class QTimer;
+class TestProgram;
+class TestRunner;
+
+// collects a runner's testResultsReady notifications & passes them on in
+// batches, at most once per interval, so views refresh at a steady frame rate
+// however many programs finish at once
+//
+// pending results are delivered right away when the run finishes (before
+// anyone sees runTestsFinished), & dropped when a new listing starts (their
+// programs are about to be deleted).
+//
+// each batch's delivery (i.e. the view updates) is timed into the runner's
+// dispatch metric & trace (see TestRunner::recordDispatch()).
+class ResultBatcher : public QObject {
+
+    Q_OBJECT
+
+    // ctor & dtor
+    public:
+        explicit ResultBatcher(TestRunner* runner, QObject* parent = 0);
+        ~ResultBatcher(void);
+
+    // signals
+    signals:
+        void resultsReady(const QList<TestProgram*>& programs); // in order of completion
+
+    // ResultBatcher interface
+    public slots:
+        void flush(void);
+    public:
+        int interval(void) const;    // msecs, default: 33 (~30 updates per second)
+        void setInterval(int msecs);
+
+    // internal methods
+    private slots:
+        void discard(void);
+        void onTestResultsReady(TestProgram* program);
+
+    // data members
+    private:
+        TestRunner* m_runner; // copy, not owned
+        QTimer* m_timer;
+        QList<TestProgram*> m_pendingPrograms;
+        QSet<TestProgram*>  m_pendingSet;
+};
+
+#endif // RESULTBATCHER_H
@@ -1,24 +1,129 @@
 #include "resultdetailsview.h"
+#include "historystore.h"
+#include "logview.h"
 #include "testcase.h"
 #include "testprogram.h"
 #include "testsuite.h"
 #include <QtGui>
 #include <QtDebug>
 
+namespace Constants {
+    // failure messages larger than this are only loaded on request
+    enum { MaxMessageBytesLoaded = 1024 * 1024 };
+
+    // most previous runs listed for a test
+    enum { MaxHistoryShown = 10 };
+} // namespace Constants
+
+// returns size as bytes, KB or MB
+static
+QString sizeString(qint64 bytes) {
+    if ( bytes < 1024 )
+        return QString("%1 bytes").arg(bytes);
+    if ( bytes < 1024*1024 )
+        return QString("%1 KB").arg(qreal(bytes)/1024, 0, 'f', 1);
+    return QString("%1 MB").arg(qreal(bytes)/(1024*1024), 0, 'f', 1);
+}
+
+// a range of a program's output log, read straight from its mapping
+class ProgramOutputSource : public LogView::Source {
+
+    public:
+        ProgramOutputSource(const TestProgram* program, qint64 offset, qint64 size)
+            : m_program(program)
+            , m_offset(offset)
+            , m_size(size)
+        { }
+
+        qint64 size(void) const {
+            return m_size;
+        }
+
+        QByteArray read(qint64 offset, qint64 size) const {
+            return m_program->output(m_offset + offset, size);
+        }
+
+    private:
+        const TestProgram* m_program; // copy, not owned
+        qint64 m_offset;
+        qint64 m_size;
+};
+
 // ----------------------------------
 // ResultDetailsView implementation
 // ----------------------------------
 
 ResultDetailsView::ResultDetailsView(QWidget* parent)
-    : QTextEdit(parent)
+    : QWidget(parent)
+    , m_history(0)
+    , m_log(new LogView)
+    , m_findEdit(new QLineEdit)
+    , m_findStatusLabel(new QLabel(""))
+    , m_currentTest(0)
 {
-    // default attributes
-    setReadOnly(true);
+    // log, with find box below
+    m_findEdit->setToolTip("Find in details (Enter: next match, Shift+Enter: previous)");
+    QHBoxLayout* findLayout = new QHBoxLayout;
+    findLayout->setContentsMargins(0, 0, 0, 0);
+    findLayout->addWidget(new QLabel("Find:"));
+    findLayout->addWidget(m_findEdit, 1);
+    findLayout->addWidget(m_findStatusLabel);
+
+    QVBoxLayout* layout = new QVBoxLayout;
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_log, 1);
+    layout->addLayout(findLayout);
+    setLayout(layout);
+
+    QShortcut* findShortcut = new QShortcut(QKeySequence::Find, this);
+    connect(findShortcut, SIGNAL(activated()),          m_findEdit, SLOT(setFocus()));
+    connect(findShortcut, SIGNAL(activated()),          m_findEdit, SLOT(selectAll()));
+    connect(m_findEdit,   SIGNAL(textChanged(QString)), this, SLOT(onFindTextChanged(QString)));
+    connect(m_findEdit,   SIGNAL(returnPressed()),      this, SLOT(findNext()));
+    connect(m_log,        SIGNAL(lineActivated(int)),   this, SLOT(onLineActivated(int)));
 }
 
 ResultDetailsView::~ResultDetailsView(void) { }
 
+void ResultDetailsView::append(const QString& text) {
+    m_log->appendLine(text);
+}
+
+void ResultDetailsView::clear(void) {
+    m_log->clear();
+    m_deferredMessageLines.clear();
+    m_findStatusLabel->clear();
+}
+
+void ResultDetailsView::findNext(void) {
+    const bool backward = QApplication::keyboardModifiers().testFlag(Qt::ShiftModifier);
+    showFindResult( m_log->find(m_findEdit->text(), backward) );
+}
+
+void ResultDetailsView::onFindTextChanged(const QString& text) {
+
+    // search again from the top
+    m_log->clearFind();
+    if ( text.isEmpty() ) {
+        m_findStatusLabel->clear();
+        return;
+    }
+    showFindResult( m_log->find(text) );
+}
+
+void ResultDetailsView::onLineActivated(int index) {
+
+    // load a large failure message, in place
+    if ( m_currentTest == 0 || !m_deferredMessageLines.contains(index) )
+        return;
+    m_loadedMessages.insert( m_deferredMessageLines.value(index) );
+    const int firstLine = m_log->firstVisibleLine();
+    onTestCaseSelected(m_currentTest);
+    m_log->scrollToLine(firstLine);
+}
+
 void ResultDetailsView::onListTestsStarted(void) {
+    m_currentTest = 0;
     setPlainText("Listing tests.");
 }
 
@@ -27,6 +132,7 @@ void ResultDetailsView::onListTestsFinished(void) {
 }
 
 void ResultDetailsView::onRunTestsStarted(void) {
+    m_currentTest = 0;
     setPlainText("Running tests.");
 }
 
@@ -42,6 +148,11 @@ void ResultDetailsView::onTestCaseSelected(TestCase* test) {
     if ( test == 0 )
         return;
 
+    // large messages are loaded again (only) on request, when switching tests
+    if ( test != m_currentTest )
+        m_loadedMessages.clear();
+    m_currentTest = test;
+
     // write test header
     writeHeader(test->name(),
                 test->wasRun(),
@@ -49,34 +160,36 @@ void ResultDetailsView::onTestCaseSelected(TestCase* test) {
                 !test->passed());
 
     // skip out if the test wasn't acutally run
-    if ( !test->wasRun() )
+    if ( !test->wasRun() ) {
+        writeHistory(test);
         return;
+    }
 
     // write any failure messages
-    if ( test->hasFailureMessages() ) {
+    writeFailureMessages(test);
+
+    // write any benchmark results
+    if ( test->hasBenchmarkResults() ) {
 
         append("");
-        append("Failures:");
+        append("Benchmarks: ");
         append("");
 
-        const QStringList& messages = test->failureMessages();
-        foreach ( const QString& msg, messages ) {
-            append(msg);
+        const QList<BenchmarkResult>& benchmarks = test->benchmarkResults();
+        foreach ( const BenchmarkResult& bm, benchmarks ) {
+            append(bm.toString());
             append("");
         }
-    }
-
-    // write any benchmark messages
-    if ( test->hasBenchmarkMessages() ) {
-
-        append("");
-        append("Benchmarks: ");
-        append("");
 
-        const QStringList& benchmarks = test->benchmarkMessages();
-        foreach ( const QString& bm, benchmarks ) {
-            append(bm);
+        // and how they compare to the pinned baseline
+        const QList<BenchmarkComparison>& comparisons = test->benchmarkComparisons();
+        if ( !comparisons.isEmpty() ) {
+            append("Compared to baseline (median of recent runs): ");
             append("");
+            foreach ( const BenchmarkComparison& comparison, comparisons ) {
+                append(comparison.toString());
+                append("");
+            }
         }
     }
 
@@ -93,23 +206,101 @@ void ResultDetailsView::onTestCaseSelected(TestCase* test) {
             append("");
         }
     }
+
+    // write any captured output (read from the program's log as it's shown)
+    if ( test->hasOutput() && test->suite() && test->suite()->program() ) {
+
+        append("");
+        append("Output: ");
+        append("");
+
+        m_log->appendSource( new ProgramOutputSource(test->suite()->program(),
+                                                     test->outputOffset(),
+                                                     test->outputSize()) );
+    }
+
+    // write previous results
+    writeHistory(test);
 }
 
 void ResultDetailsView::onTestSuiteSelected(TestSuite* suite) {
+    m_currentTest = 0;
     if ( suite ) {
         writeHeader(suite->name(),
                     suite->hasRunTests(),
                     suite->time(),
                     suite->hasFailedTests());
+        if ( suite->hasRunTests() )
+            writeRegressionCount(suite->regressedTestCount());
     }
 }
 
 void ResultDetailsView::onTestProgramSelected(TestProgram* program) {
-    if ( program ) {
-        writeHeader(program->programName(),
-                    program->hasRunTests(),
-                    program->time(),
-                    program->hasFailedTests());
+
+    // skip invalid program
+    m_currentTest = 0;
+    if ( program == 0 )
+        return;
+
+    // write program header
+    writeHeader(program->programName(),
+                program->hasRunTests(),
+                program->time(),
+                program->hasFailedTests() || program->hasError());
+    if ( program->hasRunTests() )
+        writeRegressionCount(program->regressedTestCount());
+
+    // write any problem running the program itself
+    if ( program->hasError() ) {
+        append("");
+        append( QString("Error: %1").arg(program->errorString()) );
+    }
+
+    // write captured output (read from the log as it's shown)
+    const qint64 outputSize = program->outputSize();
+    if ( program->hasRunTests() && outputSize > 0 ) {
+
+        append("");
+        append( QString("Output: %1 bytes (%2)").arg(outputSize).arg(program->outputLogFilename()) );
+        append("");
+
+        m_log->appendSource( new ProgramOutputSource(program, 0, outputSize) );
+    }
+}
+
+void ResultDetailsView::setHistoryStore(HistoryStore* history) {
+    m_history = history;
+}
+
+void ResultDetailsView::setPlainText(const QString& text) {
+    clear();
+    m_log->setPlainText(text);
+}
+
+void ResultDetailsView::showFindResult(bool found) {
+    m_findStatusLabel->setText( found ? QString() : QString("Not found") );
+}
+
+void ResultDetailsView::writeFailureMessages(TestCase* test) {
+
+    if ( !test->hasFailureMessages() )
+        return;
+
+    append("");
+    append("Failures:");
+    append("");
+
+    const int numMessages = test->failureMessageCount();
+    for ( int i = 0; i < numMessages; ++i ) {
+
+        // very large message: placeholder, until double-clicked
+        const qint64 size = test->failureMessageSize(i);
+        if ( size > Constants::MaxMessageBytesLoaded && !m_loadedMessages.contains(i) ) {
+            m_deferredMessageLines.insert(m_log->lineCount(), i);
+            append( QString("[%1 failure message - double-click to load]").arg(sizeString(size)) );
+        } else
+            append( test->failureMessage(i) );
+        append("");
     }
 }
 
@@ -144,3 +335,57 @@ void ResultDetailsView::writeHeader(const QString& name,
     failureLine.append( (hasFailures ? QString("yes") : QString("no")) );
     append(failureLine);
 }
+
+void ResultDetailsView::writeHistory(TestCase* test) {
+
+    // skip if no history available
+    if ( m_history == 0 || test->suite() == 0 || test->suite()->program() == 0 )
+        return;
+    const QList<HistoryStore::Sample> samples = m_history->testHistory(test->suite()->program()->fileName(),
+                                                                       test->suite()->name(),
+                                                                       test->name());
+    if ( samples.isEmpty() )
+        return;
+
+    append("");
+    append( QString("History (%1 runs): ").arg(samples.size()) );
+    append("");
+
+    // most recent runs first
+    const int numShown = qMin(samples.size(), int(Constants::MaxHistoryShown));
+    for ( int i = samples.size() - 1; i >= samples.size() - numShown; --i ) {
+        const HistoryStore::Sample& sample = samples.at(i);
+        QString line = QDateTime::fromMSecsSinceEpoch(sample.timestamp).toString("yyyy-MM-dd hh:mm:ss");
+        switch ( sample.status ) {
+            case HistoryStore::Passed : line.append("  passed"); break;
+            case HistoryStore::Failed : line.append("  FAILED"); break;
+            default:
+                line.append("  not run");
+                break;
+        }
+        if ( sample.time >= 0.0 )
+            line.append( QString("  %1 seconds").arg(sample.time) );
+        if ( sample.hasBenchmarkRegression )
+            line.append("  (benchmark regression)");
+        append(line);
+    }
+
+    // mean time across all runs
+    qreal totalTime = 0.0;
+    int numTimed = 0;
+    foreach ( const HistoryStore::Sample& sample, samples ) {
+        if ( sample.time >= 0.0 ) {
+            totalTime += sample.time;
+            ++numTimed;
+        }
+    }
+    if ( numTimed > 0 ) {
+        append("");
+        append( QString("Mean time: %1 seconds").arg(totalTime / numTimed) );
+    }
+}
+
+void ResultDetailsView::writeRegressionCount(int numRegressed) {
+    if ( numRegressed > 0 )
+        append( QString("Benchmark regressions: %1 test(s)").arg(numRegressed) );
+}
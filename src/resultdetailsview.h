@@ -1,13 +1,23 @@
 #ifndef RESULTDETAILSVIEW_H
 #define RESULTDETAILSVIEW_H
 
-#include <QTextEdit>
+#include <QHash>
+#include <QSet>
+#include <QWidget>
+class HistoryStore;
+class LogView;
+class QLabel;
+class QLineEdit;
 class QString;
 class TestCase;
 class TestSuite;
 class TestProgram;
 
-class ResultDetailsView : public QTextEdit {
+// details of the selected program, suite or test, in a LogView (so even huge
+// failure messages & output show up instantly), with a find box below it
+//
+// very large failure messages aren't loaded until double-clicked.
+class ResultDetailsView : public QWidget {
 
     Q_OBJECT
 
@@ -15,6 +25,10 @@ class ResultDetailsView : public QTextEdit {
     public:
         explicit ResultDetailsView(QWidget* parent = 0);
         ~ResultDetailsView(void);
+
+    // ResultDetailsView interface
+    public:
+        void setHistoryStore(HistoryStore* history);
     
     // ResultDetailsView interface
     public slots:
@@ -29,11 +43,34 @@ class ResultDetailsView : public QTextEdit {
         void onTestProgramSelected(TestProgram* program);
 
     // internal methods
+    private slots:
+        void findNext(void);
+        void onFindTextChanged(const QString& text);
+        void onLineActivated(int index);
     private:
+        void append(const QString& text);
+        void clear(void);
+        void setPlainText(const QString& text);
+        void showFindResult(bool found);
+        void writeFailureMessages(TestCase* test);
+        void writeHistory(TestCase* test);
         void writeHeader(const QString& name,
                          bool wasRun,
                          qreal time,
                          bool hasFailures);
+        void writeRegressionCount(int numRegressed);
+
+    // data members
+    private:
+        HistoryStore* m_history; // copy, not owned
+        LogView*   m_log;
+        QLineEdit* m_findEdit;
+        QLabel*    m_findStatusLabel;
+
+        // large failure messages, by the line showing their placeholder
+        TestCase*         m_currentTest; // copy, not owned
+        QHash<int, int>   m_deferredMessageLines;
+        QSet<int>         m_loadedMessages;
 };
 
 #endif // RESULTDETAILSVIEW_H
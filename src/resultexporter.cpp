@@ -0,0 +1,451 @@
+#include "resultexporter.h"
+#include "benchmarkbaseline.h"
+#include "benchmarkresult.h"
+#include "jsonwriter.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+// returns text w/ any characters not allowed in XML 1.0 replaced
+static
+QString xmlText(const QString& text) {
+    QString result = text;
+    const int length = result.size();
+    for ( int i = 0; i < length; ++i ) {
+        const ushort c = result.at(i).unicode();
+        if ( (c < 0x20 && c != '\t' && c != '\n' && c != '\r') || c == 0xFFFE || c == 0xFFFF )
+            result[i] = QChar('?');
+    }
+    return result;
+}
+
+// returns 'passed', 'failed', or 'notrun'
+static
+QString testStatus(const TestCase* test) {
+    if ( !test->wasRun() )
+        return "notrun";
+    return ( test->passed() ? "passed" : "failed" );
+}
+
+// -------------------------------
+// ResultExporter implementation
+// -------------------------------
+
+ResultExporter::ResultExporter(Format format, const QString& filename, QObject* parent)
+    : QObject(parent)
+    , m_format(format)
+    , m_filename(filename)
+    , m_runner(0)
+    , m_isFirstProgram(true)
+    , m_programCount(0)
+    , m_testCount(0)
+    , m_passedCount(0)
+    , m_failedCount(0)
+    , m_regressedCount(0)
+    , m_errorCount(0)
+{ }
+
+ResultExporter::~ResultExporter(void) {
+
+    // unfinished output is discarded
+    if ( m_file.isOpen() ) {
+        m_file.close();
+        m_file.remove();
+    }
+}
+
+void ResultExporter::attach(TestRunner* runner) {
+    Q_ASSERT_X(runner, Q_FUNC_INFO, "null test runner");
+    m_runner = runner;
+    connect(runner, SIGNAL(runTestsStarted()),  SLOT(onRunTestsStarted()));
+    connect(runner, SIGNAL(testResultsReady(TestProgram*)), SLOT(writeProgram(TestProgram*)));
+    connect(runner, SIGNAL(runTestsFinished()), SLOT(finish()));
+}
+
+bool ResultExporter::begin(void) {
+
+    // drop any unfinished previous output
+    if ( m_file.isOpen() ) {
+        m_file.close();
+        m_file.remove();
+    }
+
+    // reset state
+    m_errorString.clear();
+    m_isFirstProgram = true;
+    m_programCount   = 0;
+    m_testCount      = 0;
+    m_passedCount    = 0;
+    m_failedCount    = 0;
+    m_regressedCount = 0;
+    m_errorCount     = 0;
+
+    // open temp file
+    const QString tempFilename = m_filename + ".tmp";
+    QFile::remove(tempFilename);
+    m_file.setFileName(tempFilename);
+    if ( !m_file.open(QFile::WriteOnly | QFile::Truncate) ) {
+        setError( QString("Could not write %1: %2").arg(tempFilename, m_file.errorString()) );
+        return false;
+    }
+
+    // write header
+    if ( m_format == ResultExporter::JUnitXml ) {
+        m_xml.setDevice(&m_file);
+        m_xml.setAutoFormatting(true);
+        m_xml.writeStartDocument();
+        m_xml.writeStartElement("testsuites");
+        m_xml.writeAttribute("name", "edgecase");
+    } else {
+        m_json.setDevice(&m_file);
+        m_json.setCodec("UTF-8");
+        m_json << "{\n\"programs\": [";
+    }
+
+    return true;
+}
+
+QString ResultExporter::errorString(void) const {
+    return m_errorString;
+}
+
+bool ResultExporter::exportResults(const TestRunner* runner,
+                                   Format format,
+                                   const QString& filename,
+                                   QString* error)
+{
+    Q_ASSERT_X(runner, Q_FUNC_INFO, "null test runner");
+
+    ResultExporter exporter(format, filename);
+    if ( exporter.begin() ) {
+
+        // write each program that has results
+        const int numPrograms = runner->programCount();
+        for ( int i = 0; i < numPrograms; ++i ) {
+            TestProgram* program = runner->programAt(i);
+            Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+            if ( program->hasRunTests() || program->hasError() )
+                exporter.writeProgram(program);
+        }
+
+        exporter.finish();
+    }
+
+    if ( error )
+        *error = exporter.errorString();
+    return !exporter.hasError();
+}
+
+QString ResultExporter::fileName(void) const {
+    return m_filename;
+}
+
+bool ResultExporter::finish(void) {
+
+    // nothing to do if not writing
+    if ( !m_file.isOpen() )
+        return !hasError();
+
+    // write summary & close
+    if ( m_format == ResultExporter::JUnitXml ) {
+        m_xml.writeEndElement(); // testsuites
+        m_xml.writeEndDocument();
+        if ( m_xml.hasError() )
+            setError( QString("Could not write %1").arg(m_file.fileName()) );
+    } else {
+        m_json << "\n],\n\"summary\": {"
+               << "\"programs\": " << m_programCount
+               << ", \"tests\": " << m_testCount
+               << ", \"passed\": " << m_passedCount
+               << ", \"failed\": " << m_failedCount
+               << ", \"regressed\": " << m_regressedCount
+               << ", \"errors\": " << m_errorCount
+               << "}\n}\n";
+        m_json.flush();
+        if ( m_json.status() != QTextStream::Ok )
+            setError( QString("Could not write %1").arg(m_file.fileName()) );
+    }
+
+    m_file.close();
+    if ( m_file.error() != QFile::NoError && !hasError() )
+        setError( QString("Could not write %1: %2").arg(m_file.fileName(), m_file.errorString()) );
+
+    // move into place, if OK
+    if ( hasError() ) {
+        m_file.remove();
+        return false;
+    }
+    QFile::remove(m_filename);
+    if ( !m_file.rename(m_filename) ) {
+        setError( QString("Could not write %1: %2").arg(m_filename, m_file.errorString()) );
+        m_file.remove();
+        return false;
+    }
+    return true;
+}
+
+ResultExporter::Format ResultExporter::format(void) const {
+    return m_format;
+}
+
+ResultExporter::Format ResultExporter::formatForFileName(const QString& filename) {
+    return ( filename.endsWith(".json", Qt::CaseInsensitive) ? ResultExporter::Json
+                                                               : ResultExporter::JUnitXml );
+}
+
+bool ResultExporter::hasError(void) const {
+    return !m_errorString.isEmpty();
+}
+
+bool ResultExporter::isIncluded(const TestCase* test) const {
+    // tests that were run, or meant to be
+    return test->wasRun() || test->isEnabled();
+}
+
+void ResultExporter::onRunTestsStarted(void) {
+
+    Q_ASSERT_X(m_runner, Q_FUNC_INFO, "null test runner");
+    if ( !begin() )
+        return;
+
+    // programs w/ nothing to run never report results, so write any that
+    // errored (e.g. crashed while listing) now, or they'd be left out
+    const int numPrograms = m_runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        TestProgram* program = m_runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        if ( program->hasError() && !program->hasEnabledTests() )
+            writeProgram(program);
+    }
+}
+
+void ResultExporter::setError(const QString& error) {
+    if ( m_errorString.isEmpty() )
+        m_errorString = error;
+    qDebug() << error;
+}
+
+void ResultExporter::writeJsonProgram(const TestProgram* program) {
+
+    m_json << ( m_isFirstProgram ? "\n" : ",\n" )
+           << "{\"name\": " << JsonWriter::string(program->programName())
+           << ", \"path\": " << JsonWriter::string(program->fileName())
+           << ", \"time\": " << ( program->hasTime() ? JsonWriter::number(program->time()) : QString("null") )
+           << ", \"error\": " << ( program->hasError() ? JsonWriter::string(program->errorString()) : QString("null") )
+           << ", \"suites\": [";
+
+    bool isFirstSuite = true;
+    const int numSuites = program->suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        const TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+        bool isFirstTest = true;
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests; ++j ) {
+            const TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            if ( !isIncluded(test) )
+                continue;
+
+            // suite is only written if it has any tests to report
+            if ( isFirstTest ) {
+                m_json << ( isFirstSuite ? "\n " : ",\n " )
+                       << "{\"name\": " << JsonWriter::string(suite->name())
+                       << ", \"time\": " << ( suite->hasTime() ? JsonWriter::number(suite->time()) : QString("null") )
+                       << ", \"tests\": [";
+                isFirstSuite = false;
+            }
+
+            m_json << ( isFirstTest ? "\n  " : ",\n  " );
+            writeJsonTest(test);
+            isFirstTest = false;
+        }
+        if ( !isFirstTest )
+            m_json << "]}";
+    }
+
+    m_json << "]}";
+}
+
+void ResultExporter::writeJsonTest(const TestCase* test) {
+
+    m_json << "{\"name\": " << JsonWriter::string(test->name())
+           << ", \"status\": \"" << testStatus(test) << '"'
+           << ", \"time\": " << ( test->hasTime() ? JsonWriter::number(test->time()) : QString("null") )
+           << ", \"regressed\": " << JsonWriter::boolean(test->hasBenchmarkRegression());
+
+    if ( test->hasFailureMessages() )
+        m_json << ", \"failures\": " << JsonWriter::stringList(test->failureMessages());
+    if ( test->hasOtherMessages() )
+        m_json << ", \"messages\": " << JsonWriter::stringList(test->otherMessages());
+
+    if ( test->hasBenchmarkResults() ) {
+        m_json << ", \"benchmarks\": [";
+        bool isFirst = true;
+        const QList<BenchmarkResult> results = test->benchmarkResults();
+        foreach ( const BenchmarkResult& bm, results ) {
+            m_json << ( isFirst ? "" : ", " )
+                   << "{\"metric\": \"" << BenchmarkResult::metricName(bm.metric) << '"'
+                   << ", \"counter\": " << JsonWriter::string(bm.counterName)
+                   << ", \"aggregate\": " << JsonWriter::string(bm.aggregate)
+                   << ", \"tag\": " << JsonWriter::string(bm.dataTag)
+                   << ", \"value\": " << JsonWriter::number(bm.value)
+                   << ", \"unit\": " << JsonWriter::string(bm.unit)
+                   << ", \"iterations\": " << bm.iterations
+                   << '}';
+            isFirst = false;
+        }
+        m_json << ']';
+    }
+
+    m_json << '}';
+}
+
+void ResultExporter::writeJUnitProgram(const TestProgram* program) {
+
+    // program-level errors are reported as a suite of their own
+    if ( program->hasError() ) {
+        m_xml.writeStartElement("testsuite");
+        m_xml.writeAttribute("name", xmlText(program->programName()));
+        m_xml.writeAttribute("tests", "1");
+        m_xml.writeAttribute("failures", "0");
+        m_xml.writeAttribute("errors", "1");
+        m_xml.writeAttribute("skipped", "0");
+        m_xml.writeAttribute("time", "0");
+        m_xml.writeStartElement("testcase");
+        m_xml.writeAttribute("name", "(program)");
+        m_xml.writeAttribute("classname", xmlText(program->programName()));
+        m_xml.writeAttribute("time", "0");
+        m_xml.writeStartElement("error");
+        m_xml.writeAttribute("message", xmlText(program->errorString()));
+        m_xml.writeCharacters(xmlText(program->fileName()));
+        m_xml.writeEndElement(); // error
+        m_xml.writeEndElement(); // testcase
+        m_xml.writeEndElement(); // testsuite
+    }
+
+    const int numSuites = program->suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        const TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+        writeJUnitSuite(program, suite);
+    }
+}
+
+void ResultExporter::writeJUnitSuite(const TestProgram* program, const TestSuite* suite) {
+
+    // count reported tests
+    int numIncluded = 0;
+    int numFailed   = 0;
+    int numSkipped  = 0;
+    const int numTests = suite->testCount();
+    for ( int i = 0; i < numTests; ++i ) {
+        const TestCase* test = suite->testAt(i);
+        Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+        if ( !isIncluded(test) )
+            continue;
+        ++numIncluded;
+        if ( !test->wasRun() )
+            ++numSkipped;
+        else if ( !test->passed() )
+            ++numFailed;
+    }
+    if ( numIncluded == 0 )
+        return;
+
+    // write suite
+    const QString className = xmlText( program->programName() + '.' + suite->name() );
+    m_xml.writeStartElement("testsuite");
+    m_xml.writeAttribute("name", className);
+    m_xml.writeAttribute("tests", QString::number(numIncluded));
+    m_xml.writeAttribute("failures", QString::number(numFailed));
+    m_xml.writeAttribute("errors", "0");
+    m_xml.writeAttribute("skipped", QString::number(numSkipped));
+    m_xml.writeAttribute("time", QString::number(suite->hasTime() ? suite->time() : 0.0, 'f', 3));
+    m_xml.writeAttribute("package", xmlText(program->fileName()));
+
+    for ( int i = 0; i < numTests; ++i ) {
+        const TestCase* test = suite->testAt(i);
+        if ( isIncluded(test) )
+            writeJUnitTest(className, test);
+    }
+
+    m_xml.writeEndElement(); // testsuite
+}
+
+void ResultExporter::writeJUnitTest(const QString& className, const TestCase* test) {
+
+    m_xml.writeStartElement("testcase");
+    m_xml.writeAttribute("name", xmlText(test->name()));
+    m_xml.writeAttribute("classname", className);
+    m_xml.writeAttribute("time", QString::number(test->hasTime() ? test->time() : 0.0, 'f', 3));
+
+    // benchmark results & regressions
+    if ( test->hasBenchmarkResults() ) {
+        m_xml.writeStartElement("properties");
+        const QList<BenchmarkResult> results = test->benchmarkResults();
+        foreach ( const BenchmarkResult& bm, results ) {
+            m_xml.writeStartElement("property");
+            m_xml.writeAttribute("name", xmlText("benchmark." + bm.label()));
+            m_xml.writeAttribute("value", xmlText(bm.toString()));
+            m_xml.writeEndElement();
+        }
+        const QList<BenchmarkComparison> comparisons = test->benchmarkComparisons();
+        foreach ( const BenchmarkComparison& comparison, comparisons ) {
+            if ( comparison.status != BenchmarkComparison::Regressed )
+                continue;
+            m_xml.writeStartElement("property");
+            m_xml.writeAttribute("name", "benchmark.regression");
+            m_xml.writeAttribute("value", xmlText(comparison.toString()));
+            m_xml.writeEndElement();
+        }
+        m_xml.writeEndElement(); // properties
+    }
+
+    // status
+    if ( !test->wasRun() ) {
+        m_xml.writeStartElement("skipped");
+        m_xml.writeAttribute("message", "Not run");
+        m_xml.writeEndElement();
+    } else if ( !test->passed() ) {
+        const QStringList failures = test->failureMessages();
+        m_xml.writeStartElement("failure");
+        m_xml.writeAttribute("message", xmlText( failures.isEmpty() ? QString("Failed")
+                                                                    : failures.first().section('\n', 0, 0) ));
+        m_xml.writeCharacters( xmlText(failures.join("\n")) );
+        m_xml.writeEndElement();
+    }
+
+    // other messages
+    if ( test->hasOtherMessages() )
+        m_xml.writeTextElement("system-out", xmlText(test->otherMessages().join("\n")));
+
+    m_xml.writeEndElement(); // testcase
+}
+
+void ResultExporter::writeProgram(TestProgram* program) {
+
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    if ( !m_file.isOpen() || program == 0 )
+        return;
+
+    // write program
+    if ( m_format == ResultExporter::JUnitXml )
+        writeJUnitProgram(program);
+    else
+        writeJsonProgram(program);
+    m_isFirstProgram = false;
+
+    // update summary counts
+    ++m_programCount;
+    m_testCount      += program->runTestCount();
+    m_passedCount    += program->passedTestCount();
+    m_failedCount    += program->failedTestCount();
+    m_regressedCount += program->regressedTestCount();
+    if ( program->hasError() )
+        ++m_errorCount;
+}
@@ -0,0 +1,103 @@
+#ifndef RESULTEXPORTER_H
+#define RESULTEXPORTER_H
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+class TestCase;
+class TestProgram;
+class TestRunner;
+class TestSuite;
+
+// writes the results of a whole run to one file, as JUnit XML or JSON
+//
+// results are streamed: each program is written out as soon as it's
+// finished & nothing is kept afterwards, so memory use doesn't grow with
+// the size of the run. The file is written under a temporary name & only
+// moved into place by finish().
+//
+// JUnit XML: one <testsuite> per program & suite ('program.Suite'), with
+// benchmark results as <property> elements of each <testcase>. Programs
+// that failed to run get a <testsuite> of their own, w/ an <error>. When
+// attached to a runner, programs that couldn't be listed (so are never run)
+// are written as soon as the run starts, so they're reported all the same.
+//
+// JSON: { "programs": [ { "name", "path", "time", "error",
+//                         "suites": [ { "name", "time", "tests": [...] } ] } ],
+//         "summary": { ... } }
+class ResultExporter : public QObject {
+
+    Q_OBJECT
+
+    public:
+        enum Format { JUnitXml = 0
+                    , Json
+                    };
+
+    // ctor & dtor
+    public:
+        ResultExporter(Format format, const QString& filename, QObject* parent = 0);
+        ~ResultExporter(void);
+
+    // ResultExporter interface
+    public slots:
+        bool begin(void);
+        void writeProgram(TestProgram* program);
+        bool finish(void);
+    public:
+        QString fileName(void) const;
+        Format format(void) const;
+
+        bool hasError(void) const;
+        QString errorString(void) const;
+
+        // write each run of a runner as it happens:
+        // begin() when a run starts (w/ any programs that won't be run because of
+        // an error), each program as its results are ready, finish() at the end
+        void attach(TestRunner* runner);
+
+        // one-shot export of a runner's current results
+        static bool exportResults(const TestRunner* runner,
+                                  Format format,
+                                  const QString& filename,
+                                  QString* error = 0);
+
+        // JSON for '*.json', JUnit XML otherwise
+        static Format formatForFileName(const QString& filename);
+
+    // internal methods
+    private slots:
+        void onRunTestsStarted(void);
+    private:
+        bool isIncluded(const TestCase* test) const;
+        void setError(const QString& error);
+        void writeJsonProgram(const TestProgram* program);
+        void writeJsonTest(const TestCase* test);
+        void writeJUnitProgram(const TestProgram* program);
+        void writeJUnitSuite(const TestProgram* program, const TestSuite* suite);
+        void writeJUnitTest(const QString& className, const TestCase* test);
+
+    // data members
+    private:
+        Format  m_format;
+        QString m_filename;
+        QString m_errorString;
+        TestRunner* m_runner; // copy, not owned (if attached)
+
+        QFile m_file;               // temp file, while writing
+        QXmlStreamWriter m_xml;
+        QTextStream m_json;
+        bool m_isFirstProgram;
+
+        // summary counts, for programs written so far
+        int m_programCount;
+        int m_testCount;
+        int m_passedCount;
+        int m_failedCount;
+        int m_regressedCount;
+        int m_errorCount;
+};
+
+#endif // RESULTEXPORTER_H
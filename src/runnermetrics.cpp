@@ -0,0 +1,169 @@
+#include "runnermetrics.h"
+#include <QtCore>
+#include <QtDebug>
+
+// returns Prometheus-formatted number
+static
+QString metricNumber(double value) {
+    if ( qIsNaN(value) ) return "NaN";
+    if ( qIsInf(value) ) return ( value > 0 ? "+Inf" : "-Inf" );
+    return QString::number(value, 'g', 12);
+}
+
+// returns default histogram buckets: 1 ms .. 60 s
+static
+QList<double> defaultBuckets(void) {
+    static const double bounds[] = { 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1,
+                                     0.25,  0.5,    1.0,   2.5,  5.0,   10.0, 30.0, 60.0 };
+    QList<double> result;
+    for ( size_t i = 0; i < sizeof(bounds)/sizeof(bounds[0]); ++i )
+        result.append(bounds[i]);
+    return result;
+}
+
+// ------------------------------
+// RunnerMetrics implementation
+// ------------------------------
+
+RunnerMetrics::RunnerMetrics(void) { }
+
+RunnerMetrics::~RunnerMetrics(void) { }
+
+void RunnerMetrics::add(const QString& name, double delta) {
+    QMap<QString, Metric>::iterator iter = m_metrics.find(name);
+    Q_ASSERT_X(iter != m_metrics.end() && iter->type == RunnerMetrics::Counter,
+               Q_FUNC_INFO, "unknown counter");
+    if ( iter != m_metrics.end() )
+        iter->value += delta;
+}
+
+void RunnerMetrics::define(const QString& name,
+                           Type type,
+                           const QString& help,
+                           const QList<double>& buckets)
+{
+    Metric metric;
+    metric.type  = type;
+    metric.help  = help;
+    metric.value = 0.0;
+    metric.count = 0;
+    if ( type == RunnerMetrics::Histogram ) {
+        metric.bounds = ( buckets.isEmpty() ? defaultBuckets() : buckets );
+        metric.counts.fill(0, metric.bounds.size() + 1);
+    }
+    m_metrics.insert(name, metric);
+}
+
+double RunnerMetrics::elapsedSeconds(const QElapsedTimer& timer) {
+    if ( !timer.isValid() )
+        return 0.0;
+#if QT_VERSION >= 0x040800
+    return timer.nsecsElapsed() / 1e9;
+#else
+    return timer.elapsed() / 1e3;
+#endif
+}
+
+void RunnerMetrics::observe(const QString& name, double value) {
+
+    QMap<QString, Metric>::iterator iter = m_metrics.find(name);
+    Q_ASSERT_X(iter != m_metrics.end() && iter->type == RunnerMetrics::Histogram,
+               Q_FUNC_INFO, "unknown histogram");
+    if ( iter == m_metrics.end() )
+        return;
+
+    // find bucket (few buckets, linear scan is fine)
+    Metric& metric = iter.value();
+    int bucket = 0;
+    const int numBounds = metric.bounds.size();
+    while ( bucket < numBounds && value > metric.bounds.at(bucket) )
+        ++bucket;
+
+    ++metric.counts[bucket];
+    ++metric.count;
+    metric.value += value;
+}
+
+void RunnerMetrics::reset(void) {
+    QMap<QString, Metric>::iterator iter = m_metrics.begin();
+    QMap<QString, Metric>::iterator end  = m_metrics.end();
+    for ( ; iter != end; ++iter ) {
+        iter->value = 0.0;
+        iter->count = 0;
+        iter->counts.fill(0);
+    }
+}
+
+void RunnerMetrics::set(const QString& name, double value) {
+    QMap<QString, Metric>::iterator iter = m_metrics.find(name);
+    Q_ASSERT_X(iter != m_metrics.end() && iter->type == RunnerMetrics::Gauge,
+               Q_FUNC_INFO, "unknown gauge");
+    if ( iter != m_metrics.end() )
+        iter->value = value;
+}
+
+void RunnerMetrics::setMax(const QString& name, double value) {
+    if ( value > this->value(name) )
+        set(name, value);
+}
+
+QByteArray RunnerMetrics::toPrometheusText(void) const {
+
+    static const char* const typeNames[] = { "counter", "gauge", "histogram" };
+
+    QString text;
+    QMap<QString, Metric>::const_iterator iter = m_metrics.constBegin();
+    QMap<QString, Metric>::const_iterator end  = m_metrics.constEnd();
+    for ( ; iter != end; ++iter ) {
+        const QString& name = iter.key();
+        const Metric& metric = iter.value();
+
+        text.append( QString("# HELP %1 %2\n").arg(name, metric.help) );
+        text.append( QString("# TYPE %1 %2\n").arg(name, typeNames[metric.type]) );
+
+        if ( metric.type != RunnerMetrics::Histogram ) {
+            text.append( QString("%1 %2\n").arg(name, metricNumber(metric.value)) );
+            continue;
+        }
+
+        // histogram buckets are cumulative
+        qint64 cumulative = 0;
+        const int numBounds = metric.bounds.size();
+        for ( int i = 0; i < numBounds; ++i ) {
+            cumulative += metric.counts.at(i);
+            text.append( QString("%1_bucket{le=\"%2\"} %3\n")
+                             .arg(name, metricNumber(metric.bounds.at(i)))
+                             .arg(cumulative) );
+        }
+        text.append( QString("%1_bucket{le=\"+Inf\"} %2\n").arg(name).arg(metric.count) );
+        text.append( QString("%1_sum %2\n").arg(name, metricNumber(metric.value)) );
+        text.append( QString("%1_count %2\n").arg(name).arg(metric.count) );
+    }
+    return text.toUtf8();
+}
+
+double RunnerMetrics::value(const QString& name) const {
+    return m_metrics.value(name).value;
+}
+
+bool RunnerMetrics::writeFile(const QString& filename) const {
+
+    // write to temp file, then move into place (readers never see a partial file)
+    const QString tempFilename = filename + ".tmp";
+    QFile file(tempFilename);
+    if ( !file.open(QFile::WriteOnly | QFile::Truncate) ) {
+        qDebug() << "Could not write metrics file:" << file.errorString();
+        return false;
+    }
+
+    const QByteArray text = toPrometheusText();
+    const bool ok = ( file.write(text) == text.size() );
+    file.close();
+    if ( !ok ) {
+        QFile::remove(tempFilename);
+        return false;
+    }
+
+    QFile::remove(filename);
+    return QFile::rename(tempFilename, filename);
+}
@@ -0,0 +1,73 @@
+#ifndef RUNNERMETRICS_H
+#define RUNNERMETRICS_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QVector>
+class QElapsedTimer;
+
+// edgecase's own overheads (process spawning, parsing, result handling, etc.)
+// as Prometheus-style counters, gauges, & histograms
+//
+// metrics are registered up front (with help text & buckets), then updated by
+// name. Output is the Prometheus text exposition format (version 0.0.4), e.g.
+// for node_exporter's textfile collector or a scraper.
+class RunnerMetrics {
+
+    public:
+        enum Type { Counter = 0
+                  , Gauge
+                  , Histogram
+                  };
+
+    // ctor & dtor
+    public:
+        RunnerMetrics(void);
+        ~RunnerMetrics(void);
+
+    // RunnerMetrics interface
+    public:
+
+        // registration (histograms use default, seconds-based buckets if none given)
+        void define(const QString& name,
+                    Type type,
+                    const QString& help,
+                    const QList<double>& buckets = QList<double>());
+
+        // updates (name must have been defined w/ matching type)
+        void add(const QString& name, double delta = 1.0);  // counter
+        void set(const QString& name, double value);        // gauge
+        void setMax(const QString& name, double value);     // gauge, if larger
+        void observe(const QString& name, double value);    // histogram
+
+        double value(const QString& name) const;            // counter or gauge
+
+        // zero everything
+        void reset(void);
+
+        // output
+        QByteArray toPrometheusText(void) const;
+        bool writeFile(const QString& filename) const;
+
+        // convenience
+        static double elapsedSeconds(const QElapsedTimer& timer);
+
+    // internal types
+    private:
+        struct Metric {
+            Type    type;
+            QString help;
+            double  value;              // counter, gauge, or histogram sum
+            QList<double>   bounds;     // histogram bucket upper bounds
+            QVector<qint64> counts;     // per bucket (+Inf last), not cumulative
+            qint64  count;              // histogram observations
+        };
+
+    // data members
+    private:
+        QMap<QString, Metric> m_metrics; // by name (sorted output)
+};
+
+#endif // RUNNERMETRICS_H
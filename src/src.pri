@@ -0,0 +1,83 @@
+# edgecase's shared sources: everything but main() & the command-line/main
+# window front ends, included by edgecase.pro & bench/bench.pro
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/benchmarkbaseline.cpp \
+           $$PWD/benchmarkexporter.cpp \
+           $$PWD/benchmarkresult.cpp \
+           $$PWD/discoveryindex.cpp \
+           $$PWD/elfinspector.cpp \
+           $$PWD/googlebenchmarkprogram.cpp \
+           $$PWD/googletestfilter.cpp \
+           $$PWD/googletestprogram.cpp \
+           $$PWD/historystore.cpp \
+           $$PWD/jsonreader.cpp \
+           $$PWD/jsonwriter.cpp \
+           $$PWD/logview.cpp \
+           $$PWD/messagestore.cpp \
+           $$PWD/outputlog.cpp \
+           $$PWD/profiletracker.cpp \
+           $$PWD/profileview.cpp \
+           $$PWD/programfinder.cpp \
+           $$PWD/programtypeselector.cpp \
+           $$PWD/progressestimator.cpp \
+           $$PWD/qtestlibprogram.cpp \
+           $$PWD/resultbatcher.cpp \
+           $$PWD/resultdetailsview.cpp \
+           $$PWD/resultexporter.cpp \
+           $$PWD/runnermetrics.cpp \
+           $$PWD/statusserver.cpp \
+           $$PWD/storagepaths.cpp \
+           $$PWD/testcase.cpp \
+           $$PWD/testprogram.cpp \
+           $$PWD/testprogramfactory.cpp \
+           $$PWD/testprogressbar.cpp \
+           $$PWD/testresultbatch.cpp \
+           $$PWD/testrunner.cpp \
+           $$PWD/testsearchindex.cpp \
+           $$PWD/testselection.cpp \
+           $$PWD/testsuite.cpp \
+           $$PWD/testtreemodel.cpp \
+           $$PWD/testlistview.cpp \
+           $$PWD/tracerecorder.cpp
+
+HEADERS += $$PWD/benchmarkbaseline.h \
+           $$PWD/benchmarkexporter.h \
+           $$PWD/benchmarkresult.h \
+           $$PWD/discoveryindex.h \
+           $$PWD/elfinspector.h \
+           $$PWD/googlebenchmarkprogram.h \
+           $$PWD/googletestfilter.h \
+           $$PWD/googletestprogram.h \
+           $$PWD/historystore.h \
+           $$PWD/jsonreader.h \
+           $$PWD/jsonwriter.h \
+           $$PWD/logview.h \
+           $$PWD/messagestore.h \
+           $$PWD/outputlog.h \
+           $$PWD/profiletracker.h \
+           $$PWD/profileview.h \
+           $$PWD/programfinder.h \
+           $$PWD/programinfo.h \
+           $$PWD/programtypeselector.h \
+           $$PWD/progressestimator.h \
+           $$PWD/qtestlibprogram.h \
+           $$PWD/resultbatcher.h \
+           $$PWD/resultdetailsview.h \
+           $$PWD/resultexporter.h \
+           $$PWD/runnermetrics.h \
+           $$PWD/statusserver.h \
+           $$PWD/storagepaths.h \
+           $$PWD/testcase.h \
+           $$PWD/testprogram.h \
+           $$PWD/testprogramfactory.h \
+           $$PWD/testprogressbar.h \
+           $$PWD/testresultbatch.h \
+           $$PWD/testrunner.h \
+           $$PWD/testsearchindex.h \
+           $$PWD/testselection.h \
+           $$PWD/testsuite.h \
+           $$PWD/testtreemodel.h \
+           $$PWD/testlistview.h \
+           $$PWD/tracerecorder.h
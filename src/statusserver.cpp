@@ -0,0 +1,459 @@
+#include "statusserver.h"
+#include "jsonwriter.h"
+#include "runnermetrics.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtNetwork>
+#include <QtDebug>
+
+namespace Constants {
+
+    const int MaxClients       = 32;
+    const int MaxRequestSize   = 8 * 1024;
+    const int KeepAliveMsecs   = 15 * 1000;
+
+    // time allowed for a client to send its complete request header
+    const int RequestTimeoutMsecs       = 5 * 1000;
+    const int RequestCheckIntervalMsecs = 1000;
+
+    // unsent data allowed per event client, before it's dropped
+    const qint64 MaxClientBacklog = Q_INT64_C(4) * 1024 * 1024;
+
+} // namespace Constants
+
+// ----------------------------
+// StatusServer implementation
+// ----------------------------
+
+StatusServer::StatusServer(TestRunner* runner, QObject* parent)
+    : QObject(parent)
+    , m_runner(runner)
+    , m_server(new QTcpServer(this))
+    , m_keepAliveTimer(new QTimer(this))
+    , m_requestTimer(new QTimer(this))
+    , m_state("idle")
+{
+    Q_ASSERT_X(m_runner, Q_FUNC_INFO, "null test runner");
+
+    connect(m_server, SIGNAL(newConnection()), SLOT(onNewConnection()));
+
+    m_keepAliveTimer->setInterval(Constants::KeepAliveMsecs);
+    connect(m_keepAliveTimer, SIGNAL(timeout()), SLOT(onKeepAlive()));
+
+    m_requestTimer->setInterval(Constants::RequestCheckIntervalMsecs);
+    connect(m_requestTimer, SIGNAL(timeout()), SLOT(onRequestTimeout()));
+    m_clock.start();
+
+    connect(m_runner, SIGNAL(listTestsStarted()),  SLOT(onListTestsStarted()));
+    connect(m_runner, SIGNAL(listTestsFinished()), SLOT(onListTestsFinished()));
+    connect(m_runner, SIGNAL(runTestsStarted()),   SLOT(onRunTestsStarted()));
+    connect(m_runner, SIGNAL(runTestsFinished()),  SLOT(onRunTestsFinished()));
+    connect(m_runner, SIGNAL(programStarted(TestProgram*)),   SLOT(onProgramStarted(TestProgram*)));
+    connect(m_runner, SIGNAL(testResultsReady(TestProgram*)), SLOT(onTestResultsReady(TestProgram*)));
+}
+
+StatusServer::~StatusServer(void) {
+    close();
+}
+
+QString StatusServer::allowedOrigin(void) const {
+    return m_allowedOrigin;
+}
+
+void StatusServer::broadcast(const QByteArray& event, const QByteArray& data) {
+
+    // 'event: <name>\ndata: <json>\n\n'
+    QByteArray message;
+    message.reserve(event.size() + data.size() + 16);
+    message.append("event: ").append(event).append("\ndata: ").append(data).append("\n\n");
+
+    // drop any client that has stopped reading
+    QList<QTcpSocket*> clients = m_eventClients;
+    foreach ( QTcpSocket* client, clients ) {
+        if ( client->bytesToWrite() > Constants::MaxClientBacklog ) {
+            client->abort();
+            removeClient(client);
+            continue;
+        }
+        client->write(message);
+    }
+}
+
+void StatusServer::broadcastStatus(void) {
+    broadcast("status", statusJson());
+}
+
+void StatusServer::close(void) {
+
+    m_server->close();
+    m_keepAliveTimer->stop();
+    m_requestTimer->stop();
+
+    // disconnect all clients
+    QList<QTcpSocket*> clients = m_eventClients + m_pendingRequests.keys();
+    foreach ( QTcpSocket* client, clients ) {
+        client->abort();
+        removeClient(client);
+    }
+}
+
+QString StatusServer::errorString(void) const {
+    return m_server->errorString();
+}
+
+void StatusServer::handleRequest(QTcpSocket* client, const QByteArray& request) {
+
+    // request line: 'GET /path?query HTTP/1.1'
+    const int lineEnd = request.indexOf("\r\n");
+    const QList<QByteArray> parts = request.left(lineEnd).split(' ');
+    if ( parts.size() != 3 || !parts.at(2).startsWith("HTTP/") ) {
+        sendResponse(client, "400 Bad Request", "text/plain", "Bad request\n");
+        return;
+    }
+    if ( parts.at(0) != "GET" ) {
+        sendResponse(client, "405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+        return;
+    }
+    QByteArray path = parts.at(1);
+    const int query = path.indexOf('?');
+    if ( query >= 0 )
+        path.truncate(query);
+
+    // snapshots
+    if ( path == "/" || path == "/status" ) {
+        sendResponse(client, "200 OK", "application/json", statusJson() + '\n');
+        return;
+    }
+    if ( path == "/programs" ) {
+        sendResponse(client, "200 OK", "application/json", programsJson() + '\n');
+        return;
+    }
+    if ( path == "/metrics" ) {
+        sendResponse(client, "200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                     m_runner->metrics()->toPrometheusText());
+        return;
+    }
+
+    // event stream: keep connection open, starting w/ current status
+    if ( path == "/events" ) {
+        client->write("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/event-stream\r\n"
+                      "Cache-Control: no-cache\r\n"
+                      "Connection: keep-alive\r\n"
+                      + originHeader() +
+                      "\r\n");
+        m_eventClients.append(client);
+        if ( !m_keepAliveTimer->isActive() )
+            m_keepAliveTimer->start();
+        client->write("event: status\ndata: " + statusJson() + "\n\n");
+        return;
+    }
+
+    sendResponse(client, "404 Not Found", "text/plain", "Not found\n");
+}
+
+bool StatusServer::isListening(void) const {
+    return m_server->isListening();
+}
+
+bool StatusServer::listen(quint16 port) {
+    close();
+    return m_server->listen(QHostAddress::LocalHost, port);
+}
+
+void StatusServer::onClientDisconnected(void) {
+    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
+    if ( client )
+        removeClient(client);
+}
+
+void StatusServer::onClientReadyRead(void) {
+
+    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
+    if ( client == 0 )
+        return;
+
+    // ignore anything else sent once a request has been handled
+    if ( !m_pendingRequests.contains(client) ) {
+        client->readAll();
+        return;
+    }
+
+    // wait for complete request header
+    QByteArray& request = m_pendingRequests[client];
+    request.append( client->readAll() );
+    if ( !request.contains("\r\n\r\n") ) {
+        if ( request.size() > Constants::MaxRequestSize ) {
+            m_pendingRequests.remove(client);
+            m_requestDeadlines.remove(client);
+            sendResponse(client, "431 Request Header Fields Too Large", "text/plain", "Request too large\n");
+        }
+        return;
+    }
+
+    const QByteArray completeRequest = request;
+    m_pendingRequests.remove(client);
+    m_requestDeadlines.remove(client);
+    handleRequest(client, completeRequest);
+}
+
+void StatusServer::onKeepAlive(void) {
+
+    if ( m_eventClients.isEmpty() ) {
+        m_keepAliveTimer->stop();
+        return;
+    }
+
+    // SSE comment line, keeps proxies & idle timeouts from closing the stream
+    foreach ( QTcpSocket* client, m_eventClients )
+        client->write(": keepalive\n\n");
+}
+
+void StatusServer::onListTestsFinished(void) {
+    m_state = "idle";
+    if ( m_eventClients.isEmpty() )
+        return;
+    broadcast("listing-finished", "{}");
+    broadcastStatus();
+}
+
+void StatusServer::onListTestsStarted(void) {
+    m_state = "listing";
+    m_timer.start();
+    m_runningPrograms.clear();
+    m_finishedPrograms.clear();
+    if ( m_eventClients.isEmpty() )
+        return;
+    broadcast("listing-started", "{}");
+    broadcastStatus();
+}
+
+void StatusServer::onNewConnection(void) {
+
+    while ( m_server->hasPendingConnections() ) {
+        QTcpSocket* client = m_server->nextPendingConnection();
+
+        // refuse, if we're at our limit
+        if ( m_pendingRequests.size() + m_eventClients.size() >= Constants::MaxClients ) {
+            client->abort();
+            client->deleteLater();
+            continue;
+        }
+
+        connect(client, SIGNAL(readyRead()),    SLOT(onClientReadyRead()));
+        connect(client, SIGNAL(disconnected()), SLOT(onClientDisconnected()));
+        m_pendingRequests.insert(client, QByteArray());
+        m_requestDeadlines.insert(client, m_clock.elapsed() + Constants::RequestTimeoutMsecs);
+    }
+
+    if ( !m_requestTimer->isActive() )
+        m_requestTimer->start();
+}
+
+void StatusServer::onProgramStarted(TestProgram* program) {
+
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    m_runningPrograms.insert(program);
+
+    if ( m_eventClients.isEmpty() )
+        return;
+    broadcast("program-started", programJson(program, false));
+    broadcastStatus();
+}
+
+void StatusServer::onRequestTimeout(void) {
+
+    if ( m_requestDeadlines.isEmpty() ) {
+        m_requestTimer->stop();
+        return;
+    }
+
+    // drop clients that have connected but not (fully) sent a request
+    const qint64 now = m_clock.elapsed();
+    QList<QTcpSocket*> expired;
+    QHash<QTcpSocket*, qint64>::const_iterator iter = m_requestDeadlines.constBegin();
+    const QHash<QTcpSocket*, qint64>::const_iterator end = m_requestDeadlines.constEnd();
+    for ( ; iter != end; ++iter ) {
+        if ( iter.value() <= now )
+            expired.append(iter.key());
+    }
+    foreach ( QTcpSocket* client, expired ) {
+        m_pendingRequests.remove(client);
+        m_requestDeadlines.remove(client);
+        sendResponse(client, "408 Request Timeout", "text/plain", "Request timed out\n");
+    }
+}
+
+void StatusServer::onRunTestsFinished(void) {
+    m_state = "idle";
+    m_runningPrograms.clear();
+    if ( m_eventClients.isEmpty() )
+        return;
+    broadcast("run-finished", statusJson());
+    broadcastStatus();
+}
+
+void StatusServer::onRunTestsStarted(void) {
+    m_state = "running";
+    m_timer.start();
+    m_runningPrograms.clear();
+    m_finishedPrograms.clear();
+    if ( m_eventClients.isEmpty() )
+        return;
+    broadcast("run-started", "{}");
+    broadcastStatus();
+}
+
+void StatusServer::onTestResultsReady(TestProgram* program) {
+
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    m_runningPrograms.remove(program);
+    m_finishedPrograms.insert(program);
+
+    if ( m_eventClients.isEmpty() )
+        return;
+    broadcast("program-finished", programJson(program, true));
+    broadcastStatus();
+}
+
+QByteArray StatusServer::originHeader(void) const {
+    if ( m_allowedOrigin.isEmpty() )
+        return QByteArray();
+    return "Access-Control-Allow-Origin: " + m_allowedOrigin.toUtf8() + "\r\n";
+}
+
+quint16 StatusServer::port(void) const {
+    return m_server->serverPort();
+}
+
+QByteArray StatusServer::programJson(const TestProgram* program, bool includeTests) const {
+
+    QString json;
+    json.append( QString("{\"name\": %1, \"path\": %2, \"state\": \"%3\"")
+                     .arg(JsonWriter::string(program->programName()),
+                          JsonWriter::string(program->fileName()),
+                          programState(program)) );
+    json.append( QString(", \"total\": %1, \"enabled\": %2, \"run\": %3, \"passed\": %4"
+                         ", \"failed\": %5, \"regressed\": %6")
+                     .arg(program->totalTestCount())
+                     .arg(program->enabledTestCount())
+                     .arg(program->runTestCount())
+                     .arg(program->passedTestCount())
+                     .arg(program->failedTestCount())
+                     .arg(program->regressedTestCount()) );
+    json.append( QString(", \"time\": %1, \"error\": %2")
+                     .arg(program->hasTime() ? JsonWriter::number(program->time()) : QString("null"),
+                          program->hasError() ? JsonWriter::string(program->errorString()) : QString("null")) );
+
+    // each test's result
+    if ( includeTests ) {
+        json.append(", \"tests\": [");
+        bool isFirst = true;
+        const int numSuites = program->suiteCount();
+        for ( int i = 0; i < numSuites; ++i ) {
+            const TestSuite* suite = program->suiteAt(i);
+            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+            const QString suiteName = JsonWriter::string(suite->name());
+
+            const int numTests = suite->testCount();
+            for ( int j = 0; j < numTests; ++j ) {
+                const TestCase* test = suite->testAt(j);
+                Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+                if ( !test->wasRun() && !test->isEnabled() )
+                    continue;
+
+                const QString status = ( !test->wasRun() ? "notrun" : (test->passed() ? "passed" : "failed") );
+                json.append( QString("%1{\"suite\": %2, \"name\": %3, \"status\": \"%4\", \"time\": %5, \"regressed\": %6}")
+                                 .arg(isFirst ? "" : ", ")
+                                 .arg(suiteName,
+                                      JsonWriter::string(test->name()),
+                                      status,
+                                      test->hasTime() ? JsonWriter::number(test->time()) : QString("null"),
+                                      JsonWriter::boolean(test->hasBenchmarkRegression())) );
+                isFirst = false;
+            }
+        }
+        json.append(']');
+    }
+
+    json.append('}');
+    return json.toUtf8();
+}
+
+QByteArray StatusServer::programsJson(void) const {
+    QByteArray json("[");
+    const int numPrograms = m_runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        if ( i > 0 )
+            json.append(",\n ");
+        json.append( programJson(m_runner->programAt(i), false) );
+    }
+    json.append(']');
+    return json;
+}
+
+QString StatusServer::programState(const TestProgram* program) const {
+    if ( m_runningPrograms.contains(program) )
+        return "running";
+    if ( m_finishedPrograms.contains(program) )
+        return "finished";
+    if ( m_state == "running" && program->hasRunnableTests() )
+        return "queued";
+    return "idle";
+}
+
+void StatusServer::removeClient(QTcpSocket* client) {
+    m_pendingRequests.remove(client);
+    m_requestDeadlines.remove(client);
+    m_eventClients.removeAll(client);
+    client->disconnect(this);
+    client->deleteLater();
+}
+
+void StatusServer::sendResponse(QTcpSocket* client,
+                                const QByteArray& status,
+                                const QByteArray& contentType,
+                                const QByteArray& body)
+{
+    QByteArray response;
+    response.append("HTTP/1.1 ").append(status).append("\r\n")
+            .append("Content-Type: ").append(contentType).append("\r\n")
+            .append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n")
+            .append("Cache-Control: no-cache\r\n")
+            .append(originHeader())
+            .append("Connection: close\r\n")
+            .append("\r\n")
+            .append(body);
+    client->write(response);
+
+    // closes once everything's been written
+    client->disconnectFromHost();
+}
+
+void StatusServer::setAllowedOrigin(const QString& origin) {
+    m_allowedOrigin = origin;
+}
+
+QByteArray StatusServer::statusJson(void) const {
+
+    const qreal elapsed = ( m_timer.isValid() ? m_timer.elapsed() / 1000.0 : 0.0 );
+    const QString json =
+        QString("{\"state\": \"%1\", \"elapsed\": %2"
+                ", \"programs\": {\"total\": %3, \"queued\": %4, \"running\": %5, \"finished\": %6}")
+            .arg(m_state)
+            .arg(JsonWriter::number(elapsed))
+            .arg(m_runner->programCount())
+            .arg(m_runner->queuedProgramCount())
+            .arg(m_runner->runningProgramCount())
+            .arg(m_finishedPrograms.size())
+      + QString(", \"tests\": {\"total\": %1, \"run\": %2, \"passed\": %3, \"failed\": %4, \"regressed\": %5}}")
+            .arg(m_runner->totalTestCount())
+            .arg(m_runner->runTestCount())
+            .arg(m_runner->passedTestCount())
+            .arg(m_runner->failedTestCount())
+            .arg(m_runner->regressedTestCount());
+    return json.toUtf8();
+}
@@ -0,0 +1,103 @@
+#ifndef STATUSSERVER_H
+#define STATUSSERVER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+class TestProgram;
+class TestRunner;
+
+// serves a TestRunner's live status over HTTP, on localhost only
+//
+//   GET /status    JSON snapshot: state, program & test counts
+//   GET /programs  JSON snapshot: each program's state & counts
+//   GET /metrics   runner overheads, in Prometheus text format (see RunnerMetrics)
+//   GET /events    server-sent events stream: 'listing-started', 'listing-finished',
+//                  'run-started', 'program-started', 'program-finished' (w/ each
+//                  test's result), 'run-finished' & 'status' (after each of the others)
+//
+// all socket I/O is asynchronous, so the runner is never kept waiting: event
+// clients that stop reading (too much unsent data) are dropped, as are clients
+// that don't finish sending a request within a few seconds (so idle connections
+// can't use up the client limit), & event data isn't even built unless someone
+// is listening.
+class StatusServer : public QObject {
+
+    Q_OBJECT
+
+    // ctor & dtor
+    public:
+        explicit StatusServer(TestRunner* runner, QObject* parent = 0);
+        ~StatusServer(void);
+
+    // StatusServer interface
+    public:
+        bool listen(quint16 port); // 0 = any free port
+        void close(void);
+        bool isListening(void) const;
+        quint16 port(void) const;
+        QString errorString(void) const;
+
+        // origin allowed to read responses from a browser page (CORS), e.g.
+        // 'http://dashboard.local:8080' - default: none, so other sites open in
+        // the user's browser can't read paths, test names, or failure messages
+        QString allowedOrigin(void) const;
+        void setAllowedOrigin(const QString& origin);
+
+    // internal methods
+    private slots:
+        void onClientDisconnected(void);
+        void onClientReadyRead(void);
+        void onKeepAlive(void);
+        void onNewConnection(void);
+        void onRequestTimeout(void);
+
+        void onListTestsFinished(void);
+        void onListTestsStarted(void);
+        void onProgramStarted(TestProgram* program);
+        void onRunTestsFinished(void);
+        void onRunTestsStarted(void);
+        void onTestResultsReady(TestProgram* program);
+    private:
+        void broadcast(const QByteArray& event, const QByteArray& data);
+        void broadcastStatus(void);
+        void handleRequest(QTcpSocket* client, const QByteArray& request);
+        QByteArray originHeader(void) const;
+        QByteArray programJson(const TestProgram* program, bool includeTests) const;
+        QByteArray programsJson(void) const;
+        QString programState(const TestProgram* program) const;
+        void removeClient(QTcpSocket* client);
+        void sendResponse(QTcpSocket* client,
+                          const QByteArray& status,
+                          const QByteArray& contentType,
+                          const QByteArray& body);
+        QByteArray statusJson(void) const;
+
+    // data members
+    private:
+        TestRunner* m_runner;   // copy, not owned
+        QTcpServer* m_server;
+        QTimer*     m_keepAliveTimer;
+        QTimer*     m_requestTimer;
+
+        QHash<QTcpSocket*, QByteArray> m_pendingRequests; // clients still sending a request
+        QHash<QTcpSocket*, qint64> m_requestDeadlines;    // msecs, on m_clock
+        QElapsedTimer m_clock;
+        QList<QTcpSocket*> m_eventClients;                // '/events' subscribers
+        QString m_allowedOrigin;
+
+        // run state
+        QString m_state;
+        QElapsedTimer m_timer;                  // since listing/run started
+        QSet<const TestProgram*> m_runningPrograms;
+        QSet<const TestProgram*> m_finishedPrograms;
+};
+
+#endif // STATUSSERVER_H
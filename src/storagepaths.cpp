@@ -0,0 +1,25 @@
+#include "storagepaths.h"
+#include <QtCore>
+#include <QtDebug>
+
+QString StoragePaths::dataDirectory(void) {
+    const QString path = QDir::homePath() + "/.edgecase";
+    QDir().mkpath(path);
+    return path;
+}
+
+QString StoragePaths::fileForRoot(const QString& category,
+                                  const QString& rootDirectory,
+                                  const QString& extension)
+{
+    // make sure category directory exists
+    const QString categoryPath = dataDirectory() + "/" + category;
+    QDir().mkpath(categoryPath);
+
+    // name file after a hash of the (canonical, if possible) root directory
+    QString root = QFileInfo(rootDirectory).canonicalFilePath();
+    if ( root.isEmpty() )
+        root = QFileInfo(rootDirectory).absoluteFilePath();
+    const QByteArray hash = QCryptographicHash::hash(root.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return categoryPath + "/" + QString::fromLatin1(hash) + "." + extension;
+}
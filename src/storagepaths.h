@@ -0,0 +1,19 @@
+#ifndef STORAGEPATHS_H
+#define STORAGEPATHS_H
+
+#include <QString>
+
+// locations of edgecase's persistent, per-user data
+class StoragePaths {
+    public:
+        // '~/.edgecase' (created if needed)
+        static QString dataDirectory(void);
+
+        // '~/.edgecase/<category>/<hash of root directory>.<extension>'
+        // (category directory is created if needed)
+        static QString fileForRoot(const QString& category,
+                                   const QString& rootDirectory,
+                                   const QString& extension);
+};
+
+#endif // STORAGEPATHS_H
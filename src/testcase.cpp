@@ -1,52 +1,165 @@
 #include "testcase.h"
+#include "messagestore.h"
+#include "testprogram.h"
+#include "testsuite.h"
 #include <QtCore>
 #include <QtDebug>
 
+namespace Constants {
+    enum { SpilledPreviewLength = 1024 };
+} // namespace Constants
+
 // -------------------------
 // TestCase implementation
 // -------------------------
 
 TestCase::TestCase(const QString& name)
-    : m_name(name)
+    : m_suite(0)
+    , m_name(name)
     , m_time(-1.0)
     , m_wasRun(false)
     , m_passed(false)
     , m_isEnabled(true)
+    , m_hasBenchmarkRegression(false)
+    , m_outputOffset(-1)
+    , m_outputSize(0)
 { }
 
 TestCase::~TestCase(void) { }
 
-void TestCase::addBenchmarkMessage(const QString& msg) {
-    m_benchmarkMessages.append(msg);
+void TestCase::addBenchmarkResult(const BenchmarkResult& result) {
+    m_benchmarkResults.append(result);
 }
 
 void TestCase::addFailureMessage(const QString& msg) {
-    m_failureMessages.append(msg);
+
+    FailureMessage failure;
+    failure.offset = -1;
+
+    // keep message in memory, if store allows it
+    MessageStore* store = messageStore();
+    if ( store == 0 || store->reserve(msg) ) {
+        failure.text = msg;
+        failure.size = msg.toUtf8().size();
+    }
+
+    // otherwise write to disk, keeping only a preview
+    else if ( store->append(msg, &failure.offset, &failure.size) )
+        failure.text = msg.left(Constants::SpilledPreviewLength);
+
+    // if that fails too, keep it in memory anyway (rather than drop it)
+    else {
+        failure.text = msg;
+        failure.size = msg.toUtf8().size();
+    }
+
+    m_failureMessages.append(failure);
 }
 
 void TestCase::addOtherMessage(const QString& msg) {
     m_otherMessages.append(msg);
 }
 
-QStringList TestCase::benchmarkMessages(void) const {
-    return m_benchmarkMessages;
+QList<BenchmarkComparison> TestCase::benchmarkComparisons(void) const {
+    return m_benchmarkComparisons;
+}
+
+QList<BenchmarkResult> TestCase::benchmarkResults(void) const {
+    return m_benchmarkResults;
 }
 
 void TestCase::clearResults(void) {
-    m_wasRun = false;
-    m_passed = false;
+
+    updateStatus(false, false);
     m_time = -1.0;
-    m_benchmarkMessages.clear();
+    m_outputOffset = -1;
+    m_outputSize = 0;
+    m_benchmarkResults.clear();
+    setBenchmarkComparisons( QList<BenchmarkComparison>() );
+
+    // return in-memory messages' space to store
+    MessageStore* store = messageStore();
+    if ( store ) {
+        foreach ( const FailureMessage& failure, m_failureMessages ) {
+            if ( failure.offset < 0 )
+                store->release(failure.text);
+        }
+    }
     m_failureMessages.clear();
     m_otherMessages.clear();
 }
 
+QString TestCase::failureMessage(int index) const {
+
+    Q_ASSERT_X(index >= 0 && index < m_failureMessages.size(), Q_FUNC_INFO, "index out of range");
+    const FailureMessage& failure = m_failureMessages.at(index);
+
+    // load from disk if needed
+    MessageStore* store = messageStore();
+    if ( failure.offset >= 0 && store )
+        return store->read(failure.offset, failure.size);
+    return failure.text;
+}
+
+qint64 TestCase::failureMessageBytes(void) const {
+    qint64 result = 0;
+    foreach ( const FailureMessage& failure, m_failureMessages )
+        result += failure.size;
+    return result;
+}
+
+int TestCase::failureMessageCount(void) const {
+    return m_failureMessages.size();
+}
+
 QStringList TestCase::failureMessages(void) const {
-    return m_failureMessages;
+    QStringList result;
+    const int numMessages = m_failureMessages.size();
+    for ( int i = 0; i < numMessages; ++i )
+        result.append( failureMessage(i) );
+    return result;
+}
+
+qint64 TestCase::failureMessageSize(int index) const {
+    Q_ASSERT_X(index >= 0 && index < m_failureMessages.size(), Q_FUNC_INFO, "index out of range");
+    return m_failureMessages.at(index).size;
+}
+
+QString TestCase::failurePreview(int maxLength) const {
+
+    if ( m_failureMessages.isEmpty() )
+        return QString();
+
+    // start of first message
+    QString preview = m_failureMessages.first().text.left(maxLength);
+
+    // note if there's more than that
+    const qint64 totalBytes = failureMessageBytes();
+    if ( m_failureMessages.size() > 1 || preview.size() < m_failureMessages.first().text.size() ||
+         m_failureMessages.first().offset >= 0 )
+    {
+        QString sizeString;
+        if ( totalBytes < 1024 )
+            sizeString = QString("%1 bytes").arg(totalBytes);
+        else if ( totalBytes < 1024*1024 )
+            sizeString = QString("%1 KB").arg(qreal(totalBytes)/1024, 0, 'f', 1);
+        else
+            sizeString = QString("%1 MB").arg(qreal(totalBytes)/(1024*1024), 0, 'f', 1);
+
+        preview.append( QString("...\n(%1 message(s), %2 total)")
+                        .arg(m_failureMessages.size())
+                        .arg(sizeString) );
+    }
+
+    return preview;
+}
+
+bool TestCase::hasBenchmarkRegression(void) const {
+    return m_hasBenchmarkRegression;
 }
 
-bool TestCase::hasBenchmarkMessages(void) const {
-    return !m_benchmarkMessages.isEmpty();
+bool TestCase::hasBenchmarkResults(void) const {
+    return !m_benchmarkResults.isEmpty();
 }
 
 bool TestCase::hasFailureMessages(void) const {
@@ -57,6 +170,10 @@ bool TestCase::hasOtherMessages(void) const {
     return !m_otherMessages.isEmpty();
 }
 
+bool TestCase::hasOutput(void) const {
+    return m_outputOffset >= 0 && m_outputSize > 0;
+}
+
 bool TestCase::hasTime(void) const {
     return m_time >= 0.0;
 }
@@ -65,6 +182,12 @@ bool TestCase::isEnabled(void) const {
     return m_isEnabled;
 }
 
+MessageStore* TestCase::messageStore(void) const {
+    if ( m_suite == 0 || m_suite->program() == 0 )
+        return 0;
+    return m_suite->program()->messageStore();
+}
+
 QString TestCase::name(void) const {
     return m_name;
 }
@@ -73,16 +196,67 @@ QStringList TestCase::otherMessages(void) const {
     return m_otherMessages;
 }
 
+QByteArray TestCase::output(void) const {
+    if ( !hasOutput() || m_suite == 0 || m_suite->program() == 0 )
+        return QByteArray();
+    return m_suite->program()->output(m_outputOffset, m_outputSize);
+}
+
+qint64 TestCase::outputOffset(void) const {
+    return m_outputOffset;
+}
+
+qint64 TestCase::outputSize(void) const {
+    return m_outputSize;
+}
+
 bool TestCase::passed(void) const {
     return m_passed;
 }
 
+void TestCase::setBenchmarkComparisons(const QList<BenchmarkComparison>& comparisons) {
+
+    m_benchmarkComparisons = comparisons;
+
+    // determine regression status
+    bool hasRegression = false;
+    foreach ( const BenchmarkComparison& comparison, m_benchmarkComparisons ) {
+        if ( comparison.status == BenchmarkComparison::Regressed ) {
+            hasRegression = true;
+            break;
+        }
+    }
+
+    // keep parent counts in sync
+    if ( hasRegression != m_hasBenchmarkRegression ) {
+        m_hasBenchmarkRegression = hasRegression;
+        if ( m_suite )
+            m_suite->adjustRegressedCount( hasRegression ? 1 : -1 );
+    }
+}
+
 void TestCase::setEnabled(bool ok) {
+
+    if ( m_isEnabled == ok )
+        return;
     m_isEnabled = ok;
+
+    // keep parent counts in sync
+    if ( m_suite )
+        m_suite->adjustCounts((ok ? 1 : -1), 0, 0, 0);
+}
+
+void TestCase::setOutputRange(qint64 offset, qint64 size) {
+    m_outputOffset = offset;
+    m_outputSize = size;
 }
 
 void TestCase::setPassed(bool ok) {
-    m_passed = ok;
+    updateStatus(m_wasRun, ok);
+}
+
+void TestCase::setSuite(TestSuite* suite) {
+    m_suite = suite;
 }
 
 void TestCase::setTime(qreal t) {
@@ -90,13 +264,38 @@ void TestCase::setTime(qreal t) {
 }
 
 void TestCase::setWasRun(bool ok) {
-    m_wasRun = ok;
+    updateStatus(ok, m_passed);
+}
+
+TestSuite* TestCase::suite(void) const {
+    return m_suite;
 }
 
 qreal TestCase::time(void) const {
     return m_time;
 }
 
+void TestCase::updateStatus(bool wasRun, bool passed) {
+
+    // skip if no change
+    if ( m_wasRun == wasRun && m_passed == passed )
+        return;
+
+    // determine count changes, using the same rules as TestSuite's counts
+    // (a test only counts as passed/failed if it was actually run)
+    const int runDelta    = int(wasRun) - int(m_wasRun);
+    const int passedDelta = int(wasRun && passed)  - int(m_wasRun && m_passed);
+    const int failedDelta = int(wasRun && !passed) - int(m_wasRun && !m_passed);
+
+    // store new status
+    m_wasRun = wasRun;
+    m_passed = passed;
+
+    // notify parent
+    if ( m_suite )
+        m_suite->adjustCounts(0, runDelta, passedDelta, failedDelta);
+}
+
 bool TestCase::wasRun(void) const {
     return m_wasRun;
 }
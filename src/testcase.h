@@ -1,8 +1,13 @@
 #ifndef TESTCASE_H
 #define TESTCASE_H
 
+#include "benchmarkbaseline.h"
+#include "benchmarkresult.h"
+#include <QList>
 #include <QMetaType>
 #include <QStringList>
+class MessageStore;
+class TestSuite;
 
 class TestCase {
 
@@ -17,6 +22,9 @@ class TestCase {
         // name
         QString name(void) const;
 
+        // parent suite (set when added to a TestSuite)
+        TestSuite* suite(void) const;
+
         // time
         qreal time(void) const;
         void setTime(qreal t);
@@ -35,33 +43,70 @@ class TestCase {
         void setEnabled(bool ok = true);
 
         // failures
+        // (large messages may be kept on disk, & are only loaded by failureMessage(s)())
         void addFailureMessage(const QString& msg);
         QStringList failureMessages(void) const;
+        QString failureMessage(int index) const;
+        int failureMessageCount(void) const;
+        qint64 failureMessageSize(int index) const; // UTF-8 size
         bool hasFailureMessages(void) const;
+        qint64 failureMessageBytes(void) const; // total UTF-8 size
+        QString failurePreview(int maxLength = 200) const;
 
         // benchmarks
-        void addBenchmarkMessage(const QString& msg);
-        QStringList benchmarkMessages(void) const;
-        bool hasBenchmarkMessages(void) const;
+        void addBenchmarkResult(const BenchmarkResult& result);
+        QList<BenchmarkResult> benchmarkResults(void) const;
+        bool hasBenchmarkResults(void) const;
+
+        // benchmark comparisons against pinned baseline (set by TestRunner)
+        QList<BenchmarkComparison> benchmarkComparisons(void) const;
+        void setBenchmarkComparisons(const QList<BenchmarkComparison>& comparisons);
+        bool hasBenchmarkRegression(void) const;
 
         // 'other' messages
         void addOtherMessage(const QString& msg);
         QStringList otherMessages(void) const;
         bool hasOtherMessages(void) const;
 
+        // captured output (byte range in our program's output log)
+        bool hasOutput(void) const;
+        QByteArray output(void) const; // view into mapped log, see OutputLog::data()
+        qint64 outputOffset(void) const;
+        qint64 outputSize(void) const;
+        void setOutputRange(qint64 offset, qint64 size);
+
         // add'l methods
         void clearResults(void);
 
+    // internal methods
+    private:
+        friend class TestSuite;
+        MessageStore* messageStore(void) const;
+        void setSuite(TestSuite* suite);
+        void updateStatus(bool wasRun, bool passed);
+
+        // failure message, either in memory or on disk (in our program's MessageStore)
+        struct FailureMessage {
+            QString text;     // full text, or preview if on disk
+            qint64  offset;   // -1 if in memory
+            qint64  size;     // UTF-8 bytes
+        };
+
     // data members
     private:
+        TestSuite* m_suite; // copy, not owned
         QString m_name;
         qreal m_time;
         bool m_wasRun;
         bool m_passed;
         bool m_isEnabled;
-        QStringList m_failureMessages;
-        QStringList m_benchmarkMessages;
+        QList<FailureMessage> m_failureMessages;
+        QList<BenchmarkResult> m_benchmarkResults;
+        QList<BenchmarkComparison> m_benchmarkComparisons;
+        bool m_hasBenchmarkRegression;
         QStringList m_otherMessages;
+        qint64 m_outputOffset;
+        qint64 m_outputSize;
 };
 
 Q_DECLARE_METATYPE(TestCase*)
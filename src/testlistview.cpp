@@ -3,172 +3,284 @@
 #include "testprogram.h"
 #include "testrunner.h"
 #include "testsuite.h"
+#include "testtreemodel.h"
+#include <QtConcurrentRun>
 #include <QtGui>
 #include <QtDebug>
 
+namespace Constants {
+
+    // expand the whole (filtered) tree when a search matches this many tests or less
+    const int MaxAutoExpandMatches = 500;
+
+    // queries wait for typing to pause this long (msecs)
+    const int DefaultSearchDelay = 150;
+
+} // namespace Constants
+
 // -----------------------------
 // TestListView implementation
 // -----------------------------
 
 TestListView::TestListView(TestRunner* runner, QWidget* parent)
-    : QTreeWidget(parent)
+    : QTreeView(parent)
     , m_runner(runner)
-    , m_passColor("#98fc66")
-    , m_failColor("#f44800")
-    , m_noResultColor("#aaaaaa")
+    , m_model(new TestTreeModel(runner, this))
+    , m_searchIndex(0)
+    , m_buildingIndex(0)
+    , m_indexWatcher(new QFutureWatcher<void>(this))
+    , m_isIndexStale(false)
+    , m_isBuildPending(false)
+    , m_searchTimer(new QTimer(this))
+    , m_searchMatchCount(-1)
 {
+    setModel(m_model);
+
     // hide our header, unused & unecessary visual clutter
     header()->setVisible(false);
 
+    // all rows are the same height, so the view needn't measure each one
+    setUniformRowHeights(true);
+
     // set our default size policy to fill available space
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
-    // intercept 'current item changed' signal to translate to specific testcase-type signal
-    connect(this, SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)),
-            this, SLOT(onCurrentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)));    
+    // intercept 'current index changed' signal to translate to specific testcase-type signal
+    connect(selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)),
+            this,             SLOT(onCurrentIndexChanged(QModelIndex,QModelIndex)));
+
+    // pass on checkbox changes
+    connect(m_model, SIGNAL(testSelectionChanged()), this, SIGNAL(testSelectionChanged()));
+
+    // swap in search index once built
+    connect(m_indexWatcher, SIGNAL(finished()), this, SLOT(onSearchIndexBuilt()));
+
+    // apply queries once typing pauses
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(Constants::DefaultSearchDelay);
+    connect(m_searchTimer, SIGNAL(timeout()), this, SLOT(applySearch()));
 }
 
-TestListView::~TestListView(void) { }
+TestListView::~TestListView(void) {
+
+    // let any background build finish, before its index goes away
+    m_indexWatcher->waitForFinished();
+    delete m_buildingIndex;
+    delete m_searchIndex;
+}
 
-QTreeWidgetItem* TestListView::itemForProgram(TestProgram* program) {
+void TestListView::applySearch(void) {
 
-    // sanity check
-    if ( program == 0 )
-        return 0;
-
-    // iterate over top-level (program-level) tree items
-    const int programCount = topLevelItemCount();
-    for ( int i = 0; i < programCount; ++i ) {
-        QTreeWidgetItem* programItem = topLevelItem(i);
-        Q_ASSERT_X(programItem, Q_FUNC_INFO, "null tree item");
-
-        // if tree item's data matches requested program, return it
-        const QVariant itemData = programItem->data(0, Qt::UserRole);
-        Q_ASSERT_X(itemData.canConvert<TestProgram*>(), Q_FUNC_INFO, "item/data mismatch");
-        TestProgram* itemProgram = itemData.value<TestProgram*>();
-        if ( itemProgram == program )
-            return programItem;
+    m_searchTimer->stop();
+
+    // no query: show everything
+    if ( m_searchQuery.trimmed().isEmpty() ) {
+        m_searchMatches = TestSearchIndex::Matches();
+        m_searchMatchCount = -1;
+        if ( m_model->isFiltered() ) {
+            const TreeState state = saveTreeState();
+            m_model->clearFilter();
+            restoreTreeState(state);
+        }
+        emit searchResultsChanged(m_searchMatchCount);
+        return;
     }
 
-    // not found
-    return 0;
+    // index not ready yet: query is applied once it's built
+    if ( m_searchIndex == 0 || !m_searchIndex->isBuilt() ) {
+        m_searchMatchCount = -1;
+        emit searchResultsChanged(m_searchMatchCount);
+        return;
+    }
+
+    // filter tree (a query that can't be parsed matches nothing)
+    // (the model is rebuilt, so expanded & current rows are put back after)
+    m_searchMatches = m_searchIndex->find(m_searchQuery);
+    m_searchMatchCount = m_searchMatches.count;
+    const TreeState state = saveTreeState();
+    m_model->setFilter(m_searchIndex, m_searchMatches);
+    restoreTreeState(state);
+    if ( m_searchMatchCount <= Constants::MaxAutoExpandMatches )
+        expandMatches();
+    emit searchResultsChanged(m_searchMatchCount);
 }
 
-void TestListView::onCurrentItemChanged(QTreeWidgetItem* current,
-                                        QTreeWidgetItem* previous)
+void TestListView::expandMatches(void) {
+
+    // fetch & expand programs & suites (lazy model, so expandAll() isn't enough)
+    const int numPrograms = m_model->rowCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        const QModelIndex programIndex = m_model->index(i, 0);
+        while ( m_model->canFetchMore(programIndex) )
+            m_model->fetchMore(programIndex);
+        expand(programIndex);
+
+        const int numSuites = m_model->rowCount(programIndex);
+        for ( int j = 0; j < numSuites; ++j ) {
+            const QModelIndex suiteIndex = m_model->index(j, 0, programIndex);
+            while ( m_model->canFetchMore(suiteIndex) )
+                m_model->fetchMore(suiteIndex);
+            expand(suiteIndex);
+        }
+    }
+}
+
+QModelIndex TestListView::fetchIndexForSuite(TestSuite* suite) {
+
+    Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+    const QModelIndex programIndex = m_model->indexForProgram(suite->program());
+    if ( !programIndex.isValid() )
+        return QModelIndex();
+
+    // look through program's rows, fetching more as needed
+    int row = 0;
+    forever {
+        const int numRows = m_model->rowCount(programIndex);
+        for ( ; row < numRows; ++row ) {
+            const QModelIndex index = m_model->index(row, 0, programIndex);
+            if ( m_model->suiteForIndex(index) == suite )
+                return index;
+        }
+        if ( !m_model->canFetchMore(programIndex) )
+            return QModelIndex();
+        m_model->fetchMore(programIndex);
+    }
+}
+
+QModelIndex TestListView::fetchIndexForTest(TestCase* test) {
+
+    Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+    const QModelIndex suiteIndex = fetchIndexForSuite(test->suite());
+    if ( !suiteIndex.isValid() )
+        return QModelIndex();
+
+    // look through suite's rows, fetching more as needed
+    int row = 0;
+    forever {
+        const int numRows = m_model->rowCount(suiteIndex);
+        for ( ; row < numRows; ++row ) {
+            const QModelIndex index = m_model->index(row, 0, suiteIndex);
+            if ( m_model->testForIndex(index) == test )
+                return index;
+        }
+        if ( !m_model->canFetchMore(suiteIndex) )
+            return QModelIndex();
+        m_model->fetchMore(suiteIndex);
+    }
+}
+
+bool TestListView::isSearchIndexReady(void) const {
+    return ( m_searchIndex != 0 && m_searchIndex->isBuilt() );
+}
+
+QList<TestCase*> TestListView::matchingTests(void) const {
+    if ( m_searchMatchCount < 0 || m_searchIndex == 0 )
+        return QList<TestCase*>();
+    return m_searchIndex->matchingTests(m_searchMatches);
+}
+
+void TestListView::onBenchmarkBaselineChanged(void) {
+
+    // refresh regression colors & tooltips
+    m_model->updateAll();
+}
+
+void TestListView::onCurrentIndexChanged(const QModelIndex& current,
+                                         const QModelIndex& previous)
 {
     Q_UNUSED(previous);
-    if ( current == 0 )
+    if ( !current.isValid() )
         return;
 
-    // fetch item's data (we always use column 0)
-    QVariant itemData = current->data(0, Qt::UserRole);
+    TestProgram* program = m_model->programForIndex(current);
+    TestSuite*   suite   = m_model->suiteForIndex(current);
+    TestCase*    test    = m_model->testForIndex(current);
 
     // TestProgram
-    if ( itemData.canConvert<TestProgram*>() ) {
-        TestProgram* program = itemData.value<TestProgram*>();
-        emit testProgramSelected( program  );
-    }
+    if ( program )
+        emit testProgramSelected(program);
 
     // TestSuite
-    else if ( itemData.canConvert<TestSuite*>() ) {
-        TestSuite* suite = itemData.value<TestSuite*>();
+    else if ( suite )
         emit testSuiteSelected(suite);
-    }
 
     // TestCase
-    else if ( itemData.canConvert<TestCase*>() ) {
-        TestCase* test = itemData.value<TestCase*>();
+    else if ( test )
         emit testCaseSelected(test);
-    }
 }
 
 void TestListView::onListTestsStarted(void) {
-    clear();
+
+    m_model->clear();
+
+    // old index points at tests that are being removed
+    delete m_searchIndex;
+    m_searchIndex = 0;
+    m_searchMatches = TestSearchIndex::Matches();
+    m_searchMatchCount = -1;
+    if ( m_indexWatcher->isRunning() ) {
+        m_isIndexStale = true;
+        m_isBuildPending = false;
+    }
 }
 
 void TestListView::onListTestsFinished(void) {
 
-    // sanity check
-    Q_ASSERT_X(m_runner, Q_FUNC_INFO, "null test runner");
-    if ( m_runner == 0 )
-        return;
+    // one row per program, suites & tests are fetched as they're expanded
+    // (starts with all items collapsed)
+    m_model->reset();
+
+    // index new tests for searching
+    startSearchIndexBuild();
+}
 
-    // clear any previous data (necessary here?)
-    clear();
+void TestListView::onRunTestsStarted(void) {
 
-    // foreach program
-    const int numPrograms = m_runner->programCount();
-    for ( int i = 0; i < numPrograms; ++i ) {
-        TestProgram* program = m_runner->programAt(i);
-        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    // gray out all tests, & keep selection as run
+    m_model->markAllPending();
+    m_model->setSelectionLocked(true);
+}
 
-        // create top-level item for program
-        QTreeWidgetItem* programItem = new QTreeWidgetItem;
-        programItem->setData(0, Qt::DisplayRole, program->programName());
-        programItem->setData(0, Qt::UserRole, QVariant::fromValue(program));
-//        programItem->setCheckState(0, Qt::Checked);
+void TestListView::onRunTestsFinished(void) {
+    m_model->setSelectionLocked(false);
+}
 
-        // foreach test suite
-        const int numSuites = program->suiteCount();
-        for ( int j = 0; j < numSuites; ++j ) {
-            TestSuite* suite = program->suiteAt(j);
-            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-
-            // create item for suite
-            QTreeWidgetItem* suiteItem = new QTreeWidgetItem(programItem);
-            suiteItem->setData(0, Qt::DisplayRole, suite->name());
-            suiteItem->setData(0, Qt::UserRole, QVariant::fromValue(suite));
-//            suiteItem->setCheckState(0, Qt::Checked);
-
-            // foreach test case
-            const int numTests = suite->testCount();
-            for ( int k = 0; k < numTests; ++k ) {
-                TestCase* test = suite->testAt(k);
-                Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-
-                // create item for test
-                QTreeWidgetItem* testItem = new QTreeWidgetItem(suiteItem);
-                testItem->setData(0, Qt::DisplayRole, test->name());
-                testItem->setData(0, Qt::UserRole, QVariant::fromValue(test));
-//                testItem->setCheckState(0, Qt::Checked);
-            }
-        }
+void TestListView::onSearchIndexBuilt(void) {
 
-        // add program item to table
-        addTopLevelItem(programItem);
+    // tests were re-listed during build, drop it
+    if ( m_isIndexStale ) {
+        delete m_buildingIndex;
+        m_buildingIndex = 0;
+        m_isIndexStale = false;
     }
 
-    // start with all items collapsed
-    collapseAll();
-}
-
-void TestListView::onRunTestsStarted(void) {
+    // otherwise, use it (applying any query typed so far)
+    else {
+        delete m_searchIndex;
+        m_searchIndex = m_buildingIndex;
+        m_buildingIndex = 0;
+        applySearch();
+    }
 
-    // gray out all tests
-    const int programCount = topLevelItemCount();
-    for ( int i = 0; i < programCount; ++i ) {
-        QTreeWidgetItem* programItem = topLevelItem(i);
-        Q_ASSERT_X(programItem, Q_FUNC_INFO, "null tree item");
-        programItem->setBackgroundColor(0, m_noResultColor);
-
-        const int suiteCount = programItem->childCount();
-        for ( int j = 0; j < suiteCount; ++j ) {
-            QTreeWidgetItem* suiteItem = programItem->child(j);
-            Q_ASSERT_X(suiteItem, Q_FUNC_INFO, "null tree item");
-            suiteItem->setBackgroundColor(0, m_noResultColor);
-
-            const int testCount = suiteItem->childCount();
-            for ( int k = 0; k < testCount; ++k ) {
-                QTreeWidgetItem* testItem = suiteItem->child(k);
-                Q_ASSERT_X(testItem, Q_FUNC_INFO, "null tree item");
-                testItem->setBackgroundColor(0, m_noResultColor);
-            }
-        }
+    // listing finished during build
+    if ( m_isBuildPending ) {
+        m_isBuildPending = false;
+        startSearchIndexBuild();
     }
 }
 
-void TestListView::onRunTestsFinished(void) { }
+void TestListView::onTestResultsBatchReady(const QList<TestProgram*>& programs) {
+
+    if ( programs.isEmpty() )
+        return;
+
+    // refresh programs' rows, & any of their visible suites & tests
+    m_model->updatePrograms(programs);
+
+    // select first program item if none selected yet
+    if ( !currentIndex().isValid() )
+        setCurrentIndex( m_model->indexForProgram(programs.first()) );
+}
 
 void TestListView::onTestResultsReady(TestProgram* program) {
 
@@ -177,75 +289,107 @@ void TestListView::onTestResultsReady(TestProgram* program) {
     if ( program == 0 )
         return;
 
-    // fetch tree item for requested program
-    QTreeWidgetItem* programItem = itemForProgram(program);
-    if ( programItem == 0 )
-        return;
-    updateItemForResults(programItem);
-
-    // update program's children (suites & test cases)
-    const int suiteCount = programItem->childCount();
-    for ( int j = 0; j < suiteCount; ++j ) {
-        QTreeWidgetItem* suiteItem = programItem->child(j);
-        if ( suiteItem )
-            updateItemForResults(suiteItem);
-
-        // foreach test case
-        const int testCount = suiteItem->childCount();
-        for ( int k = 0; k < testCount; ++k ) {
-            QTreeWidgetItem* testItem = suiteItem->child(k);
-            if ( testItem )
-                updateItemForResults(testItem);
-        }
+    onTestResultsBatchReady( QList<TestProgram*>() << program );
+}
+
+void TestListView::restoreTreeState(const TreeState& state) {
+
+    // re-expand rows that are still shown
+    foreach ( TestProgram* program, state.expandedPrograms ) {
+        const QModelIndex index = m_model->indexForProgram(program);
+        if ( index.isValid() )
+            expand(index);
+    }
+    foreach ( TestSuite* suite, state.expandedSuites ) {
+        const QModelIndex index = fetchIndexForSuite(suite);
+        if ( index.isValid() )
+            expand(index);
     }
 
-    // select program item if none selected yet
-    QTreeWidgetItem* item = currentItem();
-    if ( item == 0 )
-        setCurrentItem(programItem);
+    // & current row, if still shown
+    QModelIndex current;
+    if ( state.currentProgram )
+        current = m_model->indexForProgram(state.currentProgram);
+    else if ( state.currentSuite )
+        current = fetchIndexForSuite(state.currentSuite);
+    else if ( state.currentTest )
+        current = fetchIndexForTest(state.currentTest);
+    if ( current.isValid() ) {
+        setCurrentIndex(current);
+        scrollTo(current);
+    }
 }
 
-void TestListView::updateItemForResults(QTreeWidgetItem*item) {
+TestListView::TreeState TestListView::saveTreeState(void) const {
 
-    Q_ASSERT_X(item, Q_FUNC_INFO, "null item");
-    const QVariant itemData = item->data(0, Qt::UserRole);
+    TreeState state;
+    const QModelIndex current = currentIndex();
+    state.currentProgram = m_model->programForIndex(current);
+    state.currentSuite   = m_model->suiteForIndex(current);
+    state.currentTest    = m_model->testForIndex(current);
 
-    // TestProgram
-    if ( itemData.canConvert<TestProgram*>() ) {
-        TestProgram* program = itemData.value<TestProgram*>();
-        if ( !program->hasRunTests() )
-            item->setBackgroundColor(0, m_noResultColor);
-        else {
-            if ( program->hasFailedTests() )
-                item->setBackgroundColor(0, m_failColor);
-            else
-                item->setBackgroundColor(0, m_passColor);
-        }
-    }
+    // expanded programs & suites (only those fetched can be expanded)
+    const int numPrograms = m_model->rowCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        const QModelIndex programIndex = m_model->index(i, 0);
+        if ( !isExpanded(programIndex) )
+            continue;
+        state.expandedPrograms.append( m_model->programForIndex(programIndex) );
 
-    // TestSuite
-    else if ( itemData.canConvert<TestSuite*>() ) {
-        TestSuite* suite = itemData.value<TestSuite*>();
-        if ( !suite->hasRunTests() )
-            item->setBackgroundColor(0, m_noResultColor);
-        else {
-            if ( suite->hasFailedTests() )
-                item->setBackgroundColor(0, m_failColor);
-            else
-                item->setBackgroundColor(0, m_passColor);
+        const int numSuites = m_model->rowCount(programIndex);
+        for ( int j = 0; j < numSuites; ++j ) {
+            const QModelIndex suiteIndex = m_model->index(j, 0, programIndex);
+            if ( isExpanded(suiteIndex) )
+                state.expandedSuites.append( m_model->suiteForIndex(suiteIndex) );
         }
     }
+    return state;
+}
 
-    // TestCase
-    else if ( itemData.canConvert<TestCase*>() ) {
-        TestCase* test = itemData.value<TestCase*>();
-        if ( !test->wasRun() )
-            item->setBackgroundColor(0, m_noResultColor);
-        else {
-            if ( !test->passed() )
-                item->setBackgroundColor(0, m_failColor);
-            else
-                item->setBackgroundColor(0, m_passColor);
-        }
+int TestListView::searchDelay(void) const {
+    return m_searchTimer->interval();
+}
+
+int TestListView::searchMatchCount(void) const {
+    return m_searchMatchCount;
+}
+
+QString TestListView::searchQuery(void) const {
+    return m_searchQuery;
+}
+
+void TestListView::setSearchDelay(int msecs) {
+    m_searchTimer->setInterval( qMax(0, msecs) );
+}
+
+void TestListView::setSearchQuery(const QString& query) {
+
+    if ( query == m_searchQuery )
+        return;
+    m_searchQuery = query;
+
+    // wait for typing to pause (each keystroke restarts the delay)
+    if ( m_searchTimer->interval() == 0 )
+        applySearch();
+    else
+        m_searchTimer->start();
+}
+
+void TestListView::startSearchIndexBuild(void) {
+
+    // one build at a time
+    if ( m_indexWatcher->isRunning() ) {
+        m_isBuildPending = true;
+        return;
     }
+
+    // copy names on this thread (cheap), index them on another
+    m_isIndexStale = false;
+    m_buildingIndex = new TestSearchIndex;
+    m_buildingIndex->setSource(m_runner);
+    m_indexWatcher->setFuture( QtConcurrent::run(m_buildingIndex, &TestSearchIndex::build) );
+}
+
+TestTreeModel* TestListView::testModel(void) const {
+    return m_model;
 }
@@ -1,14 +1,20 @@
 #ifndef TESTLISTVIEW_H
 #define TESTLISTVIEW_H
 
-#include <QColor>
-#include <QTreeWidget>
+#include <QFutureWatcher>
+#include <QList>
+#include <QModelIndex>
+#include <QString>
+#include <QTreeView>
+#include "testsearchindex.h"
+class QTimer;
 class TestCase;
 class TestSuite;
 class TestProgram;
 class TestRunner;
+class TestTreeModel;
 
-class TestListView : public QTreeWidget {
+class TestListView : public QTreeView {
 
     Q_OBJECT
 
@@ -22,6 +28,8 @@ class TestListView : public QTreeWidget {
         void testCaseSelected(TestCase* test);
         void testSuiteSelected(TestSuite* suite);
         void testProgramSelected(TestProgram* program);
+        void searchResultsChanged(int matchCount); // -1 if not filtering
+        void testSelectionChanged(void);           // rows checked/unchecked
 
     // TestListView interface
     public slots:
@@ -30,21 +38,56 @@ class TestListView : public QTreeWidget {
         void onRunTestsStarted(void);
         void onRunTestsFinished(void);
         void onTestResultsReady(TestProgram* program);
+        void onTestResultsBatchReady(const QList<TestProgram*>& programs); // see ResultBatcher
+        void onBenchmarkBaselineChanged(void);
+        void setSearchQuery(const QString& query);
+    public:
+        TestTreeModel* testModel(void) const;
+
+        // search filter (indexed in the background after each listing)
+        // queries are applied once typing pauses for the search delay, keeping
+        // expanded rows & the current row where they're still shown
+        QString searchQuery(void) const;
+        int searchDelay(void) const;         // msecs, default: 150 (0 = apply at once)
+        void setSearchDelay(int msecs);
+        bool isSearchIndexReady(void) const;
+        int searchMatchCount(void) const;
+        QList<TestCase*> matchingTests(void) const;
 
     // internal methods
     private slots:
-        void onCurrentItemChanged(QTreeWidgetItem* current, QTreeWidgetItem* previous);
+        void onCurrentIndexChanged(const QModelIndex& current, const QModelIndex& previous);
+        void onSearchIndexBuilt(void);
+        void applySearch(void);
     private:
-        QTreeWidgetItem* itemForProgram(TestProgram* program);
-        void updateItemForResults(QTreeWidgetItem* item);
+        struct TreeState {
+            QList<TestProgram*> expandedPrograms;
+            QList<TestSuite*>   expandedSuites;
+            TestProgram* currentProgram;  // (only the current row's kind is set)
+            TestSuite*   currentSuite;
+            TestCase*    currentTest;
+        };
+        void expandMatches(void);
+        QModelIndex fetchIndexForSuite(TestSuite* suite);
+        QModelIndex fetchIndexForTest(TestCase* test);
+        void restoreTreeState(const TreeState& state);
+        TreeState saveTreeState(void) const;
+        void startSearchIndexBuild(void);
 
     // data members
     private:
-        TestRunner* m_runner; // copy, not owned
+        TestRunner*    m_runner; // copy, not owned
+        TestTreeModel* m_model;
 
-        QColor m_passColor;
-        QColor m_failColor;
-        QColor m_noResultColor;
+        TestSearchIndex* m_searchIndex;   // ready for queries
+        TestSearchIndex* m_buildingIndex; // being built in background
+        QFutureWatcher<void>* m_indexWatcher;
+        bool m_isIndexStale;              // listing restarted during build
+        bool m_isBuildPending;            // build again, once current one is done
+        QString m_searchQuery;
+        QTimer* m_searchTimer;            // delays queries while typing
+        TestSearchIndex::Matches m_searchMatches;
+        int m_searchMatchCount;
 };
 
 #endif // TESTLISTVIEW_H
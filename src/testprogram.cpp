@@ -1,9 +1,22 @@
 #include "testprogram.h"
+#include "runnermetrics.h"
 #include "testcase.h"
+#include "testresultbatch.h"
 #include "testsuite.h"
+#include <QtConcurrentRun>
 #include <QtCore>
 #include <QtDebug>
 
+namespace Constants {
+
+    // limits on captured output, per program run
+    const qint64 MaxOutputBytes      = Q_INT64_C(256) * 1024 * 1024;
+    const qint64 MaxOutputRate       = Q_INT64_C(32) * 1024 * 1024;  // bytes per window
+    const qint64 OutputRateWindow    = 1000;                         // msecs
+    const int    MaxMarkerLineLength = 1024; // only the start of a line is checked for markers
+
+} // namespace Constants
+
 // ----------------------------
 // TestProgram implementation
 // ----------------------------
@@ -14,17 +27,93 @@ TestProgram::TestProgram(const QString& filename, QObject* parent)
     , m_time(-1.0)
     , m_currentTask(TestProgram::NoTask)
     , m_process(new QProcess(this))
+    , m_messageStore(0)
+    , m_timeoutTimer(new QTimer(this))
+    , m_isTimedOut(false)
+    , m_processFinishedTime(-1.0)
+    , m_parseWatcher(new QFutureWatcher<void>(this))
+    , m_resultBatch(0)
+    , m_isParseOk(false)
+    , m_unfinishedTest(0)
+    , m_partialLineOffset(0)
+    , m_outputTest(0)
+    , m_outputTestOffset(0)
+    , m_outputTestStartTime(-1.0)
+    , m_outputWindowBytes(0)
+    , m_isOutputRateLimited(false)
+    , m_isOutputTruncated(false)
+    , m_totalCount(0)
+    , m_enabledCount(0)
+    , m_runCount(0)
+    , m_passedCount(0)
+    , m_failedCount(0)
+    , m_regressedCount(0)
 {
     connect(m_process, SIGNAL(finished(int,QProcess::ExitStatus)),
             SLOT(onProcessFinished(int,QProcess::ExitStatus)));
+    connect(m_process, SIGNAL(error(QProcess::ProcessError)),
+            SLOT(onProcessError(QProcess::ProcessError)));
+    connect(m_process, SIGNAL(started()), SLOT(onProcessStarted()));
+    connect(m_process, SIGNAL(readyReadStandardOutput()), SLOT(readOutput()));
+
+    m_timeoutTimer->setSingleShot(true);
+    m_timeoutTimer->setInterval(0);
+    connect(m_timeoutTimer, SIGNAL(timeout()), SLOT(onTimeout()));
+
+    // parsed output is applied back on our thread
+    connect(m_parseWatcher, SIGNAL(finished()), SLOT(onParseFinished()));
+
+    m_taskTiming.spawnTime   = -1.0;
+    m_taskTiming.processTime = -1.0;
+    m_taskTiming.parseTime   = -1.0;
+    m_taskTiming.totalTime   = -1.0;
 }
 
 TestProgram::~TestProgram(void) {
+
+    // let any parse finish, before what it reads goes away
+    m_parseWatcher->waitForFinished();
+    delete m_resultBatch;
     removeAllSuites();
 }
 
 void TestProgram::addSuite(TestSuite* suite) {
+
+    Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
     m_suites.append(suite);
+    suite->setProgram(this);
+    if ( !m_suitesByName.contains(suite->name()) )
+        m_suitesByName.insert(suite->name(), suite);
+
+    // include the new suite's current counts in ours
+    adjustCounts(suite->testCount(),
+                 suite->enabledTestCount(),
+                 suite->runTestCount(),
+                 suite->passedTestCount(),
+                 suite->failedTestCount());
+    adjustRegressedCount(suite->regressedTestCount());
+}
+
+void TestProgram::adjustCounts(int totalDelta,
+                               int enabledDelta,
+                               int runDelta,
+                               int passedDelta,
+                               int failedDelta)
+{
+    m_totalCount   += totalDelta;
+    m_enabledCount += enabledDelta;
+    m_runCount     += runDelta;
+    m_passedCount  += passedDelta;
+    m_failedCount  += failedDelta;
+
+    Q_ASSERT_X(m_totalCount >= 0 && m_enabledCount >= 0 && m_runCount >= 0 &&
+               m_passedCount >= 0 && m_failedCount >= 0,
+               Q_FUNC_INFO, "negative test count");
+}
+
+void TestProgram::adjustRegressedCount(int delta) {
+    m_regressedCount += delta;
+    Q_ASSERT_X(m_regressedCount >= 0, Q_FUNC_INFO, "negative test count");
 }
 
 void TestProgram::clearResults(void) {
@@ -35,44 +124,91 @@ void TestProgram::clearResults(void) {
     }
 }
 
+int TestProgram::enabledTestCount(void) const {
+    return m_enabledCount;
+}
+
+QString TestProgram::errorString(void) const {
+    return m_errorString;
+}
+
 int TestProgram::failedTestCount(void) const {
-    int result = 0;
-    foreach ( TestSuite* suite, m_suites ) {
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-        result += suite->failedTestCount();
-    }
-    return result;
+    return m_failedCount;
+}
+
+void TestProgram::failRun(const QString& message) {
+
+    // finish as a run whose process never started (so no results or timing)
+    m_outputLog.close();
+    m_errorString = message;
+    m_isTimedOut = false;
+    m_taskTiming.spawnTime   = -1.0;
+    m_taskTiming.processTime = -1.0;
+    m_taskTiming.parseTime   = -1.0;
+    m_taskTiming.totalTime   = -1.0;
+    m_currentTask = TestProgram::NoTask;
+    emit resultsReady(this);
+}
+
+void TestProgram::failUnfinishedTest(TestCase* test, const QString& message) {
+
+    // leave alone if results were reported before the program died
+    Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+    if ( test->wasRun() )
+        return;
+
+    test->setWasRun(true);
+    test->setPassed(false);
+    test->addFailureMessage(message);
 }
 
 QString TestProgram::fileName(void) const {
     return m_filename;
 }
 
-bool TestProgram::hasEnabledTests(void) const {
-    foreach ( TestSuite* suite, m_suites ) {
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-        if ( suite->hasEnabledTests() )
-            return true;
+void TestProgram::finishOutput(void) {
+
+    // read anything left over
+    readOutput();
+
+    // handle final line, if not newline-terminated
+    if ( !m_partialLine.isEmpty() ) {
+        const QByteArray line = m_partialLine;
+        m_partialLine.clear();
+        processOutputLine(line, m_partialLineOffset, m_outputLog.size());
     }
-    return false;
+
+    // if a test never finished (e.g. crashed), it gets the rest of the output
+    if ( m_outputTest ) {
+        m_outputTest->setOutputRange(m_outputTestOffset, m_outputLog.size() - m_outputTestOffset);
+        m_outputTest = 0;
+    }
+
+    m_outputLog.close();
+}
+
+bool TestProgram::hasEnabledTests(void) const {
+    return m_enabledCount > 0;
+}
+
+bool TestProgram::hasError(void) const {
+    return !m_errorString.isEmpty();
 }
 
 bool TestProgram::hasFailedTests(void) const {
-    foreach ( TestSuite* suite, m_suites ) {
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-        if ( suite->hasFailedTests() )
-            return true;
-    }
-    return false;
+    return m_failedCount > 0;
+}
+
+bool TestProgram::hasRegressedTests(void) const {
+    return m_regressedCount > 0;
+}
+
+bool TestProgram::hasRunnableTests(void) const {
+    return hasEnabledTests();
 }
 
 bool TestProgram::hasRunTests(void) const {
-    foreach ( TestSuite* suite, m_suites ) {
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-        if ( suite->hasRunTests() )
-            return true;
-    }
-    return false;
+    return m_runCount > 0;
 }
 
 bool TestProgram::hasTime(void) const {
@@ -105,101 +241,312 @@ void TestProgram::initializeListing(const QMap<QString, QStringList>& listingMap
     }
 }
 
+TestProgram::TaskTiming TestProgram::lastTaskTiming(void) const {
+    return m_taskTiming;
+}
+
+QByteArray TestProgram::limitOutput(const QByteArray& data) {
+
+    // drop everything once we've hit the size limit
+    if ( m_isOutputTruncated )
+        return QByteArray();
+
+    // check rate limit, starting a new window if needed
+    if ( !m_outputRateTimer.isValid() || m_outputRateTimer.elapsed() > Constants::OutputRateWindow ) {
+        m_outputRateTimer.start();
+        m_outputWindowBytes = 0;
+        m_isOutputRateLimited = false;
+    }
+    if ( m_isOutputRateLimited )
+        return QByteArray();
+    if ( m_outputWindowBytes + data.size() > Constants::MaxOutputRate ) {
+        m_isOutputRateLimited = true;
+        return QByteArray("\n[edgecase: output rate limit exceeded, dropping output]\n");
+    }
+    m_outputWindowBytes += data.size();
+
+    // check size limit
+    const qint64 remaining = Constants::MaxOutputBytes - m_outputLog.size();
+    if ( data.size() > remaining ) {
+        m_isOutputTruncated = true;
+        return data.left(int(qMax(qint64(0), remaining)))
+                + QByteArray("\n[edgecase: output size limit reached, remaining output dropped]\n");
+    }
+
+    // if we get here, data is OK as-is
+    return data;
+}
+
 QProcess::ProcessChannel TestProgram::listingOutputChannel(void) const {
     return QProcess::StandardOutput;
 }
 
 void TestProgram::listTests(void) {
 
-    // skip if our process is still running
-    if ( m_process->state() != QProcess::NotRunning )
+    // skip if our process is still running (or its output being parsed)
+    if ( m_process->state() != QProcess::NotRunning || m_parseWatcher->isRunning() )
         return;
 
-    // set our state & start process (w/ args from derived class)
-    m_currentTask = TestProgram::ListTests;
-    const QStringList args = listingArgs();
-    m_process->start(m_filename, args);
+    // start process (w/ args from derived class)
+    startProcess(TestProgram::ListTests, QProcess::SeparateChannels, listingArgs());
+}
+
+void TestProgram::onParseFinished(void) {
+
+    // apply parsed output
+    // (signals are always emitted, so anyone waiting on us can move on)
+    switch ( m_currentTask ) {
+
+        case TestProgram::ListTests :
+        {
+            // if no errors, set up suite/test case hierachy
+            if ( !hasError() ) {
+                if ( m_parseErrors.isEmpty() )
+                    initializeListing(m_parsedListing);
+                else
+                    m_errorString = QString("Could not get test listing: %1").arg(m_parseErrors.join("; "));
+            }
+            m_parsedListing.clear();
+
+            m_taskTiming.totalTime = RunnerMetrics::elapsedSeconds(m_taskTimer);
+            m_taskTiming.parseTime = m_taskTiming.totalTime - m_processFinishedTime;
+            m_currentTask = TestProgram::NoTask;
+            emit listingReady(this);
+            break;
+        }
+
+        case TestProgram::RunTests :
+        {
+            // whatever results were written, in one go
+            Q_ASSERT_X(m_resultBatch, Q_FUNC_INFO, "null result batch");
+            m_resultBatch->applyTo(this);
+            if ( m_resultBatch->programTime() >= 0.0 )
+                setTime( m_resultBatch->programTime() );
+            delete m_resultBatch;
+            m_resultBatch = 0;
+
+            if ( !m_isParseOk ) {
+                const QString message = QString("Could not parse results: %1").arg(m_parseErrors.join("; "));
+                m_errorString = ( hasError() ? m_errorString + "; " + message : message );
+            }
+
+            // a test that was still running when the program died has failed
+            if ( m_unfinishedTest && !m_exitError.isEmpty() )
+                failUnfinishedTest(m_unfinishedTest, m_exitError);
+            m_unfinishedTest = 0;
+            m_exitError.clear();
+
+            m_taskTiming.totalTime = RunnerMetrics::elapsedSeconds(m_taskTimer);
+            m_taskTiming.parseTime = m_taskTiming.totalTime - m_processFinishedTime;
+            m_currentTask = TestProgram::NoTask;
+            emit resultsReady(this);
+            break;
+        }
+
+        default:
+            Q_ASSERT_X(false, Q_FUNC_INFO, "unexpected task type");
+            m_currentTask = TestProgram::NoTask;
+            break;
+    }
+}
+
+void TestProgram::onProcessError(QProcess::ProcessError error) {
+
+    // crashes & kills are handled on finish, but a process that
+    // fails to start never finishes - so finish the task here
+    if ( error != QProcess::FailedToStart || m_currentTask == TestProgram::NoTask )
+        return;
+
+    m_errorString = m_process->errorString();
+    onProcessFinished(-1, QProcess::CrashExit);
 }
 
 void TestProgram::onProcessFinished(int exitCode, QProcess::ExitStatus status) {
 
-    // TODO: error handling
+    // non-zero exit codes just mean failed tests, for most frameworks
     Q_UNUSED(exitCode);
-    Q_UNUSED(status);
 
-    // handle process completion depending on our current task
+    // note process lifetime
+    m_processFinishedTime = RunnerMetrics::elapsedSeconds(m_taskTimer);
+    if ( m_taskTiming.spawnTime >= 0.0 )
+        m_taskTiming.processTime = m_processFinishedTime - m_taskTiming.spawnTime;
+
+    // note any abnormal exit
+    m_timeoutTimer->stop();
+    if ( m_isTimedOut )
+        m_errorString = QString("Timed out after %1 s").arg(timeout() / 1000.0);
+    else if ( status == QProcess::CrashExit && m_errorString.isEmpty() )
+        m_errorString = "Crashed";
+
+    // parse output on the global thread pool, so large results don't block
+    // the GUI (& programs finishing together are parsed in parallel);
+    // onParseFinished() picks up from there
+    m_parsedListing.clear();
+    m_parseErrors.clear();
+    m_isParseOk = false;
     switch ( m_currentTask ) {
 
         case TestProgram::ListTests :
         {
+            // a listing from a program that didn't exit cleanly can't be trusted
+            if ( hasError() ) {
+                onParseFinished();
+                break;
+            }
+
             // read listing output from standard out/error
             const QByteArray output = ( listingOutputChannel() == QProcess::StandardOutput
                                           ? m_process->readAllStandardOutput()
                                           : m_process->readAllStandardError()
                                       );
-
-            // parse listing from program output
-            QStringList errors;
-            QMap<QString, QStringList> listing = parseTestListing(output, &errors);
-
-            // if no errors, set up suite/test case hierachy & emit signal
-            if ( errors.isEmpty() ) {
-                initializeListing(listing);
-                emit listingReady(this);
-            }
-
-            // else report error msgs
-            else {
-                qDebug() << "Could not get test listing: ";
-                foreach ( const QString& e, errors )
-                    qDebug() << e;
-            }
-
+            m_parseWatcher->setFuture( QtConcurrent::run(this, &TestProgram::parseListing, output) );
             break;
         }
 
         case TestProgram::RunTests :
         {
-            QStringList errors;
-            if ( parseTestResults(&errors) )
-                emit resultsReady(this);
-            else {
-                qDebug() << "Could not parse results: ";
-                foreach ( const QString& e, errors )
-                    qDebug() << e;
-            }
-
+            m_unfinishedTest = m_outputTest;
+            m_exitError = m_errorString;
+            finishOutput();
+
+            // results are collected apart from our tests, & applied once parsed
+            delete m_resultBatch;
+            m_resultBatch = new TestResultBatch(this);
+            m_parseWatcher->setFuture( QtConcurrent::run(this, &TestProgram::parseResults) );
             break;
         }
 
         default:
             Q_ASSERT_X(false, Q_FUNC_INFO, "unexpected task type");
+            m_currentTask = TestProgram::NoTask;
             break;
     }
+}
 
-    // reset our task state
-    m_currentTask = TestProgram::NoTask;
+void TestProgram::onProcessStarted(void) {
+    m_taskTiming.spawnTime = RunnerMetrics::elapsedSeconds(m_taskTimer);
+}
+
+void TestProgram::onTimeout(void) {
+    m_isTimedOut = true;
+    m_process->kill();
+}
+
+MessageStore* TestProgram::messageStore(void) const {
+    return m_messageStore;
+}
+
+QByteArray TestProgram::output(qint64 offset, qint64 size) const {
+    return m_outputLog.data(offset, size);
+}
+
+QString TestProgram::outputLogFilename(void) const {
+    return m_outputLog.fileName();
+}
+
+qint64 TestProgram::outputSize(void) const {
+    return m_outputLog.size();
+}
+
+void TestProgram::parseListing(const QByteArray& output) {
+    m_parsedListing = parseTestListing(output, &m_parseErrors);
+}
+
+TestProgram::OutputMarker TestProgram::parseOutputLine(const QByteArray& line,
+                                                       QString* suiteName,
+                                                       QString* testName) const
+{
+    Q_UNUSED(line);
+    Q_UNUSED(suiteName);
+    Q_UNUSED(testName);
+    return TestProgram::NoMarker;
+}
+
+void TestProgram::parseResults(void) {
+    Q_ASSERT_X(m_resultBatch, Q_FUNC_INFO, "null result batch");
+    m_isParseOk = parseTestResults(m_resultBatch, &m_parseErrors);
 }
 
 int TestProgram::passedTestCount(void) const {
-    int result = 0;
-    foreach ( TestSuite* suite, m_suites ) {
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-        result += suite->passedTestCount();
+    return m_passedCount;
+}
+
+void TestProgram::processOutputLine(const QByteArray& line, qint64 lineStart, qint64 lineEnd) {
+
+    // check for test start/end markers
+    QString suiteName;
+    QString testName;
+    const OutputMarker marker = parseOutputLine(line, &suiteName, &testName);
+    if ( marker == TestProgram::NoMarker )
+        return;
+
+    // look up test
+    TestSuite* suite = suiteForName(suiteName);
+    TestCase* test = ( suite ? suite->testForName(testName) : 0 );
+
+    // test started: its output starts at this line
+    if ( marker == TestProgram::TestStarted ) {
+        m_outputTest = test;
+        m_outputTestOffset = lineStart;
+        m_outputTestStartTime = RunnerMetrics::elapsedSeconds(m_taskTimer);
+    }
+
+    // test finished: its output ends after this line
+    // (ignore summary lines, etc. that don't match the current test)
+    else if ( marker == TestProgram::TestFinished && test != 0 && test == m_outputTest ) {
+        test->setOutputRange(m_outputTestOffset, lineEnd - m_outputTestOffset);
+        m_outputTest = 0;
+
+        TestTiming timing;
+        timing.startTime  = m_outputTestStartTime;
+        timing.finishTime = RunnerMetrics::elapsedSeconds(m_taskTimer);
+        m_testTimings.insert(test, timing);
+
+        emit testFinished(this, test);
     }
-    return result;
 }
 
 QString TestProgram::programName(void) const {
     return QFileInfo(m_filename).fileName();
 }
 
+void TestProgram::readOutput(void) {
+
+    // only capture output from test runs
+    if ( m_currentTask != TestProgram::RunTests )
+        return;
+
+    // always read everything available, so QProcess doesn't buffer dropped output
+    const QByteArray data = limitOutput( m_process->readAllStandardOutput() );
+    if ( data.isEmpty() )
+        return;
+
+    // write to log & look for test markers
+    const qint64 offset = m_outputLog.append(data);
+    if ( offset >= 0 )
+        scanOutput(data, offset);
+}
+
 void TestProgram::removeAllSuites(void) {
+
     while ( !m_suites.isEmpty() ) {
         TestSuite* suite = m_suites.takeFirst();
         if ( suite )
             delete suite;
     }
+    m_suitesByName.clear();
+    m_testTimings.clear();
+
+    // & their captured output
+    m_outputLog.remove();
+
+    // reset aggregate counts
+    m_totalCount     = 0;
+    m_enabledCount   = 0;
+    m_runCount       = 0;
+    m_passedCount    = 0;
+    m_failedCount    = 0;
+    m_regressedCount = 0;
 }
 
 void TestProgram::removeXmlFile(void) const {
@@ -209,34 +556,125 @@ void TestProgram::removeXmlFile(void) const {
 }
 
 
+int TestProgram::regressedTestCount(void) const {
+    return m_regressedCount;
+}
+
 int TestProgram::runTestCount(void) const {
-    int result = 0;
-    foreach ( TestSuite* suite, m_suites ) {
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-        result += suite->runTestCount();
-    }
-    return result;
+    return m_runCount;
 }
 
 void TestProgram::runTests(void) {
 
-    // skip if our process is still running
-    if ( m_process->state() != QProcess::NotRunning )
+    // skip if our process is still running (or its output being parsed)
+    if ( m_process->state() != QProcess::NotRunning || m_parseWatcher->isRunning() )
         return;
 
     // clear out any prior data
     clearResults();
 
-    // set our state & start process (w/ args from derived class)
-    m_currentTask = TestProgram::RunTests;
-    const QStringList args = runTestArgs();
-    m_process->start(m_filename, args);
+    // set up output capture
+    m_outputLog.open();
+    m_partialLine.clear();
+    m_partialLineOffset = 0;
+    m_outputTest = 0;
+    m_outputTestOffset = 0;
+    m_outputTestStartTime = -1.0;
+    m_testTimings.clear();
+    m_outputRateTimer.invalidate();
+    m_outputWindowBytes = 0;
+    m_isOutputRateLimited = false;
+    m_isOutputTruncated = false;
+
+    // start process (w/ args from derived class) - or if those can't be set
+    // up as asked, fail the run instead of running other tests
+    QString argsError;
+    const QStringList args = runTestArgs(&argsError);
+    if ( argsError.isEmpty() )
+        startProcess(TestProgram::RunTests, QProcess::MergedChannels, args);
+    else
+        failRun(argsError);
+}
+
+void TestProgram::scanOutput(const QByteArray& data, qint64 offset) {
+
+    int lineStart = 0;
+    while ( lineStart < data.size() ) {
+
+        // if no more complete lines, store start of partial line for next time
+        const int newline = data.indexOf('\n', lineStart);
+        if ( newline == -1 ) {
+            if ( m_partialLine.isEmpty() )
+                m_partialLineOffset = offset + lineStart;
+            const int room = Constants::MaxMarkerLineLength - m_partialLine.size();
+            if ( room > 0 )
+                m_partialLine.append( data.mid(lineStart, room) );
+            return;
+        }
+
+        // fetch line (prepending any partial line from last time)
+        QByteArray line = data.mid(lineStart, qMin(newline-lineStart, int(Constants::MaxMarkerLineLength)));
+        qint64 lineOffset = offset + lineStart;
+        if ( !m_partialLine.isEmpty() ) {
+            line.prepend(m_partialLine);
+            lineOffset = m_partialLineOffset;
+            m_partialLine.clear();
+        }
+        if ( line.endsWith('\r') )
+            line.chop(1);
+
+        // handle line
+        processOutputLine(line, lineOffset, offset + newline + 1);
+        lineStart = newline + 1;
+    }
+}
+
+void TestProgram::setMessageStore(MessageStore* store) {
+    m_messageStore = store;
+}
+
+void TestProgram::setTestsEnabled(bool ok) {
+
+    // nothing to change
+    const int targetCount = ( ok ? m_totalCount : 0 );
+    if ( m_enabledCount == targetCount )
+        return;
+
+    foreach ( TestSuite* suite, m_suites ) {
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+        suite->setTestsEnabled(ok);
+    }
+}
+
+void TestProgram::setTimeout(int msecs) {
+    m_timeoutTimer->setInterval( qMax(0, msecs) );
 }
 
 void TestProgram::setTime(qreal t) {
     m_time = t;
 }
 
+void TestProgram::startProcess(TaskType task,
+                               QProcess::ProcessChannelMode mode,
+                               const QStringList& args)
+{
+    // reset error state & timing
+    m_errorString.clear();
+    m_isTimedOut = false;
+    m_taskTiming.spawnTime   = -1.0;
+    m_taskTiming.processTime = -1.0;
+    m_taskTiming.parseTime   = -1.0;
+    m_taskTiming.totalTime   = -1.0;
+    m_taskTimer.start();
+
+    // set our state & start process
+    m_currentTask = task;
+    if ( timeout() > 0 )
+        m_timeoutTimer->start();
+    m_process->setProcessChannelMode(mode);
+    m_process->start(m_filename, args);
+}
+
 TestSuite* TestProgram::suiteAt(int index) const {
     Q_ASSERT_X(index >= 0 && index < suiteCount(), Q_FUNC_INFO, "invalid index");
     return m_suites.at(index);
@@ -247,25 +685,26 @@ int TestProgram::suiteCount(void) const {
 }
 
 TestSuite* TestProgram::suiteForName(const QString& name) const {
-    foreach ( TestSuite* suite, m_suites ) {
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-        if ( suite->name() == name )
-            return suite;
-    }
-    return 0;
+    return m_suitesByName.value(name, 0);
+}
+
+TestProgram::TestTiming TestProgram::testTiming(const TestCase* test) const {
+    TestTiming timing;
+    timing.startTime  = -1.0;
+    timing.finishTime = -1.0;
+    return m_testTimings.value(test, timing);
 }
 
 qreal TestProgram::time(void) const {
     return m_time;
 }
 
+int TestProgram::timeout(void) const {
+    return m_timeoutTimer->interval();
+}
+
 int TestProgram::totalTestCount(void) const {
-    int result = 0;
-    foreach ( TestSuite* suite, m_suites ) {
-        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
-        result += suite->testCount();
-    }
-    return result;
+    return m_totalCount;
 }
 
 QString TestProgram::xmlFilename(void) const {
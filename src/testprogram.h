@@ -1,11 +1,19 @@
 #ifndef TESTPROGRAM_H
 #define TESTPROGRAM_H
 
+#include "outputlog.h"
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QMap>
 #include <QMetaType>
 #include <QObject>
 #include <QProcess>
 #include <QStringList>
+class QTimer;
+class MessageStore;
+class TestCase;
+class TestResultBatch;
 class TestSuite;
 
 class TestProgram : public QObject {
@@ -22,6 +30,7 @@ class TestProgram : public QObject {
     signals:
         void listingReady(TestProgram* program);
         void resultsReady(TestProgram* program);
+        void testFinished(TestProgram* program, TestCase* test); // live, if output has test markers
 
     // TestProgram interface
     public slots:
@@ -34,21 +43,67 @@ class TestProgram : public QObject {
         // status
         bool hasEnabledTests(void) const;
         bool hasFailedTests(void) const;
+        bool hasRegressedTests(void) const; // benchmark regressions
         bool hasRunTests(void) const;
 
+        // whether runTests() would run any of the enabled tests (default: any
+        // enabled) - programs without any are skipped
+        virtual bool hasRunnableTests(void) const;
+
+        // problems running the program itself (failed to start, crashed, timed out,
+        // unreadable output), from the last listing or run
+        bool hasError(void) const;
+        QString errorString(void) const;
+
+        // limit on each listing or run, the process is killed when exceeded
+        int timeout(void) const;           // msecs, default: 0 (no limit)
+        void setTimeout(int msecs);
+
         // time
         bool hasTime(void) const;
         qreal time(void) const;
 
+        // our own overhead for the last listing or run (seconds, -1 if unknown)
+        struct TaskTiming {
+            qreal spawnTime;    // from start until the process is running
+            qreal processTime;  // process lifetime
+            qreal parseTime;    // reading the listing or results
+            qreal totalTime;    // from start until listing/results are ready
+        };
+        TaskTiming lastTaskTiming(void) const;
+
+        // when a test's start & finish markers were read from the last run's
+        // output, in seconds since the run was started (-1 if the framework has
+        // no markers, or the test's weren't seen)
+        struct TestTiming {
+            qreal startTime;
+            qreal finishTime;
+        };
+        TestTiming testTiming(const TestCase* test) const;
+
+        // captured output (combined stdout & stderr from last test run)
+        QByteArray output(qint64 offset, qint64 size) const; // see OutputLog::data()
+        qint64 outputSize(void) const;
+        QString outputLogFilename(void) const; // temporary, empty if nothing captured
+
+        // storage for large result messages (not owned, may be null)
+        MessageStore* messageStore(void) const;
+        void setMessageStore(MessageStore* store);
+
         // TestSuite access
         int suiteCount(void) const;
         TestSuite* suiteAt(int index) const;
         TestSuite* suiteForName(const QString& name) const;
 
+        // enables (or disables) all of our tests, only visiting suites that change
+        void setTestsEnabled(bool ok = true);
+
         // convenience counts (total numbers across all of our test suites)
+        int enabledTestCount(void) const;
         int failedTestCount(void) const;
         int runTestCount(void) const;
         int passedTestCount(void) const;
+        int regressedTestCount(void) const;
         int totalTestCount(void) const;
 
     // TestProgram 'shared' internals
@@ -59,19 +114,34 @@ class TestProgram : public QObject {
                       , RunTests
                       };
 
-        // called by derived classes during parseTestResults()
+        enum OutputMarker { NoMarker = 0
+                          , TestStarted
+                          , TestFinished
+                          };
+
+        // set from each run's parsed results (see parseTestResults())
         void setTime(qreal t);
 
         // used to read the QByteArray that gets passed to parseTestListing() - default: STDOUT
         virtual QProcess::ProcessChannel listingOutputChannel(void) const;
 
         // provide command line args for each run type
+        // ('error' is set if the enabled tests can't be passed, failing the run)
         virtual QStringList listingArgs(void) const =0;
-        virtual QStringList runTestArgs(void) const =0;
+        virtual QStringList runTestArgs(QString* error) const =0;
 
         // derived classes should output
+        // (both are called on a worker thread: they may read our suite & test
+        //  names, but must leave our suites & tests alone - results go in
+        //  the batch, which is applied on the GUI thread once parsing is done)
         virtual QMap<QString, QStringList> parseTestListing(QByteArray output, QStringList* errors) =0;
-        virtual bool parseTestResults(QStringList* errors) =0;
+        virtual bool parseTestResults(TestResultBatch* batch, QStringList* errors) =0;
+
+        // derived classes may detect per-test start/end lines in run output
+        // (default: no markers, all output belongs to the program only)
+        virtual OutputMarker parseOutputLine(const QByteArray& line,
+                                             QString* suiteName,
+                                             QString* testName) const;
 
         // XmlFile-related convience methods
         QString xmlFilename(void) const;
@@ -79,12 +149,33 @@ class TestProgram : public QObject {
 
     // TestProgram private internals
     private slots:
+        void onParseFinished(void);
+        void onProcessError(QProcess::ProcessError error);
         void onProcessFinished(int exitCode, QProcess::ExitStatus status);
+        void onProcessStarted(void);
+        void onTimeout(void);
+        void readOutput(void);
     private:
+        friend class TestSuite;
         void addSuite(TestSuite* suite);
+        void adjustCounts(int totalDelta,
+                          int enabledDelta,
+                          int runDelta,
+                          int passedDelta,
+                          int failedDelta);
+        void adjustRegressedCount(int delta);
         void clearResults(void);
+        void failRun(const QString& message);
+        void finishOutput(void);
+        void failUnfinishedTest(TestCase* test, const QString& message);
         void initializeListing(const QMap<QString, QStringList>& listingMap);
+        QByteArray limitOutput(const QByteArray& data);
+        void parseListing(const QByteArray& output); // worker thread
+        void parseResults(void);                     // worker thread
+        void processOutputLine(const QByteArray& line, qint64 lineStart, qint64 lineEnd);
         void removeAllSuites(void);
+        void scanOutput(const QByteArray& data, qint64 offset);
+        void startProcess(TaskType task, QProcess::ProcessChannelMode mode, const QStringList& args);
 
     // data members
     private:
@@ -92,7 +183,49 @@ class TestProgram : public QObject {
         qreal    m_time;
         TaskType m_currentTask;
         QList<TestSuite*> m_suites;
+        QHash<QString, TestSuite*> m_suitesByName;
         QProcess* m_process;
+        MessageStore* m_messageStore; // copy, not owned
+
+        // error handling
+        QString m_errorString;
+        QTimer* m_timeoutTimer;
+        bool    m_isTimedOut;
+
+        // task timing
+        QElapsedTimer m_taskTimer;
+        TaskTiming    m_taskTiming;
+        qreal         m_processFinishedTime;
+
+        // parsing (on the global thread pool), & its results
+        QFutureWatcher<void>* m_parseWatcher;
+        QMap<QString, QStringList> m_parsedListing;
+        TestResultBatch* m_resultBatch;
+        bool        m_isParseOk;
+        QStringList m_parseErrors;
+        TestCase*   m_unfinishedTest;  // running when the process exited, copy, not owned
+        QString     m_exitError;
+
+        // output capture
+        OutputLog     m_outputLog;
+        QByteArray    m_partialLine;        // start of an incomplete output line
+        qint64        m_partialLineOffset;
+        TestCase*     m_outputTest;         // test whose output is currently being written
+        qint64        m_outputTestOffset;
+        qreal         m_outputTestStartTime;
+        QHash<const TestCase*, TestTiming> m_testTimings;
+        QElapsedTimer m_outputRateTimer;
+        qint64        m_outputWindowBytes;
+        bool          m_isOutputRateLimited;
+        bool          m_isOutputTruncated;
+
+        // aggregate counts, kept up to date by our test suites
+        int m_totalCount;
+        int m_enabledCount;
+        int m_runCount;
+        int m_passedCount;
+        int m_failedCount;
+        int m_regressedCount;
 };
 
 Q_DECLARE_METATYPE(TestProgram*)
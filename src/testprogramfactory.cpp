@@ -1,4 +1,5 @@
 #include "testprogramfactory.h"
+#include "googlebenchmarkprogram.h"
 #include "googletestprogram.h"
 #include "qtestlibprogram.h"
 #include <QtCore>
@@ -17,6 +18,9 @@ TestProgramFactory::createPrograms(const QList<ProgramInfo>& programInfoList) {
             case ProgramInfo::QtTestLib :
                 programs.append( new QTestLibProgram(info.filename) );
                 break;
+            case ProgramInfo::GoogleBenchmark :
+                programs.append( new GoogleBenchmarkProgram(info.filename) );
+                break;
             default:
                 ; // ignore any others
         }
@@ -0,0 +1,183 @@
+#include "testresultbatch.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+// result of every test, until any are reported
+// (built before main(), so it's safe to share between parser threads)
+static const TestResultBatch::TestResult NoResult;
+
+// -------------------------------------------
+// TestResultBatch::TestResult implementation
+// -------------------------------------------
+
+TestResultBatch::TestResult::TestResult(void)
+    : wasRun(false)
+    , passed(false)
+    , time(-1.0)
+{ }
+
+// -------------------------------------------
+// TestResultBatch implementation
+// -------------------------------------------
+
+TestResultBatch::TestResultBatch(const TestProgram* program)
+    : m_programTime(-1.0)
+    , m_isIndexBuilt(false)
+{
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+
+    // names only (shared, not deep copies), results are allocated by the parser's thread
+    const int numSuites = program->suiteCount();
+    m_firstTests.reserve(numSuites + 1);
+    for ( int i = 0; i < numSuites; ++i ) {
+        const TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+        m_suiteNames.append( suite->name() );
+        m_firstTests.append( m_testNames.size() );
+
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests; ++j )
+            m_testNames.append( suite->testAt(j)->name() );
+    }
+    m_firstTests.append( m_testNames.size() );
+}
+
+TestResultBatch::~TestResultBatch(void) { }
+
+void TestResultBatch::applyTo(TestProgram* program) const {
+
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    Q_ASSERT_X(program->suiteCount() == m_suiteNames.size(), Q_FUNC_INFO, "listing changed");
+
+    const int numSuites = qMin(program->suiteCount(), m_suiteNames.size());
+    for ( int i = 0; i < numSuites; ++i ) {
+        TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+        if ( suiteTime(i) >= 0.0 )
+            suite->setTime( suiteTime(i) );
+        if ( !hasReportedTests(i) )
+            continue;
+
+        const int numTests = qMin(suite->testCount(), testCount(i));
+        for ( int j = 0; j < numTests; ++j ) {
+            const int index = offset(i, j);
+            if ( !m_isReported.at(index) )
+                continue;
+
+            TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            const TestResult& result = m_results.at(index);
+            test->setWasRun(result.wasRun);
+            test->setPassed(result.passed);
+            if ( result.time >= 0.0 )
+                test->setTime(result.time);
+            foreach ( const QString& message, result.failureMessages )
+                test->addFailureMessage(message);
+            foreach ( const QString& message, result.otherMessages )
+                test->addOtherMessage(message);
+            foreach ( const BenchmarkResult& benchmark, result.benchmarkResults )
+                test->addBenchmarkResult(benchmark);
+        }
+    }
+}
+
+void TestResultBatch::buildIndex(void) const {
+
+    // (first of any duplicate names wins, like a linear search would)
+    const int numSuites = m_suiteNames.size();
+    m_testIndexes.resize(numSuites);
+    for ( int i = numSuites - 1; i >= 0; --i ) {
+        m_suiteIndexes.insert(m_suiteNames.at(i), i);
+
+        QHash<QString, int>& tests = m_testIndexes[i];
+        const int numTests = testCount(i);
+        tests.reserve(numTests);
+        for ( int j = numTests - 1; j >= 0; --j )
+            tests.insert(m_testNames.at( offset(i, j) ), j);
+    }
+    m_isIndexBuilt = true;
+}
+
+bool TestResultBatch::hasReportedTests(int suite) const {
+    Q_ASSERT_X(suite >= 0 && suite < suiteCount(), Q_FUNC_INFO, "invalid suite index");
+    return ( !m_reportedCounts.isEmpty() && m_reportedCounts.at(suite) > 0 );
+}
+
+bool TestResultBatch::isReported(int suite, int test) const {
+    return ( !m_isReported.isEmpty() && m_isReported.at( offset(suite, test) ) );
+}
+
+int TestResultBatch::offset(int suite, int test) const {
+    Q_ASSERT_X(suite >= 0 && suite < suiteCount(), Q_FUNC_INFO, "invalid suite index");
+    Q_ASSERT_X(test >= 0 && test < testCount(suite), Q_FUNC_INFO, "invalid test index");
+    return m_firstTests.at(suite) + test;
+}
+
+qreal TestResultBatch::programTime(void) const {
+    return m_programTime;
+}
+
+TestResultBatch::TestResult& TestResultBatch::result(int suite, int test) {
+
+    // first result, allocate for all tests
+    if ( m_results.isEmpty() ) {
+        m_results.resize( m_testNames.size() );
+        m_isReported.fill(false, m_testNames.size());
+        m_reportedCounts.fill(0, m_suiteNames.size());
+    }
+
+    const int index = offset(suite, test);
+    if ( !m_isReported.at(index) ) {
+        m_isReported[index] = true;
+        ++m_reportedCounts[suite];
+    }
+    return m_results[index];
+}
+
+const TestResultBatch::TestResult& TestResultBatch::result(int suite, int test) const {
+    if ( m_results.isEmpty() )
+        return NoResult;
+    return m_results.at( offset(suite, test) );
+}
+
+void TestResultBatch::setProgramTime(qreal t) {
+    m_programTime = t;
+}
+
+void TestResultBatch::setSuiteTime(int suite, qreal t) {
+    Q_ASSERT_X(suite >= 0 && suite < suiteCount(), Q_FUNC_INFO, "invalid suite index");
+    if ( m_suiteTimes.isEmpty() )
+        m_suiteTimes.fill(-1.0, m_suiteNames.size());
+    m_suiteTimes[suite] = t;
+}
+
+int TestResultBatch::suiteCount(void) const {
+    return m_suiteNames.size();
+}
+
+int TestResultBatch::suiteIndex(const QString& name) const {
+    if ( !m_isIndexBuilt )
+        buildIndex();
+    return m_suiteIndexes.value(name, -1);
+}
+
+qreal TestResultBatch::suiteTime(int suite) const {
+    Q_ASSERT_X(suite >= 0 && suite < suiteCount(), Q_FUNC_INFO, "invalid suite index");
+    return ( m_suiteTimes.isEmpty() ? -1.0 : m_suiteTimes.at(suite) );
+}
+
+int TestResultBatch::testCount(int suite) const {
+    Q_ASSERT_X(suite >= 0 && suite < suiteCount(), Q_FUNC_INFO, "invalid suite index");
+    return m_firstTests.at(suite + 1) - m_firstTests.at(suite);
+}
+
+int TestResultBatch::testIndex(int suite, const QString& name) const {
+    if ( suite < 0 || suite >= suiteCount() )
+        return -1;
+    if ( !m_isIndexBuilt )
+        buildIndex();
+    return m_testIndexes.at(suite).value(name, -1);
+}
@@ -0,0 +1,83 @@
+#ifndef TESTRESULTBATCH_H
+#define TESTRESULTBATCH_H
+
+#include "benchmarkresult.h"
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QVector>
+class TestProgram;
+
+// results of one program run, parsed away from the GUI thread
+//
+// made from a snapshot of the program's suite & test names (on the GUI thread,
+// names don't change during a run), filled in by the program's
+// parseTestResults() on a worker thread, & then copied into the program's
+// suites & tests on the GUI thread in one step (applyTo()). Suites & tests are
+// found by name through hashes, built on first lookup.
+class TestResultBatch {
+
+    // ctor & dtor
+    public:
+        explicit TestResultBatch(const TestProgram* program);
+        ~TestResultBatch(void);
+
+    // TestResultBatch interface
+    public:
+
+        struct TestResult {
+            bool  wasRun;
+            bool  passed;
+            qreal time;      // seconds, -1 if none
+            QStringList failureMessages;
+            QStringList otherMessages;
+            QList<BenchmarkResult> benchmarkResults;
+
+            TestResult(void);
+        };
+
+        // lookup (-1 if not listed)
+        int suiteIndex(const QString& name) const;
+        int testIndex(int suite, const QString& name) const;
+
+        // results, by index
+        int suiteCount(void) const;
+        int testCount(int suite) const;
+        TestResult& result(int suite, int test);             // marks test as reported
+        const TestResult& result(int suite, int test) const;
+        bool isReported(int suite, int test) const;
+        bool hasReportedTests(int suite) const;
+
+        // times (seconds, -1 if none)
+        qreal suiteTime(int suite) const;
+        void setSuiteTime(int suite, qreal t);
+        qreal programTime(void) const;
+        void setProgramTime(qreal t);
+
+        // copy reported results into program's suites & tests (GUI thread only,
+        // program must have the listing we were made from)
+        void applyTo(TestProgram* program) const;
+
+    // internal methods
+    private:
+        void buildIndex(void) const;
+        int offset(int suite, int test) const;
+
+    // data members
+    private:
+        QStringList m_suiteNames;
+        QVector<int> m_firstTests;     // index of each suite's first test, + total at end
+        QStringList m_testNames;
+        QVector<TestResult> m_results;
+        QVector<bool> m_isReported;
+        QVector<int> m_reportedCounts; // per suite
+        QVector<qreal> m_suiteTimes;
+        qreal m_programTime;
+
+        // name lookup
+        mutable bool m_isIndexBuilt;
+        mutable QHash<QString, int> m_suiteIndexes;
+        mutable QVector< QHash<QString, int> > m_testIndexes;
+};
+
+#endif // TESTRESULTBATCH_H
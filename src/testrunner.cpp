@@ -1,12 +1,80 @@
 #include "testrunner.h"
+#include "benchmarkbaseline.h"
+#include "historystore.h"
+#include "messagestore.h"
 #include "programfinder.h"
-#include "programinfo.h"
-#include "programtypeselector.h"
+#include "progressestimator.h"
+#include "runnermetrics.h"
+#include "storagepaths.h"
+#include "testcase.h"
 #include "testprogram.h"
 #include "testprogramfactory.h"
+#include "testsuite.h"
+#include "tracerecorder.h"
 #include <QtCore>
 #include <QtDebug>
 
+namespace Constants {
+    const char* const SpawnMetric       = "edgecase_process_spawn_seconds";
+    const char* const ListingMetric     = "edgecase_listing_seconds";
+    const char* const ProcessMetric     = "edgecase_program_run_seconds";
+    const char* const ParseMetric       = "edgecase_result_parse_seconds";
+    const char* const DispatchMetric    = "edgecase_result_dispatch_seconds";
+    const char* const QueueMetric       = "edgecase_queue_depth";
+    const char* const QueueMaxMetric    = "edgecase_queue_depth_max";
+    const char* const SlotsMetric       = "edgecase_slots";
+    const char* const BusySlotsMetric   = "edgecase_slots_busy";
+    const char* const BusyTimeMetric    = "edgecase_slot_busy_seconds_total";
+    const char* const UtilizationMetric = "edgecase_slot_utilization";
+    const char* const RunTimeMetric     = "edgecase_run_seconds";
+    const char* const OutputMetric      = "edgecase_output_bytes_total";
+    const char* const ProgramsMetric    = "edgecase_programs_run_total";
+    const char* const ErrorsMetric      = "edgecase_program_errors_total";
+    const char* const TestsMetric       = "edgecase_tests_run_total";
+    const char* const FailuresMetric    = "edgecase_tests_failed_total";
+
+    // run progress is reported in 1/1000ths of the expected test time
+    enum { RunProgressScale = 1000 };
+
+    // refresh of progress & remaining time while programs are running
+    enum { ProgressInterval = 500 }; // msecs
+} // namespace Constants
+
+// registers the metrics updated by TestRunner
+static
+void defineMetrics(RunnerMetrics* metrics) {
+
+    using namespace Constants;
+
+    metrics->define(SpawnMetric, RunnerMetrics::Histogram,
+                    "Time from starting a test program until its process is running.");
+    metrics->define(ListingMetric, RunnerMetrics::Histogram,
+                    "Time to list a program's tests, from process start until the listing is ready.");
+    metrics->define(ProcessMetric, RunnerMetrics::Histogram,
+                    "Lifetime of each test run process.");
+    metrics->define(ParseMetric, RunnerMetrics::Histogram,
+                    "Time to read a program's results after its process exits.");
+    metrics->define(DispatchMetric, RunnerMetrics::Histogram,
+                    "Time spent updating views w/ each batch of results.");
+
+    metrics->define(QueueMetric,    RunnerMetrics::Gauge, "Programs waiting for a free slot.");
+    metrics->define(QueueMaxMetric, RunnerMetrics::Gauge, "Most programs waiting for a free slot during the last run.");
+    metrics->define(SlotsMetric,    RunnerMetrics::Gauge, "Programs allowed to run at once.");
+    metrics->define(BusySlotsMetric, RunnerMetrics::Gauge, "Programs currently being listed or run.");
+    metrics->define(BusyTimeMetric, RunnerMetrics::Counter,
+                    "Slot time used by test runs, including spawn & parse time.");
+    metrics->define(UtilizationMetric, RunnerMetrics::Gauge,
+                    "Share of available slot time used during the last run (0-1).");
+    metrics->define(RunTimeMetric, RunnerMetrics::Gauge, "Wall time of the last run.");
+
+    metrics->define(OutputMetric,   RunnerMetrics::Counter, "Bytes of test program output captured.");
+    metrics->define(ProgramsMetric, RunnerMetrics::Counter, "Test program runs completed.");
+    metrics->define(ErrorsMetric,   RunnerMetrics::Counter,
+                    "Program listings or runs that failed to start, crashed, timed out, or couldn't be read.");
+    metrics->define(TestsMetric,    RunnerMetrics::Counter, "Tests run.");
+    metrics->define(FailuresMetric, RunnerMetrics::Counter, "Tests failed.");
+}
+
 // ---------------------------
 // TestRunner implementation
 // ---------------------------
@@ -14,23 +82,117 @@
 TestRunner::TestRunner(QObject *parent)
     : QObject(parent)
     , m_currentTask(TestRunner::NotRunning)
-{ }
+    , m_finder(new ProgramFinder(this))
+    , m_messageStore(new MessageStore)
+    , m_baseline(new BenchmarkBaseline)
+    , m_history(new HistoryStore)
+    , m_metrics(new RunnerMetrics)
+    , m_trace(new TraceRecorder)
+    , m_runBusyTime(0.0)
+    , m_progress(new ProgressEstimator)
+    , m_progressTimer(new QTimer(this))
+    , m_activeProgramCount(0)
+    , m_maxConcurrentPrograms( qMax(1, QThread::idealThreadCount()) )
+    , m_programTimeout(0)
+    , m_totalCount(0)
+    , m_runCount(0)
+    , m_passedCount(0)
+    , m_failedCount(0)
+    , m_regressedCount(0)
+{
+    connect(m_finder, SIGNAL(programsFound(QList<ProgramInfo>)),
+            this,     SLOT(onProgramsFound(QList<ProgramInfo>)));
+    connect(m_finder, SIGNAL(finished()), this, SLOT(onProgramSearchFinished()));
+
+    m_progressTimer->setInterval(Constants::ProgressInterval);
+    connect(m_progressTimer, SIGNAL(timeout()), this, SLOT(onProgressTimeout()));
+
+    defineMetrics(m_metrics);
+    m_metrics->set(Constants::SlotsMetric, m_maxConcurrentPrograms);
+}
 
 TestRunner::~TestRunner(void) {
     removeAllTests();
+    delete m_messageStore;
+    delete m_baseline;
+    delete m_history;
+    delete m_metrics;
+    delete m_trace;
+    delete m_progress;
+}
+
+void TestRunner::addProgramCounts(TestProgram* program, int sign) {
+
+    // add (sign = 1) or remove (sign = -1) a program's result counts from our totals
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    m_runCount       += sign * program->runTestCount();
+    m_passedCount    += sign * program->passedTestCount();
+    m_failedCount    += sign * program->failedTestCount();
+    m_regressedCount += sign * program->regressedTestCount();
 }
 
 bool TestRunner::allProgramsFinished(void) const {
     return finishedProgramCount() == m_isRunningMap.size();
 }
 
-int TestRunner::failedTestCount(void) const {
-    int result = 0;
-    foreach ( TestProgram* program, m_programs ) {
-        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
-        result += program->failedTestCount();
+BenchmarkBaseline* TestRunner::benchmarkBaseline(void) const {
+    return m_baseline;
+}
+
+void TestRunner::checkListingFinished(void) {
+
+    // still waiting on directory scan or program listings
+    if ( m_finder->isRunning() || !allProgramsFinished() )
+        return;
+
+    // reset our state flag & progress tracking
+    m_currentTask = TestRunner::NotRunning;
+    m_isRunningMap.clear();
+
+    // signal runner finished
+    emit listTestsFinished();
+}
+
+void TestRunner::compareBenchmarks(TestProgram* program) {
+
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+
+    // foreach test with benchmark results
+    const int numSuites = program->suiteCount();
+    for ( int i = 0; i < numSuites; ++i ) {
+        TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests; ++j ) {
+            TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            if ( !test->hasBenchmarkResults() )
+                continue;
+
+            // record this run's samples, then compare recent samples against baseline
+            const QString testKey = program->fileName() + '\t' + suite->name() + '\t' + test->name();
+            const QList<BenchmarkResult> results = test->benchmarkResults();
+            m_baseline->addResults(testKey, results);
+            test->setBenchmarkComparisons( m_baseline->compare(testKey, results) );
+        }
     }
-    return result;
+}
+
+void TestRunner::emitRunProgress(void) {
+
+    // share of expected test time completed
+    const qreal expectedTime = m_progress->expectedTime();
+    const qreal completedTime = m_progress->completedTime();
+    const int value = ( expectedTime > 0.0 ? qRound(Constants::RunProgressScale * completedTime / expectedTime) : 0 );
+    emit progressValueChanged(value);
+
+    const qreal remainingTime = m_progress->remainingTime();
+    emit remainingTimeChanged( remainingTime < 0.0 ? -1 : qRound(remainingTime) );
+}
+
+int TestRunner::failedTestCount(void) const {
+    return m_failedCount;
 }
 
 int TestRunner::finishedProgramCount(void) const {
@@ -51,6 +213,27 @@ int TestRunner::finishedProgramCount(void) const {
     return numProgramsFinished;
 }
 
+void TestRunner::finishRunMetrics(void) {
+
+    // slot utilization: share of (slots x wall time) spent on programs
+    const qreal runTime = RunnerMetrics::elapsedSeconds(m_runTimer);
+    m_metrics->set(Constants::RunTimeMetric, runTime);
+    if ( runTime > 0.0 ) {
+        const qreal utilization = m_runBusyTime / (runTime * m_maxConcurrentPrograms);
+        m_metrics->set(Constants::UtilizationMetric, qMin(utilization, qreal(1.0)));
+    }
+    m_metrics->set(Constants::QueueMetric, 0);
+    m_metrics->set(Constants::BusySlotsMetric, 0);
+
+    const QString filename = metricsFileName();
+    if ( !filename.isEmpty() )
+        m_metrics->writeFile(filename);
+}
+
+HistoryStore* TestRunner::historyStore(void) const {
+    return m_history;
+}
+
 void TestRunner::listTests(QString directory, bool shouldRecurse) {
 
     // don't do anything if we're currently running
@@ -60,33 +243,36 @@ void TestRunner::listTests(QString directory, bool shouldRecurse) {
     // clear out any previous test programs
     removeAllTests();
 
+    // load benchmark samples & result history for this directory
+    m_directory = directory;
+    m_baseline->load( StoragePaths::fileForRoot("baselines", directory, "baseline") );
+    m_history->open( StoragePaths::fileForRoot("history", directory, "hist") );
+
     // set our current state
     m_currentTask = TestRunner::ListTests;
 
-    // use helper utilites to create program objects from filenames
-    const QStringList& filepaths              = ProgramFinder::lookupExecutables(directory, shouldRecurse);
-    const QList<ProgramInfo>& programInfoList = ProgramTypeSelector::getInfo(filepaths);
-    const QList<TestProgram*>& programList    = TestProgramFactory::createPrograms(programInfoList);
-
     // fire off initial progress notifications
+    // (range is extended as programs are found)
     emit listTestsStarted();
-    emit progressRangeChanged(0, programList.size());
+    emit progressRangeChanged(0, 0);
     emit progressValueChanged(0);
 
-    // set up each program created
-    foreach ( TestProgram* p, programList ) {
+    // start looking for programs, they will be listed as they are found
+    m_finder->start(directory, shouldRecurse);
+}
 
-        // store program
-        m_programs.append(p);
-        m_isRunningMap.insert(p, true);
+int TestRunner::maxConcurrentPrograms(void) const {
+    return m_maxConcurrentPrograms;
+}
 
-        // make connections
-        connect(p, SIGNAL(listingReady(TestProgram*)), SLOT(onProgramListingReady(TestProgram*)));
-        connect(p, SIGNAL(resultsReady(TestProgram*)), SLOT(onProgramResultsReady(TestProgram*)));
+RunnerMetrics* TestRunner::metrics(void) const {
+    return m_metrics;
+}
 
-        // produce listing
-        p->listTests();
-    }
+QString TestRunner::metricsFileName(void) const {
+    if ( !m_metricsFilename.isEmpty() || m_directory.isEmpty() )
+        return m_metricsFilename;
+    return StoragePaths::fileForRoot("metrics", m_directory, "prom");
 }
 
 void TestRunner::onProgramListingReady(TestProgram* program) {
@@ -96,19 +282,27 @@ void TestRunner::onProgramListingReady(TestProgram* program) {
     if ( program == 0 )
         return;
 
+    // let the next program start
+    --m_activeProgramCount;
+    startPendingPrograms();
+
+    // record our overhead
+    const TestProgram::TaskTiming timing = program->lastTaskTiming();
+    if ( timing.spawnTime >= 0.0 )
+        m_metrics->observe(Constants::SpawnMetric, timing.spawnTime);
+    if ( timing.totalTime >= 0.0 )
+        m_metrics->observe(Constants::ListingMetric, timing.totalTime);
+    if ( program->hasError() )
+        m_metrics->add(Constants::ErrorsMetric);
+
+    // update total count
+    m_totalCount += program->totalTestCount();
+
     // update progress tracking & emit signals
     updateProgress(program);
 
     // check for completion
-    if ( allProgramsFinished() ) {
-
-        // reset our state flag & progress tracking
-        m_currentTask = TestRunner::NotRunning;
-        m_isRunningMap.clear();
-
-        // signal runner finished
-        emit listTestsFinished();
-    }
+    checkListingFinished();
 }
 
 void TestRunner::onProgramResultsReady(TestProgram* program) {
@@ -118,11 +312,45 @@ void TestRunner::onProgramResultsReady(TestProgram* program) {
     if ( program == 0 )
         return;
 
+    // let the next program start
+    --m_activeProgramCount;
+    m_trace->endProgram(program);
+    startPendingPrograms();
+    const qint64 handlingStart = m_trace->now();
+
+    // check benchmarks against baseline & update result counts
+    compareBenchmarks(program);
+    addProgramCounts(program, 1);
+
+    // record results
+    m_history->appendRun(program);
+
+    // record our overhead
+    const TestProgram::TaskTiming timing = program->lastTaskTiming();
+    if ( timing.spawnTime >= 0.0 )
+        m_metrics->observe(Constants::SpawnMetric, timing.spawnTime);
+    if ( timing.processTime >= 0.0 )
+        m_metrics->observe(Constants::ProcessMetric, timing.processTime);
+    if ( timing.parseTime >= 0.0 )
+        m_metrics->observe(Constants::ParseMetric, timing.parseTime);
+    if ( timing.totalTime >= 0.0 ) {
+        m_metrics->add(Constants::BusyTimeMetric, timing.totalTime);
+        m_runBusyTime += timing.totalTime;
+    }
+    m_metrics->add(Constants::OutputMetric, program->outputSize());
+    m_metrics->add(Constants::ProgramsMetric);
+    m_metrics->add(Constants::TestsMetric, program->runTestCount());
+    m_metrics->add(Constants::FailuresMetric, program->failedTestCount());
+    if ( program->hasError() )
+        m_metrics->add(Constants::ErrorsMetric);
+
     // update progress tracking & emit signals
     updateProgress(program);
 
     // signal that results are ready for this program
+    // (views are updated in batches, timed by recordDispatch())
     emit testResultsReady(program);
+    m_trace->addMainThreadSpan("record results: " + program->programName(), "runner", handlingStart, m_trace->now());
 
     // check for completion
     if ( allProgramsFinished() ) {
@@ -131,24 +359,121 @@ void TestRunner::onProgramResultsReady(TestProgram* program) {
         m_currentTask = TestRunner::NotRunning;
         m_isRunningMap.clear();
 
+        // store this run's benchmark samples
+        m_baseline->save();
+
+        // let any last batch of results be shown (& timed)
+        emit runTestsFinishing();
+
+        // write out our metrics & timeline
+        m_progressTimer->stop();
+        finishRunMetrics();
+        m_trace->finish();
+
         // signal runner finished
         emit runTestsFinished();
     }
 }
 
+void TestRunner::onProgramSearchFinished(void) {
+    checkListingFinished();
+}
+
+void TestRunner::onProgramTestFinished(TestProgram* program, TestCase* test) {
+
+    // credit expected time of test (progress is emitted on next refresh)
+    if ( m_currentTask == TestRunner::RunTests )
+        m_progress->testFinished(program, test);
+}
+
+void TestRunner::onProgramsFound(const QList<ProgramInfo>& programInfoList) {
+
+    // ignore late results from a canceled scan
+    if ( m_currentTask != TestRunner::ListTests )
+        return;
+
+    // create program objects
+    const QList<TestProgram*>& programList = TestProgramFactory::createPrograms(programInfoList);
+    if ( programList.isEmpty() )
+        return;
+
+    // set up each program created
+    foreach ( TestProgram* p, programList ) {
+
+        // store program
+        p->setMessageStore(m_messageStore);
+        m_programs.append(p);
+        m_isRunningMap.insert(p, true);
+
+        // make connections
+        connect(p, SIGNAL(listingReady(TestProgram*)), SLOT(onProgramListingReady(TestProgram*)));
+        connect(p, SIGNAL(resultsReady(TestProgram*)), SLOT(onProgramResultsReady(TestProgram*)));
+        connect(p, SIGNAL(testFinished(TestProgram*,TestCase*)), SLOT(onProgramTestFinished(TestProgram*,TestCase*)));
+
+        // queue listing
+        p->setTimeout(m_programTimeout);
+        m_pendingPrograms.append(p);
+    }
+
+    // produce listings, as slots are available
+    startPendingPrograms();
+
+    // update progress range
+    emit progressRangeChanged(0, m_isRunningMap.size());
+    emit progressValueChanged( finishedProgramCount() );
+}
+
+void TestRunner::onProgressTimeout(void) {
+    if ( m_currentTask == TestRunner::RunTests )
+        emitRunProgress();
+}
+
 int TestRunner::passedTestCount(void) const {
-    int result = 0;
+    return m_passedCount;
+}
+
+void TestRunner::pinBenchmarkBaseline(void) {
+
+    // don't do anything if we're currently running
+    if ( m_currentTask != TestRunner::NotRunning )
+        return;
+
+    // samples collected so far become the new baseline
+    m_baseline->pin();
+    m_baseline->save();
+
+    // previous comparisons no longer apply
     foreach ( TestProgram* program, m_programs ) {
         Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
-        result += program->passedTestCount();
+        addProgramCounts(program, -1);
+
+        const int numSuites = program->suiteCount();
+        for ( int i = 0; i < numSuites; ++i ) {
+            TestSuite* suite = program->suiteAt(i);
+            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+            const int numTests = suite->testCount();
+            for ( int j = 0; j < numTests; ++j )
+                suite->testAt(j)->setBenchmarkComparisons( QList<BenchmarkComparison>() );
+        }
+
+        addProgramCounts(program, 1);
     }
-    return result;
+
+    emit benchmarkBaselineChanged();
 }
 
 int TestRunner::programCount(void) const {
     return m_programs.size();
 }
 
+ProgramFinder* TestRunner::programFinder(void) const {
+    return m_finder;
+}
+
+int TestRunner::programTimeout(void) const {
+    return m_programTimeout;
+}
+
 TestProgram* TestRunner::programAt(int index) const {
     Q_ASSERT_X(index >= 0 && index < programCount(), Q_FUNC_INFO, "invalid index");
     return m_programs.at(index);
@@ -163,6 +488,20 @@ TestProgram* TestRunner::programForName(const QString& name) const {
     return 0;
 }
 
+QString TestRunner::programPath(const TestProgram* program) const {
+    Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+    return QDir(m_directory).relativeFilePath( program->fileName() );
+}
+
+int TestRunner::queuedProgramCount(void) const {
+    return m_pendingPrograms.size();
+}
+
+void TestRunner::recordDispatch(const QString& name, qint64 startUsecs, qreal seconds) {
+    m_metrics->observe(Constants::DispatchMetric, seconds);
+    m_trace->addMainThreadSpan(name, "gui", startUsecs, m_trace->now());
+}
+
 void TestRunner::removeAllTests(void) {
     while ( !m_programs.isEmpty() ) {
         TestProgram* p = m_programs.takeFirst();
@@ -170,15 +509,32 @@ void TestRunner::removeAllTests(void) {
         if ( p )
             delete p;
     }
+
+    // nothing left to schedule
+    m_pendingPrograms.clear();
+    m_activeProgramCount = 0;
+
+    // drop stored messages
+    m_messageStore->clear();
+
+    // reset aggregate counts
+    m_totalCount     = 0;
+    m_runCount       = 0;
+    m_passedCount    = 0;
+    m_failedCount    = 0;
+    m_regressedCount = 0;
+}
+
+int TestRunner::regressedTestCount(void) const {
+    return m_regressedCount;
+}
+
+int TestRunner::runningProgramCount(void) const {
+    return m_activeProgramCount;
 }
 
 int TestRunner::runTestCount(void) const {
-    int result = 0;
-    foreach ( TestProgram* program, m_programs ) {
-        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
-        result += program->runTestCount();
-    }
-    return result;
+    return m_runCount;
 }
 
 void TestRunner::runTests(void) {
@@ -189,20 +545,30 @@ void TestRunner::runTests(void) {
 
     // set our current state
     m_currentTask = TestRunner::RunTests;
+    m_runTimer.start();
+    m_runBusyTime = 0.0;
+    m_metrics->set(Constants::QueueMaxMetric, 0);
+    const QString traceFilename = traceFileName();
+    if ( !traceFilename.isEmpty() )
+        m_trace->start(traceFilename);
 
     // determine our list of programs to run
     foreach ( TestProgram* program, m_programs ) {
         Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
-        if ( program->hasEnabledTests() )
+        if ( program->hasRunnableTests() )
             m_isRunningMap.insert(program, false);
     }
 
+    // estimate each program's share of the run, from its tests' history
+    m_progress->start(m_isRunningMap.keys(), m_history, m_maxConcurrentPrograms);
+
     // fire off initial progress notifications
     emit runTestsStarted();
-    emit progressRangeChanged(0, m_isRunningMap.size());
-    emit progressValueChanged(0);
+    emit progressRangeChanged(0, Constants::RunProgressScale);
+    emitRunProgress();
+    m_progressTimer->start();
 
-    // for each program that has any enabled tests
+    // queue each program that has any (runnable) enabled tests
     QMap<TestProgram*, bool>::iterator progIter = m_isRunningMap.begin();
     QMap<TestProgram*, bool>::iterator progEnd  = m_isRunningMap.end();
     for ( ; progIter != progEnd; ++progIter ) {
@@ -210,19 +576,82 @@ void TestRunner::runTests(void) {
         // set progress tracking flag
         progIter.value() = true;
 
-        // run tests
         TestProgram* p = progIter.key();
-        p->runTests();
+        p->setTimeout(m_programTimeout);
+        m_pendingPrograms.append(p);
+    }
+
+    // run tests, as slots are available
+    startPendingPrograms();
+
+    // nothing enabled, nothing to wait for
+    if ( m_isRunningMap.isEmpty() ) {
+        m_currentTask = TestRunner::NotRunning;
+        m_progressTimer->stop();
+        finishRunMetrics();
+        m_trace->finish();
+        emit runTestsFinished();
     }
 }
 
-int TestRunner::totalTestCount(void) const {
-    int result = 0;
-    foreach ( TestProgram* program, m_programs ) {
-        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
-        result += program->totalTestCount();
+void TestRunner::setMaxConcurrentPrograms(int count) {
+    m_maxConcurrentPrograms = qMax(1, count);
+    m_metrics->set(Constants::SlotsMetric, m_maxConcurrentPrograms);
+}
+
+void TestRunner::setMetricsFileName(const QString& filename) {
+    m_metricsFilename = filename;
+}
+
+void TestRunner::setProgramTimeout(int msecs) {
+    m_programTimeout = qMax(0, msecs);
+}
+
+void TestRunner::setTraceFileName(const QString& filename) {
+    m_traceFilename = filename;
+}
+
+void TestRunner::startPendingPrograms(void) {
+
+    // start queued programs until all slots are used
+    // (a program that fails to start finishes right away, re-entering here)
+    while ( !m_pendingPrograms.isEmpty() && m_activeProgramCount < m_maxConcurrentPrograms ) {
+        TestProgram* p = m_pendingPrograms.takeFirst();
+        Q_ASSERT_X(p, Q_FUNC_INFO, "null test program");
+        ++m_activeProgramCount;
+
+        if ( m_currentTask == TestRunner::ListTests )
+            p->listTests();
+        else if ( m_currentTask == TestRunner::RunTests ) {
+
+            // drop program's previous results from our counts (re-added when new results are ready)
+            addProgramCounts(p, -1);
+            emit programStarted(p);
+            m_trace->beginProgram(p);
+            m_progress->programStarted(p);
+            p->runTests();
+        }
     }
-    return result;
+
+    // update slot usage
+    m_metrics->set(Constants::QueueMetric, m_pendingPrograms.size());
+    m_metrics->set(Constants::BusySlotsMetric, m_activeProgramCount);
+    if ( m_currentTask == TestRunner::RunTests )
+        m_metrics->setMax(Constants::QueueMaxMetric, m_pendingPrograms.size());
+}
+
+int TestRunner::totalTestCount(void) const {
+    return m_totalCount;
+}
+
+QString TestRunner::traceFileName(void) const {
+    if ( !m_traceFilename.isEmpty() || m_directory.isEmpty() )
+        return m_traceFilename;
+    return StoragePaths::fileForRoot("traces", m_directory, "json");
+}
+
+qint64 TestRunner::traceTime(void) const {
+    return m_trace->now();
 }
 
 void TestRunner::updateProgress(TestProgram* program) {
@@ -231,6 +660,10 @@ void TestRunner::updateProgress(TestProgram* program) {
     Q_ASSERT_X(m_isRunningMap.contains(program), Q_FUNC_INFO, "unknown test program");
     m_isRunningMap[program] = false;
 
-    // emit signals
-    emit progressValueChanged( finishedProgramCount() );
+    // emit signals (listings count programs, runs count expected test time)
+    if ( m_currentTask == TestRunner::RunTests ) {
+        m_progress->programFinished(program);
+        emitRunProgress();
+    } else
+        emit progressValueChanged( finishedProgramCount() );
 }
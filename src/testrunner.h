@@ -1,12 +1,23 @@
 #ifndef TESTRUNNER_H
 #define TESTRUNNER_H
 
+#include <QElapsedTimer>
 #include <QList>
 #include <QMap>
 #include <QMetaType>
 #include <QObject>
 #include <QString>
+#include "programinfo.h"
+class BenchmarkBaseline;
+class HistoryStore;
+class MessageStore;
+class ProgramFinder;
+class ProgressEstimator;
+class RunnerMetrics;
+class TestCase;
 class TestProgram;
+class TraceRecorder;
+class QTimer;
 
 class TestRunner : public QObject {
 
@@ -23,38 +34,90 @@ class TestRunner : public QObject {
         void listTestsFinished(void);
 
         void runTestsStarted(void);
+        void runTestsFinishing(void); // all results are in, metrics & timeline not yet written
         void runTestsFinished(void);
 
+        void programStarted(TestProgram* program);
         void testResultsReady(TestProgram* program);
+        void benchmarkBaselineChanged(void);
 
         void progressRangeChanged(int min, int max);
         void progressValueChanged(int value);
+        void remainingTimeChanged(int seconds); // estimate during runs, -1 if unknown
 
     // TestRunner interface
     public slots:
         void listTests(QString directory, bool shouldRecurse);
         void runTests(void);
+        void pinBenchmarkBaseline(void);
     public:
 
+        // program discovery settings
+        ProgramFinder* programFinder(void) const;
+
+        // scheduling settings
+        int maxConcurrentPrograms(void) const;    // default: QThread::idealThreadCount()
+        void setMaxConcurrentPrograms(int count);
+        int programTimeout(void) const;           // msecs per listing or run, 0 = no limit (default)
+        void setProgramTimeout(int msecs);
+
+        // programs waiting for, or using, a slot in the current listing/run
+        int queuedProgramCount(void) const;
+        int runningProgramCount(void) const;
+
+        // benchmark regression detection settings
+        BenchmarkBaseline* benchmarkBaseline(void) const;
+
+        // results of previous runs (for the current directory)
+        HistoryStore* historyStore(void) const;
+
+        // our own overheads (spawn, parse, & dispatch times, slot usage, etc.),
+        // written to a Prometheus text file at the end of each run
+        RunnerMetrics* metrics(void) const;
+        QString metricsFileName(void) const;  // default: ~/.edgecase/metrics/<directory hash>.prom
+        void setMetricsFileName(const QString& filename);
+
+        // GUI updates w/ a batch of results (see ResultBatcher), recorded as
+        // dispatch time & a main thread span ('startUsecs' from traceTime())
+        qint64 traceTime(void) const;
+        void recordDispatch(const QString& name, qint64 startUsecs, qreal seconds);
+
+        // timeline of each run (program spawn/run/parse spans per slot, tests,
+        // & view updates), written as a Chrome trace-event JSON file
+        QString traceFileName(void) const;    // default: ~/.edgecase/traces/<directory hash>.json
+        void setTraceFileName(const QString& filename);
+
         // TestProgram access
         int programCount(void) const;
         TestProgram* programAt(int index) const;
         TestProgram* programForName(const QString& name) const;
+        QString programPath(const TestProgram* program) const; // relative to the listed directory, 'sub/test_exe'
 
         // convenience counts (total numbers across all of our test programs)
         int failedTestCount(void) const;
         int runTestCount(void) const;
         int passedTestCount(void) const;
+        int regressedTestCount(void) const;
         int totalTestCount(void) const;
 
     // internal methods
     private slots:
         void onProgramListingReady(TestProgram* program);
         void onProgramResultsReady(TestProgram* program);
+        void onProgramSearchFinished(void);
+        void onProgramTestFinished(TestProgram* program, TestCase* test);
+        void onProgramsFound(const QList<ProgramInfo>& programInfoList);
+        void onProgressTimeout(void);
     private:
         bool allProgramsFinished(void) const;
+        void checkListingFinished(void);
         int finishedProgramCount(void) const;
+        void addProgramCounts(TestProgram* program, int sign);
+        void compareBenchmarks(TestProgram* program);
+        void emitRunProgress(void);
+        void finishRunMetrics(void);
         void removeAllTests(void);
+        void startPendingPrograms(void);
         void updateProgress(TestProgram* program);
 
     // data members
@@ -65,9 +128,35 @@ class TestRunner : public QObject {
                       };
         TaskType m_currentTask;
 
+        ProgramFinder* m_finder;
+        MessageStore*  m_messageStore;
+        BenchmarkBaseline* m_baseline;
+        HistoryStore*      m_history;
+        RunnerMetrics*     m_metrics;
+        QString            m_metricsFilename;
+        TraceRecorder*     m_trace;
+        QString            m_traceFilename;
+        QString            m_directory;
+        QElapsedTimer      m_runTimer;
+        ProgressEstimator* m_progress;       // run progress, in expected test time
+        QTimer*            m_progressTimer;  // refreshes progress of running programs
+        qreal              m_runBusyTime;    // seconds of slot time used in current run
         QList<TestProgram*> m_programs;
         QMap<TestProgram*, bool> m_isRunningMap;
 
+        // programs waiting for a free slot (for the current task)
+        QList<TestProgram*> m_pendingPrograms;
+        int m_activeProgramCount;
+        int m_maxConcurrentPrograms;
+        int m_programTimeout;
+
+        // aggregate counts, updated as each program's listing/results come in
+        int m_totalCount;
+        int m_runCount;
+        int m_passedCount;
+        int m_failedCount;
+        int m_regressedCount;
+
 };
 
 Q_DECLARE_METATYPE(TestRunner*)
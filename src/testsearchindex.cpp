@@ -0,0 +1,308 @@
+#include "testsearchindex.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+#include <algorithm>
+
+namespace Constants {
+
+    const int TrigramLength = 3;
+
+} // namespace Constants
+
+// returns 3 characters, packed as one key
+static inline
+quint64 trigram(const QChar* chars) {
+    return ( quint64(chars[0].unicode()) << 32 ) |
+           ( quint64(chars[1].unicode()) << 16 ) |
+             quint64(chars[2].unicode());
+}
+
+// returns the literal runs of a glob pattern ('*ser*flow?' -> 'ser', 'flow')
+static
+QStringList globLiterals(const QString& pattern) {
+    QStringList literals;
+    QString current;
+    const int length = pattern.size();
+    for ( int i = 0; i < length; ++i ) {
+        const QChar c = pattern.at(i);
+        if ( c == '*' || c == '?' || c == '[' ) {
+            literals.append(current);
+            current.clear();
+
+            // skip character set
+            if ( c == '[' ) {
+                i = pattern.indexOf(']', i + 1);
+                if ( i == -1 )
+                    break;
+            }
+        } else
+            current.append(c);
+    }
+    literals.append(current);
+    return literals;
+}
+
+// -----------------------------------------
+// TestSearchIndex::Matches implementation
+// -----------------------------------------
+
+TestSearchIndex::Matches::Matches(void)
+    : count(0)
+    , isValid(true)
+{ }
+
+// -----------------------------------------
+// TestSearchIndex implementation
+// -----------------------------------------
+
+TestSearchIndex::TestSearchIndex(void)
+    : m_isBuilt(false)
+{ }
+
+TestSearchIndex::~TestSearchIndex(void) { }
+
+void TestSearchIndex::addMatch(Matches* matches, int test) const {
+    Q_ASSERT_X(matches, Q_FUNC_INFO, "null matches");
+    if ( matches->tests.testBit(test) )
+        return;
+    const int suite = m_testSuites.at(test);
+    matches->tests.setBit(test);
+    ++matches->suiteCounts[suite];
+    ++matches->programCounts[ m_suites.at(suite).program ];
+    ++matches->count;
+}
+
+void TestSearchIndex::build(void) {
+
+    // keys & trigram postings (tests are visited in order, so postings stay sorted)
+    const int numTests = m_testNames.size();
+    m_keys.resize(numTests);
+    m_keyTestOffsets.resize(numTests);
+    m_postings.clear();
+
+    for ( int t = 0; t < numTests; ++t ) {
+        const int suite = m_testSuites.at(t);
+        const QString& programName = m_programNames.at( m_suites.at(suite).program );
+        const QString key = ( programName + '/' + m_suiteNames.at(suite) + '.' + m_testNames.at(t) ).toLower();
+        m_keys[t] = key;
+        m_keyTestOffsets[t] = programName.size() + 1;
+
+        const QChar* chars = key.constData();
+        const int numTrigrams = key.size() - Constants::TrigramLength + 1;
+        for ( int i = 0; i < numTrigrams; ++i ) {
+            QVector<int>& posting = m_postings[ trigram(chars + i) ];
+            if ( posting.isEmpty() || posting.last() != t )
+                posting.append(t);
+        }
+    }
+
+    // drop growth slack
+    QHash<quint64, QVector<int> >::iterator iter = m_postings.begin();
+    QHash<quint64, QVector<int> >::iterator end  = m_postings.end();
+    for ( ; iter != end; ++iter )
+        iter->squeeze();
+
+    m_isBuilt = true;
+}
+
+QVector<int> TestSearchIndex::candidatesFor(const QStringList& literals, bool* isNarrowed) const {
+
+    Q_ASSERT_X(isNarrowed, Q_FUNC_INFO, "null flag");
+
+    // postings of every trigram in the literals
+    QList<const QVector<int>*> postings;
+    foreach ( const QString& literal, literals ) {
+        const QChar* chars = literal.constData();
+        const int numTrigrams = literal.size() - Constants::TrigramLength + 1;
+        for ( int i = 0; i < numTrigrams; ++i ) {
+            QHash<quint64, QVector<int> >::const_iterator posting = m_postings.constFind( trigram(chars + i) );
+
+            // a trigram no test has: nothing can match
+            if ( posting == m_postings.constEnd() ) {
+                *isNarrowed = true;
+                return QVector<int>();
+            }
+            postings.append( &posting.value() );
+        }
+    }
+
+    // no trigrams, every test is a candidate
+    if ( postings.isEmpty() ) {
+        *isNarrowed = false;
+        return QVector<int>();
+    }
+
+    // start from the rarest trigram, keep tests found in all of the others
+    int rarest = 0;
+    for ( int i = 1; i < postings.size(); ++i ) {
+        if ( postings.at(i)->size() < postings.at(rarest)->size() )
+            rarest = i;
+    }
+    QVector<int> candidates = *postings.at(rarest);
+    for ( int i = 0; i < postings.size() && !candidates.isEmpty(); ++i ) {
+        const QVector<int>* posting = postings.at(i);
+        if ( i == rarest || posting == postings.at(rarest) )
+            continue;
+
+        int kept = 0;
+        const int numCandidates = candidates.size();
+        for ( int j = 0; j < numCandidates; ++j ) {
+            const int t = candidates.at(j);
+            if ( std::binary_search(posting->constBegin(), posting->constEnd(), t) )
+                candidates[kept++] = t;
+        }
+        candidates.resize(kept);
+    }
+
+    *isNarrowed = true;
+    return candidates;
+}
+
+TestSearchIndex::Matches TestSearchIndex::emptyMatches(void) const {
+    Matches matches;
+    matches.tests.resize( m_testNames.size() );
+    matches.suiteCounts.fill(0, m_suites.size());
+    matches.programCounts.fill(0, m_programNames.size());
+    return matches;
+}
+
+TestSearchIndex::Matches TestSearchIndex::find(const QString& query) const {
+
+    Matches matches = emptyMatches();
+    const QString text = query.trimmed();
+    if ( !m_isBuilt || text.isEmpty() )
+        return matches;
+    const int numTests = m_keys.size();
+
+    // regular expression: '/pattern/', anywhere in the name
+    if ( text.size() >= 2 && text.startsWith('/') && text.endsWith('/') ) {
+        const QRegExp regExp(text.mid(1, text.size() - 2), Qt::CaseInsensitive, QRegExp::RegExp2);
+        if ( !regExp.isValid() ) {
+            matches.isValid = false;
+            return matches;
+        }
+        for ( int t = 0; t < numTests; ++t ) {
+            if ( regExp.indexIn(m_keys.at(t)) != -1 )
+                addMatch(&matches, t);
+        }
+        return matches;
+    }
+
+    // glob or substring
+    const QString pattern = text.toLower();
+    const bool isGlob = ( pattern.contains('*') || pattern.contains('?') || pattern.contains('[') );
+    const QRegExp glob(pattern, Qt::CaseSensitive, QRegExp::Wildcard);
+    if ( isGlob && !glob.isValid() ) {
+        matches.isValid = false;
+        return matches;
+    }
+
+    // only check tests that have all of the query's trigrams
+    bool isNarrowed = false;
+    const QVector<int> candidates = candidatesFor( (isGlob ? globLiterals(pattern) : QStringList(pattern)), &isNarrowed );
+    const int numCandidates = ( isNarrowed ? candidates.size() : numTests );
+    for ( int i = 0; i < numCandidates; ++i ) {
+        const int t = ( isNarrowed ? candidates.at(i) : i );
+        const QString& key = m_keys.at(t);
+
+        bool isMatch = false;
+        if ( isGlob )
+            isMatch = glob.exactMatch(key) || glob.exactMatch( key.mid(m_keyTestOffsets.at(t)) );
+        else
+            isMatch = key.contains(pattern);
+
+        if ( isMatch )
+            addMatch(&matches, t);
+    }
+    return matches;
+}
+
+bool TestSearchIndex::isBuilt(void) const {
+    return m_isBuilt;
+}
+
+bool TestSearchIndex::matchesProgram(const Matches& matches, const TestProgram* program) const {
+    const int index = m_programIndexes.value(program, -1);
+    return ( index >= 0 && index < matches.programCounts.size() && matches.programCounts.at(index) > 0 );
+}
+
+bool TestSearchIndex::matchesSuite(const Matches& matches, const TestSuite* suite) const {
+    const int index = m_suiteIndexes.value(suite, -1);
+    return ( index >= 0 && index < matches.suiteCounts.size() && matches.suiteCounts.at(index) > 0 );
+}
+
+bool TestSearchIndex::matchesTest(const Matches& matches, const TestSuite* suite, int testIndex) const {
+    const int index = m_suiteIndexes.value(suite, -1);
+    if ( index < 0 )
+        return false;
+    const int test = m_suites.at(index).firstTest + testIndex;
+    return ( test >= 0 && test < matches.tests.size() && matches.tests.testBit(test) );
+}
+
+QList<TestCase*> TestSearchIndex::matchingTests(const Matches& matches) const {
+    QList<TestCase*> tests;
+    const int numTests = qMin(matches.tests.size(), m_tests.size());
+    for ( int t = 0; t < numTests; ++t ) {
+        if ( matches.tests.testBit(t) )
+            tests.append( m_tests.at(t) );
+    }
+    return tests;
+}
+
+void TestSearchIndex::setSource(const TestRunner* runner) {
+
+    Q_ASSERT_X(runner, Q_FUNC_INFO, "null test runner");
+
+    // drop any previous data
+    m_programNames.clear();
+    m_suites.clear();
+    m_suiteNames.clear();
+    m_testNames.clear();
+    m_testSuites.clear();
+    m_tests.clear();
+    m_programIndexes.clear();
+    m_suiteIndexes.clear();
+    m_keys.clear();
+    m_keyTestOffsets.clear();
+    m_postings.clear();
+    m_isBuilt = false;
+
+    // copy names (shared, not deep copies) & pointers, in tree order
+    const int numPrograms = runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        const TestProgram* program = runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        m_programIndexes.insert(program, i);
+        m_programNames.append( program->programName() );
+
+        const int numSuites = program->suiteCount();
+        for ( int j = 0; j < numSuites; ++j ) {
+            const TestSuite* suite = program->suiteAt(j);
+            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+            SuiteInfo info;
+            info.program   = i;
+            info.firstTest = m_tests.size();
+            m_suiteIndexes.insert(suite, m_suites.size());
+            m_suites.append(info);
+            m_suiteNames.append( suite->name() );
+
+            const int numTests = suite->testCount();
+            for ( int k = 0; k < numTests; ++k ) {
+                TestCase* test = suite->testAt(k);
+                Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+                m_tests.append(test);
+                m_testNames.append( test->name() );
+                m_testSuites.append( m_suites.size() - 1 );
+            }
+        }
+    }
+}
+
+int TestSearchIndex::testCount(void) const {
+    return m_tests.size();
+}
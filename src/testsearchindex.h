@@ -0,0 +1,97 @@
+#ifndef TESTSEARCHINDEX_H
+#define TESTSEARCHINDEX_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+class TestCase;
+class TestProgram;
+class TestRunner;
+class TestSuite;
+
+// trigram index over every test's 'program/Suite.Test' name, for instant
+// filtering of huge test trees
+//
+// queries (always case-insensitive):
+//   'Overflow'               substring of the full name
+//   'Suite.*', '*Ser*Over*'  glob, matching the full name or 'Suite.Test'
+//   '/Serial.+Over(flow)?/'  regular expression, anywhere in the full name
+//
+// substrings & globs are narrowed down to candidates sharing all of their
+// trigrams (3-letter pieces) first, so only a handful of names are actually
+// compared. Short substrings (< 3 letters) & regular expressions scan all names.
+//
+// setSource() copies names & pointers from the runner (cheap, GUI thread);
+// build() does the real work, & only touches those copies, so it may run in
+// the background. The runner's objects are never dereferenced by the index.
+class TestSearchIndex {
+
+    // matches
+    public:
+        struct Matches {
+            QBitArray    tests;          // by test (in program, suite, test order)
+            QVector<int> suiteCounts;    // matching tests in each suite
+            QVector<int> programCounts;  // matching tests in each program
+            int count;
+            bool isValid;                // false if query couldn't be parsed
+
+            Matches(void);
+        };
+
+    // ctor & dtor
+    public:
+        TestSearchIndex(void);
+        ~TestSearchIndex(void);
+
+    // TestSearchIndex interface
+    public:
+
+        // index construction
+        void setSource(const TestRunner* runner);
+        void build(void);
+        bool isBuilt(void) const;
+
+        // queries
+        Matches find(const QString& query) const;
+        int testCount(void) const;
+
+        // visibility of runner objects in a query's results
+        bool matchesProgram(const Matches& matches, const TestProgram* program) const;
+        bool matchesSuite(const Matches& matches, const TestSuite* suite) const;
+        bool matchesTest(const Matches& matches, const TestSuite* suite, int testIndex) const;
+        QList<TestCase*> matchingTests(const Matches& matches) const;
+
+    // internal methods
+    private:
+        void addMatch(Matches* matches, int test) const;
+        QVector<int> candidatesFor(const QStringList& literals, bool* isNarrowed) const;
+        Matches emptyMatches(void) const;
+
+    // data members
+    private:
+        struct SuiteInfo {
+            int program;    // index into m_programNames
+            int firstTest;  // index into m_tests
+        };
+
+        // source (copied from runner)
+        QStringList        m_programNames;
+        QVector<SuiteInfo> m_suites;
+        QStringList        m_suiteNames;
+        QStringList        m_testNames;
+        QVector<int>       m_testSuites;   // suite of each test
+        QVector<TestCase*> m_tests;
+        QHash<const TestProgram*, int> m_programIndexes;
+        QHash<const TestSuite*, int>   m_suiteIndexes;
+
+        // built
+        QVector<QString> m_keys;           // lowercase 'program/suite.test'
+        QVector<int>     m_keyTestOffsets; // where 'suite.test' starts in each key
+        QHash<quint64, QVector<int> > m_postings; // trigram -> tests, ascending
+        bool m_isBuilt;
+};
+
+#endif // TESTSEARCHINDEX_H
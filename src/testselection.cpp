@@ -0,0 +1,191 @@
+#include "testselection.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+
+    // where named selections are kept
+    const char* const SettingsOrganization = "edgecase";
+    const char* const SettingsApplication  = "edgecase";
+    const char* const SelectionsKey        = "testSelections";
+
+} // namespace Constants
+
+// one program's part of a selection
+struct ProgramSelection {
+    bool isAll;
+    QSet<QString> wholeSuites;
+    QHash<QString, QSet<QString> > tests; // by suite
+
+    ProgramSelection(void) : isAll(false) { }
+};
+
+// returns all named selections
+static
+QVariantMap loadSelections(void) {
+    const QSettings settings(Constants::SettingsOrganization, Constants::SettingsApplication);
+    return settings.value(Constants::SelectionsKey).toMap();
+}
+
+// replaces all named selections
+static
+void storeSelections(const QVariantMap& selections) {
+    QSettings settings(Constants::SettingsOrganization, Constants::SettingsApplication);
+    settings.setValue(Constants::SelectionsKey, selections);
+}
+
+// -------------------------------
+// TestSelection implementation
+// -------------------------------
+
+int TestSelection::apply(TestRunner* runner, const QStringList& patterns) {
+
+    Q_ASSERT_X(runner, Q_FUNC_INFO, "null test runner");
+
+    // program paths (test names may contain '/' too, so these tell where a pattern's path ends)
+    QSet<QString> programPaths;
+    const int numPrograms = runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i )
+        programPaths.insert( runner->programPath(runner->programAt(i)) );
+
+    // patterns, by program path - or by program name, for patterns saved before
+    // they had paths ('program/Suite.Test')
+    QHash<QString, ProgramSelection> selections;
+    QHash<QString, ProgramSelection> selectionsByName;
+    foreach ( const QString& pattern, patterns ) {
+        const int nameSlash = pattern.indexOf('/');
+        if ( nameSlash <= 0 )
+            continue;
+        int slash = nameSlash;
+        while ( slash > 0 && !programPaths.contains(pattern.left(slash)) )
+            slash = pattern.indexOf('/', slash + 1);
+        const bool hasPath = ( slash > 0 );
+        if ( !hasPath )
+            slash = nameSlash;
+        ProgramSelection& selection = ( hasPath ? selections : selectionsByName )[ pattern.left(slash) ];
+        const QString rest = pattern.mid(slash + 1);
+        if ( rest == "*" ) {
+            selection.isAll = true;
+            continue;
+        }
+        const int dot = rest.indexOf('.');
+        if ( dot <= 0 )
+            continue;
+        const QString suiteName = rest.left(dot);
+        const QString testName  = rest.mid(dot + 1);
+        if ( testName == "*" )
+            selection.wholeSuites.insert(suiteName);
+        else
+            selection.tests[suiteName].insert(testName);
+    }
+
+    // whole programs & suites are switched without visiting their tests (unless they change)
+    int numEnabled = 0;
+    for ( int i = 0; i < numPrograms; ++i ) {
+        TestProgram* program = runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+
+        const ProgramSelection* found = 0;
+        const QString path = runner->programPath(program);
+        if ( selections.contains(path) )
+            found = &selections[path];
+        else if ( selectionsByName.contains(program->programName()) )
+            found = &selectionsByName[ program->programName() ];
+        if ( !found || found->isAll ) {
+            program->setTestsEnabled( found != 0 );
+            numEnabled += program->enabledTestCount();
+            continue;
+        }
+
+        const int numSuites = program->suiteCount();
+        for ( int j = 0; j < numSuites; ++j ) {
+            TestSuite* suite = program->suiteAt(j);
+            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+            const QHash<QString, QSet<QString> >::const_iterator suiteTests = found->tests.constFind( suite->name() );
+            if ( suiteTests == found->tests.constEnd() ) {
+                suite->setTestsEnabled( found->wholeSuites.contains(suite->name()) );
+                continue;
+            }
+
+            const int numTests = suite->testCount();
+            for ( int k = 0; k < numTests; ++k ) {
+                TestCase* test = suite->testAt(k);
+                Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+                test->setEnabled( suiteTests->contains(test->name()) );
+            }
+        }
+        numEnabled += program->enabledTestCount();
+    }
+    return numEnabled;
+}
+
+QStringList TestSelection::fromEnabledTests(const TestRunner* runner) {
+
+    Q_ASSERT_X(runner, Q_FUNC_INFO, "null test runner");
+
+    QStringList patterns;
+    const int numPrograms = runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i ) {
+        const TestProgram* program = runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+
+        // whole program, or none of it
+        if ( !program->hasEnabledTests() )
+            continue;
+        const QString prefix = runner->programPath(program) + '/';
+        if ( program->enabledTestCount() == program->totalTestCount() ) {
+            patterns.append(prefix + '*');
+            continue;
+        }
+
+        // whole suites, or their enabled tests
+        const int numSuites = program->suiteCount();
+        for ( int j = 0; j < numSuites; ++j ) {
+            const TestSuite* suite = program->suiteAt(j);
+            Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+            const int numEnabled = suite->enabledTestCount();
+            if ( numEnabled == 0 )
+                continue;
+            const QString suitePrefix = prefix + suite->name() + '.';
+            if ( numEnabled == suite->testCount() ) {
+                patterns.append(suitePrefix + '*');
+                continue;
+            }
+
+            const int numTests = suite->testCount();
+            for ( int k = 0; k < numTests; ++k ) {
+                const TestCase* test = suite->testAt(k);
+                Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+                if ( test->isEnabled() )
+                    patterns.append(suitePrefix + test->name());
+            }
+        }
+    }
+    return patterns;
+}
+
+QStringList TestSelection::load(const QString& name) {
+    return loadSelections().value(name).toStringList();
+}
+
+void TestSelection::remove(const QString& name) {
+    QVariantMap selections = loadSelections();
+    if ( selections.remove(name) > 0 )
+        storeSelections(selections);
+}
+
+void TestSelection::save(const QString& name, const QStringList& patterns) {
+    QVariantMap selections = loadSelections();
+    selections.insert(name, patterns);
+    storeSelections(selections);
+}
+
+QStringList TestSelection::savedNames(void) {
+    // (map keys are sorted)
+    return loadSelections().keys();
+}
@@ -0,0 +1,33 @@
+#ifndef TESTSELECTION_H
+#define TESTSELECTION_H
+
+#include <QStringList>
+class TestRunner;
+
+// the set of enabled tests, as name patterns that outlive any one listing
+//
+// patterns are 'path/Suite.Test', with 'path/Suite.*' for a fully enabled
+// suite & 'path/*' for a fully enabled program, so even a huge selection is
+// only as long as its partly enabled suites. Paths are relative to the listed
+// directory (see TestRunner::programPath()), so programs of the same name in
+// different subdirectories are kept apart; patterns saved w/ just the program's
+// name are still applied to any program of that name. Programs with nothing
+// enabled aren't listed.
+//
+// named selections are kept in the user's settings (not per directory, so
+// e.g. "fast tests" applies to any build of the same programs).
+class TestSelection {
+    public:
+
+        // current selection, or make one current (returns number of enabled tests)
+        static QStringList fromEnabledTests(const TestRunner* runner);
+        static int apply(TestRunner* runner, const QStringList& patterns);
+
+        // named selections
+        static QStringList savedNames(void); // sorted
+        static QStringList load(const QString& name);
+        static void save(const QString& name, const QStringList& patterns);
+        static void remove(const QString& name);
+};
+
+#endif // TESTSELECTION_H
@@ -1,5 +1,6 @@
 #include "testsuite.h"
 #include "testcase.h"
+#include "testprogram.h"
 #include <QtCore>
 #include <QtDebug>
 
@@ -8,8 +9,14 @@
 // --------------------------
 
 TestSuite::TestSuite(const QString& name)
-    : m_name(name)
+    : m_program(0)
+    , m_name(name)
     , m_time(-1.0)
+    , m_enabledCount(0)
+    , m_runCount(0)
+    , m_passedCount(0)
+    , m_failedCount(0)
+    , m_regressedCount(0)
 { }
 
 TestSuite::~TestSuite(void) {
@@ -21,7 +28,54 @@ TestSuite::~TestSuite(void) {
 }
 
 void TestSuite::addTest(TestCase* test) {
+
+    Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
     m_tests.append(test);
+    test->setSuite(this);
+    if ( !m_testsByName.contains(test->name()) )
+        m_testsByName.insert(test->name(), test);
+
+    // include the new test's current status in our counts
+    const int enabledDelta = ( test->isEnabled() ? 1 : 0 );
+    const int runDelta     = ( test->wasRun() ? 1 : 0 );
+    const int passedDelta  = ( test->wasRun() && test->passed() ? 1 : 0 );
+    const int failedDelta  = ( test->wasRun() && !test->passed() ? 1 : 0 );
+    m_enabledCount += enabledDelta;
+    m_runCount     += runDelta;
+    m_passedCount  += passedDelta;
+    m_failedCount  += failedDelta;
+    if ( test->hasBenchmarkRegression() )
+        adjustRegressedCount(1);
+
+    // notify parent
+    if ( m_program )
+        m_program->adjustCounts(1, enabledDelta, runDelta, passedDelta, failedDelta);
+}
+
+void TestSuite::adjustCounts(int enabledDelta, int runDelta, int passedDelta, int failedDelta) {
+
+    // update our counts
+    m_enabledCount += enabledDelta;
+    m_runCount     += runDelta;
+    m_passedCount  += passedDelta;
+    m_failedCount  += failedDelta;
+
+    Q_ASSERT_X(m_enabledCount >= 0 && m_runCount >= 0 && m_passedCount >= 0 && m_failedCount >= 0,
+               Q_FUNC_INFO, "negative test count");
+
+    // notify parent
+    if ( m_program )
+        m_program->adjustCounts(0, enabledDelta, runDelta, passedDelta, failedDelta);
+}
+
+void TestSuite::adjustRegressedCount(int delta) {
+
+    m_regressedCount += delta;
+    Q_ASSERT_X(m_regressedCount >= 0, Q_FUNC_INFO, "negative test count");
+
+    // notify parent
+    if ( m_program )
+        m_program->adjustRegressedCount(delta);
 }
 
 void TestSuite::clearResults(void) {
@@ -34,45 +88,32 @@ void TestSuite::clearResults(void) {
     }
 }
 
+int TestSuite::enabledTestCount(void) const {
+    return m_enabledCount;
+}
+
 QString TestSuite::name(void) const {
     return m_name;
 }
 
 int TestSuite::failedTestCount(void) const {
-    int count = 0;
-    foreach ( TestCase* test, m_tests ) {
-        Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-        if ( test->wasRun() && !test->passed() )
-            ++count;
-    }
-    return count;
+    return m_failedCount;
 }
 
 bool TestSuite::hasEnabledTests(void) const {
-    foreach ( TestCase* test, m_tests ) {
-        Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-        if ( test->isEnabled() )
-            return true;
-    }
-    return false;
+    return m_enabledCount > 0;
 }
 
 bool TestSuite::hasFailedTests(void) const {
-    foreach ( TestCase* test, m_tests ) {
-        Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-        if ( test->wasRun() && !test->passed() )
-            return true;
-    }
-    return false;
+    return m_failedCount > 0;
+}
+
+bool TestSuite::hasRegressedTests(void) const {
+    return m_regressedCount > 0;
 }
 
 bool TestSuite::hasRunTests(void) const {
-    foreach ( TestCase* test, m_tests ) {
-        Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-        if ( test->wasRun() )
-            return true;
-    }
-    return false;
+    return m_runCount > 0;
 }
 
 bool TestSuite::hasTime(void) const {
@@ -80,23 +121,42 @@ bool TestSuite::hasTime(void) const {
 }
 
 int TestSuite::passedTestCount(void) const {
-    int count = 0;
-    foreach ( TestCase* test, m_tests ) {
-        Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-        if ( test->wasRun() && test->passed() )
-            ++count;
-    }
-    return count;
+    return m_passedCount;
+}
+
+TestProgram* TestSuite::program(void) const {
+    return m_program;
+}
+
+int TestSuite::regressedTestCount(void) const {
+    return m_regressedCount;
 }
 
 int TestSuite::runTestCount(void) const {
-    int count = 0;
+    return m_runCount;
+}
+
+void TestSuite::setProgram(TestProgram* program) {
+    m_program = program;
+}
+
+void TestSuite::setTestsEnabled(bool ok) {
+
+    // nothing to change
+    const int targetCount = ( ok ? m_tests.size() : 0 );
+    if ( m_enabledCount == targetCount )
+        return;
+
+    // flip tests directly, & adjust counts once
+    int enabledDelta = 0;
     foreach ( TestCase* test, m_tests ) {
         Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-        if ( test->wasRun() )
-            ++count;
+        if ( test->m_isEnabled == ok )
+            continue;
+        test->m_isEnabled = ok;
+        enabledDelta += ( ok ? 1 : -1 );
     }
-    return count;
+    adjustCounts(enabledDelta, 0, 0, 0);
 }
 
 void TestSuite::setTime(qreal t) {
@@ -113,12 +173,7 @@ int TestSuite::testCount(void) const {
 }
 
 TestCase* TestSuite::testForName(const QString& name) const {
-    foreach ( TestCase* test, m_tests ) {
-        Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
-        if ( test->name() == name )
-            return test;
-    }
-    return 0;
+    return m_testsByName.value(name, 0);
 }
 
 qreal TestSuite::time(void) const {
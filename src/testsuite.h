@@ -1,10 +1,12 @@
 #ifndef TESTSUITE_H
 #define TESTSUITE_H
 
+#include <QHash>
 #include <QList>
 #include <QMetaType>
 #include <QString>
 class TestCase;
+class TestProgram;
 
 class TestSuite {
 
@@ -18,9 +20,13 @@ class TestSuite {
         // name
         QString name(void) const;
 
+        // parent program (set when added to a TestProgram)
+        TestProgram* program(void) const;
+
         // status
         bool hasEnabledTests(void) const;
         bool hasFailedTests(void) const;
+        bool hasRegressedTests(void) const; // benchmark regressions
         bool hasRunTests(void) const;
 
         // time
@@ -34,17 +40,39 @@ class TestSuite {
         TestCase* testAt(int index) const;
         TestCase* testForName(const QString& name) const;
 
+        // enables (or disables) all of our tests, only visiting them if any change
+        void setTestsEnabled(bool ok = true);
+
         // convenience methods
         void clearResults(void);
+        int enabledTestCount(void) const;
         int runTestCount(void) const;
         int passedTestCount(void) const;
         int failedTestCount(void) const;
+        int regressedTestCount(void) const;
+
+    // internal methods
+    private:
+        friend class TestCase;
+        friend class TestProgram;
+        void adjustCounts(int enabledDelta, int runDelta, int passedDelta, int failedDelta);
+        void adjustRegressedCount(int delta);
+        void setProgram(TestProgram* program);
 
     // data members
     private:
+        TestProgram* m_program; // copy, not owned
         QString m_name;
         qreal   m_time;
         QList<TestCase*> m_tests;
+        QHash<QString, TestCase*> m_testsByName;
+
+        // aggregate counts, kept up to date by our test cases
+        int m_enabledCount;
+        int m_runCount;
+        int m_passedCount;
+        int m_failedCount;
+        int m_regressedCount;
 };
 
 Q_DECLARE_METATYPE(TestSuite*)
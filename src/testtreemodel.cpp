@@ -0,0 +1,500 @@
+#include "testtreemodel.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testrunner.h"
+#include "testsuite.h"
+#include <QtGui>
+#include <QtDebug>
+
+namespace Constants {
+
+    // rows created per fetchMore(), views fetch more as they scroll to the end
+    const int FetchChunkSize = 1000;
+
+} // namespace Constants
+
+// ---------------------------------
+// TestTreeModel::Node implementation
+// ---------------------------------
+
+TestTreeModel::Node::Node(Kind k, Node* p, int r)
+    : kind(k)
+    , parent(p)
+    , row(r)
+    , isFetched(false)
+    , fetchedCount(0)
+    , program(0)
+    , suite(0)
+    , test(0)
+{
+    if ( parent ) {
+        program = parent->program;
+        suite   = parent->suite;
+    }
+}
+
+TestTreeModel::Node::~Node(void) {
+    qDeleteAll(children);
+}
+
+// ---------------------------------
+// TestTreeModel implementation
+// ---------------------------------
+
+TestTreeModel::TestTreeModel(TestRunner* runner, QObject* parent)
+    : QAbstractItemModel(parent)
+    , m_runner(runner)
+    , m_root(new Node(Node::Root, 0, 0))
+    , m_isSelectionLocked(false)
+    , m_searchIndex(0)
+    , m_passColor("#98fc66")
+    , m_failColor("#f44800")
+    , m_regressionColor("#f4c000")
+    , m_noResultColor("#aaaaaa")
+{
+    m_root->isFetched = true;
+}
+
+TestTreeModel::~TestTreeModel(void) {
+    delete m_root;
+}
+
+bool TestTreeModel::canFetchMore(const QModelIndex& parent) const {
+    const Node* node = nodeForIndex(parent);
+    return !node->isFetched && childCountForNode(node) > 0;
+}
+
+Qt::CheckState TestTreeModel::checkStateForNode(const Node* node) const {
+
+    Q_ASSERT_X(node, Q_FUNC_INFO, "null node");
+
+    // from enabled counts, so no need to visit any tests
+    int enabledCount = 0;
+    int totalCount = 0;
+    switch ( node->kind ) {
+        case Node::Program :
+            enabledCount = node->program->enabledTestCount();
+            totalCount   = node->program->totalTestCount();
+            break;
+        case Node::Suite :
+            enabledCount = node->suite->enabledTestCount();
+            totalCount   = node->suite->testCount();
+            break;
+        case Node::Test :
+            return ( node->test->isEnabled() ? Qt::Checked : Qt::Unchecked );
+        case Node::Root :
+        default:
+            return Qt::Unchecked;
+    }
+
+    if ( enabledCount == 0 )
+        return Qt::Unchecked;
+    if ( enabledCount == totalCount )
+        return Qt::Checked;
+    return Qt::PartiallyChecked;
+}
+
+int TestTreeModel::childCountForNode(const Node* node) const {
+    Q_ASSERT_X(node, Q_FUNC_INFO, "null node");
+    switch ( node->kind ) {
+        case Node::Root    : return node->children.size();
+        case Node::Program : return node->program->suiteCount();
+        case Node::Suite   : return node->suite->testCount();
+        case Node::Test    :
+        default:
+            return 0;
+    }
+}
+
+void TestTreeModel::clear(void) {
+    beginResetModel();
+    qDeleteAll(m_root->children);
+    m_root->children.clear();
+    m_programNodes.clear();
+    m_pendingPrograms.clear();
+    m_searchIndex = 0;
+    m_matches = TestSearchIndex::Matches();
+    endResetModel();
+}
+
+void TestTreeModel::clearFilter(void) {
+    if ( m_searchIndex == 0 )
+        return;
+    m_searchIndex = 0;
+    m_matches = TestSearchIndex::Matches();
+    rebuild();
+}
+
+QColor TestTreeModel::colorForNode(const Node* node) const {
+
+    Q_ASSERT_X(node, Q_FUNC_INFO, "null node");
+
+    // waiting for new results
+    if ( m_pendingPrograms.contains(node->program) )
+        return m_noResultColor;
+
+    switch ( node->kind ) {
+
+        case Node::Program : {
+            const TestProgram* program = node->program;
+            if ( program->hasError() || program->hasFailedTests() ) return m_failColor;
+            if ( !program->hasRunTests() )      return m_noResultColor;
+            if ( program->hasRegressedTests() ) return m_regressionColor;
+            return m_passColor;
+        }
+
+        case Node::Suite : {
+            const TestSuite* suite = node->suite;
+            if ( !suite->hasRunTests() )      return m_noResultColor;
+            if ( suite->hasFailedTests() )    return m_failColor;
+            if ( suite->hasRegressedTests() ) return m_regressionColor;
+            return m_passColor;
+        }
+
+        case Node::Test : {
+            const TestCase* test = node->test;
+            if ( !test->wasRun() )                return m_noResultColor;
+            if ( !test->passed() )                return m_failColor;
+            if ( test->hasBenchmarkRegression() ) return m_regressionColor;
+            return m_passColor;
+        }
+
+        case Node::Root :
+        default:
+            return QColor();
+    }
+}
+
+int TestTreeModel::columnCount(const QModelIndex& parent) const {
+    Q_UNUSED(parent);
+    return 1;
+}
+
+QVariant TestTreeModel::data(const QModelIndex& index, int role) const {
+
+    if ( !index.isValid() )
+        return QVariant();
+    const Node* node = nodeForIndex(index);
+
+    switch ( role ) {
+        case Qt::DisplayRole :
+            switch ( node->kind ) {
+                case Node::Program : return node->program->programName();
+                case Node::Suite   : return node->suite->name();
+                case Node::Test    : return node->test->name();
+                default:
+                    return QVariant();
+            }
+
+        // only once a program has results (otherwise, default background)
+        case Qt::BackgroundRole : {
+            const bool hasStatus = ( node->program->hasRunTests() ||
+                                     node->program->hasError() ||
+                                     m_pendingPrograms.contains(node->program) );
+            if ( !hasStatus )
+                return QVariant();
+            return QBrush( colorForNode(node) );
+        }
+
+        case Qt::CheckStateRole :
+            return checkStateForNode(node);
+
+        case Qt::ToolTipRole :
+            if ( node->kind == Node::Test && !m_pendingPrograms.contains(node->program) )
+                return toolTipForTest(node->test);
+            return QVariant();
+
+        default:
+            return QVariant();
+    }
+}
+
+void TestTreeModel::emitAncestorsChanged(Node* node) {
+    Q_ASSERT_X(node, Q_FUNC_INFO, "null node");
+    for ( Node* ancestor = node->parent; ancestor && ancestor != m_root; ancestor = ancestor->parent ) {
+        const QModelIndex index = indexForNode(ancestor);
+        emit dataChanged(index, index);
+    }
+}
+
+void TestTreeModel::emitChildrenChanged(Node* node) {
+
+    Q_ASSERT_X(node, Q_FUNC_INFO, "null node");
+    if ( node->children.isEmpty() )
+        return;
+
+    // node's fetched children, & theirs
+    const QModelIndex parent = indexForNode(node);
+    emit dataChanged( index(0, 0, parent), index(node->children.size() - 1, 0, parent) );
+    foreach ( Node* child, node->children )
+        emitChildrenChanged(child);
+}
+
+void TestTreeModel::fetchMore(const QModelIndex& parent) {
+
+    Node* node = nodeForIndex(parent);
+    if ( node->isFetched )
+        return;
+
+    // create the next chunk of this node's (visible) children, after any fetched so far
+    const int count = childCountForNode(node);
+    QVector<int> visibleChildren;
+    visibleChildren.reserve( qMin(count - node->fetchedCount, int(Constants::FetchChunkSize)) );
+    int next = node->fetchedCount;
+    for ( ; next < count && visibleChildren.size() < Constants::FetchChunkSize; ++next ) {
+        if ( isVisible(node, next) )
+            visibleChildren.append(next);
+    }
+    node->fetchedCount = next;
+    node->isFetched = ( next >= count );
+    if ( visibleChildren.isEmpty() )
+        return;
+
+    const int firstRow = node->children.size();
+    beginInsertRows(parent, firstRow, firstRow + visibleChildren.size() - 1);
+    node->children.reserve(firstRow + visibleChildren.size());
+    for ( int j = 0; j < visibleChildren.size(); ++j ) {
+        const int row = firstRow + j;
+        const int i = visibleChildren.at(j);
+        if ( node->kind == Node::Program ) {
+            Node* child = new Node(Node::Suite, node, row);
+            child->suite = node->program->suiteAt(i);
+            node->children.append(child);
+        } else {
+            Node* child = new Node(Node::Test, node, row);
+            child->test = node->suite->testAt(i);
+            node->children.append(child);
+        }
+    }
+    endInsertRows();
+}
+
+Qt::ItemFlags TestTreeModel::flags(const QModelIndex& index) const {
+    if ( !index.isValid() )
+        return 0;
+    Qt::ItemFlags result = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if ( !m_isSelectionLocked )
+        result |= Qt::ItemIsUserCheckable;
+    return result;
+}
+
+bool TestTreeModel::hasChildren(const QModelIndex& parent) const {
+    const Node* node = nodeForIndex(parent);
+    return ( !node->children.isEmpty() ||
+             (!node->isFetched && childCountForNode(node) > 0) );
+}
+
+QModelIndex TestTreeModel::index(int row, int column, const QModelIndex& parent) const {
+    const Node* node = nodeForIndex(parent);
+    if ( column != 0 || row < 0 || row >= node->children.size() )
+        return QModelIndex();
+    return createIndex(row, column, node->children.at(row));
+}
+
+QModelIndex TestTreeModel::indexForNode(Node* node) const {
+    if ( node == 0 || node == m_root )
+        return QModelIndex();
+    return createIndex(node->row, 0, node);
+}
+
+QModelIndex TestTreeModel::indexForProgram(TestProgram* program) const {
+    return indexForNode( m_programNodes.value(program, 0) );
+}
+
+bool TestTreeModel::isFiltered(void) const {
+    return ( m_searchIndex != 0 );
+}
+
+bool TestTreeModel::isSelectionLocked(void) const {
+    return m_isSelectionLocked;
+}
+
+bool TestTreeModel::isVisible(const Node* parent, int childIndex) const {
+
+    Q_ASSERT_X(parent, Q_FUNC_INFO, "null node");
+    if ( m_searchIndex == 0 )
+        return true;
+
+    // matching tests, & programs & suites holding any
+    switch ( parent->kind ) {
+        case Node::Root    : return m_searchIndex->matchesProgram(m_matches, m_runner->programAt(childIndex));
+        case Node::Program : return m_searchIndex->matchesSuite(m_matches, parent->program->suiteAt(childIndex));
+        case Node::Suite   : return m_searchIndex->matchesTest(m_matches, parent->suite, childIndex);
+        case Node::Test    :
+        default:
+            return false;
+    }
+}
+
+void TestTreeModel::markAllPending(void) {
+
+    // sanity check
+    Q_ASSERT_X(m_runner, Q_FUNC_INFO, "null test runner");
+    if ( m_runner == 0 )
+        return;
+
+    // all programs (not only those shown)
+    const int numPrograms = m_runner->programCount();
+    for ( int i = 0; i < numPrograms; ++i )
+        m_pendingPrograms.insert( m_runner->programAt(i) );
+    emitChildrenChanged(m_root);
+}
+
+TestTreeModel::Node* TestTreeModel::nodeForIndex(const QModelIndex& index) const {
+    if ( !index.isValid() )
+        return m_root;
+    Q_ASSERT_X(index.model() == this, Q_FUNC_INFO, "index from another model");
+    return static_cast<Node*>( index.internalPointer() );
+}
+
+QModelIndex TestTreeModel::parent(const QModelIndex& index) const {
+    if ( !index.isValid() )
+        return QModelIndex();
+    return indexForNode( nodeForIndex(index)->parent );
+}
+
+TestProgram* TestTreeModel::programForIndex(const QModelIndex& index) const {
+    const Node* node = nodeForIndex(index);
+    return ( node->kind == Node::Program ? node->program : 0 );
+}
+
+void TestTreeModel::rebuild(void) {
+
+    // sanity check
+    Q_ASSERT_X(m_runner, Q_FUNC_INFO, "null test runner");
+    if ( m_runner == 0 )
+        return;
+
+    beginResetModel();
+    qDeleteAll(m_root->children);
+    m_root->children.clear();
+    m_programNodes.clear();
+
+    // (visible) program nodes only (suites & tests are fetched as needed)
+    const int numPrograms = m_runner->programCount();
+    m_root->children.reserve(numPrograms);
+    for ( int i = 0; i < numPrograms; ++i ) {
+        TestProgram* program = m_runner->programAt(i);
+        Q_ASSERT_X(program, Q_FUNC_INFO, "null test program");
+        if ( !isVisible(m_root, i) )
+            continue;
+
+        Node* node = new Node(Node::Program, m_root, m_root->children.size());
+        node->program = program;
+        m_root->children.append(node);
+        m_programNodes.insert(program, node);
+    }
+    endResetModel();
+}
+
+void TestTreeModel::reset(void) {
+    m_pendingPrograms.clear();
+    m_searchIndex = 0;
+    m_matches = TestSearchIndex::Matches();
+    rebuild();
+}
+
+int TestTreeModel::rowCount(const QModelIndex& parent) const {
+    return nodeForIndex(parent)->children.size();
+}
+
+bool TestTreeModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+
+    if ( !index.isValid() || role != Qt::CheckStateRole || m_isSelectionLocked )
+        return false;
+    Node* node = nodeForIndex(index);
+
+    // (partially checked programs & suites become fully checked)
+    const bool isEnabled = ( value.toInt() != Qt::Unchecked );
+    switch ( node->kind ) {
+        case Node::Program : node->program->setTestsEnabled(isEnabled); break;
+        case Node::Suite   : node->suite->setTestsEnabled(isEnabled);   break;
+        case Node::Test    : node->test->setEnabled(isEnabled);         break;
+        case Node::Root    :
+        default:
+            return false;
+    }
+
+    // row, its fetched descendants, & its ancestors' tri-states
+    emit dataChanged(index, index);
+    emitChildrenChanged(node);
+    emitAncestorsChanged(node);
+    emit testSelectionChanged();
+    return true;
+}
+
+void TestTreeModel::setFilter(const TestSearchIndex* index, const TestSearchIndex::Matches& matches) {
+    Q_ASSERT_X(index, Q_FUNC_INFO, "null search index");
+    m_searchIndex = index;
+    m_matches = matches;
+    rebuild();
+}
+
+void TestTreeModel::setSelectionLocked(bool locked) {
+    m_isSelectionLocked = locked;
+}
+
+TestSuite* TestTreeModel::suiteForIndex(const QModelIndex& index) const {
+    const Node* node = nodeForIndex(index);
+    return ( node->kind == Node::Suite ? node->suite : 0 );
+}
+
+TestCase* TestTreeModel::testForIndex(const QModelIndex& index) const {
+    const Node* node = nodeForIndex(index);
+    return ( node->kind == Node::Test ? node->test : 0 );
+}
+
+QString TestTreeModel::toolTipForTest(const TestCase* test) const {
+
+    Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+
+    // show start of failure message (full text may be large & on disk)
+    QString toolTip = test->failurePreview();
+
+    // or any benchmark regressions
+    if ( test->hasBenchmarkRegression() ) {
+        QStringList regressions;
+        const QList<BenchmarkComparison> comparisons = test->benchmarkComparisons();
+        foreach ( const BenchmarkComparison& comparison, comparisons ) {
+            if ( comparison.status == BenchmarkComparison::Regressed )
+                regressions.append( comparison.toString() );
+        }
+        if ( !toolTip.isEmpty() )
+            toolTip.append("\n\n");
+        toolTip.append( regressions.join("\n") );
+    }
+
+    return toolTip;
+}
+
+void TestTreeModel::updateAll(void) {
+    emitChildrenChanged(m_root);
+}
+
+void TestTreeModel::updateProgram(TestProgram* program) {
+    updatePrograms( QList<TestProgram*>() << program );
+}
+
+void TestTreeModel::updatePrograms(const QList<TestProgram*>& programs) {
+
+    // find rows of programs
+    QList<Node*> nodes;
+    int firstRow = -1;
+    int lastRow  = -1;
+    foreach ( TestProgram* program, programs ) {
+        m_pendingPrograms.remove(program);
+        Node* node = m_programNodes.value(program, 0);
+        if ( node == 0 )
+            continue;
+        nodes.append(node);
+        firstRow = ( firstRow == -1 ? node->row : qMin(firstRow, node->row) );
+        lastRow  = qMax(lastRow, node->row);
+    }
+    if ( nodes.isEmpty() )
+        return;
+
+    // one range for all program rows, & any fetched suites & tests
+    emit dataChanged( index(firstRow, 0), index(lastRow, 0) );
+    foreach ( Node* node, nodes )
+        emitChildrenChanged(node);
+}
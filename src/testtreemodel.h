@@ -0,0 +1,140 @@
+#ifndef TESTTREEMODEL_H
+#define TESTTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include "testsearchindex.h"
+class TestCase;
+class TestProgram;
+class TestRunner;
+class TestSuite;
+
+// programs > suites > tests, straight from a TestRunner's data
+//
+// nodes for a program's suites (or a suite's tests) are only created once a
+// view asks for them (canFetchMore/fetchMore, i.e. when expanded), a chunk of
+// rows at a time (views fetch more as they're scrolled), so listing - or
+// expanding - even huge test trees is cheap. Each node knows its parent & row, so index
+// lookups are O(1). Status colors & tooltips are computed in data(), for the
+// rows a view actually shows.
+//
+// with a filter set, only matching tests (& the suites & programs holding
+// them) get nodes.
+//
+// each row has a (tri-state, for programs & suites) checkbox showing whether
+// its tests are enabled for the next run. Checking a program or suite enables
+// all of its tests, whether or not they're shown.
+class TestTreeModel : public QAbstractItemModel {
+
+    Q_OBJECT
+
+    // ctor & dtor
+    public:
+        explicit TestTreeModel(TestRunner* runner, QObject* parent = 0);
+        ~TestTreeModel(void);
+
+    // signals
+    signals:
+        void testSelectionChanged(void); // by checking/unchecking rows
+
+    // TestTreeModel interface
+    public:
+
+        // rebuild from runner's programs, or drop them all
+        void reset(void);
+        void clear(void);
+
+        // only show tests matching a search (index not owned)
+        void setFilter(const TestSearchIndex* index, const TestSearchIndex::Matches& matches);
+        void clearFilter(void);
+        bool isFiltered(void) const;
+
+        // checkboxes are read-only while locked (e.g. during runs)
+        bool isSelectionLocked(void) const;
+        void setSelectionLocked(bool locked);
+
+        // show programs as waiting for results (until updateProgram())
+        void markAllPending(void);
+
+        // refresh status of programs & their fetched suites & tests
+        void updateProgram(TestProgram* program);
+        void updatePrograms(const QList<TestProgram*>& programs);
+        void updateAll(void);
+
+        // index <-> runner data
+        QModelIndex indexForProgram(TestProgram* program) const;
+        TestProgram* programForIndex(const QModelIndex& index) const;
+        TestSuite* suiteForIndex(const QModelIndex& index) const;
+        TestCase* testForIndex(const QModelIndex& index) const;
+
+    // QAbstractItemModel interface
+    public:
+        bool canFetchMore(const QModelIndex& parent) const;
+        int columnCount(const QModelIndex& parent = QModelIndex()) const;
+        QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+        void fetchMore(const QModelIndex& parent);
+        Qt::ItemFlags flags(const QModelIndex& index) const;
+        bool hasChildren(const QModelIndex& parent = QModelIndex()) const;
+        QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+        QModelIndex parent(const QModelIndex& index) const;
+        int rowCount(const QModelIndex& parent = QModelIndex()) const;
+        bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
+
+    // internal methods
+    private:
+        struct Node;
+        Qt::CheckState checkStateForNode(const Node* node) const;
+        int childCountForNode(const Node* node) const;
+        QColor colorForNode(const Node* node) const;
+        void emitAncestorsChanged(Node* node);
+        void emitChildrenChanged(Node* node);
+        QModelIndex indexForNode(Node* node) const;
+        Node* nodeForIndex(const QModelIndex& index) const;
+        bool isVisible(const Node* parent, int childIndex) const;
+        void rebuild(void);
+        QString toolTipForTest(const TestCase* test) const;
+
+    // data members
+    private:
+        struct Node {
+            enum Kind { Root = 0
+                      , Program
+                      , Suite
+                      , Test
+                      };
+
+            Kind  kind;
+            Node* parent;
+            int   row;
+            bool  isFetched;        // all children created
+            int   fetchedCount;     // suites (or tests) looked at so far, w/ or w/o a child node
+            QList<Node*> children;
+
+            // (a test node has its suite & program set too, etc.)
+            TestProgram* program;
+            TestSuite*   suite;
+            TestCase*    test;
+
+            Node(Kind k, Node* p, int r);
+            ~Node(void);
+        };
+
+        TestRunner* m_runner; // copy, not owned
+        Node* m_root;
+        QHash<TestProgram*, Node*> m_programNodes;
+        QSet<TestProgram*> m_pendingPrograms;
+        bool m_isSelectionLocked;
+
+        const TestSearchIndex* m_searchIndex; // copy, not owned
+        TestSearchIndex::Matches m_matches;
+
+        QColor m_passColor;
+        QColor m_failColor;
+        QColor m_regressionColor;
+        QColor m_noResultColor;
+};
+
+#endif // TESTTREEMODEL_H
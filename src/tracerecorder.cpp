@@ -0,0 +1,243 @@
+#include "tracerecorder.h"
+#include "jsonwriter.h"
+#include "runnermetrics.h"
+#include "testcase.h"
+#include "testprogram.h"
+#include "testsuite.h"
+#include <QtCore>
+#include <QtDebug>
+
+namespace Constants {
+
+    // keeps traces of huge runs loadable (program spans are always written)
+    const int MaxTestSpans = 200000;
+
+    const int MainThread = 0; // slot N is thread N+1
+
+} // namespace Constants
+
+// returns seconds as whole usecs
+static
+qint64 toUsecs(qreal seconds) {
+    return qint64(seconds * 1e6 + 0.5);
+}
+
+// ------------------------------
+// TraceRecorder implementation
+// ------------------------------
+
+TraceRecorder::TraceRecorder(void)
+    : m_isFirstEvent(true)
+    , m_testSpanCount(0)
+{ }
+
+TraceRecorder::~TraceRecorder(void) {
+
+    // unfinished trace is discarded
+    if ( m_file.isOpen() ) {
+        m_file.close();
+        m_file.remove();
+    }
+}
+
+void TraceRecorder::addMainThreadSpan(const QString& name,
+                                      const QString& category,
+                                      qint64 startUsecs,
+                                      qint64 endUsecs)
+{
+    if ( !isActive() )
+        return;
+    writeSpan(name, category, Constants::MainThread, startUsecs, qMax(Q_INT64_C(0), endUsecs - startUsecs));
+}
+
+void TraceRecorder::beginProgram(const TestProgram* program) {
+
+    if ( !isActive() )
+        return;
+
+    // take lowest free slot
+    int slot = m_isSlotBusy.indexOf(false);
+    if ( slot == -1 ) {
+        slot = m_isSlotBusy.size();
+        m_isSlotBusy.append(true);
+        writeThreadName(slot + 1, QString("Slot %1").arg(slot + 1));
+    }
+    m_isSlotBusy[slot] = true;
+
+    m_programSlots.insert(program, slot);
+    m_programStarts.insert(program, now());
+}
+
+void TraceRecorder::endProgram(const TestProgram* program) {
+
+    if ( !isActive() || !m_programSlots.contains(program) )
+        return;
+
+    // release slot
+    const int slot = m_programSlots.take(program);
+    const int thread = slot + 1;
+    m_isSlotBusy[slot] = false;
+
+    // program phases, one after another from when it was started
+    const TestProgram::TaskTiming timing = program->lastTaskTiming();
+    const qint64 programStart = m_programStarts.take(program);
+    qint64 time = programStart;
+
+    if ( timing.spawnTime >= 0.0 ) {
+        const qint64 duration = toUsecs(timing.spawnTime);
+        writeSpan("spawn", "runner", thread, time, duration);
+        time += duration;
+    }
+
+    const qint64 runStart = time;
+    const qint64 runDuration = ( timing.processTime >= 0.0 ? toUsecs(timing.processTime) : 0 );
+    {
+        QString args = QString("{\"run\": %1, \"failed\": %2, \"path\": ")
+                           .arg(program->runTestCount())
+                           .arg(program->failedTestCount());
+        args.append( JsonWriter::string(program->fileName()) );
+        if ( program->hasError() )
+            args.append( ", \"error\": " + JsonWriter::string(program->errorString()) );
+        args.append('}');
+        writeSpan(program->programName(), "program", thread, runStart, runDuration, args);
+        time += runDuration;
+    }
+
+    if ( timing.parseTime >= 0.0 )
+        writeSpan("parse", "runner", thread, time, toUsecs(timing.parseTime));
+
+    // tests: where their output markers were seen, if the framework has them
+    // (relative to the program's start, like its task timing), otherwise
+    // back-to-back inside the run span
+    const qint64 runEnd = runStart + runDuration;
+    qint64 testStart = runStart;
+    const int numSuites = program->suiteCount();
+    for ( int i = 0; i < numSuites && m_testSpanCount < Constants::MaxTestSpans; ++i ) {
+        const TestSuite* suite = program->suiteAt(i);
+        Q_ASSERT_X(suite, Q_FUNC_INFO, "null test suite");
+
+        const int numTests = suite->testCount();
+        for ( int j = 0; j < numTests && m_testSpanCount < Constants::MaxTestSpans; ++j ) {
+            const TestCase* test = suite->testAt(j);
+            Q_ASSERT_X(test, Q_FUNC_INFO, "null test case");
+            if ( !test->wasRun() )
+                continue;
+
+            qint64 start = testStart;
+            qint64 duration = 0;
+            const TestProgram::TestTiming observed = program->testTiming(test);
+            if ( observed.startTime >= 0.0 && observed.finishTime >= observed.startTime ) {
+                start = qBound(runStart, programStart + toUsecs(observed.startTime), runEnd);
+                duration = qMin(programStart + toUsecs(observed.finishTime), runEnd) - start;
+            } else if ( test->hasTime() )
+                duration = qMin(toUsecs(test->time()), runEnd - start);
+            else
+                continue;
+            if ( start >= runEnd || duration < 0 )
+                continue;
+
+            writeSpan(suite->name() + '.' + test->name(), "test", thread, start, duration,
+                      QString("{\"passed\": %1}").arg(JsonWriter::boolean(test->passed())));
+            testStart = qMax(testStart, start + duration);
+            ++m_testSpanCount;
+        }
+    }
+}
+
+bool TraceRecorder::finish(void) {
+
+    if ( !isActive() )
+        return false;
+
+    // whole run, on main thread
+    writeSpan("run", "runner", Constants::MainThread, 0, now());
+
+    // close file & move into place
+    m_stream << "\n]}\n";
+    m_stream.flush();
+    const bool ok = ( m_stream.status() == QTextStream::Ok );
+    m_file.close();
+    if ( !ok || m_file.error() != QFile::NoError ) {
+        qDebug() << "Could not write trace file:" << m_file.errorString();
+        m_file.remove();
+        return false;
+    }
+
+    QFile::remove(m_filename);
+    return m_file.rename(m_filename);
+}
+
+bool TraceRecorder::isActive(void) const {
+    return m_file.isOpen();
+}
+
+qint64 TraceRecorder::now(void) const {
+    return toUsecs( RunnerMetrics::elapsedSeconds(m_timer) );
+}
+
+bool TraceRecorder::start(const QString& filename) {
+
+    // drop any unfinished trace
+    if ( m_file.isOpen() ) {
+        m_file.close();
+        m_file.remove();
+    }
+
+    // reset state
+    m_filename = filename;
+    m_isFirstEvent = true;
+    m_isSlotBusy.clear();
+    m_programSlots.clear();
+    m_programStarts.clear();
+    m_testSpanCount = 0;
+
+    // open temp file
+    m_file.setFileName(filename + ".tmp");
+    if ( !m_file.open(QFile::WriteOnly | QFile::Truncate) ) {
+        qDebug() << "Could not write trace file:" << m_file.errorString();
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    m_stream.setCodec("UTF-8");
+    m_stream << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+    m_timer.start();
+    writeThreadName(Constants::MainThread, "edgecase");
+    return true;
+}
+
+void TraceRecorder::writeEvent(const QString& event) {
+    m_stream << ( m_isFirstEvent ? "\n" : ",\n" ) << event;
+    m_isFirstEvent = false;
+}
+
+void TraceRecorder::writeSpan(const QString& name,
+                              const QString& category,
+                              int thread,
+                              qint64 startUsecs,
+                              qint64 durationUsecs,
+                              const QString& args)
+{
+    // (names & args appended, not substituted - they may contain '%1' etc.)
+    QString event = "{\"name\": " + JsonWriter::string(name);
+    event.append( QString(", \"cat\": \"%1\", \"ph\": \"X\", \"pid\": 1, \"tid\": %2, \"ts\": %3, \"dur\": %4")
+                      .arg(category)
+                      .arg(thread)
+                      .arg(startUsecs)
+                      .arg(durationUsecs) );
+    if ( !args.isEmpty() )
+        event.append( ", \"args\": " + args );
+    event.append('}');
+    writeEvent(event);
+}
+
+void TraceRecorder::writeThreadName(int thread, const QString& name) {
+
+    // thread names & sort order (main thread first, then slots in order)
+    writeEvent( QString("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %1"
+                        ", \"args\": {\"name\": ")
+                    .arg(thread) + JsonWriter::string(name) + "}}" );
+    writeEvent( QString("{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": %1"
+                        ", \"args\": {\"sort_index\": %1}}")
+                    .arg(thread) );
+}
@@ -0,0 +1,78 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+class TestProgram;
+
+// timeline of a test run, as a Chrome trace-event JSON file
+// (chrome://tracing, https://ui.perfetto.dev)
+//
+// each execution slot is a thread track, showing each program's spawn, run,
+// & parse spans. Tests are placed inside their program's run span where their
+// start & finish markers were seen in its output (see TestProgram::testTiming()),
+// so setup/teardown gaps show up where they happened. For frameworks w/o markers,
+// tests w/ a reported time are laid out back-to-back from the start of the run
+// span instead (frameworks run a program's tests sequentially). The 'main thread'
+// track shows edgecase's own result handling & view updates.
+//
+// events are streamed to a temp file as each program finishes, & the file is
+// moved into place by finish().
+class TraceRecorder {
+
+    // ctor & dtor
+    public:
+        TraceRecorder(void);
+        ~TraceRecorder(void);
+
+    // TraceRecorder interface
+    public:
+
+        // run lifetime
+        bool start(const QString& filename);
+        bool finish(void);
+        bool isActive(void) const;
+
+        // current time, in usecs since start()
+        qint64 now(void) const;
+
+        // program spans (between start & finish only)
+        void beginProgram(const TestProgram* program);
+        void endProgram(const TestProgram* program);
+
+        // main thread work (e.g. view updates)
+        void addMainThreadSpan(const QString& name,
+                               const QString& category,
+                               qint64 startUsecs,
+                               qint64 endUsecs);
+
+    // internal methods
+    private:
+        void writeEvent(const QString& event);
+        void writeSpan(const QString& name,
+                       const QString& category,
+                       int thread,
+                       qint64 startUsecs,
+                       qint64 durationUsecs,
+                       const QString& args = QString());
+        void writeThreadName(int thread, const QString& name);
+
+    // data members
+    private:
+        QString m_filename;
+        QFile m_file;                   // temp file, while recording
+        QTextStream m_stream;
+        bool m_isFirstEvent;
+
+        QElapsedTimer m_timer;
+        QVector<bool> m_isSlotBusy;
+        QHash<const TestProgram*, int>    m_programSlots;
+        QHash<const TestProgram*, qint64> m_programStarts;
+        int m_testSpanCount;
+};
+
+#endif // TRACERECORDER_H